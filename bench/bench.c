@@ -0,0 +1,345 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "../src/include/tokenizer.h"
+#include "../src/include/parse.h"
+#include "../src/include/semantic.h"
+#include "../src/include/inline.h"
+#include "../src/include/io.h"
+
+// Programs stressing one dimension of the front end each
+BenchShape Bench_Shapes[] = {
+        {"procedures",   400, 2,  6,  3,   30, 1},
+        {"nesting",      20,  24, 4,  2,   30, 2},
+        {"expressions",  40,  1,  48, 4,   30, 3},
+        {"declarations", 20,  2,  3,  200, 30, 4},
+        {"literals",     100, 2,  12, 3,   90, 5},
+};
+
+#define BENCH_SHAPES (sizeof(Bench_Shapes) / sizeof(Bench_Shapes[0]))
+
+typedef struct {
+    double prime;       // Time taken to prime the source, which is only done once
+    double tokenize;    // } Best time of the phase over the repetitions, in seconds
+    double parse;       // }
+    double semantic;    // }
+    unsigned long long bytes;
+    unsigned long long tokens;
+    unsigned long long nodes;
+} BenchResult;
+
+typedef struct {
+    unsigned repeat;
+    double tolerance;   // Fraction of the baseline rate a phase may lose before it counts as a regression
+    const char *only;   // Shape to run, NULL for all of them
+    const char *baseline;
+    const char *save;
+    bool json;
+} BenchOptions;
+
+// Times every phase on the program, keeping the best of the repetitions
+bool Bench_Run(BenchShape *shape, unsigned repeat, BenchResult *result) {
+    char *source = Bench_Generate(shape);
+    bool ok = true;
+
+    *result = (BenchResult) {0, 1e30, 1e30, 1e30, strlen(source), 0, 0};
+
+    int out = Bench_Silence();
+
+    double priming = Bench_Now();
+    char *primed = Tokenizer_Prime(source);
+    result->prime = Bench_Now() - priming;
+
+    for (unsigned r = 0; r < repeat && ok; r++) {
+        Tokenizer *tokenizer = Tokenizer_Create(primed);
+        unsigned long long tokens = 0;
+        double start = Bench_Now();
+
+        while (Tokenizer_Next(tokenizer) == STATUS_OK && tokenizer->current->type != TT_UNKNOWN)
+            tokens++;
+
+        double tokenized = Bench_Now();
+        Tokenizer_Destroy(tokenizer);
+
+        tokenizer = Tokenizer_Create(primed);
+        Parser *parser = Parser_CreateParser(tokenizer);
+
+        double parsing = Bench_Now();
+        Node *program = Parser_ParseProgram(parser);
+        double parsed = Bench_Now();
+
+        ok = program != NULL;
+
+        if (ok) {
+            SemanticAnalysis *sa = SemanticAnalysis_Create(program);
+
+            double analysing = Bench_Now();
+            ok = SemanticAnalysis_RunAnalysis(sa) == STATUS_OK;
+            double analysed = Bench_Now();
+
+            result->tokens = tokens;
+            result->nodes = Inline_Size(program->node.program.nodes);
+
+            if (tokenized - start < result->tokenize)
+                result->tokenize = tokenized - start;
+            if (parsed - parsing < result->parse)
+                result->parse = parsed - parsing;
+            if (analysed - analysing < result->semantic)
+                result->semantic = analysed - analysing;
+
+            Node_DestroyRecurse(program);
+            SemanticAnalysis_Destroy(sa);
+        }
+
+        Parser_DestroyParser(parser);
+        Tokenizer_Destroy(tokenizer);
+    }
+
+    Bench_Restore(out);
+
+    if (!ok) {
+        BENCH_PRINT("The program generated for \"%s\" does not compile.\n", shape->name);
+    }
+
+    free(primed);
+    free(source);
+    return ok;
+}
+
+double Bench_Rate(unsigned long long count, double seconds) {
+    return seconds > 0 ? (double) count / seconds : 0;
+}
+
+void Bench_Json(FILE *out, BenchShape *shapes, BenchResult *results, unsigned n) {
+    fprintf(out, "{\n  \"shapes\": [\n");
+
+    for (unsigned i = 0; i < n; i++) {
+        BenchShape *s = &shapes[i];
+        BenchResult *r = &results[i];
+
+        fprintf(out, "    {\"name\": \"%s\", \"procedures\": %u, \"depth\": %u, \"expression\": %u, "
+                     "\"declarations\": %u, \"literals\": %u, \"seed\": %u,\n", s->name, s->procedures, s->depth,
+                s->expression, s->declarations, s->literals, s->seed);
+        fprintf(out, "     \"bytes\": %llu, \"tokens\": %llu, \"nodes\": %llu,\n", r->bytes, r->tokens, r->nodes);
+        fprintf(out, "     \"prime\": {\"seconds\": %.6f, \"bytes_per_sec\": %.0f},\n", r->prime,
+                Bench_Rate(r->bytes, r->prime));
+        fprintf(out, "     \"tokenize\": {\"seconds\": %.6f, \"tokens_per_sec\": %.0f},\n", r->tokenize,
+                Bench_Rate(r->tokens, r->tokenize));
+        fprintf(out, "     \"parse\": {\"seconds\": %.6f, \"tokens_per_sec\": %.0f, \"nodes_per_sec\": %.0f},\n",
+                r->parse, Bench_Rate(r->tokens, r->parse), Bench_Rate(r->nodes, r->parse));
+        fprintf(out, "     \"semantic\": {\"seconds\": %.6f, \"nodes_per_sec\": %.0f}}%s\n", r->semantic,
+                Bench_Rate(r->nodes, r->semantic), i + 1 < n ? "," : "");
+    }
+
+    fprintf(out, "  ]\n}\n");
+}
+
+// Finds a rate in a baseline written by this program: the key in the object of the phase, within
+// the entry of the shape. Zero if there is none.
+double Bench_Baseline(const char *text, const char *shape, const char *phase, const char *key) {
+    char pattern[128];
+    snprintf(pattern, sizeof(pattern), "\"name\": \"%s\"", shape);
+
+    const char *entry = strstr(text, pattern);
+
+    if (!entry)
+        return 0;
+
+    const char *end = strstr(entry + 1, "\"name\": ");
+    snprintf(pattern, sizeof(pattern), "\"%s\": {", phase);
+
+    const char *object = strstr(entry, pattern);
+
+    if (!object || (end && object > end))
+        return 0;
+
+    const char *close = strchr(object, '}');
+    snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+
+    const char *value = strstr(object, pattern);
+
+    if (!value || value > close)
+        return 0;
+
+    return strtod(value + strlen(pattern), NULL);
+}
+
+// Every phase is compared by the rate it processes its input at: bytes for priming, tokens for the
+// tokenizer and nodes for the others, so that the baseline holds across changes to the programs
+unsigned Bench_Compare(const char *text, BenchShape *shapes, BenchResult *results, unsigned n, double tolerance) {
+    const char *phases[] = {"prime", "tokenize", "parse", "semantic"};
+    const char *keys[] = {"bytes_per_sec", "tokens_per_sec", "nodes_per_sec", "nodes_per_sec"};
+    unsigned regressions = 0;
+
+    for (unsigned i = 0; i < n; i++) {
+        BenchResult *r = &results[i];
+        double rates[] = {Bench_Rate(r->bytes, r->prime), Bench_Rate(r->tokens, r->tokenize),
+                          Bench_Rate(r->nodes, r->parse), Bench_Rate(r->nodes, r->semantic)};
+
+        for (unsigned p = 0; p < 4; p++) {
+            double base = Bench_Baseline(text, shapes[i].name, phases[p], keys[p]);
+
+            if (base <= 0) {
+                BENCH_PRINT("%-12s %-8s has no baseline.\n", shapes[i].name, phases[p]);
+                continue;
+            }
+
+            double change = rates[p] / base - 1;
+            bool regressed = change < -tolerance;
+            regressions += regressed;
+
+            BENCH_PRINT("%-12s %-8s %12.0f %s, baseline %12.0f (%+.1f%%)%s\n", shapes[i].name, phases[p], rates[p],
+                        keys[p], base, 100 * change, regressed ? " REGRESSION" : "");
+        }
+    }
+
+    return regressions;
+}
+
+void Bench_Usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --shape=NAME          Run only the named shape:");
+    for (unsigned i = 0; i < BENCH_SHAPES; i++)
+        fprintf(stderr, " %s", Bench_Shapes[i].name);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  --procedures=N        } Override the shape of the generated programs\n");
+    fprintf(stderr, "  --depth=N             }\n");
+    fprintf(stderr, "  --expression=N        }\n");
+    fprintf(stderr, "  --declarations=N      }\n");
+    fprintf(stderr, "  --literals=PERCENT    }\n");
+    fprintf(stderr, "  --seed=N              }\n");
+    fprintf(stderr, "  --repeat=N            Keep the best of N runs of every phase (default 5)\n");
+    fprintf(stderr, "  --json                Print the results as JSON\n");
+    fprintf(stderr, "  --save=FILE           Write the results to FILE as the new baseline\n");
+    fprintf(stderr, "  --baseline=FILE       Compare against FILE, failing on any regression\n");
+    fprintf(stderr, "  --tolerance=PERCENT   Slowdown accepted before it counts as a regression (default 25)\n");
+    fprintf(stderr, "  --dump                Print the generated programs instead of measuring them\n");
+}
+
+#define VALUE_OF(arg, prefix) (strncmp(arg, prefix, strlen(prefix)) == 0 ? arg + strlen(prefix) : NULL)
+
+int main(int argc, char **argv) {
+    BenchOptions opts = {5, 0.25, NULL, NULL, NULL, false};
+    long overrides[6] = {-1, -1, -1, -1, -1, -1};
+    const char *names[6] = {"--procedures=", "--depth=", "--expression=", "--declarations=", "--literals=",
+                            "--seed="};
+    bool dump = false;
+
+    for (int i = 1; i < argc; i++) {
+        char *arg = argv[i];
+        char *val;
+        bool known = false;
+
+        for (unsigned k = 0; k < 6 && !known; k++) {
+            if ((val = VALUE_OF(arg, names[k]))) {
+                overrides[k] = strtol(val, NULL, 10);
+                known = true;
+            }
+        }
+
+        if (known)
+            continue;
+
+        if ((val = VALUE_OF(arg, "--shape="))) {
+            opts.only = val;
+        } else if ((val = VALUE_OF(arg, "--repeat="))) {
+            opts.repeat = (unsigned) strtoul(val, NULL, 10);
+        } else if ((val = VALUE_OF(arg, "--tolerance="))) {
+            opts.tolerance = strtod(val, NULL) / 100;
+        } else if ((val = VALUE_OF(arg, "--save="))) {
+            opts.save = val;
+        } else if ((val = VALUE_OF(arg, "--baseline="))) {
+            opts.baseline = val;
+        } else if (strcmp(arg, "--json") == 0) {
+            opts.json = true;
+        } else if (strcmp(arg, "--dump") == 0) {
+            dump = true;
+        } else {
+            Bench_Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (opts.repeat == 0)
+        opts.repeat = 1;
+
+    BenchShape shapes[BENCH_SHAPES];
+    BenchResult results[BENCH_SHAPES];
+    unsigned n = 0;
+
+    for (unsigned i = 0; i < BENCH_SHAPES; i++) {
+        if (opts.only && strcmp(opts.only, Bench_Shapes[i].name) != 0)
+            continue;
+
+        BenchShape shape = Bench_Shapes[i];
+        unsigned *fields[6] = {&shape.procedures, &shape.depth, &shape.expression, &shape.declarations,
+                               &shape.literals, &shape.seed};
+
+        for (unsigned k = 0; k < 6; k++)
+            if (overrides[k] >= 0)
+                *fields[k] = (unsigned) overrides[k];
+
+        shapes[n++] = shape;
+    }
+
+    if (n == 0) {
+        BENCH_PRINT("There is no shape named \"%s\".\n", opts.only);
+        return 2;
+    }
+
+    if (dump) {
+        for (unsigned i = 0; i < n; i++) {
+            char *source = Bench_Generate(&shapes[i]);
+            fputs(source, stdout);
+            free(source);
+        }
+        return 0;
+    }
+
+    for (unsigned i = 0; i < n; i++) {
+        if (!Bench_Run(&shapes[i], opts.repeat, &results[i]))
+            return 1;
+
+        BenchResult *r = &results[i];
+        BENCH_PRINT("%-12s %7llu bytes %7llu tokens %7llu nodes | prime %8.4fs tokenize %7.4fs parse %7.4fs "
+                    "semantic %7.4fs\n", shapes[i].name, r->bytes, r->tokens, r->nodes, r->prime, r->tokenize,
+                    r->parse, r->semantic);
+    }
+
+    if (opts.json)
+        Bench_Json(stdout, shapes, results, n);
+
+    if (opts.save) {
+        FILE *file = fopen(opts.save, "w");
+
+        if (!file) {
+            BENCH_PRINT("Could not write the baseline \"%s\".\n", opts.save);
+            return 1;
+        }
+
+        Bench_Json(file, shapes, results, n);
+        fclose(file);
+        BENCH_PRINT("Saved the baseline to \"%s\".\n", opts.save);
+    }
+
+    if (opts.baseline) {
+        char *text = read_file((char *) opts.baseline);
+
+        if (!text) {
+            BENCH_PRINT("Could not read the baseline \"%s\".\n", opts.baseline);
+            return 1;
+        }
+
+        unsigned regressions = Bench_Compare(text, shapes, results, n, opts.tolerance);
+        free(text);
+
+        if (regressions > 0) {
+            BENCH_PRINT("%u phase(s) slowed down by more than %.0f%% against the baseline.\n", regressions,
+                        100 * opts.tolerance);
+            return 1;
+        }
+    }
+
+    return 0;
+}
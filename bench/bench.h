@@ -0,0 +1,28 @@
+#ifndef LFLOW_BENCH_H
+#define LFLOW_BENCH_H
+
+#include <stdio.h>
+
+#define BENCH_PRINT(...) \
+        fprintf(stderr, "Benchide -> "); \
+        fprintf(stderr, __VA_ARGS__);
+
+// Shape of a generated program
+typedef struct {
+    const char *name;
+    unsigned procedures;    // Procedures besides the top level, each calling earlier ones now and then
+    unsigned depth;         // Checks and loops nested in every procedure
+    unsigned expression;    // Operands of every expression
+    unsigned declarations;  // Variables declared at every level of nesting
+    unsigned literals;      // Percentage of operands that are literals rather than variables
+    unsigned seed;
+} BenchShape;
+
+char *Bench_Generate(BenchShape *);
+
+double Bench_Now();
+double Bench_Cpu();
+int Bench_Silence();
+void Bench_Restore(int);
+
+#endif
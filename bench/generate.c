@@ -0,0 +1,132 @@
+#include "bench.h"
+
+#include <stdlib.h>
+
+typedef struct {
+    BenchShape *shape;
+    FILE *out;
+    unsigned long long state;
+    unsigned procedure;     // Being generated, procedures before it can be called
+    unsigned level;         // Of nesting, every level declares its own variables
+    unsigned declared;      // Variables of the innermost level declared so far
+} BenchGenerator;
+
+// xorshift64*, the same program for the same seed
+unsigned Bench_Random(BenchGenerator *gen, unsigned bound) {
+    gen->state ^= gen->state >> 12;
+    gen->state ^= gen->state << 25;
+    gen->state ^= gen->state >> 27;
+    return (unsigned) ((gen->state * 2685821657736338717ULL) >> 33) % bound;
+}
+
+void Bench_Indent(BenchGenerator *gen) {
+    fprintf(gen->out, "%*s", 4 * gen->level, "");
+}
+
+// A literal, a call to an earlier procedure, or a variable declared at this level or an enclosing one
+void Bench_Operand(BenchGenerator *gen) {
+    BenchShape *shape = gen->shape;
+
+    if (Bench_Random(gen, 100) < shape->literals) {
+        fprintf(gen->out, "%u", 1 + Bench_Random(gen, 99));
+        return;
+    }
+
+    if (gen->procedure > 0 && Bench_Random(gen, 20) == 0) {
+        fprintf(gen->out, "p%u(%u, b)", Bench_Random(gen, gen->procedure), 1 + Bench_Random(gen, 9));
+        return;
+    }
+
+    unsigned level = Bench_Random(gen, gen->level + 1);
+    unsigned declared = level == gen->level ? gen->declared : shape->declarations;
+
+    // Loop counters belong to the levels opened by loops, the odd ones past the first
+    if (level >= 3 && level % 2 == 1 && Bench_Random(gen, 4) == 0)
+        fprintf(gen->out, "i%u", level);
+    else if (level > 0 && declared > 0)
+        fprintf(gen->out, "v%u_%u", level, Bench_Random(gen, declared));
+    else
+        fprintf(gen->out, Bench_Random(gen, 2) ? "a" : "b");
+}
+
+void Bench_Expression(BenchGenerator *gen) {
+    static const char *operators[] = {" + ", " - ", " * "};
+
+    for (unsigned i = 0; i < gen->shape->expression; i++) {
+        if (i > 0)
+            fprintf(gen->out, "%s", operators[Bench_Random(gen, 3)]);
+        Bench_Operand(gen);
+    }
+
+    if (gen->shape->expression == 0)
+        fprintf(gen->out, "0");
+}
+
+// The declarations of a level, then the next level in a check or a loop, then an assignment
+void Bench_Level(BenchGenerator *gen) {
+    BenchShape *shape = gen->shape;
+    unsigned level = ++gen->level;
+
+    for (unsigned i = 0; i < shape->declarations; i++) {
+        gen->declared = i;
+        Bench_Indent(gen);
+        fprintf(gen->out, "varying v%u_%u: qword = ", level, i);
+        Bench_Expression(gen);
+        fprintf(gen->out, ";\n");
+    }
+
+    gen->declared = shape->declarations;
+
+    if (level <= shape->depth) {
+        Bench_Indent(gen);
+
+        if (level % 2 == 1) {
+            fprintf(gen->out, "check (");
+            Bench_Expression(gen);
+            fprintf(gen->out, " > %u) {\n", Bench_Random(gen, 100));
+        } else {
+            fprintf(gen->out, "loop (i%u: qword = 0 -> %u) {\n", level + 1, 1 + Bench_Random(gen, 8));
+        }
+
+        Bench_Level(gen);
+
+        Bench_Indent(gen);
+        fprintf(gen->out, "}\n");
+    }
+
+    gen->declared = shape->declarations;
+
+    if (shape->declarations > 0) {
+        Bench_Indent(gen);
+        fprintf(gen->out, "v%u_%u = ", level, Bench_Random(gen, shape->declarations));
+        Bench_Expression(gen);
+        fprintf(gen->out, ";\n");
+    }
+
+    gen->level--;
+}
+
+// A program of the given shape, which passes semantic analysis
+char *Bench_Generate(BenchShape *shape) {
+    char *text = NULL;
+    size_t length = 0;
+    BenchGenerator gen = {shape, open_memstream(&text, &length), 0x9e3779b97f4a7c15ULL ^ shape->seed, 0, 0, 0};
+
+    for (gen.procedure = 0; gen.procedure < shape->procedures; gen.procedure++) {
+        fprintf(gen.out, "procedure p%u(a: qword, b: qword): qword {\n", gen.procedure);
+        Bench_Level(&gen);
+        fprintf(gen.out, "    return ");
+        Bench_Expression(&gen);
+        fprintf(gen.out, ";\n}\n\n");
+    }
+
+    fprintf(gen.out, "varying total: qword = 0;\n");
+
+    for (unsigned i = 0; i < shape->procedures; i++)
+        fprintf(gen.out, "total = total + p%u(%u, %u);\n", i, i, 1 + Bench_Random(&gen, 9));
+
+    fprintf(gen.out, "return total;\n");
+    fclose(gen.out);
+
+    return text;
+}
@@ -0,0 +1,34 @@
+#include "bench.h"
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+double Bench_Now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+// Time spent running this thread, which other processes taking the processor do not add to
+double Bench_Cpu() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+// The compiler reports as it goes, which goes nowhere while it is measured
+int Bench_Silence() {
+    fflush(stdout);
+    int out = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+    return out;
+}
+
+void Bench_Restore(int out) {
+    fflush(stdout);
+    dup2(out, STDOUT_FILENO);
+    close(out);
+}
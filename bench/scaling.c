@@ -0,0 +1,319 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "../src/include/tokenizer.h"
+#include "../src/include/parse.h"
+#include "../src/include/semantic.h"
+
+#define SCALING_PHASES 4
+#define SCALING_STEPS 5
+
+// Every sample compiles its input again until it has run this long, and takes the mean of the runs
+#define SCALING_SAMPLE_SECONDS 0.1
+
+// Phases that took less than this over all the runs of a sample are mostly noise and left out of the fit
+#define SCALING_MIN_SECONDS 0.01
+
+const char *Scaling_Phases[SCALING_PHASES] = {"prime", "tokenize", "parse", "semantic"};
+
+// Inputs growing along one axis, the program of size n being twice as large as that of size n / 2
+typedef struct {
+    const char *name;
+    unsigned size;      // Of the smallest input, doubled at every step
+    void (*generate)(FILE *, unsigned);
+} ScalingAxis;
+
+// Variables with names n characters long
+void Scaling_Identifiers(FILE *out, unsigned n) {
+    for (unsigned k = 0; k < 16; k++) {
+        fprintf(out, "varying %c", 'a' + k);
+        for (unsigned i = 0; i < n; i++)
+            fputc('x', out);
+        fprintf(out, ": qword = %u;\n", k);
+    }
+
+    fprintf(out, "return 0;\n");
+}
+
+// String literals n characters long
+void Scaling_Strings(FILE *out, unsigned n) {
+    for (unsigned k = 0; k < 16; k++) {
+        fprintf(out, "\"%c", 'a' + k);
+        for (unsigned i = 0; i < n; i++)
+            fputc('x', out);
+        fprintf(out, "\";\n");
+    }
+
+    fprintf(out, "return 0;\n");
+}
+
+// A block of n declarations, each referring to the one before
+void Scaling_Wide(FILE *out, unsigned n) {
+    fprintf(out, "procedure f(a: qword): qword {\n    varying v0: qword = a;\n");
+
+    for (unsigned i = 1; i < n; i++)
+        fprintf(out, "    varying v%u: qword = v%u + %u;\n", i, i - 1, i);
+
+    fprintf(out, "    return v%u;\n}\nreturn f(1);\n", n - 1);
+}
+
+// n checks nested in one another, each declaring a variable from the one of the enclosing level
+void Scaling_Nesting(FILE *out, unsigned n) {
+    fprintf(out, "varying v0: qword = 1;\n");
+
+    for (unsigned i = 0; i < n; i++)
+        fprintf(out, "check (v%u > 0) {\nvarying v%u: qword = v%u + 1;\n", i, i + 1, i);
+
+    for (unsigned i = 0; i < n; i++)
+        fprintf(out, "}\n");
+
+    fprintf(out, "return v0;\n");
+}
+
+// An expression of n operands
+void Scaling_Expression(FILE *out, unsigned n) {
+    fprintf(out, "varying a: qword = 1;\nreturn a");
+
+    for (unsigned i = 1; i < n; i++)
+        fprintf(out, " %s %s", i % 2 ? "+" : "-", i % 3 ? "a" : "1");
+
+    fprintf(out, ";\n");
+}
+
+ScalingAxis Scaling_Axes[] = {
+        {"identifiers", 4096, Scaling_Identifiers},
+        {"strings",     4096, Scaling_Strings},
+        {"wide",        2048, Scaling_Wide},
+        {"nesting",     128,  Scaling_Nesting},
+        {"expression",  512,  Scaling_Expression},
+};
+
+#define SCALING_AXES (sizeof(Scaling_Axes) / sizeof(Scaling_Axes[0]))
+
+char *Scaling_Generate(ScalingAxis *axis, unsigned n) {
+    char *text = NULL;
+    size_t length = 0;
+    FILE *out = open_memstream(&text, &length);
+    axis->generate(out, n);
+    fclose(out);
+    return text;
+}
+
+// Times every phase once on the program, false if it does not compile
+bool Scaling_Run(const char *source, double times[SCALING_PHASES]) {
+    int out = Bench_Silence();
+
+    double start = Bench_Cpu();
+    char *primed = Tokenizer_Prime((char *) source);
+    double primed_at = Bench_Cpu();
+
+    Tokenizer *tokenizer = Tokenizer_Create(primed);
+    while (Tokenizer_Next(tokenizer) == STATUS_OK && tokenizer->current->type != TT_UNKNOWN);
+    double tokenized = Bench_Cpu();
+    Tokenizer_Destroy(tokenizer);
+
+    tokenizer = Tokenizer_Create(primed);
+    Parser *parser = Parser_CreateParser(tokenizer);
+
+    double parsing = Bench_Cpu();
+    Node *program = Parser_ParseProgram(parser);
+    double parsed = Bench_Cpu();
+
+    bool ok = program != NULL;
+
+    if (ok) {
+        SemanticAnalysis *sa = SemanticAnalysis_Create(program);
+
+        double analysing = Bench_Cpu();
+        ok = SemanticAnalysis_RunAnalysis(sa) == STATUS_OK;
+        times[3] = Bench_Cpu() - analysing;
+
+        Node_DestroyRecurse(program);
+        SemanticAnalysis_Destroy(sa);
+    }
+
+    Parser_DestroyParser(parser);
+    Tokenizer_Destroy(tokenizer);
+    free(primed);
+
+    Bench_Restore(out);
+
+    times[0] = primed_at - start;
+    times[1] = tokenized - primed_at;
+    times[2] = parsed - parsing;
+    return ok;
+}
+
+// Times every phase as the mean of as many runs as fit in a sample, returning the number of runs or 0 if the
+// program does not compile
+unsigned Scaling_Sample(const char *source, double times[SCALING_PHASES]) {
+    unsigned runs = 0;
+    double start = Bench_Cpu();
+
+    for (unsigned p = 0; p < SCALING_PHASES; p++)
+        times[p] = 0;
+
+    do {
+        double run[SCALING_PHASES];
+
+        if (!Scaling_Run(source, run))
+            return 0;
+
+        for (unsigned p = 0; p < SCALING_PHASES; p++)
+            times[p] += run[p];
+
+        runs++;
+    } while (Bench_Cpu() - start < SCALING_SAMPLE_SECONDS);
+
+    for (unsigned p = 0; p < SCALING_PHASES; p++)
+        times[p] /= runs;
+
+    return runs;
+}
+
+// The exponent k of the growth t ~ n^k, a least squares fit of log t against log n over the times
+// long enough to measure in their runs. Negative if there are not two of them.
+double Scaling_Exponent(const unsigned *sizes, const double *times, const unsigned *runs, unsigned steps) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    unsigned points = 0;
+
+    for (unsigned i = 0; i < steps; i++) {
+        if (times[i] * runs[i] < SCALING_MIN_SECONDS)
+            continue;
+
+        double x = log((double) sizes[i]), y = log(times[i]);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        points++;
+    }
+
+    if (points < 2)
+        return -1;
+
+    return (points * sxy - sx * sy) / (points * sxx - sx * sx);
+}
+
+// Measures every phase on the inputs of the axis, returning the number of phases growing faster
+// than the limit
+unsigned Scaling_Axis(ScalingAxis *axis, unsigned repeat, double limit) {
+    unsigned sizes[SCALING_STEPS], runs[SCALING_STEPS];
+    double times[SCALING_PHASES][SCALING_STEPS];
+
+    for (unsigned s = 0; s < SCALING_STEPS; s++) {
+        sizes[s] = axis->size << s;
+        char *source = Scaling_Generate(axis, sizes[s]);
+
+        for (unsigned p = 0; p < SCALING_PHASES; p++)
+            times[p][s] = 1e30;
+
+        for (unsigned r = 0; r < repeat; r++) {
+            double sample[SCALING_PHASES];
+            runs[s] = Scaling_Sample(source, sample);
+
+            if (runs[s] == 0) {
+                BENCH_PRINT("The \"%s\" input of size %u does not compile.\n", axis->name, sizes[s]);
+                free(source);
+                return SCALING_PHASES;
+            }
+
+            for (unsigned p = 0; p < SCALING_PHASES; p++)
+                if (sample[p] < times[p][s])
+                    times[p][s] = sample[p];
+        }
+
+        free(source);
+    }
+
+    unsigned failures = 0;
+
+    for (unsigned p = 0; p < SCALING_PHASES; p++) {
+        double k = Scaling_Exponent(sizes, times[p], runs, SCALING_STEPS);
+        bool failed = k > limit;
+        failures += failed;
+
+        if (k < 0) {
+            BENCH_PRINT("%-12s %-8s %8.4fs at %6u, too fast to tell\n", axis->name, Scaling_Phases[p],
+                        times[p][SCALING_STEPS - 1], sizes[SCALING_STEPS - 1]);
+        } else {
+            BENCH_PRINT("%-12s %-8s %8.4fs at %6u, grows as n^%.2f%s\n", axis->name, Scaling_Phases[p],
+                        times[p][SCALING_STEPS - 1], sizes[SCALING_STEPS - 1], k, failed ? " TOO FAST" : "");
+        }
+    }
+
+    return failures;
+}
+
+void Scaling_Usage(const char *program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --axis=NAME           Grow only the named axis:");
+    for (unsigned i = 0; i < SCALING_AXES; i++)
+        fprintf(stderr, " %s", Scaling_Axes[i].name);
+    fprintf(stderr, "\n");
+    fprintf(stderr, "  --exponent=K          Fail if a phase grows faster than n^K (default 1.5)\n");
+    fprintf(stderr, "  --repeat=N            Keep the best of N samples at every size (default 3)\n");
+    fprintf(stderr, "  --dump=SIZE           Print the inputs of the given size instead of measuring them\n");
+}
+
+#define VALUE_OF(arg, prefix) (strncmp(arg, prefix, strlen(prefix)) == 0 ? arg + strlen(prefix) : NULL)
+
+int main(int argc, char **argv) {
+    const char *only = NULL;
+    double limit = 1.5;
+    unsigned repeat = 3;
+    unsigned dump = 0;
+
+    for (int i = 1; i < argc; i++) {
+        char *arg = argv[i];
+        char *val;
+
+        if ((val = VALUE_OF(arg, "--axis="))) {
+            only = val;
+        } else if ((val = VALUE_OF(arg, "--exponent="))) {
+            limit = strtod(val, NULL);
+        } else if ((val = VALUE_OF(arg, "--repeat="))) {
+            repeat = (unsigned) strtoul(val, NULL, 10);
+        } else if ((val = VALUE_OF(arg, "--dump="))) {
+            dump = (unsigned) strtoul(val, NULL, 10);
+        } else {
+            Scaling_Usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (repeat == 0)
+        repeat = 1;
+
+    unsigned failures = 0, axes = 0;
+
+    for (unsigned i = 0; i < SCALING_AXES; i++) {
+        if (only && strcmp(only, Scaling_Axes[i].name) != 0)
+            continue;
+
+        axes++;
+
+        if (dump) {
+            char *source = Scaling_Generate(&Scaling_Axes[i], dump);
+            fputs(source, stdout);
+            free(source);
+            continue;
+        }
+
+        failures += Scaling_Axis(&Scaling_Axes[i], repeat, limit);
+    }
+
+    if (axes == 0) {
+        BENCH_PRINT("There is no axis named \"%s\".\n", only);
+        return 2;
+    }
+
+    if (failures > 0) {
+        BENCH_PRINT("%u phase(s) grow faster than n^%.2f.\n", failures, limit);
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,49 +1,35 @@
 #include <stdio.h>
 #include <stdlib.h>
 
-#include "src/include/tokenizer.h"
-#include "src/include/io.h"
-#include "src/include/parse.h"
-#include "src/include/semantic.h"
-
-int main(void) {
-    char *str = read_file("main.flow");
-
-    if (!str) {
-        printf("Failed to read file.\n");
-        return 0;
+#include "src/include/options.h"
+#include "src/include/compile.h"
+#include "src/include/server.h"
+#include "src/include/memory.h"
+
+int main(int argc, char **argv) {
+    Options opts;
+    Options_Default(&opts);
+
+    if (Options_Parse(&opts, argc, argv) == STATUS_FAIL) {
+        Options_Usage(argv[0]);
+        return 1;
     }
 
-    char *primed = Tokenizer_Prime(str);
-    free(str);
-
-    Tokenizer *tokenizer = Tokenizer_Create(primed);
+    if (opts.server)
+        return Server_Run(&opts) == STATUS_OK ? 0 : 1;
 
-    Parser *parser = Parser_CreateParser(tokenizer);
+    Status compiled;
 
-    Node *n = Parser_ParseProgram(parser);
+    if (opts.connect && Server_Request(opts.connect, argc, argv, &compiled) == STATUS_OK)
+        return compiled == STATUS_OK ? 0 : 1;
 
-    Tokenizer_Destroy(tokenizer);
-
-    if (n) {
-        printf("Natron -> Syntactic analysis successful.\n");
-        Node_Print(0, n);
-        SemanticAnalysis *sa = SemanticAnalysis_Create(n);
-        if (SemanticAnalysis_RunAnalysis(sa) == STATUS_FAIL) {
-            printf("Notamide -> Semantic analysis failed.\n");
-        } else {
-            printf("Notamide -> Semantic analysis OK.\n");
-        }
-
-        Node_DestroyRecurse(n);
-        SemanticAnalysis_Destroy(sa);
-    } else {
-        printf("Natron -> Parsing failed.\n");
-    }
+    if (opts.memory_report)
+        Memory_Enable();
 
-    Parser_DestroyParser(parser);
+    AstCache cache = {opts.ast_cache, NULL};
+    Status status = Compile_Run(&opts, &cache);
 
-    free(primed);
+    Memory_Report();
 
-    return 0;
-}
\ No newline at end of file
+    return status == STATUS_OK ? 0 : 1;
+}
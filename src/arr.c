@@ -1,40 +1,79 @@
-#include "include/arr.h"
-
-#include <stdlib.h>
-
-Array *Array_Create() {
-    Array *arr = malloc(sizeof(Array));
-    arr->base = malloc(0);
-    arr->length = 0;
-    return arr;
-}
-
-void Array_Destroy(Array *arr) {
-    if (!arr)
-        return;
-
-    free(arr->base);
-    free(arr);
-}
-
-void Array_DestroyCallBack(Array *array, void (*callback)(void *)) {
-    if (!array)
-        return;
-
-    for (unsigned i = 0; i < array->length; i ++)
-        callback(array->base[i]);
-
-    Array_Destroy(array);
-}
-
-void Array_Push(Array *arr, void *ptr) {
-    arr->base = realloc(arr->base, (++ arr->length) * sizeof(void *));
-    arr->base[arr->length - 1] = ptr;
-}
-
-void *Array_At(Array *arr, unsigned i) {
-    if (i >= arr->length)
-        return NULL;
-
-    return arr->base[i];
-}
\ No newline at end of file
+#include "include/arr.h"
+
+#include <stdlib.h>
+#include "include/memory.h"
+
+Array *Array_Create() {
+    Array *arr = malloc(sizeof(Array));
+    arr->base = NULL;
+    arr->length = 0;
+    arr->capacity = 0;
+    return arr;
+}
+
+void Array_Destroy(Array *arr) {
+    if (!arr)
+        return;
+
+    free(arr->base);
+    free(arr);
+}
+
+void Array_DestroyCallBack(Array *array, void (*callback)(void *)) {
+    if (!array)
+        return;
+
+    for (unsigned i = 0; i < array->length; i ++)
+        callback(array->base[i]);
+
+    Array_Destroy(array);
+}
+
+void Array_Push(Array *arr, void *ptr) {
+    if (arr->length == arr->capacity) {
+        arr->capacity = arr->capacity ? 2 * arr->capacity : 4;
+        arr->base = realloc(arr->base, arr->capacity * sizeof(void *));
+    }
+
+    arr->base[arr->length ++] = ptr;
+}
+
+void *Array_At(Array *arr, unsigned i) {
+    if (i >= arr->length)
+        return NULL;
+
+    return arr->base[i];
+}
+
+void Array_Set(Array *arr, unsigned i, void *ptr) {
+    if (i >= arr->length)
+        return;
+
+    arr->base[i] = ptr;
+}
+
+// Remove the element at the given index, preserving the order of the rest
+void Array_Remove(Array *arr, unsigned i) {
+    if (i >= arr->length)
+        return;
+
+    for (unsigned j = i + 1; j < arr->length; j ++)
+        arr->base[j - 1] = arr->base[j];
+
+    arr->length --;
+}
+
+// Insert an element before the given index
+void Array_Insert(Array *arr, unsigned i, void *ptr) {
+    if (i >= arr->length) {
+        Array_Push(arr, ptr);
+        return;
+    }
+
+    Array_Push(arr, NULL);
+
+    for (unsigned j = arr->length - 1; j > i; j --)
+        arr->base[j] = arr->base[j - 1];
+
+    arr->base[i] = ptr;
+}
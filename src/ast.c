@@ -1,503 +1,641 @@
-#include <stdlib.h>
-#include <string.h>
-#include <stdio.h>
-
-#include "include/param.h"
-#include "include/ast.h"
-#include "include/util.h"
-
-#define CASE(x) case x: return #x;
-
-const char *NodeType_ToString(NodeType type) {
-    switch (type) {
-        CASE(NODE_PROGRAM);
-        CASE(NODE_STRING_LITERAL);
-        CASE(NODE_INTEGER_LITERAL);
-        CASE(NODE_FLOAT_LITERAL);
-        CASE(NODE_VARIABLE_DECLARATION);
-        CASE(NODE_VARIABLE_ASSIGNMENT);
-        CASE(NODE_FUNCTION_CALL);
-        CASE(NODE_FUNCTION_DEFINITION);
-        CASE(NODE_RETURN);
-        CASE(NODE_CHECK);
-        CASE(NODE_BLOCK);
-        CASE(NODE_VARIABLE_REFERENCE);
-        CASE(NODE_BINARY_EXPRESSION);
-
-        default:
-            return "(Unknown Node Type)";
-    }
-}
-
-const char *BinaryType_ToString(BinaryType type) {
-    switch (type) {
-        CASE(BIN_ADD);
-        CASE(BIN_SUB);
-        CASE(BIN_MUL);
-        CASE(BIN_DIV);
-        CASE(BIN_OR);
-        CASE(BIN_AND);
-        CASE(BIN_EQUAL);
-        CASE(BIN_LGREATER);
-        CASE(BIN_RGREATER);
-
-        default:
-            return "*Unknown Binary Type)";
-    }
-}
-
-BinaryType BinaryType_FromTokenType(TokenType tt) {
-    switch (tt) {
-        case TT_PLUS:
-            return BIN_ADD;
-        case TT_MINUS:
-            return BIN_SUB;
-        case TT_ASTERISK:
-            return BIN_MUL;
-        case TT_SLASH:
-            return BIN_DIV;
-        case TT_AND_AND:
-            return BIN_AND;
-        case TT_OR_OR:
-            return BIN_OR;
-        case TT_DOUBLE_EQUALS:
-            return BIN_EQUAL;
-        case TT_LGREATER:
-            return BIN_LGREATER;
-        case TT_RGREATER:
-            return BIN_RGREATER;
-        default:
-            return BIN_UNDEF;
-    }
-}
-
-ModificationQualifier ModificationQualifier_FromTokenType(TokenType token) {
-    switch (token) {
-        case TT_KW_VARYING:
-            return MQ_VARYING;
-        case TT_KW_CONSTANT:
-            return MQ_CONST;
-        default:
-            return MQ_UNDEF;
-    }
-}
-
-const char *ModificationQualifier_String(ModificationQualifier modQua) {
-    switch (modQua) {
-        CASE(MQ_CONST)
-        CASE(MQ_VARYING)
-        CASE(MQ_UNDEF)
-    }
-}
-
-#undef CASE
-
-Node *Node_CreateBase(NodeType type, Node *super) {
-    Node *node = malloc(sizeof(Node));
-    node->type = type;
-    node->super = super;
-    return node;
-}
-
-void Node_DestroyBase(Node *node) {
-    free(node);
-}
-
-Node *Node_CreateProgram(Node *blk) {
-    Node *n = Node_CreateBase(NODE_PROGRAM, NULL);
-    n->node.program.nodes = blk;
-    return n;
-}
-
-Node *Node_CreateStringLiteral(char *str) {
-    Node *n = Node_CreateBase(NODE_STRING_LITERAL, NULL);
-    n->node.str_lit.str = malloc(strlen(str) + 1);
-    strcpy(n->node.str_lit.str, str);
-    return n;
-}
-
-Node *Node_CreateIntegerLiteral(int i) {
-    Node *n = Node_CreateBase(NODE_INTEGER_LITERAL, NULL);
-    n->node.int_lit.n = i;
-    return n;
-}
-
-Node *Node_CreateFloatLiteral(float f) {
-    Node *n = Node_CreateBase(NODE_FLOAT_LITERAL, NULL);
-    n->node.float_lit.f = f;
-    return n;
-}
-
-Node *Node_CreateVariableDeclaration(Token *id, Node *value, Token *type, ModificationQualifier modQua, Node *super) {
-    Node *n = Node_CreateBase(NODE_VARIABLE_DECLARATION, super);
-    n->node.var_decl.defined = value != NULL;
-    n->node.var_decl.value = value;
-    n->node.var_decl.id = Token_Dup(id);
-    n->node.var_decl.type = Type_CreatePlaceholder(type);
-    n->node.var_decl.mutable = modQua;
-    return n;
-}
-
-Node *Node_CreateVariableAssignment(Token *id, Node *value, Node *super) {
-    Node *n = Node_CreateBase(NODE_VARIABLE_ASSIGNMENT, super);
-    n->node.var_assign.id = Token_Dup(id);
-    n->node.var_assign.value = value;
-    return n;
-}
-
-Node *Node_CreateBinaryOperation(Node *left, Node *right, BinaryType type, Node *super) {
-    Node *n = Node_CreateBase(NODE_BINARY_EXPRESSION, super);
-    n->node.binary.left = left;
-    n->node.binary.right = right;
-    n->node.binary.op = type;
-    return n;
-}
-
-Node *Node_CreateFunctionCall(Token *id, Array *xprs, Node *super) {
-    Node *n = Node_CreateBase(NODE_FUNCTION_CALL, super);
-    n->node.fcall.id = Token_Dup(id);
-    n->node.fcall.exprs = xprs;
-    return n;
-}
-
-Node *Node_CreateVariableReference(Token *id, Node *super) {
-    Node *n = Node_CreateBase(NODE_VARIABLE_REFERENCE, super);
-    n->node.var_ref.id = Token_Dup(id);
-    n->node.var_ref.next = NULL;
-    return n;
-}
-
-Node *Node_CreateBlock(Array *arr, Node *super) {
-    Node *n = Node_CreateBase(NODE_BLOCK, super);
-    n->node.block.nodes = arr;
-    n->node.block.sub = NULL;
-    n->node.block.super = NULL;
-    n->node.block.declarations = Array_Create();
-    return n;
-}
-
-Node *Node_CreateFunctionDefinition(Token *id, Token *type, Array *params, Node *blk, Node *super) {
-    Node *n = Node_CreateBase(NODE_FUNCTION_DEFINITION, super);
-    n->node.func_def.id = Token_Dup(id);
-    n->node.func_def.type = Type_CreatePlaceholder(type);
-    n->node.func_def.params = params;
-    n->node.func_def.block = blk;
-    return n;
-}
-
-Node *Node_CreateReturn(Node *expr, Node *super) {
-    Node *n = Node_CreateBase(NODE_RETURN, super);
-    n->node.ret.expr = expr;
-    return n;
-}
-
-Node *Node_CreateCheck(Node *expr, Node *block, Node *sub, Node *super) {
-    Node *n = Node_CreateBase(NODE_CHECK, super);
-    n->node.check.expr = expr;
-    n->node.check.block = block;
-    n->node.check.sub = sub;
-    return n;
-}
-
-Node *Node_CreateSize(Type *type, Node *super) {
-    Node *n = Node_CreateBase(NODE_SIZE, super);
-    n->node.size.type = type;
-    return n;
-}
-
-#define CANFREE(t) (t->type == TYPE_PLACEHOLDER || t->type == TYPE_VOID)
-
-void Node_DestroyRecurse(Node *node) {
-
-    if (!node)
-        return;
-
-    switch (node->type) {
-
-        case NODE_PROGRAM:
-            Node_DestroyRecurse(node->node.program.nodes);
-            break;
-
-        case NODE_VARIABLE_DECLARATION:
-            Token_Destroy(node->node.var_decl.id);
-            if (CANFREE(node->node.var_decl.type)) {
-                Type_Destroy(node->node.var_decl.type);
-            }
-            Node_DestroyRecurse(node->node.var_decl.value);
-            break;
-
-        case NODE_VARIABLE_ASSIGNMENT:
-            Token_Destroy(node->node.var_assign.id);
-            Node_DestroyRecurse(node->node.var_assign.value);
-            break;
-
-        case NODE_STRING_LITERAL:
-            free(node->node.str_lit.str);
-            break;
-
-        case NODE_BINARY_EXPRESSION:
-            Node_DestroyRecurse(node->node.binary.left);
-            Node_DestroyRecurse(node->node.binary.right);
-            break;
-
-        case NODE_FUNCTION_CALL:
-            Token_Destroy(node->node.fcall.id);
-            Array_DestroyCallBack(node->node.fcall.exprs, (void *) Node_DestroyRecurse);
-            break;
-
-        case NODE_VARIABLE_REFERENCE:
-            Token_Destroy(node->node.var_ref.id);
-            if (node->node.var_ref.next)
-                Node_DestroyRecurse(node->node.var_ref.next);
-            break;
-
-        case NODE_BLOCK:
-            Array_DestroyCallBack(node->node.block.nodes, (void *) Node_DestroyRecurse);
-
-            Array_Destroy(node->node.block.declarations);
-            Node_DestroyRecurse(node->node.block.sub);
-            Node_DestroyRecurse(node->node.block.super);
-
-            break;
-
-        case NODE_FUNCTION_DEFINITION:
-            Token_Destroy(node->node.func_def.id);
-            if (CANFREE(node->node.func_def.type)) {
-                Type_Destroy(node->node.func_def.type);
-            }
-            Array_DestroyCallBack(node->node.func_def.params, (void *) FunctionParameter_Destroy);
-            Node_DestroyRecurse(node->node.func_def.block);
-            break;
-
-        case NODE_RETURN:
-            Node_DestroyRecurse(node->node.ret.expr);
-            break;
-
-        case NODE_CHECK:
-            Node_DestroyRecurse(node->node.check.expr);
-            Node_DestroyRecurse(node->node.check.block);
-            Node_DestroyRecurse(node->node.check.sub);
-            break;
-
-        case NODE_SIZE:
-            if (CANFREE(node->node.size.type)) {
-                Type_Destroy(node->node.size.type);
-            }
-            break;
-    }
-
-    Node_DestroyBase(node);
-}
-
-#define OUTPUT(...) \
-        indent_str = indent(depth);            \
-        printf("%s", indent_str);                       \
-        free(indent_str);            \
-        printf(__VA_ARGS__);
-
-void Node_Print(unsigned depth, Node *node) {
-
-    char *indent_str = NULL;
-
-    if (!node) {
-        OUTPUT("(Null Node)\n");
-        return;
-    }
-
-    switch (node->type) {
-        case NODE_PROGRAM:
-        OUTPUT("Program\n");
-            depth++;
-            Node_Print(depth, node->node.program.nodes);
-            depth--;
-            break;
-        case NODE_STRING_LITERAL:
-        OUTPUT("String Literal\n");
-            depth++;
-            OUTPUT("Value: %s\n", node->node.str_lit.str);
-            depth--;
-            break;
-        case NODE_INTEGER_LITERAL:
-        OUTPUT("Integer Literal\n");
-            depth++;
-            OUTPUT("Value: %d\n", node->node.int_lit.n);
-            depth--;
-            break;
-        case NODE_FLOAT_LITERAL:
-        OUTPUT("Float Literal\n");
-            depth++;
-            OUTPUT("Value: %f\n", node->node.float_lit.f);
-            depth--;
-            break;
-        case NODE_VARIABLE_DECLARATION:
-        OUTPUT("Variable Declaration\n");
-            depth++;
-            OUTPUT("Mutable flag: %s\n", ModificationQualifier_String(node->node.var_decl.mutable));
-            OUTPUT("Identifier: %s\n", node->node.var_decl.id->value);
-            OUTPUT("Type: %s\n", Type_Identifier(node->node.var_decl.type));
-            OUTPUT("Expression\n");
-            depth++;
-            if (node->node.var_decl.value)
-                Node_Print(depth, node->node.var_decl.value);
-            else {
-                OUTPUT("Not assigned\n");
-            }
-            depth -= 2;
-            break;
-        case NODE_VARIABLE_ASSIGNMENT:
-        OUTPUT("Variable Assignment\n");
-            depth++;
-            OUTPUT("Identifier: %s\n", node->node.var_assign.id->value);
-            OUTPUT("Expression\n");
-            depth++;
-            Node_Print(depth, node->node.var_assign.value);
-            depth -= 2;
-            break;
-        case NODE_BINARY_EXPRESSION:
-        OUTPUT("Binary expression\n");
-            depth++;
-            OUTPUT("Operation: %s\n", BinaryType_ToString(node->node.binary.op));
-            OUTPUT("Left\n");
-            depth++;
-            Node_Print(depth, node->node.binary.left);
-            depth--;
-            OUTPUT("Right\n");
-            depth++;
-            Node_Print(depth, node->node.binary.right);
-            depth--;
-            depth--;
-            break;
-        case NODE_FUNCTION_CALL:
-        OUTPUT("Function call\n");
-            depth++;
-            OUTPUT("Identifier: %s\n", node->node.fcall.id->value);
-            OUTPUT("Parameters\n");
-            depth++;
-            if (node->node.fcall.exprs->length == 0) {
-                OUTPUT("No parameters\n");
-            } else {
-                for (unsigned i = 0; i < node->node.fcall.exprs->length; i++) {
-                    OUTPUT("Parameter %d\n", i);
-                    depth++;
-                    Node_Print(depth, Array_At(node->node.fcall.exprs, i));
-                    depth--;
-                }
-            }
-            depth--;
-            depth--;
-            break;
-        case NODE_VARIABLE_REFERENCE:
-        OUTPUT("Variable reference\n");
-            depth++;
-            OUTPUT("Identifier: %s\n", node->node.var_ref.id->value);
-            if (node->node.var_ref.next) {
-                OUTPUT("Next\n");
-                depth++;
-                Node_Print(depth, node->node.var_ref.next);
-                depth--;
-            }
-            depth--;
-            break;
-        case NODE_BLOCK:
-        OUTPUT("Block statement\n");
-            depth++;
-            if (node->node.block.nodes->length == 0) {
-                OUTPUT("Empty block\n");
-            }
-            for (unsigned i = 0; i < node->node.block.nodes->length; i++)
-                Node_Print(depth, Array_At(node->node.block.nodes, i));
-            depth--;
-            break;
-        case NODE_FUNCTION_DEFINITION:
-        OUTPUT("Function definition\n");
-            depth++;
-            OUTPUT("Identifier: %s\n", node->node.func_def.id->value);
-            OUTPUT("Type: %s\n", Type_Identifier(node->node.func_def.type));
-            OUTPUT("Parameters\n");
-            depth++;
-            if (node->node.func_def.params->length == 0) {
-                OUTPUT("No parameters\n");
-            }
-            for (unsigned i = 0; i < node->node.func_def.params->length; i++) {
-                FunctionParameter *param = Array_At(node->node.func_def.params, i);
-                OUTPUT("Parameter\n");
-                depth++;
-                OUTPUT("Identifier: %s\n", param->id->value);
-                OUTPUT("Type: %s\n", Type_Identifier(param->type));
-                depth--;
-            }
-            depth--;
-            Node_Print(depth, node->node.func_def.block);
-            depth--;
-            break;
-        case NODE_RETURN:
-        OUTPUT("Return\n");
-            depth++;
-            if (node->node.ret.expr)
-                Node_Print(depth, node->node.ret.expr);
-            else {
-                OUTPUT("No expression\n");
-            }
-            depth--;
-            break;
-        case NODE_CHECK:
-        OUTPUT("Check\n");
-            depth++;
-            OUTPUT("Expression\n");
-            depth++;
-            if (!node->node.check.expr) {
-                OUTPUT("No expression\n");
-            } else {
-                Node_Print(depth, node->node.check.expr);
-            }
-            depth--;
-            Node_Print(depth, node->node.check.block);
-            if (node->node.check.sub) {
-                OUTPUT("Sub-check\n");
-                depth++;
-                Node_Print(depth, node->node.check.sub);
-                depth--;
-            }
-            break;
-        case NODE_SIZE:
-            break;
-            OUTPUT("Size: %s\n", Type_Identifier(node->node.size.type));
-            break;
-        default:
-        OUTPUT("(Undefined Node)\n");
-            break;
-    }
-}
-
-// Find an element (variable declaration, function def., complex type, ...)
-// in the scope hierarchy
-Element Block_FindElement(Node *blk, Token *id) {
-    if (!blk)
-        return (Element) {.n = NULL};
-
-    Array *arr = blk->node.block.declarations;
-
-    if (!arr)
-        return (Element) {.n = NULL};
-
-    // Look in current scope
-    for (unsigned i = 0; i < arr->length; i ++) {
-        Node *n = Array_At(arr, i);
-        if (!n)
-            continue;
-        if (n->type == NODE_VARIABLE_DECLARATION)
-            if (Token_Cmp(n->node.var_decl.id, id))
-                return (Element) {.type = ELEMENT_VARIABLE, .n = n};
-        if (n->type == NODE_FUNCTION_DEFINITION)
-            if (Token_Cmp(n->node.func_def.id, id))
-                return (Element) {.type = ELEMENT_FUNCTION, .n = n};
-    }
-
-    // Look in higher-order scopes
-    if (blk->node.block.super != NULL)
-        return Block_FindElement(blk->node.block.super, id);
-
-    return (Element) {.n = NULL};
-}
-
-#undef OUTPUT
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "include/param.h"
+#include "include/ast.h"
+#include "include/pool.h"
+#include "include/memory.h"
+
+#define CASE(x) case x: return #x;
+
+const char *NodeType_ToString(NodeType type) {
+    switch (type) {
+        CASE(NODE_PROGRAM);
+        CASE(NODE_STRING_LITERAL);
+        CASE(NODE_INTEGER_LITERAL);
+        CASE(NODE_FLOAT_LITERAL);
+        CASE(NODE_VARIABLE_DECLARATION);
+        CASE(NODE_VARIABLE_ASSIGNMENT);
+        CASE(NODE_FUNCTION_CALL);
+        CASE(NODE_FUNCTION_DEFINITION);
+        CASE(NODE_RETURN);
+        CASE(NODE_CHECK);
+        CASE(NODE_BLOCK);
+        CASE(NODE_VARIABLE_REFERENCE);
+        CASE(NODE_BINARY_EXPRESSION);
+        CASE(NODE_SIZE);
+        CASE(NODE_LOOP);
+        CASE(NODE_INDEX);
+        CASE(NODE_REDUCE);
+        CASE(NODE_COMPLEX);
+
+        default:
+            return "(Unknown Node Type)";
+    }
+}
+
+const char *BinaryType_ToString(BinaryType type) {
+    switch (type) {
+        CASE(BIN_ADD);
+        CASE(BIN_SUB);
+        CASE(BIN_MUL);
+        CASE(BIN_DIV);
+        CASE(BIN_OR);
+        CASE(BIN_AND);
+        CASE(BIN_EQUAL);
+        CASE(BIN_LGREATER);
+        CASE(BIN_RGREATER);
+
+        default:
+            return "*Unknown Binary Type)";
+    }
+}
+
+BinaryType BinaryType_FromTokenType(TokenType tt) {
+    switch (tt) {
+        case TT_PLUS:
+            return BIN_ADD;
+        case TT_MINUS:
+            return BIN_SUB;
+        case TT_ASTERISK:
+            return BIN_MUL;
+        case TT_SLASH:
+            return BIN_DIV;
+        case TT_AND_AND:
+            return BIN_AND;
+        case TT_OR_OR:
+            return BIN_OR;
+        case TT_DOUBLE_EQUALS:
+            return BIN_EQUAL;
+        case TT_LGREATER:
+            return BIN_LGREATER;
+        case TT_RGREATER:
+            return BIN_RGREATER;
+        default:
+            return BIN_UNDEF;
+    }
+}
+
+ModificationQualifier ModificationQualifier_FromTokenType(TokenType token) {
+    switch (token) {
+        case TT_KW_VARYING:
+            return MQ_VARYING;
+        case TT_KW_CONSTANT:
+            return MQ_CONST;
+        default:
+            return MQ_UNDEF;
+    }
+}
+
+const char *ModificationQualifier_String(ModificationQualifier modQua) {
+    switch (modQua) {
+        CASE(MQ_CONST)
+        CASE(MQ_VARYING)
+        CASE(MQ_UNDEF)
+    }
+}
+
+#undef CASE
+
+Node *Node_CreateBase(NodeType type, Node *super) {
+    Node *node = malloc(sizeof(Node));
+    node->type = type;
+    node->super = super;
+    node->etype = NULL;
+    return node;
+}
+
+void Node_DestroyBase(Node *node) {
+    free(node);
+}
+
+Node *Node_CreateProgram(Node *blk, StringPool *strings) {
+    Node *n = Node_CreateBase(NODE_PROGRAM, NULL);
+    n->node.program.nodes = blk;
+    n->node.program.strings = strings;
+    n->node.program.profile = NULL;
+    n->node.program.imports = NULL;
+    return n;
+}
+
+// The text belongs to the string pool
+Node *Node_CreateStringLiteral(const char *str, unsigned id) {
+    Node *n = Node_CreateBase(NODE_STRING_LITERAL, NULL);
+    n->node.str_lit.str = str;
+    n->node.str_lit.id = id;
+    return n;
+}
+
+Node *Node_CreateIntegerLiteral(long long i) {
+    Node *n = Node_CreateBase(NODE_INTEGER_LITERAL, NULL);
+    n->node.int_lit.n = i;
+    return n;
+}
+
+Node *Node_CreateFloatLiteral(double f) {
+    Node *n = Node_CreateBase(NODE_FLOAT_LITERAL, NULL);
+    n->node.float_lit.f = f;
+    return n;
+}
+
+Node *Node_CreateVariableDeclaration(Token *id, Node *value, Token *type, ModificationQualifier modQua, Node *super) {
+    Node *n = Node_CreateBase(NODE_VARIABLE_DECLARATION, super);
+    n->node.var_decl.defined = value != NULL;
+    n->node.var_decl.value = value;
+    n->node.var_decl.id = Token_Dup(id);
+    n->node.var_decl.type = Type_CreatePlaceholder(type);
+    n->node.var_decl.mutable = modQua;
+    n->node.var_decl.refs = 0;
+    n->node.var_decl.imported = false;
+    return n;
+}
+
+Node *Node_CreateVariableAssignment(Token *id, Node *value, Node *super) {
+    Node *n = Node_CreateBase(NODE_VARIABLE_ASSIGNMENT, super);
+    n->node.var_assign.id = Token_Dup(id);
+    n->node.var_assign.value = value;
+    n->node.var_assign.index = NULL;
+    n->node.var_assign.checked = false;
+    n->node.var_assign.decl = NULL;
+    return n;
+}
+
+Node *Node_CreateBinaryOperation(Node *left, Node *right, BinaryType type, Node *super) {
+    Node *n = Node_CreateBase(NODE_BINARY_EXPRESSION, super);
+    n->node.binary.left = left;
+    n->node.binary.right = right;
+    n->node.binary.op = type;
+    return n;
+}
+
+Node *Node_CreateFunctionCall(Token *id, Array *xprs, Node *super) {
+    Node *n = Node_CreateBase(NODE_FUNCTION_CALL, super);
+    n->node.fcall.id = Token_Dup(id);
+    n->node.fcall.exprs = xprs;
+    n->node.fcall.def = NULL;
+    return n;
+}
+
+Node *Node_CreateVariableReference(Token *id, Node *super) {
+    Node *n = Node_CreateBase(NODE_VARIABLE_REFERENCE, super);
+    n->node.var_ref.id = Token_Dup(id);
+    n->node.var_ref.next = NULL;
+    n->node.var_ref.decl = NULL;
+    return n;
+}
+
+Node *Node_CreateBlock(Array *arr, Node *super) {
+    Node *n = Node_CreateBase(NODE_BLOCK, super);
+    n->node.block.nodes = arr;
+    n->node.block.sub = NULL;
+    n->node.block.super = super;
+    n->node.block.declarations = Array_Create();
+    n->node.block.index = NULL;
+    n->node.block.slots = 0;
+    n->node.block.indexed = 0;
+    return n;
+}
+
+Node *Node_CreateFunctionDefinition(Token *id, Token *type, Array *params, Node *blk, Node *super) {
+    Node *n = Node_CreateBase(NODE_FUNCTION_DEFINITION, super);
+    n->node.func_def.id = Token_Dup(id);
+    n->node.func_def.type = Type_CreatePlaceholder(type);
+    n->node.func_def.params = params;
+    n->node.func_def.block = blk;
+    n->node.func_def.param_decls = Array_Create();
+    n->node.func_def.refs = 0;
+    n->node.func_def.reachable = false;
+    n->node.func_def.inline_state = 0;
+    n->node.func_def.pure = false;
+    n->node.func_def.entered = (ProfileCounter) {0, 0};
+    n->node.func_def.module = NULL;
+    n->node.func_def.external = false;
+    return n;
+}
+
+Node *Node_CreateReturn(Node *expr, Node *super) {
+    Node *n = Node_CreateBase(NODE_RETURN, super);
+    n->node.ret.expr = expr;
+    n->node.ret.jump = false;
+    return n;
+}
+
+Node *Node_CreateCheck(Node *expr, Node *block, Node *sub, Node *super) {
+    Node *n = Node_CreateBase(NODE_CHECK, super);
+    n->node.check.expr = expr;
+    n->node.check.block = block;
+    n->node.check.sub = sub;
+    n->node.check.taken = (ProfileCounter) {0, 0};
+    n->node.check.missed = (ProfileCounter) {0, 0};
+    return n;
+}
+
+Node *Node_CreateSize(Type *type, Node *super) {
+    Node *n = Node_CreateBase(NODE_SIZE, super);
+    n->node.size.type = type;
+    return n;
+}
+
+Node *Node_CreateLoop(Node *var, Node *from, Node *to, Node *block, Node *super) {
+    Node *n = Node_CreateBase(NODE_LOOP, super);
+    n->node.loop.var = var;
+    n->node.loop.from = from;
+    n->node.loop.to = to;
+    n->node.loop.block = block;
+    return n;
+}
+
+// Every access is bounds checked until proven otherwise
+Node *Node_CreateIndex(Node *array, Node *expr, Node *super) {
+    Node *n = Node_CreateBase(NODE_INDEX, super);
+    n->node.index.array = array;
+    n->node.index.expr = expr;
+    n->node.index.checked = true;
+    return n;
+}
+
+Node *Node_CreateReduce(Node *expr, Node *super) {
+    Node *n = Node_CreateBase(NODE_REDUCE, super);
+    n->node.reduce.expr = expr;
+    return n;
+}
+
+Node *Node_CreateComplex(Type *type, Node *super) {
+    Node *n = Node_CreateBase(NODE_COMPLEX, super);
+    n->node.complx.type = type;
+    n->node.complx.registered = false;
+    n->node.complx.imported = false;
+    return n;
+}
+
+// Resolved types are owned by the semantic analysis
+// Declare a variable of an already resolved type in the given block
+Node *Node_DeclareVariable(Token *id, Node *value, Type *type, ModificationQualifier modQua, Node *blk) {
+    Node *n = Node_CreateBase(NODE_VARIABLE_DECLARATION, blk);
+    n->node.var_decl.defined = value != NULL;
+    n->node.var_decl.value = value;
+    n->node.var_decl.id = Token_Dup(id);
+    n->node.var_decl.type = type;
+    n->node.var_decl.mutable = modQua;
+    n->node.var_decl.refs = 0;
+    n->node.var_decl.imported = false;
+    Array_Push(blk->node.block.declarations, n);
+    return n;
+}
+
+// Create a resolved reference to a declaration
+Node *Node_Reference(Node *decl, Node *super) {
+    Node *n = Node_CreateVariableReference(decl->node.var_decl.id, super);
+    n->node.var_ref.decl = decl;
+    n->etype = decl->node.var_decl.type;
+    decl->node.var_decl.refs++;
+    return n;
+}
+
+#define CANFREE(t) (t->type == TYPE_PLACEHOLDER)
+
+void Node_DestroyRecurse(Node *node) {
+
+    if (!node)
+        return;
+
+    switch (node->type) {
+
+        case NODE_PROGRAM:
+            Node_DestroyRecurse(node->node.program.nodes);
+            StringPool_Destroy(node->node.program.strings);
+            if (node->node.program.imports)
+                Array_DestroyCallBack(node->node.program.imports, free);
+            break;
+
+        case NODE_VARIABLE_DECLARATION:
+            Token_Destroy(node->node.var_decl.id);
+            if (CANFREE(node->node.var_decl.type)) {
+                Type_Destroy(node->node.var_decl.type);
+            }
+            Node_DestroyRecurse(node->node.var_decl.value);
+            break;
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            Token_Destroy(node->node.var_assign.id);
+            Node_DestroyRecurse(node->node.var_assign.value);
+            Node_DestroyRecurse(node->node.var_assign.index);
+            break;
+
+        case NODE_BINARY_EXPRESSION:
+            Node_DestroyRecurse(node->node.binary.left);
+            Node_DestroyRecurse(node->node.binary.right);
+            break;
+
+        case NODE_FUNCTION_CALL:
+            Token_Destroy(node->node.fcall.id);
+            Array_DestroyCallBack(node->node.fcall.exprs, (void *) Node_DestroyRecurse);
+            break;
+
+        case NODE_VARIABLE_REFERENCE:
+            Token_Destroy(node->node.var_ref.id);
+            if (node->node.var_ref.next)
+                Node_DestroyRecurse(node->node.var_ref.next);
+            break;
+
+        case NODE_BLOCK:
+            Array_DestroyCallBack(node->node.block.nodes, (void *) Node_DestroyRecurse);
+
+            Array_Destroy(node->node.block.declarations);
+            free(node->node.block.index);
+
+            break;
+
+        case NODE_FUNCTION_DEFINITION:
+            Token_Destroy(node->node.func_def.id);
+            if (CANFREE(node->node.func_def.type)) {
+                Type_Destroy(node->node.func_def.type);
+            }
+            Array_DestroyCallBack(node->node.func_def.params, (void *) FunctionParameter_Destroy);
+            Array_DestroyCallBack(node->node.func_def.param_decls, (void *) Node_DestroyRecurse);
+            Node_DestroyRecurse(node->node.func_def.block);
+            break;
+
+        case NODE_RETURN:
+            Node_DestroyRecurse(node->node.ret.expr);
+            break;
+
+        case NODE_CHECK:
+            Node_DestroyRecurse(node->node.check.expr);
+            Node_DestroyRecurse(node->node.check.block);
+            Node_DestroyRecurse(node->node.check.sub);
+            break;
+
+        case NODE_SIZE:
+            if (CANFREE(node->node.size.type)) {
+                Type_Destroy(node->node.size.type);
+            }
+            break;
+
+        case NODE_LOOP:
+            Node_DestroyRecurse(node->node.loop.var);
+            Node_DestroyRecurse(node->node.loop.from);
+            Node_DestroyRecurse(node->node.loop.to);
+            Node_DestroyRecurse(node->node.loop.block);
+            break;
+
+        case NODE_INDEX:
+            Node_DestroyRecurse(node->node.index.array);
+            Node_DestroyRecurse(node->node.index.expr);
+            break;
+
+        case NODE_REDUCE:
+            Node_DestroyRecurse(node->node.reduce.expr);
+            break;
+
+        case NODE_COMPLEX:
+            if (!node->node.complx.registered)
+                Type_DestroyHard(node->node.complx.type);
+            break;
+
+        // String literals refer to the text in the program's string pool
+        case NODE_STRING_LITERAL:
+        case NODE_INTEGER_LITERAL:
+        case NODE_FLOAT_LITERAL:
+            break;
+    }
+
+    Node_DestroyBase(node);
+}
+
+// Scopes with fewer declarations are searched in order
+#define BLOCK_INDEX_THRESHOLD 16
+
+Token *Block_DeclarationId(Node *n) {
+    if (n->type == NODE_VARIABLE_DECLARATION)
+        return n->node.var_decl.id;
+    if (n->type == NODE_FUNCTION_DEFINITION)
+        return n->node.func_def.id;
+    return NULL;
+}
+
+// The slot holding the declaration of the name, or the free slot it would go to
+Node **Block_Slot(Node *blk, const char *name) {
+    unsigned mask = blk->node.block.slots - 1;
+
+    for (unsigned i = StringPool_Hash(name, strlen(name)) & mask;; i = (i + 1) & mask) {
+        Node *n = blk->node.block.index[i];
+
+        if (!n || strcmp(Block_DeclarationId(n)->value, name) == 0)
+            return &blk->node.block.index[i];
+    }
+}
+
+// Adds the declarations pushed since the last lookup. The first one of a name is kept, as it is
+// the one a search in order finds. The slots are kept at most half full.
+void Block_Index(Node *blk) {
+    Array *arr = blk->node.block.declarations;
+
+    if (2 * arr->length > blk->node.block.slots) {
+        unsigned slots = blk->node.block.slots ? blk->node.block.slots : 2 * BLOCK_INDEX_THRESHOLD;
+
+        while (2 * arr->length > slots)
+            slots *= 2;
+
+        free(blk->node.block.index);
+        blk->node.block.index = calloc(slots, sizeof(Node *));
+        blk->node.block.slots = slots;
+        blk->node.block.indexed = 0;
+    }
+
+    for (; blk->node.block.indexed < arr->length; blk->node.block.indexed++) {
+        Node *n = Array_At(arr, blk->node.block.indexed);
+        Token *id = n ? Block_DeclarationId(n) : NULL;
+
+        if (!id)
+            continue;
+
+        Node **slot = Block_Slot(blk, id->value);
+
+        if (!*slot)
+            *slot = n;
+    }
+}
+
+// Find an element (variable declaration, function def., complex type, ...)
+// in the scope hierarchy
+Element Block_FindElement(Node *blk, Token *id) {
+    if (!blk)
+        return (Element) {.n = NULL};
+
+    Array *arr = blk->node.block.declarations;
+
+    if (!arr)
+        return (Element) {.n = NULL};
+
+    if (arr->length > BLOCK_INDEX_THRESHOLD) {
+        Block_Index(blk);
+
+        Node *n = *Block_Slot(blk, id->value);
+
+        if (n)
+            return (Element) {.type = n->type == NODE_VARIABLE_DECLARATION ? ELEMENT_VARIABLE : ELEMENT_FUNCTION,
+                              .n = n};
+
+        return Block_FindElement(blk->node.block.super, id);
+    }
+
+    // Look in current scope
+    for (unsigned i = 0; i < arr->length; i ++) {
+        Node *n = Array_At(arr, i);
+        if (!n)
+            continue;
+        if (n->type == NODE_VARIABLE_DECLARATION)
+            if (Token_Cmp(n->node.var_decl.id, id))
+                return (Element) {.type = ELEMENT_VARIABLE, .n = n};
+        if (n->type == NODE_FUNCTION_DEFINITION)
+            if (Token_Cmp(n->node.func_def.id, id))
+                return (Element) {.type = ELEMENT_FUNCTION, .n = n};
+    }
+
+    // Look in higher-order scopes
+    if (blk->node.block.super != NULL)
+        return Block_FindElement(blk->node.block.super, id);
+
+    return (Element) {.n = NULL};
+}
+
+// Remove a declaration from its scope, the index is rebuilt on the next lookup
+void Block_Undeclare(Node *blk, Node *n) {
+    Array *arr = blk->node.block.declarations;
+
+    for (unsigned i = 0; i < arr->length; i++) {
+        if (Array_At(arr, i) == n) {
+            Array_Remove(arr, i);
+            break;
+        }
+    }
+
+    free(blk->node.block.index);
+    blk->node.block.index = NULL;
+    blk->node.block.slots = 0;
+    blk->node.block.indexed = 0;
+}
+
+#undef BLOCK_INDEX_THRESHOLD
+
+bool Node_IsLiteral(Node *n) {
+    if (!n)
+        return false;
+    return n->type == NODE_INTEGER_LITERAL || n->type == NODE_FLOAT_LITERAL;
+}
+
+// Copy an integer or float literal into the given scope
+Node *Node_DuplicateLiteral(Node *lit, Node *super) {
+    Node *n;
+
+    if (lit->type == NODE_INTEGER_LITERAL)
+        n = Node_CreateIntegerLiteral(lit->node.int_lit.n);
+    else if (lit->type == NODE_FLOAT_LITERAL)
+        n = Node_CreateFloatLiteral(lit->node.float_lit.f);
+    else
+        return NULL;
+
+    n->super = super;
+    n->etype = lit->etype;
+    return n;
+}
+
+
+// Whether evaluating the expression may have effects beyond its value.
+// Any procedure call is assumed to have some.
+bool Node_HasSideEffects(Node *n) {
+    if (!n)
+        return false;
+
+    switch (n->type) {
+        case NODE_FUNCTION_CALL:
+            return true;
+        case NODE_BINARY_EXPRESSION:
+            return Node_HasSideEffects(n->node.binary.left) || Node_HasSideEffects(n->node.binary.right);
+        case NODE_INDEX:
+            return Node_HasSideEffects(n->node.index.expr);
+        case NODE_REDUCE:
+            return Node_HasSideEffects(n->node.reduce.expr);
+        default:
+            return false;
+    }
+}
+
+// Drop the references a subtree holds on declarations and definitions.
+// Must be called before a subtree of the analysed program is destroyed.
+void Node_Unreference(Node *node) {
+    if (!node)
+        return;
+
+    switch (node->type) {
+        case NODE_PROGRAM:
+            Node_Unreference(node->node.program.nodes);
+            break;
+
+        case NODE_VARIABLE_DECLARATION:
+            Node_Unreference(node->node.var_decl.value);
+            break;
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            Node_Unreference(node->node.var_assign.value);
+            Node_Unreference(node->node.var_assign.index);
+            break;
+
+        case NODE_BINARY_EXPRESSION:
+            Node_Unreference(node->node.binary.left);
+            Node_Unreference(node->node.binary.right);
+            break;
+
+        case NODE_FUNCTION_CALL:
+            if (node->node.fcall.def)
+                node->node.fcall.def->node.func_def.refs--;
+            for (unsigned i = 0; i < node->node.fcall.exprs->length; i++)
+                Node_Unreference(Array_At(node->node.fcall.exprs, i));
+            break;
+
+        case NODE_VARIABLE_REFERENCE:
+            if (node->node.var_ref.decl)
+                node->node.var_ref.decl->node.var_decl.refs--;
+            Node_Unreference(node->node.var_ref.next);
+            break;
+
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < node->node.block.nodes->length; i++)
+                Node_Unreference(Array_At(node->node.block.nodes, i));
+            break;
+
+        case NODE_FUNCTION_DEFINITION:
+            Node_Unreference(node->node.func_def.block);
+            break;
+
+        case NODE_RETURN:
+            Node_Unreference(node->node.ret.expr);
+            break;
+
+        case NODE_CHECK:
+            Node_Unreference(node->node.check.expr);
+            Node_Unreference(node->node.check.block);
+            Node_Unreference(node->node.check.sub);
+            break;
+
+        case NODE_LOOP:
+            Node_Unreference(node->node.loop.from);
+            Node_Unreference(node->node.loop.to);
+            Node_Unreference(node->node.loop.block);
+            break;
+
+        case NODE_INDEX:
+            Node_Unreference(node->node.index.array);
+            Node_Unreference(node->node.index.expr);
+            break;
+
+        case NODE_REDUCE:
+            Node_Unreference(node->node.reduce.expr);
+            break;
+
+        default:
+            break;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,993 @@
+#include "include/astcache.h"
+#include "include/param.h"
+#include "include/parse.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "include/memory.h"
+
+AstCacheKey AstCache_Key(const char *source) {
+    AstCacheKey key = {14695981039346656037ULL, 0};
+
+    for (; source[key.length]; key.length++)
+        key.hash = (key.hash ^ (unsigned char) source[key.length]) * 1099511628211ULL;
+
+    return key;
+}
+
+// The file of the key within the cache directory
+char *AstCache_Path(const char *dir, AstCacheKey key) {
+    char *path = malloc(strlen(dir) + 48);
+    sprintf(path, "%s/%016llx-%llx.ast", dir, (unsigned long long) key.hash, (unsigned long long) key.length);
+    return path;
+}
+
+// The file naming the image last cached for an input, which edits of it are reparsed against
+char *AstCache_LastPath(const char *dir, const char *input) {
+    AstCacheKey key = AstCache_Key(input);
+    char *path = malloc(strlen(dir) + 32);
+    sprintf(path, "%s/%016llx.last", dir, (unsigned long long) key.hash);
+    return path;
+}
+
+void AstCache_Mark(const char *dir, const char *input, AstCacheKey key) {
+    char *path = AstCache_LastPath(dir, input);
+    char *temp = malloc(strlen(path) + 24);
+    sprintf(temp, "%s.%ld", path, (long) getpid());
+
+    FILE *file = fopen(temp, "wb");
+
+    if (file) {
+        bool written = fwrite(&key, sizeof(key), 1, file) == 1;
+
+        if (fclose(file) != 0 || !written || rename(temp, path) != 0)
+            remove(temp);
+    }
+
+    free(temp);
+    free(path);
+}
+
+AstCacheModule *AstCache_Module(AstCache *, const char *, bool);
+
+Status AstCache_Last(AstCache *cache, const char *input, AstCacheKey *key) {
+    AstCacheModule *module = cache->modules ? AstCache_Module(cache, input, false) : NULL;
+
+    if (module) {
+        *key = module->key;
+        return STATUS_OK;
+    }
+
+    if (!cache->dir)
+        return STATUS_FAIL;
+
+    char *path = AstCache_LastPath(cache->dir, input);
+    FILE *file = fopen(path, "rb");
+    free(path);
+
+    if (!file)
+        return STATUS_FAIL;
+
+    bool read = fread(key, sizeof(*key), 1, file) == 1;
+    fclose(file);
+    return read ? STATUS_OK : STATUS_FAIL;
+}
+
+typedef struct {
+    AstCacheRecord *records;
+    unsigned nrecords;
+    unsigned crecords;
+    uint32_t *entries;
+    unsigned nentries;
+    unsigned centries;
+    char *bytes;
+    unsigned nbytes;
+    unsigned cbytes;
+    Array *scopes;      // } Blocks enclosing the node being written
+    Array *indices;     // } and their records
+    bool failed;
+} AstCacheWriter;
+
+// Makes room for more items in a buffer that grows by doubling
+void *AstCache_Grow(void *base, unsigned *capacity, unsigned needed, size_t size) {
+    if (needed <= *capacity)
+        return base;
+
+    while (*capacity < needed)
+        *capacity = *capacity ? *capacity * 2 : 64;
+
+    return realloc(base, *capacity * size);
+}
+
+uint32_t AstCache_String(AstCacheWriter *w, Token *token) {
+    if (!token)
+        return AST_CACHE_NONE;
+
+    unsigned length = strlen(token->value);
+    uint32_t offset = w->nbytes;
+
+    w->bytes = AstCache_Grow(w->bytes, &w->cbytes, w->nbytes + length + 2, 1);
+    w->bytes[w->nbytes] = (char) token->type;
+    memcpy(w->bytes + w->nbytes + 1, token->value, length + 1);
+    w->nbytes += length + 2;
+
+    return offset;
+}
+
+// Types are placeholders until the semantic analysis resolves them
+uint32_t AstCache_TypeName(AstCacheWriter *w, Type *type) {
+    if (!type || type->type != TYPE_PLACEHOLDER) {
+        w->failed = true;
+        return AST_CACHE_NONE;
+    }
+
+    return AstCache_String(w, type->content.placeholder.id);
+}
+
+uint32_t AstCache_Entries(AstCacheWriter *w, uint32_t *entries, unsigned count) {
+    uint32_t list = w->nentries;
+
+    if (count == 0)
+        return list;
+
+    w->entries = AstCache_Grow(w->entries, &w->centries, w->nentries + count, sizeof(uint32_t));
+    memcpy(w->entries + w->nentries, entries, count * sizeof(uint32_t));
+    w->nentries += count;
+
+    return list;
+}
+
+int32_t AstCache_Super(AstCacheWriter *w, Node *super) {
+    if (!super)
+        return -1;
+
+    for (unsigned i = w->scopes->length; i > 0; i--)
+        if (Array_At(w->scopes, i - 1) == super)
+            return (int32_t) (uintptr_t) Array_At(w->indices, i - 1);
+
+    w->failed = true;
+    return -1;
+}
+
+int32_t AstCache_Write(AstCacheWriter *, Node *);
+
+// Children of a list are written first, their records are only known afterwards
+void AstCache_WriteList(AstCacheWriter *w, unsigned index, Array *nodes) {
+    uint32_t *entries = malloc((nodes->length + 1) * sizeof(uint32_t));
+
+    for (unsigned i = 0; i < nodes->length; i++)
+        entries[i] = (uint32_t) AstCache_Write(w, Array_At(nodes, i));
+
+    w->records[index].list = AstCache_Entries(w, entries, nodes->length);
+    w->records[index].count = nodes->length;
+    free(entries);
+}
+
+int32_t AstCache_Write(AstCacheWriter *w, Node *n) {
+    if (!n)
+        return -1;
+
+    unsigned index = w->nrecords++;
+    w->records = AstCache_Grow(w->records, &w->crecords, w->nrecords, sizeof(AstCacheRecord));
+
+    AstCacheRecord r = {n->type, AstCache_Super(w, n->super), AST_CACHE_NONE, AST_CACHE_NONE, {-1, -1, -1, -1},
+                        0, 0, 0, 0, {0}};
+    w->records[index] = r;
+
+    int32_t child[4] = {-1, -1, -1, -1};
+
+    switch (n->type) {
+        case NODE_BLOCK:
+            Array_Push(w->scopes, n);
+            Array_Push(w->indices, (void *) (uintptr_t) index);
+            AstCache_WriteList(w, index, n->node.block.nodes);
+            Array_Remove(w->scopes, w->scopes->length - 1);
+            Array_Remove(w->indices, w->indices->length - 1);
+            break;
+
+        case NODE_STRING_LITERAL:
+            w->records[index].flags = n->node.str_lit.id;
+            break;
+
+        case NODE_INTEGER_LITERAL:
+            w->records[index].value.n = n->node.int_lit.n;
+            break;
+
+        case NODE_FLOAT_LITERAL:
+            w->records[index].value.f = n->node.float_lit.f;
+            break;
+
+        case NODE_VARIABLE_DECLARATION:
+            w->records[index].token = AstCache_String(w, n->node.var_decl.id);
+            w->records[index].type_name = AstCache_TypeName(w, n->node.var_decl.type);
+            w->records[index].flags = n->node.var_decl.mutable;
+            child[0] = AstCache_Write(w, n->node.var_decl.value);
+            break;
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            w->records[index].token = AstCache_String(w, n->node.var_assign.id);
+            child[0] = AstCache_Write(w, n->node.var_assign.value);
+            child[1] = AstCache_Write(w, n->node.var_assign.index);
+            break;
+
+        case NODE_BINARY_EXPRESSION:
+            w->records[index].flags = n->node.binary.op;
+            child[0] = AstCache_Write(w, n->node.binary.left);
+            child[1] = AstCache_Write(w, n->node.binary.right);
+            break;
+
+        case NODE_FUNCTION_CALL:
+            w->records[index].token = AstCache_String(w, n->node.fcall.id);
+            AstCache_WriteList(w, index, n->node.fcall.exprs);
+            break;
+
+        case NODE_VARIABLE_REFERENCE:
+            w->records[index].token = AstCache_String(w, n->node.var_ref.id);
+            child[0] = AstCache_Write(w, n->node.var_ref.next);
+            break;
+
+        case NODE_FUNCTION_DEFINITION: {
+            Array *params = n->node.func_def.params;
+            uint32_t *entries = malloc((2 * params->length + 1) * sizeof(uint32_t));
+
+            for (unsigned i = 0; i < params->length; i++) {
+                FunctionParameter *param = Array_At(params, i);
+                entries[2 * i] = AstCache_String(w, param->id);
+                entries[2 * i + 1] = AstCache_TypeName(w, param->type);
+            }
+
+            w->records[index].token = AstCache_String(w, n->node.func_def.id);
+            w->records[index].type_name = AstCache_TypeName(w, n->node.func_def.type);
+            w->records[index].list = AstCache_Entries(w, entries, 2 * params->length);
+            w->records[index].count = params->length;
+            free(entries);
+
+            child[0] = AstCache_Write(w, n->node.func_def.block);
+            break;
+        }
+
+        case NODE_RETURN:
+            w->records[index].flags = n->node.ret.jump;
+            child[0] = AstCache_Write(w, n->node.ret.expr);
+            break;
+
+        case NODE_CHECK:
+            child[0] = AstCache_Write(w, n->node.check.expr);
+            child[1] = AstCache_Write(w, n->node.check.block);
+            child[2] = AstCache_Write(w, n->node.check.sub);
+            break;
+
+        case NODE_SIZE:
+            w->records[index].type_name = AstCache_TypeName(w, n->node.size.type);
+            break;
+
+        // The counter is declared in the scope of the body, which is only written after it.
+        // The loader puts it back there.
+        case NODE_LOOP: {
+            Node *var = n->node.loop.var;
+            w->failed |= var->super != n->node.loop.block;
+
+            var->super = NULL;
+            child[0] = AstCache_Write(w, var);
+            var->super = n->node.loop.block;
+
+            child[1] = AstCache_Write(w, n->node.loop.from);
+            child[2] = AstCache_Write(w, n->node.loop.to);
+            child[3] = AstCache_Write(w, n->node.loop.block);
+            break;
+        }
+
+        case NODE_INDEX:
+            child[0] = AstCache_Write(w, n->node.index.array);
+            child[1] = AstCache_Write(w, n->node.index.expr);
+            break;
+
+        case NODE_REDUCE:
+            child[0] = AstCache_Write(w, n->node.reduce.expr);
+            break;
+
+        case NODE_COMPLEX: {
+            ComplexType *complx = n->node.complx.type->content.complx.ref;
+            uint32_t *entries = malloc((2 * complx->fields->length + 1) * sizeof(uint32_t));
+
+            for (unsigned i = 0; i < complx->fields->length; i++) {
+                ComplexField *field = Array_At(complx->fields, i);
+                entries[2 * i] = AstCache_String(w, field->id);
+                entries[2 * i + 1] = AstCache_TypeName(w, field->type);
+            }
+
+            w->records[index].token = AstCache_String(w, complx->id);
+            w->records[index].flags = complx->ordered;
+            w->records[index].list = AstCache_Entries(w, entries, 2 * complx->fields->length);
+            w->records[index].count = complx->fields->length;
+            free(entries);
+            break;
+        }
+
+        default:
+            w->failed = true;
+            break;
+    }
+
+    memcpy(w->records[index].child, child, sizeof(child));
+    return (int32_t) index;
+}
+
+// Written next to its final place and renamed into it, so that readers never see part of a file
+Status AstCache_Save(const char *dir, const char *input, AstCacheKey key, const void *image, size_t size) {
+    Status status = STATUS_FAIL;
+    char *path = AstCache_Path(dir, key);
+    char *temp = malloc(strlen(path) + 24);
+    sprintf(temp, "%s.%ld", path, (long) getpid());
+
+    // The first save creates the directory, any other reason it cannot be written to is reported below
+    mkdir(dir, 0777);
+    FILE *file = fopen(temp, "wb");
+
+    if (file) {
+        bool written = fwrite(image, 1, size, file) == size;
+
+        if (fclose(file) == 0 && written && rename(temp, path) == 0)
+            status = STATUS_OK;
+        else
+            remove(temp);
+    }
+
+    if (status == STATUS_OK) {
+        AstCache_Mark(dir, input, key);
+        AST_CACHE_PRINT("Cached the syntax tree in \"%s\".\n", path);
+    } else {
+        AST_CACHE_PRINT("Could not cache the syntax tree in \"%s\".\n", path);
+    }
+
+    free(temp);
+    free(path);
+    return status;
+}
+
+// The module of an input, which is created if asked for
+AstCacheModule *AstCache_Module(AstCache *cache, const char *input, bool create) {
+    char *real = realpath(input, NULL);
+    const char *name = real ? real : input;
+    AstCacheModule *module = NULL;
+
+    for (unsigned i = 0; i < cache->modules->length && !module; i++) {
+        AstCacheModule *m = Array_At(cache->modules, i);
+        if (strcmp(m->input, name) == 0)
+            module = m;
+    }
+
+    if (!module && create) {
+        module = calloc(1, sizeof(AstCacheModule));
+        module->input = strdup(name);
+        Array_Push(cache->modules, module);
+    }
+
+    free(real);
+    return module;
+}
+
+// The primed source and where its top-level statements begin are kept for reparsing edits of it
+Status AstCache_Store(AstCache *cache, const char *input, AstCacheKey key, Node *program, const char *primed,
+                      Array *offsets) {
+    Array *imports = program->node.program.imports;
+
+    // The tree takes in the interfaces it imports, which change without the source
+    if (imports && imports->length > 0) {
+        AST_CACHE_PRINT("Not caching the syntax tree of \"%s\", the interfaces it imports may change on their own.\n",
+                        input);
+        return STATUS_FAIL;
+    }
+
+    AstCacheWriter w = {0};
+    w.scopes = Array_Create();
+    w.indices = Array_Create();
+
+    StringPool *pool = program->node.program.strings;
+    uint32_t *texts = malloc((pool->strings->length + 1) * sizeof(uint32_t));
+
+    for (unsigned i = 0; i < pool->strings->length; i++) {
+        Token text = {StringPool_At(pool, i)->text, 0, TT_LSTRING};
+        texts[i] = AstCache_String(&w, &text);
+    }
+
+    AstCache_Entries(&w, texts, pool->strings->length);
+    free(texts);
+
+    Node *blk = program->node.program.nodes;
+    int32_t root = AstCache_Write(&w, blk);
+    w.failed |= offsets->length != blk->node.block.nodes->length;
+
+    uint32_t *starts = malloc((offsets->length + 1) * sizeof(uint32_t));
+
+    for (unsigned i = 0; i < offsets->length; i++)
+        starts[i] = (uint32_t) (uintptr_t) Array_At(offsets, i);
+
+    uint32_t list = AstCache_Entries(&w, starts, offsets->length);
+    free(starts);
+
+    Token text = {(char *) primed, 0, TT_UNKNOWN};
+    uint32_t source = AstCache_String(&w, &text);
+
+    AstCacheHeader header = {AST_CACHE_MAGIC, AST_CACHE_VERSION, (uint32_t) root, key, w.nrecords, w.nentries,
+                             w.nbytes, pool->strings->length, pool->literals, list, source, 0};
+
+    size_t records = w.nrecords * sizeof(AstCacheRecord);
+    size_t entries = w.nentries * sizeof(uint32_t);
+    size_t size = sizeof(header) + records + entries + w.nbytes;
+    char *image = malloc(size);
+
+    memcpy(image, &header, sizeof(header));
+    memcpy(image + sizeof(header), w.records, records);
+    memcpy(image + sizeof(header) + records, w.entries, entries);
+    memcpy(image + sizeof(header) + records + entries, w.bytes, w.nbytes);
+
+    free(w.records);
+    free(w.entries);
+    free(w.bytes);
+    Array_Destroy(w.scopes);
+    Array_Destroy(w.indices);
+
+    if (w.failed) {
+        AST_CACHE_PRINT("Could not cache the syntax tree of \"%s\".\n", input);
+        free(image);
+        return STATUS_FAIL;
+    }
+
+    Status status = STATUS_OK;
+
+    if (cache->dir)
+        status = AstCache_Save(cache->dir, input, key, image, size);
+
+    // The module takes the image over
+    if (cache->modules) {
+        AstCacheModule *module = AstCache_Module(cache, input, true);
+        free(module->image);
+        module->key = key;
+        module->image = image;
+        module->size = size;
+    } else {
+        free(image);
+    }
+
+    return status;
+}
+
+void AstCache_Release(AstCache *cache) {
+    for (unsigned i = 0; cache->modules && i < cache->modules->length; i++) {
+        AstCacheModule *module = Array_At(cache->modules, i);
+        free(module->input);
+        free(module->image);
+        free(module);
+    }
+
+    Array_Destroy(cache->modules);
+    cache->modules = NULL;
+}
+
+typedef struct {
+    const AstCacheHeader *header;
+    const AstCacheRecord *records;
+    const uint32_t *entries;
+    const char *bytes;
+    StringPool *pool;
+    Node **nodes;
+    void *map;
+    size_t size;
+} AstCacheReader;
+
+// Children the nodes cannot do without, a bit each, and those that have to be blocks
+unsigned AstCache_Required(uint32_t type, unsigned *blocks) {
+    *blocks = 0;
+
+    switch ((NodeType) type) {
+        case NODE_VARIABLE_ASSIGNMENT:
+        case NODE_REDUCE:
+            return 1;
+        case NODE_BINARY_EXPRESSION:
+        case NODE_INDEX:
+            return 3;
+        case NODE_FUNCTION_DEFINITION:
+            *blocks = 1;
+            return 1;
+        case NODE_CHECK:
+            *blocks = 2;
+            return 2;
+        case NODE_LOOP:
+            *blocks = 8;
+            return 15;
+        default:
+            return 0;
+    }
+}
+
+bool AstCache_ValidString(const AstCacheHeader *h, const char *bytes, uint32_t offset, bool optional) {
+    if (offset == AST_CACHE_NONE)
+        return optional;
+
+    return offset + 1 < h->bytes && memchr(bytes + offset + 1, 0, h->bytes - offset - 1) != NULL;
+}
+
+// Everything the loader follows is checked up front, so that building the tree cannot fail halfway
+bool AstCache_Valid(AstCacheReader *rd, size_t size, AstCacheKey key) {
+    const AstCacheHeader *h = rd->header;
+
+    if (size < sizeof(AstCacheHeader) || h->magic != AST_CACHE_MAGIC || h->version != AST_CACHE_VERSION ||
+        h->key.hash != key.hash || h->key.length != key.length)
+        return false;
+
+    if (size != sizeof(AstCacheHeader) + (size_t) h->records * sizeof(AstCacheRecord) +
+                (size_t) h->entries * sizeof(uint32_t) + h->bytes)
+        return false;
+
+    if (h->root >= h->records || rd->records[h->root].type != NODE_BLOCK || h->strings > h->entries || (h->bytes > 0 && rd->bytes[h->bytes - 1] != 0))
+        return false;
+
+    for (unsigned i = 0; i < h->strings; i++)
+        if (!AstCache_ValidString(h, rd->bytes, rd->entries[i], false))
+            return false;
+
+    // Every record is the child of exactly one other, which comes before it
+    unsigned char *owned = calloc(h->records + 1, 1);
+    bool valid = true;
+    owned[h->root] = 1;
+
+    for (unsigned i = 0; i < h->records && valid; i++) {
+        const AstCacheRecord *r = &rd->records[i];
+        bool pairs = r->type == NODE_FUNCTION_DEFINITION || r->type == NODE_COMPLEX;
+        bool nodes = r->type == NODE_BLOCK || r->type == NODE_FUNCTION_CALL;
+        uint64_t count = pairs ? 2 * (uint64_t) r->count : nodes ? r->count : 0;
+
+        valid = r->type <= NODE_COMPLEX && r->type != NODE_PROGRAM && owned[i] &&
+                (r->super == -1 || ((unsigned) r->super < i && rd->records[r->super].type == NODE_BLOCK)) &&
+                AstCache_ValidString(h, rd->bytes, r->token, true) &&
+                AstCache_ValidString(h, rd->bytes, r->type_name, true) && r->list <= h->entries &&
+                count <= h->entries - r->list;
+
+        unsigned blocks;
+        unsigned required = AstCache_Required(r->type, &blocks);
+
+        for (unsigned k = 0; k < 4 && valid; k++) {
+            int32_t c = r->child[k];
+            valid = c == -1 ? !(required & (1u << k))
+                            : (unsigned) c > i && c < (int32_t) h->records && owned[c]++ == 0 &&
+                              (!(blocks & (1u << k)) || rd->records[c].type == NODE_BLOCK);
+        }
+
+        if (valid && r->type == NODE_LOOP)
+            valid = rd->records[r->child[0]].type == NODE_VARIABLE_DECLARATION;
+
+        for (unsigned k = 0; k < count && valid; k++) {
+            uint32_t e = rd->entries[r->list + k];
+            if (pairs)
+                valid = AstCache_ValidString(h, rd->bytes, e, false);
+            else
+                valid = e > i && e < h->records && owned[e]++ == 0;
+        }
+
+        if (valid && r->type == NODE_STRING_LITERAL)
+            valid = r->flags < h->strings;
+    }
+
+    free(owned);
+
+    if (!valid || !AstCache_ValidString(h, rd->bytes, h->source, false))
+        return false;
+
+    // The top-level statements begin in order within the source
+    const AstCacheRecord *root = &rd->records[h->root];
+    size_t length = strlen(rd->bytes + h->source + 1);
+
+    if (h->offsets > h->entries || root->count > h->entries - h->offsets)
+        return false;
+
+    for (unsigned i = 0; i < root->count; i++) {
+        uint32_t offset = rd->entries[h->offsets + i];
+        if (offset >= length || (i > 0 && offset <= rd->entries[h->offsets + i - 1]))
+            return false;
+    }
+
+    return true;
+}
+
+// Tokens are duplicated by the nodes they are handed to
+Token *AstCache_Token(AstCacheReader *rd, uint32_t offset) {
+    if (offset == AST_CACHE_NONE)
+        return NULL;
+
+    return Token_Create((char *) rd->bytes + offset + 1, (TokenType) (unsigned char) rd->bytes[offset]);
+}
+
+Node *AstCache_Child(AstCacheReader *rd, int32_t child) {
+    return child < 0 ? NULL : rd->nodes[child];
+}
+
+Array *AstCache_List(AstCacheReader *rd, const AstCacheRecord *r) {
+    Array *nodes = Array_Create();
+
+    // Records left out of the tree are skipped
+    for (unsigned i = 0; i < r->count; i++)
+        if (rd->nodes[rd->entries[r->list + i]])
+            Array_Push(nodes, rd->nodes[rd->entries[r->list + i]]);
+
+    return nodes;
+}
+
+Node *AstCache_Build(AstCacheReader *rd, const AstCacheRecord *r) {
+    Token *id = AstCache_Token(rd, r->token);
+    Token *type = AstCache_Token(rd, r->type_name);
+    Node *n = NULL;
+
+    switch ((NodeType) r->type) {
+        case NODE_BLOCK:
+            n = Node_CreateBlock(AstCache_List(rd, r), NULL);
+            break;
+
+        case NODE_STRING_LITERAL:
+            n = Node_CreateStringLiteral(StringPool_At(rd->pool, r->flags)->text, r->flags);
+            break;
+
+        case NODE_INTEGER_LITERAL:
+            n = Node_CreateIntegerLiteral(r->value.n);
+            break;
+
+        case NODE_FLOAT_LITERAL:
+            n = Node_CreateFloatLiteral(r->value.f);
+            break;
+
+        case NODE_VARIABLE_DECLARATION:
+            n = Node_CreateVariableDeclaration(id, AstCache_Child(rd, r->child[0]), type,
+                                               (ModificationQualifier) r->flags, NULL);
+            break;
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            n = Node_CreateVariableAssignment(id, AstCache_Child(rd, r->child[0]), NULL);
+            n->node.var_assign.index = AstCache_Child(rd, r->child[1]);
+            n->node.var_assign.checked = n->node.var_assign.index != NULL;
+            break;
+
+        case NODE_BINARY_EXPRESSION:
+            n = Node_CreateBinaryOperation(AstCache_Child(rd, r->child[0]), AstCache_Child(rd, r->child[1]),
+                                           (BinaryType) r->flags, NULL);
+            break;
+
+        case NODE_FUNCTION_CALL:
+            n = Node_CreateFunctionCall(id, AstCache_List(rd, r), NULL);
+            break;
+
+        case NODE_VARIABLE_REFERENCE:
+            n = Node_CreateVariableReference(id, NULL);
+            n->node.var_ref.next = AstCache_Child(rd, r->child[0]);
+            break;
+
+        case NODE_FUNCTION_DEFINITION: {
+            Array *params = Array_Create();
+
+            for (unsigned i = 0; i < r->count; i++) {
+                Token *param_id = AstCache_Token(rd, rd->entries[r->list + 2 * i]);
+                Token *param_type = AstCache_Token(rd, rd->entries[r->list + 2 * i + 1]);
+                Array_Push(params, FunctionParameter_Create(param_id, param_type));
+                Token_Destroy(param_id);
+                Token_Destroy(param_type);
+            }
+
+            n = Node_CreateFunctionDefinition(id, type, params, AstCache_Child(rd, r->child[0]), NULL);
+            break;
+        }
+
+        case NODE_RETURN:
+            n = Node_CreateReturn(AstCache_Child(rd, r->child[0]), NULL);
+            n->node.ret.jump = r->flags != 0;
+            break;
+
+        case NODE_CHECK:
+            n = Node_CreateCheck(AstCache_Child(rd, r->child[0]), AstCache_Child(rd, r->child[1]),
+                                 AstCache_Child(rd, r->child[2]), NULL);
+            break;
+
+        case NODE_SIZE:
+            n = Node_CreateSize(Type_CreatePlaceholder(type), NULL);
+            break;
+
+        case NODE_LOOP:
+            n = Node_CreateLoop(AstCache_Child(rd, r->child[0]), AstCache_Child(rd, r->child[1]),
+                                AstCache_Child(rd, r->child[2]), AstCache_Child(rd, r->child[3]), NULL);
+            break;
+
+        case NODE_INDEX:
+            n = Node_CreateIndex(AstCache_Child(rd, r->child[0]), AstCache_Child(rd, r->child[1]), NULL);
+            break;
+
+        case NODE_REDUCE:
+            n = Node_CreateReduce(AstCache_Child(rd, r->child[0]), NULL);
+            break;
+
+        case NODE_COMPLEX: {
+            Array *fields = Array_Create();
+
+            for (unsigned i = 0; i < r->count; i++) {
+                Token *field_id = AstCache_Token(rd, rd->entries[r->list + 2 * i]);
+                Token *field_type = AstCache_Token(rd, rd->entries[r->list + 2 * i + 1]);
+                Array_Push(fields, ComplexField_Create(field_id, Type_CreatePlaceholder(field_type)));
+                Token_Destroy(field_id);
+                Token_Destroy(field_type);
+            }
+
+            ComplexType *complx = ComplexType_Create(id, fields);
+            complx->ordered = r->flags != 0;
+            n = Node_CreateComplex(Type_CreateComplex(id, complx), NULL);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    if (id)
+        Token_Destroy(id);
+    if (type)
+        Token_Destroy(type);
+
+    return n;
+}
+
+// Checked through before anything is built from it
+bool AstCache_Read(AstCacheReader *rd, const void *image, size_t size, AstCacheKey key) {
+    const AstCacheHeader *h = image;
+    *rd = (AstCacheReader) {h, (const AstCacheRecord *) (h + 1), NULL, NULL, NULL, NULL, NULL, size};
+    rd->entries = (const uint32_t *) (rd->records + h->records);
+    rd->bytes = (const char *) (rd->entries + h->entries);
+
+    if (!AstCache_Valid(rd, size, key)) {
+        AST_CACHE_PRINT("The cached syntax tree is stale or damaged, parsing the source.\n");
+        return false;
+    }
+
+    return true;
+}
+
+// The image of the key, from the memory of a server or mapped from disk
+bool AstCache_Map(AstCacheReader *rd, AstCache *cache, const char *input, AstCacheKey key) {
+    AstCacheModule *module = cache->modules ? AstCache_Module(cache, input, false) : NULL;
+
+    if (module && module->key.hash == key.hash && module->key.length == key.length)
+        return AstCache_Read(rd, module->image, module->size, key);
+
+    if (!cache->dir)
+        return false;
+
+    char *path = AstCache_Path(cache->dir, key);
+    int fd = open(path, O_RDONLY);
+    free(path);
+
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    void *map = MAP_FAILED;
+
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(AstCacheHeader))
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (map == MAP_FAILED)
+        return false;
+
+    if (!AstCache_Read(rd, map, st.st_size, key)) {
+        munmap(map, st.st_size);
+        return false;
+    }
+
+    rd->map = map;
+    return true;
+}
+
+void AstCache_Unmap(AstCacheReader *rd) {
+    if (rd->map)
+        munmap(rd->map, rd->size);
+}
+
+// Children come after their parents, so building the records back to front finds every child
+// built. The enclosing blocks are fixed up once all nodes exist. Skipped records are left out,
+// together with everything below them.
+Node *AstCache_Tree(AstCacheReader *rd, unsigned char *skipped) {
+    const AstCacheHeader *h = rd->header;
+
+    for (unsigned i = 0; skipped && i < h->records; i++) {
+        const AstCacheRecord *r = &rd->records[i];
+
+        if (!skipped[i])
+            continue;
+
+        for (unsigned k = 0; k < 4; k++)
+            if (r->child[k] >= 0)
+                skipped[r->child[k]] = 1;
+
+        if (r->type == NODE_BLOCK || r->type == NODE_FUNCTION_CALL)
+            for (unsigned k = 0; k < r->count; k++)
+                skipped[rd->entries[r->list + k]] = 1;
+    }
+
+    rd->pool = StringPool_Create();
+
+    for (unsigned i = 0; i < h->strings; i++)
+        StringPool_Intern(rd->pool, rd->bytes + rd->entries[i] + 1);
+
+    rd->pool->literals = h->literals;
+    rd->nodes = malloc(h->records * sizeof(Node *));
+
+    for (unsigned i = h->records; i > 0; i--) {
+        bool skip = skipped && skipped[i - 1];
+
+        if (skip && rd->records[i - 1].type == NODE_STRING_LITERAL)
+            rd->pool->literals--;
+
+        rd->nodes[i - 1] = skip ? NULL : AstCache_Build(rd, &rd->records[i - 1]);
+    }
+
+    // Back to front as well, so that loops come after their counters
+    for (unsigned i = h->records; i > 0; i--) {
+        const AstCacheRecord *r = &rd->records[i - 1];
+        Node *n = rd->nodes[i - 1];
+
+        if (!n)
+            continue;
+
+        n->super = r->super < 0 ? NULL : rd->nodes[r->super];
+
+        if (r->type == NODE_BLOCK)
+            n->node.block.super = n->super;
+
+        if (r->type == NODE_LOOP)
+            n->node.loop.var->super = n->node.loop.block;
+    }
+
+    Node *root = rd->nodes[h->root];
+    free(rd->nodes);
+    rd->nodes = NULL;
+    return root;
+}
+
+Node *AstCache_Load(AstCache *cache, const char *input, AstCacheKey key) {
+    AstCacheReader rd;
+
+    if (!AstCache_Map(&rd, cache, input, key))
+        return NULL;
+
+    Node *blk = AstCache_Tree(&rd, NULL);
+    Node *program = Node_CreateProgram(blk, rd.pool);
+
+    AST_CACHE_PRINT("Loaded %u node(s) from the cache, skipping tokenization and parsing.\n", rd.header->records);
+
+    AstCache_Unmap(&rd);
+
+    if (cache->dir)
+        AstCache_Mark(cache->dir, input, key);
+
+    return program;
+}
+
+// The edit of the source lies between what it has in common with the last version cached for the
+// input at either end. Only the top-level statements the edit touches, or borders on, are tokenized
+// and parsed again; the others are taken from the image and shifted into place.
+Node *AstCache_Reparse(AstCache *cache, const char *input, const char *primed, Array *offsets) {
+    AstCacheKey key;
+    AstCacheReader rd;
+
+    if (AstCache_Last(cache, input, &key) == STATUS_FAIL || !AstCache_Map(&rd, cache, input, key))
+        return NULL;
+
+    const AstCacheHeader *h = rd.header;
+    const AstCacheRecord *root = &rd.records[h->root];
+    const uint32_t *starts = rd.entries + h->offsets;
+    const char *old = rd.bytes + h->source + 1;
+    unsigned old_length = strlen(old);
+    unsigned length = strlen(primed);
+    unsigned count = root->count;
+
+    unsigned prefix = 0;
+    while (prefix < old_length && prefix < length && old[prefix] == primed[prefix])
+        prefix++;
+
+    unsigned suffix = 0;
+    while (suffix < old_length - prefix && suffix < length - prefix &&
+           old[old_length - suffix - 1] == primed[length - suffix - 1])
+        suffix++;
+
+    // The statements [first, last) are replaced, none if only the spacing changed
+    unsigned first = count;
+    unsigned last = count;
+
+    if (prefix < old_length || prefix < length) {
+        first = 0;
+        while (first < count && (first + 1 < count ? starts[first + 1] : old_length) < prefix)
+            first++;
+
+        last = first;
+        while (last < count && starts[last] <= old_length - suffix)
+            last++;
+    }
+
+    unsigned from = first < count ? starts[first] : old_length;
+    unsigned to = (last < count ? starts[last] : old_length) + length - old_length;
+
+    if (count == 0 || (first == last && first < count) || from > prefix) {
+        AstCache_Unmap(&rd);
+        return NULL;
+    }
+
+    unsigned char *skipped = calloc(h->records + 1, 1);
+    for (unsigned i = first; i < last; i++)
+        skipped[rd.entries[root->list + i]] = 1;
+
+    Node *blk = AstCache_Tree(&rd, skipped);
+    free(skipped);
+
+    Array *parsed = Array_Create();
+    Array *positions = Array_Create();
+    Status status = STATUS_OK;
+
+    if (from < to) {
+        char *text = malloc(to - from + 1);
+        memcpy(text, primed + from, to - from);
+        text[to - from] = 0;
+
+        Tokenizer *tokenizer = Tokenizer_Create(text);
+        Parser *parser = Parser_CreateParser(tokenizer);
+        parser->lastBlock = blk;
+        parser->rootBlock = blk;
+        parser->strings = rd.pool;
+        parser->offsets = positions;
+
+        status = Parser_ParseStatements(parser, parsed);
+
+        Parser_DestroyParser(parser);
+        Tokenizer_Destroy(tokenizer);
+        free(text);
+    }
+
+    if (status == STATUS_FAIL) {
+        AST_CACHE_PRINT("Could not reparse the edit on its own, parsing the whole source.\n");
+        Array_DestroyCallBack(parsed, (void *) Node_DestroyRecurse);
+        Array_Destroy(positions);
+        Node_DestroyRecurse(blk);
+        StringPool_Destroy(rd.pool);
+        AstCache_Unmap(&rd);
+        return NULL;
+    }
+
+    // The kept statements around the parsed ones, shifted by the change in length after the edit
+    Array *kept = blk->node.block.nodes;
+    Array *nodes = Array_Create();
+
+    for (unsigned i = 0; i < first; i++) {
+        Array_Push(nodes, Array_At(kept, i));
+        Array_Push(offsets, (void *) (uintptr_t) starts[i]);
+    }
+
+    for (unsigned i = 0; i < parsed->length; i++) {
+        Array_Push(nodes, Array_At(parsed, i));
+        Array_Push(offsets, (void *) ((uintptr_t) Array_At(positions, i) + from));
+    }
+
+    for (unsigned i = last; i < count; i++) {
+        Array_Push(nodes, Array_At(kept, i - last + first));
+        Array_Push(offsets, (void *) (uintptr_t) (starts[i] + length - old_length));
+    }
+
+    blk->node.block.nodes = nodes;
+
+    AST_CACHE_PRINT("Reparsed %u of %u byte(s), %u top-level statement(s) in place of %u, and kept the other %u "
+                    "from the cache.\n", to - from, length, parsed->length, last - first, count - (last - first));
+
+    Array_Destroy(kept);
+    Array_Destroy(parsed);
+    Array_Destroy(positions);
+    AstCache_Unmap(&rd);
+    return Node_CreateProgram(blk, rd.pool);
+}
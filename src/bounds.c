@@ -0,0 +1,238 @@
+#include "include/bounds.h"
+
+#include <stdlib.h>
+#include <limits.h>
+#include "include/memory.h"
+
+Bounds *Bounds_Create(bool enabled) {
+    Bounds *b = malloc(sizeof(Bounds));
+    b->enabled = enabled;
+    b->loops = Array_Create();
+    b->accesses = 0;
+    b->proven = 0;
+    return b;
+}
+
+void Bounds_Destroy(Bounds *b) {
+    Array_Destroy(b->loops);
+    free(b);
+}
+
+// Whether the values fit the type the expression is computed in, so that it cannot wrap around.
+// Ranges are kept within the bounds of an int, which no array length exceeds.
+bool Bounds_Fits(Node *n, BoundsRange *r) {
+    int bits = n->etype ? Type_Quantify(n->etype) : -1;
+
+    if (bits <= 0 || r->lo < INT_MIN || r->hi > INT_MAX)
+        return false;
+
+    long long max = bits >= 64 ? LLONG_MAX : (1LL << (bits - 1)) - 1;
+    return r->lo >= -max - 1 && r->hi <= max;
+}
+
+bool Bounds_Binary(Bounds *b, Node *n, BoundsRange *r) {
+    BoundsRange x, y;
+
+    switch (n->node.binary.op) {
+        case BIN_EQUAL:
+        case BIN_LGREATER:
+        case BIN_RGREATER:
+        case BIN_AND:
+        case BIN_OR:
+            *r = (BoundsRange) {0, 1};
+            return true;
+        default:
+            break;
+    }
+
+    if (!Bounds_Range(b, n->node.binary.left, &x) || !Bounds_Range(b, n->node.binary.right, &y))
+        return false;
+
+    switch (n->node.binary.op) {
+        case BIN_ADD:
+            *r = (BoundsRange) {x.lo + y.lo, x.hi + y.hi};
+            return true;
+
+        case BIN_SUB:
+            *r = (BoundsRange) {x.lo - y.hi, x.hi - y.lo};
+            return true;
+
+        case BIN_MUL: {
+            long long p[] = {x.lo * y.lo, x.lo * y.hi, x.hi * y.lo, x.hi * y.hi};
+            *r = (BoundsRange) {p[0], p[0]};
+
+            for (unsigned i = 1; i < 4; i++) {
+                if (p[i] < r->lo)
+                    r->lo = p[i];
+                if (p[i] > r->hi)
+                    r->hi = p[i];
+            }
+
+            return true;
+        }
+
+        // Truncating division by a positive constant keeps the order of the values
+        case BIN_DIV:
+            if (y.lo != y.hi || y.lo <= 0)
+                return false;
+            *r = (BoundsRange) {x.lo / y.lo, x.hi / y.lo};
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// The counter of an enclosing loop stays short of the bound, which is evaluated ahead of the loop.
+// Constants take the value they were declared with.
+bool Bounds_Variable(Bounds *b, Node *decl, BoundsRange *r) {
+    for (unsigned i = 0; i < b->loops->length; i++) {
+        Node *loop = Array_At(b->loops, i);
+        BoundsRange from, to;
+
+        if (loop->node.loop.var != decl)
+            continue;
+
+        if (!Bounds_Range(b, loop->node.loop.from, &from) || !Bounds_Range(b, loop->node.loop.to, &to))
+            return false;
+
+        *r = (BoundsRange) {from.lo, to.hi - 1};
+        return true;
+    }
+
+    if (decl->node.var_decl.mutable == MQ_CONST && decl->node.var_decl.value)
+        return Bounds_Range(b, decl->node.var_decl.value, r);
+
+    return false;
+}
+
+// Returns whether the values of the expression are known to lie within a range
+bool Bounds_Range(Bounds *b, Node *n, BoundsRange *r) {
+    if (!n)
+        return false;
+
+    bool known;
+
+    switch (n->type) {
+        case NODE_INTEGER_LITERAL:
+            *r = (BoundsRange) {n->node.int_lit.n, n->node.int_lit.n};
+            known = true;
+            break;
+
+        case NODE_VARIABLE_REFERENCE:
+            if (!n->node.var_ref.decl || n->node.var_ref.next)
+                return false;
+            known = Bounds_Variable(b, n->node.var_ref.decl, r);
+            break;
+
+        case NODE_BINARY_EXPRESSION:
+            known = Bounds_Binary(b, n, r);
+            break;
+
+        default:
+            return false;
+    }
+
+    return known && Bounds_Fits(n, r);
+}
+
+void Bounds_Access(Bounds *b, bool *checked, Node *decl, Node *index) {
+    BoundsRange r;
+    long long length = decl->node.var_decl.type->content.array.length;
+
+    b->accesses++;
+
+    if (!*checked || (Bounds_Range(b, index, &r) && r.lo >= 0 && r.hi < length)) {
+        *checked = false;
+        b->proven++;
+        return;
+    }
+
+    if (!b->enabled)
+        *checked = false;
+}
+
+void Bounds_Expression(Bounds *b, Node *n) {
+    if (!n)
+        return;
+
+    switch (n->type) {
+        case NODE_BINARY_EXPRESSION:
+            Bounds_Expression(b, n->node.binary.left);
+            Bounds_Expression(b, n->node.binary.right);
+            break;
+        case NODE_FUNCTION_CALL:
+            for (unsigned i = 0; i < n->node.fcall.exprs->length; i++)
+                Bounds_Expression(b, Array_At(n->node.fcall.exprs, i));
+            break;
+        case NODE_INDEX:
+            Bounds_Expression(b, n->node.index.expr);
+            Bounds_Access(b, &n->node.index.checked, n->node.index.array->node.var_ref.decl, n->node.index.expr);
+            break;
+        case NODE_REDUCE:
+            Bounds_Expression(b, n->node.reduce.expr);
+            break;
+        default:
+            break;
+    }
+}
+
+void Bounds_Statement(Bounds *b, Node *n) {
+    if (!n)
+        return;
+
+    switch (n->type) {
+        case NODE_VARIABLE_DECLARATION:
+            Bounds_Expression(b, n->node.var_decl.value);
+            break;
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            Bounds_Expression(b, n->node.var_assign.value);
+            Bounds_Expression(b, n->node.var_assign.index);
+            if (n->node.var_assign.index)
+                Bounds_Access(b, &n->node.var_assign.checked, n->node.var_assign.decl, n->node.var_assign.index);
+            break;
+
+        case NODE_RETURN:
+            Bounds_Expression(b, n->node.ret.expr);
+            break;
+
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                Bounds_Statement(b, Array_At(n->node.block.nodes, i));
+            break;
+
+        case NODE_CHECK:
+            for (Node *chk = n; chk; chk = chk->node.check.sub) {
+                Bounds_Expression(b, chk->node.check.expr);
+                Bounds_Statement(b, chk->node.check.block);
+            }
+            break;
+
+        case NODE_LOOP:
+            Bounds_Expression(b, n->node.loop.from);
+            Bounds_Expression(b, n->node.loop.to);
+            Array_Push(b->loops, n);
+            Bounds_Statement(b, n->node.loop.block);
+            Array_Remove(b->loops, b->loops->length - 1);
+            break;
+
+        // The body runs whenever it is called, outside of the loops around the definition
+        case NODE_FUNCTION_DEFINITION: {
+            Array *loops = b->loops;
+            b->loops = Array_Create();
+            Bounds_Statement(b, n->node.func_def.block);
+            Array_Destroy(b->loops);
+            b->loops = loops;
+            break;
+        }
+
+        default:
+            Bounds_Expression(b, n);
+            break;
+    }
+}
+
+void Bounds_Program(Bounds *b, Node *program) {
+    Bounds_Statement(b, program->node.program.nodes);
+}
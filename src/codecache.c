@@ -0,0 +1,158 @@
+#include "include/codecache.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "include/memory.h"
+
+// Creates the directory unless it exists, failing if it cannot be written to
+Status CodeCache_Open(CodeCache *cache) {
+    struct stat st;
+
+    if ((mkdir(cache->dir, 0777) != 0 && errno != EEXIST) || stat(cache->dir, &st) != 0 || !S_ISDIR(st.st_mode) ||
+        access(cache->dir, W_OK | X_OK) != 0) {
+        CODE_CACHE_PRINT("Could not use \"%s\" as the code cache, generating every procedure.\n", cache->dir);
+        return STATUS_FAIL;
+    }
+
+    return STATUS_OK;
+}
+
+char *CodeCache_Path(CodeCache *cache, uint64_t key) {
+    char *path = malloc(strlen(cache->dir) + 32);
+    sprintf(path, "%s/%016llx.code", cache->dir, (unsigned long long) key);
+    return path;
+}
+
+// Copies the code of the key to the output and marks it as used now
+bool CodeCache_Load(CodeCache *cache, uint64_t key, FILE *out, CodeCacheStats *stats) {
+    char *path = CodeCache_Path(cache, key);
+    FILE *file = fopen(path, "rb");
+    CodeCacheHeader header;
+    char *text = NULL;
+    bool loaded = false;
+
+    if (file && fread(&header, sizeof(header), 1, file) == 1 && header.magic == CODE_CACHE_MAGIC &&
+        header.key == key && header.version == CODE_CACHE_VERSION && header.length < (1ULL << 32)) {
+        text = malloc(header.length + 1);
+        loaded = fread(text, 1, header.length, file) == header.length && fgetc(file) == EOF;
+    }
+
+    if (file)
+        fclose(file);
+
+    if (loaded) {
+        fwrite(text, 1, header.length, out);
+        *stats = header.stats;
+        utimensat(AT_FDCWD, path, NULL, 0);
+        cache->hits++;
+    } else {
+        cache->misses++;
+    }
+
+    free(text);
+    free(path);
+    return loaded;
+}
+
+// Written next to its final place and renamed into it, so that readers never see part of a file
+void CodeCache_Store(CodeCache *cache, uint64_t key, CodeCacheStats *stats, const char *text, size_t length) {
+    char *path = CodeCache_Path(cache, key);
+    char *temp = malloc(strlen(path) + 24);
+    sprintf(temp, "%s.%ld", path, (long) getpid());
+
+    CodeCacheHeader header = {CODE_CACHE_MAGIC, key, CODE_CACHE_VERSION, *stats, length};
+    FILE *file = fopen(temp, "wb");
+    bool stored = false;
+
+    if (file) {
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(text, 1, length, file) == length;
+
+        stored = fclose(file) == 0 && written && rename(temp, path) == 0;
+
+        if (!stored)
+            remove(temp);
+    }
+
+    if (!stored)
+        cache->failed++;
+
+    free(temp);
+    free(path);
+}
+
+typedef struct {
+    char *path;
+    off_t size;
+    struct timespec used;
+} CodeCacheEntry;
+
+int CodeCache_CompareUse(const void *a, const void *b) {
+    const CodeCacheEntry *x = a;
+    const CodeCacheEntry *y = b;
+
+    if (x->used.tv_sec != y->used.tv_sec)
+        return x->used.tv_sec < y->used.tv_sec ? -1 : 1;
+    if (x->used.tv_nsec != y->used.tv_nsec)
+        return x->used.tv_nsec < y->used.tv_nsec ? -1 : 1;
+    return 0;
+}
+
+// Removes the least recently used procedures until the rest fit within the limit
+void CodeCache_Evict(CodeCache *cache) {
+    DIR *dir = opendir(cache->dir);
+
+    if (!dir)
+        return;
+
+    CodeCacheEntry *entries = NULL;
+    unsigned count = 0;
+    unsigned capacity = 0;
+    unsigned long long total = 0;
+    struct dirent *d;
+
+    while ((d = readdir(dir))) {
+        size_t length = strlen(d->d_name);
+
+        if (length < 5 || strcmp(d->d_name + length - 5, ".code") != 0)
+            continue;
+
+        char *path = malloc(strlen(cache->dir) + length + 2);
+        sprintf(path, "%s/%s", cache->dir, d->d_name);
+
+        struct stat st;
+
+        if (stat(path, &st) != 0) {
+            free(path);
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity = capacity ? 2 * capacity : 64;
+            entries = realloc(entries, capacity * sizeof(CodeCacheEntry));
+        }
+
+        entries[count++] = (CodeCacheEntry) {path, st.st_size, st.st_mtim};
+        total += st.st_size;
+    }
+
+    closedir(dir);
+
+    if (total > cache->limit)
+        qsort(entries, count, sizeof(CodeCacheEntry), CodeCache_CompareUse);
+
+    for (unsigned i = 0; i < count; i++) {
+        if (total > cache->limit && remove(entries[i].path) == 0) {
+            total -= entries[i].size;
+            cache->evicted++;
+        }
+
+        free(entries[i].path);
+    }
+
+    free(entries);
+}
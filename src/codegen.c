@@ -0,0 +1,1210 @@
+#include "include/codegen.h"
+#include "include/trace.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "include/memory.h"
+
+#define EMIT(...) fprintf(cg->out, __VA_ARGS__)
+
+const Register Codegen_ArgumentRegisters[IR_REGISTER_ARGS] = {REG_RDI, REG_RSI, REG_RDX, REG_RCX, REG_R8,
+                                                                   REG_R9};
+
+const char *Codegen_Pointer(unsigned width) {
+    switch (width) {
+        case 1:
+            return "BYTE PTR";
+        case 2:
+            return "WORD PTR";
+        case 4:
+            return "DWORD PTR";
+        default:
+            return "QWORD PTR";
+    }
+}
+
+// Spill slots lie below the saved registers
+int Codegen_Slot(Codegen *cg, int vreg) {
+    return 8 * (int) (cg->saved + cg->alloc->intervals[vreg].slot + 1);
+}
+
+// The register holding the operand. Spilled values are reloaded into the scratch register.
+Register Codegen_Use(Codegen *cg, int vreg, unsigned width, Register scratch) {
+    Interval *it = &cg->alloc->intervals[vreg];
+
+    if (it->reg != REG_NONE)
+        return it->reg;
+
+    EMIT("\tmov %s, %s [rbp - %d]\n", Register_Name(scratch, width), Codegen_Pointer(width), Codegen_Slot(cg, vreg));
+    return scratch;
+}
+
+// The register a result is computed in, the scratch register for spilled values
+Register Codegen_Target(Codegen *cg, int vreg, Register scratch) {
+    Register reg = cg->alloc->intervals[vreg].reg;
+    return reg != REG_NONE ? reg : scratch;
+}
+
+// Store a spilled result back to its slot
+void Codegen_Commit(Codegen *cg, int vreg, Register reg) {
+    if (cg->alloc->intervals[vreg].reg != REG_NONE)
+        return;
+
+    unsigned width = cg->fn->widths[vreg];
+    EMIT("\tmov %s [rbp - %d], %s\n", Codegen_Pointer(width), Codegen_Slot(cg, vreg), Register_Name(reg, width));
+}
+
+void Codegen_Widen(Codegen *cg, Register dst, Register src, unsigned from, unsigned to) {
+    if (from >= to) {
+        if (dst != src)
+            EMIT("\tmov %s, %s\n", Register_Name(dst, to), Register_Name(src, to));
+        return;
+    }
+
+    if (from == 4)
+        EMIT("\tmovsxd %s, %s\n", Register_Name(dst, to), Register_Name(src, from));
+    else
+        EMIT("\tmovsx %s, %s\n", Register_Name(dst, to), Register_Name(src, from));
+}
+
+void Codegen_Label(Codegen *cg, unsigned label) {
+    EMIT(".L%s.%u:\n", cg->fn->name, label);
+}
+
+// Every parameter is read at once on entry. The register parameters are pushed first
+// so that moving them into place cannot overwrite one that has not been read yet.
+void Codegen_Parameters(Codegen *cg) {
+    Array *code = cg->fn->code;
+    unsigned count = 0;
+
+    while (count < code->length && ((IrInstruction *) Array_At(code, count))->op == IR_PARAMETER)
+        count++;
+
+    unsigned in_registers = count < IR_REGISTER_ARGS ? count : IR_REGISTER_ARGS;
+
+    for (int k = (int) in_registers - 1; k >= 0; k--)
+        EMIT("\tpush %s\n", Register_Name(Codegen_ArgumentRegisters[k], 8));
+
+    for (unsigned i = 0; i < count; i++) {
+        IrInstruction *ins = Array_At(code, i);
+        unsigned k = (unsigned) ins->imm;
+        Register reg = Codegen_Target(cg, ins->dst, REG_R11);
+
+        if (cg->alloc->intervals[ins->dst].start == UINT_MAX)
+            continue;
+
+        if (k < IR_REGISTER_ARGS)
+            EMIT("\tmov %s, %s [rsp + %u]\n", Register_Name(reg, ins->width), Codegen_Pointer(ins->width), 8 * k);
+        else
+            EMIT("\tmov %s, %s [rbp + %u]\n", Register_Name(reg, ins->width), Codegen_Pointer(ins->width),
+                 16 + 8 * (k - IR_REGISTER_ARGS));
+
+        Codegen_Commit(cg, ins->dst, reg);
+    }
+
+    if (in_registers > 0)
+        EMIT("\tadd rsp, %u\n", 8 * in_registers);
+}
+
+// Arguments are pushed and register arguments popped into place, which sidesteps
+// any overlap between the argument registers and the registers holding the values
+void Codegen_Call(Codegen *cg, IrInstruction *ins) {
+    unsigned on_stack = ins->nargs > IR_REGISTER_ARGS ? ins->nargs - IR_REGISTER_ARGS : 0;
+    unsigned in_registers = ins->nargs - on_stack;
+
+    // The stack is 16-byte aligned at every call
+    bool pad = on_stack % 2 == 1;
+
+    if (pad)
+        EMIT("\tsub rsp, 8\n");
+
+    for (int k = (int) ins->nargs - 1; k >= 0; k--)
+        EMIT("\tpush %s\n", Register_Name(Codegen_Use(cg, ins->args[k], 8, REG_R11), 8));
+
+    for (unsigned k = 0; k < in_registers; k++)
+        EMIT("\tpop %s\n", Register_Name(Codegen_ArgumentRegisters[k], 8));
+
+    IrFunction *callee = IrModule_FindFunction(cg->module, ins->target);
+    EMIT("\tcall %s\n", callee->name);
+
+    if (on_stack > 0 || pad)
+        EMIT("\tadd rsp, %u\n", 8 * on_stack + (pad ? 8 : 0));
+
+    if (ins->dst == IR_NONE || cg->alloc->intervals[ins->dst].start == UINT_MAX)
+        return;
+
+    Register reg = Codegen_Target(cg, ins->dst, REG_R11);
+    EMIT("\tmov %s, %s\n", Register_Name(reg, ins->width), Register_Name(REG_RAX, ins->width));
+    Codegen_Commit(cg, ins->dst, reg);
+}
+
+void Codegen_RestoreFrame(Codegen *, Register *, unsigned);
+
+// The arguments replace those of the current procedure, then its frame is torn down
+// and the callee is jumped to. It returns straight to the caller of the current procedure.
+void Codegen_TailCall(Codegen *cg, IrInstruction *ins, Register *order, unsigned norder) {
+    unsigned in_registers = ins->nargs < IR_REGISTER_ARGS ? ins->nargs : IR_REGISTER_ARGS;
+
+    for (int k = (int) ins->nargs - 1; k >= 0; k--)
+        EMIT("\tpush %s\n", Register_Name(Codegen_Use(cg, ins->args[k], 8, REG_R11), 8));
+
+    for (unsigned k = 0; k < in_registers; k++)
+        EMIT("\tpop %s\n", Register_Name(Codegen_ArgumentRegisters[k], 8));
+
+    for (unsigned k = in_registers; k < ins->nargs; k++) {
+        EMIT("\tpop r11\n");
+        EMIT("\tmov QWORD PTR [rbp + %u], r11\n", 16 + 8 * (k - IR_REGISTER_ARGS));
+    }
+
+    Codegen_RestoreFrame(cg, order, norder);
+
+    IrFunction *callee = IrModule_FindFunction(cg->module, ins->target);
+    EMIT("\tjmp %s\n", callee->name);
+}
+
+void Codegen_Arithmetic(Codegen *cg, IrInstruction *ins) {
+    const char *mnemonic = ins->op == IR_ADD ? "add" : ins->op == IR_SUB ? "sub" : "imul";
+
+    // There is no two-operand byte multiplication, the low byte of the dword product is the same
+    unsigned width = (ins->op == IR_MUL && ins->width == 1) ? 4 : ins->width;
+
+    Register a = Codegen_Use(cg, ins->a, width, REG_R10);
+    Register b = Codegen_Use(cg, ins->b, width, REG_R11);
+    Register dst = Codegen_Target(cg, ins->dst, REG_R10);
+
+    // Computing into the register of the right-hand side would overwrite it early
+    if (dst == b && dst != a) {
+        if (a != REG_R10)
+            EMIT("\tmov %s, %s\n", Register_Name(REG_R10, width), Register_Name(a, width));
+        EMIT("\t%s %s, %s\n", mnemonic, Register_Name(REG_R10, width), Register_Name(b, width));
+        EMIT("\tmov %s, %s\n", Register_Name(dst, width), Register_Name(REG_R10, width));
+    } else {
+        if (dst != a)
+            EMIT("\tmov %s, %s\n", Register_Name(dst, width), Register_Name(a, width));
+        EMIT("\t%s %s, %s\n", mnemonic, Register_Name(dst, width), Register_Name(b, width));
+    }
+
+    Codegen_Commit(cg, ins->dst, dst);
+}
+
+// Signed division through rdx:rax, narrow operands are divided as dwords
+void Codegen_Divide(Codegen *cg, IrInstruction *ins) {
+    unsigned wide = ins->width <= 4 ? 4 : 8;
+
+    Register a = Codegen_Use(cg, ins->a, ins->width, REG_R10);
+    Codegen_Widen(cg, REG_RAX, a, ins->width, wide);
+
+    Register b = Codegen_Use(cg, ins->b, ins->width, REG_R11);
+    Codegen_Widen(cg, REG_R11, b, ins->width, wide);
+
+    EMIT("\t%s\n", wide == 8 ? "cqo" : "cdq");
+    EMIT("\tidiv %s\n", Register_Name(REG_R11, wide));
+
+    Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+    EMIT("\tmov %s, %s\n", Register_Name(dst, ins->width), Register_Name(REG_RAX, ins->width));
+    Codegen_Commit(cg, ins->dst, dst);
+}
+
+void Codegen_Compare(Codegen *cg, IrInstruction *ins) {
+    const char *set = ins->op == IR_EQUAL ? "sete" : ins->op == IR_GREATER ? "setg" : "setl";
+
+    Register a = Codegen_Use(cg, ins->a, ins->width, REG_R10);
+    Register b = Codegen_Use(cg, ins->b, ins->width, REG_R11);
+    EMIT("\tcmp %s, %s\n", Register_Name(a, ins->width), Register_Name(b, ins->width));
+
+    Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+    unsigned width = cg->fn->widths[ins->dst];
+
+    EMIT("\t%s %s\n", set, Register_Name(dst, 1));
+    if (width > 1)
+        EMIT("\tmovzx %s, %s\n", Register_Name(dst, 4), Register_Name(dst, 1));
+
+    Codegen_Commit(cg, ins->dst, dst);
+}
+
+// Arrays and vector temporaries lie below the spill slots
+unsigned Codegen_FrameOffset(Codegen *cg, unsigned offset) {
+    return 8 * (cg->saved + cg->alloc->slots) + cg->fn->frame - offset;
+}
+
+unsigned Codegen_ArrayBase(Codegen *cg, Node *decl) {
+    return Codegen_FrameOffset(cg, IrFunction_FindArray(cg->fn, decl)->offset);
+}
+
+// The operand addressing element a of the target, the index is sign-extended into r10.
+// Globals are addressed through r11.
+void Codegen_Element(Codegen *cg, IrInstruction *ins, unsigned scale, char *operand) {
+    unsigned from = cg->fn->widths[ins->a];
+    Register a = Codegen_Use(cg, ins->a, from, REG_R10);
+    Codegen_Widen(cg, REG_R10, a, from, 8);
+
+    IrGlobal *global = IrModule_FindGlobal(cg->module, ins->target);
+
+    if (global) {
+        EMIT("\tlea r11, [rip + %s]\n", global->name);
+        sprintf(operand, "[r11 + r10*%u]", scale);
+    } else {
+        sprintf(operand, "[rbp + r10*%u - %u]", scale, Codegen_ArrayBase(cg, ins->target));
+    }
+}
+
+// Indices are compared unsigned, which catches negative ones as well
+void Codegen_Check(Codegen *cg, IrInstruction *ins) {
+    unsigned from = cg->fn->widths[ins->a];
+    Register a = Codegen_Use(cg, ins->a, from, REG_R10);
+    Codegen_Widen(cg, REG_R10, a, from, 8);
+
+    EMIT("\tcmp r10, %lld\n", ins->imm);
+    EMIT("\tjae .L%s.bounds\n", cg->fn->name);
+    cg->checks++;
+}
+
+// Small arrays are cleared a quadword at a time, larger ones by a loop counting down r10
+void Codegen_Clear(Codegen *cg, IrInstruction *ins) {
+    unsigned quads = (Type_Size(ins->target->node.var_decl.type) + 7) / 8;
+    IrGlobal *global = IrModule_FindGlobal(cg->module, ins->target);
+
+    if (global)
+        EMIT("\tlea r11, [rip + %s]\n", global->name);
+    else
+        EMIT("\tlea r11, [rbp - %u]\n", Codegen_ArrayBase(cg, ins->target));
+
+    if (quads <= CODEGEN_UNROLLED_CLEAR) {
+        for (unsigned k = 0; k < quads; k++)
+            EMIT("\tmov QWORD PTR [r11 + %u], 0\n", 8 * k);
+        return;
+    }
+
+    unsigned label = cg->clears++;
+
+    EMIT("\tmov r10, %u\n", quads);
+    EMIT(".L%s.clear%u:\n", cg->fn->name, label);
+    EMIT("\tmov QWORD PTR [r11 + r10*8 - 8], 0\n");
+    EMIT("\tdec r10\n");
+    EMIT("\tjnz .L%s.clear%u\n", cg->fn->name, label);
+}
+
+const char Codegen_LaneSuffix[] = {0, 'b', 'w', 0, 'd', 0, 0, 0, 'q'};
+
+bool Codegen_Avx(Codegen *cg) {
+    return cg->module->vector == VECTOR_AVX2;
+}
+
+const char *Codegen_VectorPointer(Codegen *cg) {
+    return Codegen_Avx(cg) ? "YMMWORD PTR" : "XMMWORD PTR";
+}
+
+// Vector registers are named xmm under SSE2 and ymm under AVX2
+#define VREG(cg, v) (Codegen_Avx(cg) ? "ymm" : "xmm"), (v)
+
+// Broadcast the scalar in a to every lane of vector register vd
+void Codegen_Broadcast(Codegen *cg, int vd, Register a, unsigned w, bool avx) {
+    const char *move = w == 8 ? "movq" : "movd";
+
+    if (avx) {
+        EMIT("\tv%s xmm%d, %s\n", move, vd, Register_Name(a, w == 8 ? 8 : 4));
+        EMIT("\tvpbroadcast%c ymm%d, xmm%d\n", Codegen_LaneSuffix[w], vd, vd);
+        return;
+    }
+
+    EMIT("\t%s xmm%d, %s\n", move, vd, Register_Name(a, w == 8 ? 8 : 4));
+
+    if (w == 1)
+        EMIT("\tpunpcklbw xmm%d, xmm%d\n", vd, vd);
+    if (w <= 2)
+        EMIT("\tpunpcklwd xmm%d, xmm%d\n", vd, vd);
+    if (w <= 4)
+        EMIT("\tpshufd xmm%d, xmm%d, 0\n", vd, vd);
+    else
+        EMIT("\tpunpcklqdq xmm%d, xmm%d\n", vd, vd);
+}
+
+void Codegen_Splat(Codegen *cg, IrInstruction *ins) {
+    unsigned w = ins->width;
+    int vd = ins->vd;
+
+    if (ins->a == IR_NONE) {
+        if (Codegen_Avx(cg))
+            EMIT("\tvpxor ymm%d, ymm%d, ymm%d\n", vd, vd, vd);
+        else
+            EMIT("\tpxor xmm%d, xmm%d\n", vd, vd);
+        return;
+    }
+
+    Codegen_Broadcast(cg, vd, Codegen_Use(cg, ins->a, w, REG_R10), w, Codegen_Avx(cg));
+}
+
+// Lanes that count up from a by b are written out below the stack pointer and loaded at once
+void Codegen_Series(Codegen *cg, IrInstruction *ins) {
+    unsigned w = ins->width;
+    unsigned size = cg->module->vector;
+
+    Register a = Codegen_Use(cg, ins->a, w, REG_R10);
+    if (a != REG_R10)
+        EMIT("\tmov %s, %s\n", Register_Name(REG_R10, w), Register_Name(a, w));
+
+    Register b = Codegen_Use(cg, ins->b, w, REG_R11);
+
+    for (unsigned k = 0; k < size / w; k++) {
+        if (k > 0)
+            EMIT("\tadd %s, %s\n", Register_Name(REG_R10, w), Register_Name(b, w));
+        EMIT("\tmov %s [rsp - %u], %s\n", Codegen_Pointer(w), size - k * w, Register_Name(REG_R10, w));
+    }
+
+    EMIT("\t%s %s%d, %s [rsp - %u]\n", Codegen_Avx(cg) ? "vmovdqu" : "movdqu", VREG(cg, ins->vd),
+         Codegen_VectorPointer(cg), size);
+}
+
+void Codegen_VectorArithmetic(Codegen *cg, IrInstruction *ins) {
+    const char *mnemonic = ins->op == IR_VADD ? "padd" : ins->op == IR_VSUB ? "psub" : "pmull";
+    char lane = Codegen_LaneSuffix[ins->width];
+    int vd = ins->vd;
+    int va = ins->va;
+    int vb = ins->vb;
+
+    if (Codegen_Avx(cg)) {
+        EMIT("\tv%s%c ymm%d, ymm%d, ymm%d\n", mnemonic, lane, vd, va, vb);
+        return;
+    }
+
+    // SSE2 overwrites the left-hand operand, xmm15 stands in when that would lose the right-hand side
+    if (vd == vb && vd != va) {
+        if (ins->op != IR_VSUB) {
+            EMIT("\t%s%c xmm%d, xmm%d\n", mnemonic, lane, vd, va);
+            return;
+        }
+
+        EMIT("\tmovdqa xmm15, xmm%d\n", va);
+        EMIT("\t%s%c xmm15, xmm%d\n", mnemonic, lane, vb);
+        EMIT("\tmovdqa xmm%d, xmm15\n", vd);
+        return;
+    }
+
+    if (vd != va)
+        EMIT("\tmovdqa xmm%d, xmm%d\n", vd, va);
+    EMIT("\t%s%c xmm%d, xmm%d\n", mnemonic, lane, vd, vb);
+}
+
+// The lanes are written out below the stack pointer and added up one by one
+void Codegen_Sum(Codegen *cg, IrInstruction *ins) {
+    unsigned w = ins->width;
+    unsigned size = cg->module->vector;
+
+    EMIT("\t%s %s [rsp - %u], %s%d\n", Codegen_Avx(cg) ? "vmovdqu" : "movdqu", Codegen_VectorPointer(cg), size,
+         VREG(cg, ins->va));
+
+    Register a = Codegen_Use(cg, ins->a, w, REG_R10);
+    if (a != REG_R10)
+        EMIT("\tmov %s, %s\n", Register_Name(REG_R10, w), Register_Name(a, w));
+
+    for (unsigned k = 0; k < size / w; k++)
+        EMIT("\tadd %s, %s [rsp - %u]\n", Register_Name(REG_R10, w), Codegen_Pointer(w), size - k * w);
+
+    Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+    EMIT("\tmov %s, %s\n", Register_Name(dst, w), Register_Name(REG_R10, w));
+    Codegen_Commit(cg, ins->dst, dst);
+}
+
+// Unaligned moves, arrays are only aligned to quadwords
+void Codegen_VectorMove(Codegen *cg, IrInstruction *ins) {
+    char operand[64];
+    Codegen_Element(cg, ins, ins->width, operand);
+
+    const char *move = Codegen_Avx(cg) ? "vmovdqu" : "movdqu";
+
+    if (ins->op == IR_VLOAD)
+        EMIT("\t%s %s%d, %s %s\n", move, VREG(cg, ins->vd), Codegen_VectorPointer(cg), operand);
+    else
+        EMIT("\t%s %s %s, %s%d\n", move, Codegen_VectorPointer(cg), operand, VREG(cg, ins->va));
+}
+
+#undef VREG
+
+// Vector values in memory go through xmm14 and xmm15, or ymm15 for 32 bytes, which
+// is followed by vzeroupper
+void Codegen_Address(Codegen *cg, IrInstruction *ins) {
+    Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+    IrGlobal *global = IrModule_FindGlobal(cg->module, ins->target);
+
+    if (global)
+        EMIT("\tlea %s, [rip + %s]\n", Register_Name(dst, 8), global->name);
+    else
+        EMIT("\tlea %s, [rbp - %u]\n", Register_Name(dst, 8), Codegen_ArrayBase(cg, ins->target));
+
+    Codegen_Commit(cg, ins->dst, dst);
+}
+
+// The operands are read before the address of the temporary takes the place of either
+void Codegen_Temporary(Codegen *cg, IrInstruction *ins, unsigned temp) {
+    Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+    EMIT("\tlea %s, [rbp - %u]\n", Register_Name(dst, 8), temp);
+    Codegen_Commit(cg, ins->dst, dst);
+}
+
+void Codegen_PackedSplat(Codegen *cg, IrInstruction *ins) {
+    unsigned temp = Codegen_FrameOffset(cg, ins->imm);
+    Register a = Codegen_Use(cg, ins->a, ins->width, REG_R10);
+
+    if (ins->size == VECTOR_AVX2) {
+        Codegen_Broadcast(cg, 15, a, ins->width, true);
+        EMIT("\tvmovdqu YMMWORD PTR [rbp - %u], ymm15\n", temp);
+        EMIT("\tvzeroupper\n");
+    } else {
+        Codegen_Broadcast(cg, 15, a, ins->width, false);
+        EMIT("\tmovdqu XMMWORD PTR [rbp - %u], xmm15\n", temp);
+    }
+
+    Codegen_Temporary(cg, ins, temp);
+}
+
+// Without a packed multiply for the lanes, they are multiplied one at a time in rax
+void Codegen_LaneMultiply(Codegen *cg, Register a, Register b, unsigned w, unsigned size, unsigned temp) {
+    for (unsigned k = 0; k < size; k += w) {
+        if (w == 1) {
+            EMIT("\tmovzx eax, BYTE PTR [%s + %u]\n", Register_Name(a, 8), k);
+            EMIT("\tmovzx edx, BYTE PTR [%s + %u]\n", Register_Name(b, 8), k);
+            EMIT("\timul eax, edx\n");
+        } else {
+            EMIT("\tmov %s, %s [%s + %u]\n", Register_Name(REG_RAX, w), Codegen_Pointer(w), Register_Name(a, 8), k);
+            EMIT("\timul %s, %s [%s + %u]\n", Register_Name(REG_RAX, w), Codegen_Pointer(w), Register_Name(b, 8), k);
+        }
+        EMIT("\tmov %s [rbp - %u], %s\n", Codegen_Pointer(w), temp - k, Register_Name(REG_RAX, w));
+    }
+}
+
+void Codegen_PackedArithmetic(Codegen *cg, IrInstruction *ins) {
+    const char *mnemonic = ins->op == IR_PADD ? "padd" : ins->op == IR_PSUB ? "psub" : "pmull";
+    char lane = Codegen_LaneSuffix[ins->width];
+    unsigned temp = Codegen_FrameOffset(cg, ins->imm);
+
+    Register a = Codegen_Use(cg, ins->a, 8, REG_R10);
+    Register b = Codegen_Use(cg, ins->b, 8, REG_R11);
+    const char *ra = Register_Name(a, 8);
+    const char *rb = Register_Name(b, 8);
+
+    // SSE2 multiplies words only, AVX2 words and doublewords
+    bool lanewise = ins->op == IR_PMUL &&
+                    (ins->width == 1 || ins->width == 8 || (ins->width == 4 && cg->module->isa < VECTOR_AVX2));
+
+    if (lanewise) {
+        Codegen_LaneMultiply(cg, a, b, ins->width, ins->size, temp);
+    } else if (ins->size == VECTOR_AVX2) {
+        EMIT("\tvmovdqu ymm15, YMMWORD PTR [%s]\n", ra);
+        EMIT("\tv%s%c ymm15, ymm15, YMMWORD PTR [%s]\n", mnemonic, lane, rb);
+        EMIT("\tvmovdqu YMMWORD PTR [rbp - %u], ymm15\n", temp);
+        EMIT("\tvzeroupper\n");
+    } else {
+        EMIT("\tmovdqu xmm15, XMMWORD PTR [%s]\n", ra);
+        EMIT("\tmovdqu xmm14, XMMWORD PTR [%s]\n", rb);
+        EMIT("\t%s%c xmm15, xmm14\n", mnemonic, lane);
+        EMIT("\tmovdqu XMMWORD PTR [rbp - %u], xmm15\n", temp);
+    }
+
+    Codegen_Temporary(cg, ins, temp);
+}
+
+void Codegen_PackedSum(Codegen *cg, IrInstruction *ins) {
+    unsigned w = ins->width;
+    Register a = Codegen_Use(cg, ins->a, 8, REG_R10);
+    const char *acc = Register_Name(REG_RAX, w);
+
+    EMIT("\tmov %s, %s [%s]\n", acc, Codegen_Pointer(w), Register_Name(a, 8));
+    for (unsigned k = w; k < ins->size; k += w)
+        EMIT("\tadd %s, %s [%s + %u]\n", acc, Codegen_Pointer(w), Register_Name(a, 8), k);
+
+    Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+    EMIT("\tmov %s, %s\n", Register_Name(dst, w), acc);
+    Codegen_Commit(cg, ins->dst, dst);
+}
+
+void Codegen_PackedCopy(Codegen *cg, IrInstruction *ins) {
+    const char *ra = Register_Name(Codegen_Use(cg, ins->a, 8, REG_R10), 8);
+    const char *rb = Register_Name(Codegen_Use(cg, ins->b, 8, REG_R11), 8);
+
+    if (ins->size == VECTOR_AVX2) {
+        EMIT("\tvmovdqu ymm15, YMMWORD PTR [%s]\n", rb);
+        EMIT("\tvmovdqu YMMWORD PTR [%s], ymm15\n", ra);
+        EMIT("\tvzeroupper\n");
+    } else {
+        EMIT("\tmovdqu xmm15, XMMWORD PTR [%s]\n", rb);
+        EMIT("\tmovdqu XMMWORD PTR [%s], xmm15\n", ra);
+    }
+}
+
+void Codegen_Instruction(Codegen *cg, IrInstruction *ins, bool last, Register *order, unsigned norder) {
+    // Results nobody reads are not computed, calls are still made
+    if (ins->dst != IR_NONE && ins->op != IR_CALL && cg->alloc->intervals[ins->dst].start == UINT_MAX)
+        return;
+
+    switch (ins->op) {
+        case IR_IMMEDIATE: {
+            Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+            EMIT("\tmov %s, %lld\n", Register_Name(dst, ins->width), ins->imm);
+            Codegen_Commit(cg, ins->dst, dst);
+            break;
+        }
+
+        case IR_MOVE: {
+            Register a = Codegen_Use(cg, ins->a, ins->width, REG_R10);
+            Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+            if (a != dst)
+                EMIT("\tmov %s, %s\n", Register_Name(dst, ins->width), Register_Name(a, ins->width));
+            Codegen_Commit(cg, ins->dst, dst);
+            break;
+        }
+
+        case IR_EXTEND: {
+            unsigned from = cg->fn->widths[ins->a];
+            Register a = Codegen_Use(cg, ins->a, from, REG_R10);
+            Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+            Codegen_Widen(cg, dst, a, from, ins->width);
+            Codegen_Commit(cg, ins->dst, dst);
+            break;
+        }
+
+        case IR_ADD:
+        case IR_SUB:
+        case IR_MUL:
+            Codegen_Arithmetic(cg, ins);
+            break;
+
+        case IR_DIV:
+            Codegen_Divide(cg, ins);
+            break;
+
+        case IR_EQUAL:
+        case IR_GREATER:
+        case IR_LESS:
+            Codegen_Compare(cg, ins);
+            break;
+
+        case IR_LOAD: {
+            IrGlobal *global = IrModule_FindGlobal(cg->module, ins->target);
+            Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+            EMIT("\tmov %s, %s [rip + %s]\n", Register_Name(dst, ins->width), Codegen_Pointer(ins->width),
+                 global->name);
+            Codegen_Commit(cg, ins->dst, dst);
+            break;
+        }
+
+        case IR_STORE: {
+            IrGlobal *global = IrModule_FindGlobal(cg->module, ins->target);
+            Register a = Codegen_Use(cg, ins->a, ins->width, REG_R11);
+            EMIT("\tmov %s [rip + %s], %s\n", Codegen_Pointer(ins->width), global->name,
+                 Register_Name(a, ins->width));
+            break;
+        }
+
+        case IR_CHECK:
+            Codegen_Check(cg, ins);
+            break;
+
+        case IR_ELEMENT: {
+            char operand[64];
+            Codegen_Element(cg, ins, ins->width, operand);
+            Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+            EMIT("\tmov %s, %s %s\n", Register_Name(dst, ins->width), Codegen_Pointer(ins->width), operand);
+            Codegen_Commit(cg, ins->dst, dst);
+            break;
+        }
+
+        // The value is reloaded ahead of the address, which takes both scratch registers
+        case IR_SET_ELEMENT: {
+            char operand[64];
+            Register b = Codegen_Use(cg, ins->b, ins->width, REG_RAX);
+            Codegen_Element(cg, ins, ins->width, operand);
+            EMIT("\tmov %s %s, %s\n", Codegen_Pointer(ins->width), operand, Register_Name(b, ins->width));
+            break;
+        }
+
+        case IR_CLEAR:
+            Codegen_Clear(cg, ins);
+            break;
+
+        // Handled along with the prologue
+        case IR_PARAMETER:
+            break;
+
+        case IR_CALL:
+            Codegen_Call(cg, ins);
+            break;
+
+        case IR_TAIL_CALL:
+            Codegen_TailCall(cg, ins, order, norder);
+            break;
+
+        case IR_RETURN:
+            if (ins->a != IR_NONE) {
+                Register a = Codegen_Use(cg, ins->a, ins->width, REG_R11);
+                EMIT("\tmov %s, %s\n", Register_Name(REG_RAX, ins->width), Register_Name(a, ins->width));
+            }
+            if (!last)
+                EMIT("\tjmp .L%s.ret\n", cg->fn->name);
+            break;
+
+        case IR_JUMP:
+            EMIT("\tjmp .L%s.%u\n", cg->fn->name, ins->label);
+            break;
+
+        case IR_BRANCH: {
+            Register a = Codegen_Use(cg, ins->a, ins->width, REG_R11);
+            EMIT("\ttest %s, %s\n", Register_Name(a, ins->width), Register_Name(a, ins->width));
+            EMIT("\tjz .L%s.%u\n", cg->fn->name, ins->label);
+            break;
+        }
+
+        case IR_BRANCH_SET: {
+            Register a = Codegen_Use(cg, ins->a, ins->width, REG_R11);
+            EMIT("\ttest %s, %s\n", Register_Name(a, ins->width), Register_Name(a, ins->width));
+            EMIT("\tjnz .L%s.%u\n", cg->fn->name, ins->label);
+            break;
+        }
+
+        case IR_LABEL:
+            Codegen_Label(cg, ins->label);
+            break;
+
+        case IR_VSPLAT:
+            Codegen_Splat(cg, ins);
+            break;
+
+        case IR_VSERIES:
+            Codegen_Series(cg, ins);
+            break;
+
+        case IR_VADD:
+        case IR_VSUB:
+        case IR_VMUL:
+            Codegen_VectorArithmetic(cg, ins);
+            break;
+
+        case IR_VSUM:
+            Codegen_Sum(cg, ins);
+            break;
+
+        case IR_VLOAD:
+        case IR_VSTORE:
+            Codegen_VectorMove(cg, ins);
+            break;
+
+        case IR_ADDRESS:
+            Codegen_Address(cg, ins);
+            break;
+
+        case IR_STRING: {
+            Register dst = Codegen_Target(cg, ins->dst, REG_R11);
+            EMIT("\tlea %s, [rip + .Lstr%lld]\n", Register_Name(dst, 8), ins->imm);
+            Codegen_Commit(cg, ins->dst, dst);
+            break;
+        }
+
+        case IR_COUNT:
+            EMIT("\tinc QWORD PTR [rip + .Lprofile.counts + %lld]\n", 8 * ins->imm);
+            break;
+
+        case IR_PSPLAT:
+            Codegen_PackedSplat(cg, ins);
+            break;
+
+        case IR_PADD:
+        case IR_PSUB:
+        case IR_PMUL:
+            Codegen_PackedArithmetic(cg, ins);
+            break;
+
+        case IR_PSUM:
+            Codegen_PackedSum(cg, ins);
+            break;
+
+        case IR_PCOPY:
+            Codegen_PackedCopy(cg, ins);
+            break;
+
+        // The upper halves of the ymm registers are cleared to avoid penalties in SSE code
+        case IR_VEND:
+            if (Codegen_Avx(cg))
+                EMIT("\tvzeroupper\n");
+            break;
+    }
+}
+
+void Codegen_RestoreFrame(Codegen *cg, Register *order, unsigned norder) {
+    if (cg->saved > 0)
+        EMIT("\tlea rsp, [rbp - %u]\n", 8 * cg->saved);
+    else
+        EMIT("\tmov rsp, rbp\n");
+
+    for (int i = (int) norder - 1; i >= 0; i--)
+        if (cg->alloc->callee_saved & (1u << order[i]))
+            EMIT("\tpop %s\n", Register_Name(order[i], 8));
+
+    EMIT("\tpop rbp\n");
+}
+
+void Codegen_Function(Codegen *cg, IrFunction *fn) {
+    cg->fn = fn;
+    cg->alloc = RegAlloc_Function(fn);
+    cg->saved = 0;
+    cg->checks = 0;
+    cg->clears = 0;
+
+    Register order[] = {REG_RBX, REG_R12, REG_R13, REG_R14, REG_R15};
+    unsigned norder = sizeof(order) / sizeof(Register);
+
+    for (unsigned i = 0; i < norder; i++)
+        if (cg->alloc->callee_saved & (1u << order[i]))
+            cg->saved++;
+
+    // Procedures a module exports are linked to from the modules importing it
+    if (!fn->def)
+        EMIT("\t.globl main\n");
+    else if (fn->def->node.func_def.module)
+        EMIT("\t.globl %s\n", fn->name);
+
+    EMIT("\t.type %s, @function\n", fn->name);
+    EMIT("%s:\n", fn->name);
+    EMIT("\tpush rbp\n");
+    EMIT("\tmov rbp, rsp\n");
+
+    for (unsigned i = 0; i < norder; i++)
+        if (cg->alloc->callee_saved & (1u << order[i]))
+            EMIT("\tpush %s\n", Register_Name(order[i], 8));
+
+    // Keep the stack 16-byte aligned
+    unsigned frame = 8 * cg->alloc->slots + fn->frame;
+    if ((8 * cg->saved + frame) % 16 != 0)
+        frame += 8;
+
+    if (frame > 0)
+        EMIT("\tsub rsp, %u\n", frame);
+
+    Codegen_Parameters(cg);
+
+    for (unsigned i = 0; i < fn->code->length; i++)
+        Codegen_Instruction(cg, Array_At(fn->code, i), i == fn->code->length - 1, order, norder);
+
+    EMIT(".L%s.ret:\n", cg->fn->name);
+
+    // The program writes its profile as it returns
+    if (!fn->def && cg->module->profile && cg->module->profile->generate)
+        EMIT("\tcall .Lprofile.write\n");
+
+    Codegen_RestoreFrame(cg, order, norder);
+    EMIT("\tret\n");
+
+    // Out of bounds accesses trap
+    if (cg->checks > 0) {
+        EMIT(".L%s.bounds:\n", cg->fn->name);
+        EMIT("\tud2\n");
+    }
+
+    EMIT("\t.size %s, .-%s\n\n", fn->name, fn->name);
+}
+
+// FNV-1a over the bytes of a value
+uint64_t Codegen_Mix(uint64_t hash, long long value) {
+    for (unsigned i = 0; i < sizeof(value); i++)
+        hash = (hash ^ (unsigned char) (value >> (8 * i))) * 1099511628211ULL;
+    return hash;
+}
+
+uint64_t Codegen_MixString(uint64_t hash, const char *str) {
+    for (; *str; str++)
+        hash = (hash ^ (unsigned char) *str) * 1099511628211ULL;
+    return Codegen_Mix(hash, 0);
+}
+
+// Everything the code of the function is generated from: its instructions and the names and frame
+// offsets of what they refer to. Its local labels are named after it, not after where it stands in
+// the module, so that procedures added, removed or moved around it leave it as it was.
+uint64_t Codegen_Hash(Codegen *cg, IrFunction *fn) {
+    uint64_t hash = Codegen_MixString(cg->seed, fn->name);
+    hash = Codegen_Mix(hash, fn->def != NULL);
+    hash = Codegen_Mix(hash, fn->vregs);
+    hash = Codegen_Mix(hash, fn->labels);
+    hash = Codegen_Mix(hash, fn->frame);
+
+    for (unsigned i = 0; i < fn->vregs; i++)
+        hash = Codegen_Mix(hash, fn->widths[i]);
+
+    for (unsigned i = 0; i < fn->code->length; i++) {
+        IrInstruction *ins = Array_At(fn->code, i);
+        long long fields[] = {ins->op, ins->dst, ins->a, ins->b, ins->imm, ins->width, ins->label, ins->nargs,
+                              ins->vd, ins->va, ins->vb, ins->size};
+
+        for (unsigned k = 0; k < sizeof(fields) / sizeof(fields[0]); k++)
+            hash = Codegen_Mix(hash, fields[k]);
+
+        for (unsigned k = 0; k < ins->nargs; k++)
+            hash = Codegen_Mix(hash, ins->args[k]);
+
+        if (!ins->target)
+            continue;
+
+        IrFunction *callee = IrModule_FindFunction(cg->module, ins->target);
+        IrGlobal *global = IrModule_FindGlobal(cg->module, ins->target);
+        IrArray *array = IrFunction_FindArray(fn, ins->target);
+
+        if (callee)
+            hash = Codegen_MixString(hash, callee->name);
+        if (global)
+            hash = Codegen_MixString(hash, global->name);
+        if (array)
+            hash = Codegen_Mix(hash, array->offset);
+        if (ins->target->type == NODE_VARIABLE_DECLARATION)
+            hash = Codegen_Mix(hash, Type_Size(ins->target->node.var_decl.type));
+    }
+
+    return hash;
+}
+
+// The code of the function, taken from the cache if it has been generated from the same input before
+void Codegen_Procedure(Codegen *cg, IrFunction *fn, CodeCacheStats *stats) {
+    uint64_t key = cg->cache ? Codegen_Hash(cg, fn) : 0;
+
+    if (cg->cache && CodeCache_Load(cg->cache, key, cg->out, stats))
+        return;
+
+    FILE *out = cg->out;
+    char *text = NULL;
+    size_t length = 0;
+    FILE *buffer = cg->cache ? open_memstream(&text, &length) : NULL;
+
+    if (buffer)
+        cg->out = buffer;
+
+    Codegen_Function(cg, fn);
+
+    *stats = (CodeCacheStats) {cg->alloc->allocated, cg->alloc->spilled, cg->saved};
+    Allocation_Destroy(cg->alloc);
+    cg->alloc = NULL;
+
+    if (buffer) {
+        fclose(buffer);
+        cg->out = out;
+        fwrite(text, 1, length, out);
+        CodeCache_Store(cg->cache, key, stats, text, length);
+        free(text);
+    }
+}
+
+typedef struct {
+    PooledString *s;
+    unsigned id;
+} CodegenString;
+
+// Orders by the text read backwards, which puts every string right ahead of the ones it ends
+int Codegen_CompareTails(const void *a, const void *b) {
+    const PooledString *x = ((const CodegenString *) a)->s;
+    const PooledString *y = ((const CodegenString *) b)->s;
+    unsigned i = x->length;
+    unsigned j = y->length;
+
+    while (i > 0 && j > 0) {
+        unsigned char cx = x->text[--i];
+        unsigned char cy = y->text[--j];
+        if (cx != cy)
+            return cx - cy;
+    }
+
+    return (int) x->length - (int) y->length;
+}
+
+void Codegen_StringData(Codegen *cg, PooledString *s) {
+    EMIT("\t.string \"");
+
+    for (unsigned i = 0; i < s->length; i++) {
+        unsigned char c = s->text[i];
+
+        if (c == '"' || c == '\\')
+            EMIT("\\%c", c);
+        else if (c >= 0x20 && c < 0x7f)
+            EMIT("%c", c);
+        else
+            EMIT("\\%03o", c);
+    }
+
+    EMIT("\"\n");
+}
+
+// The string literals referenced by the code go to read-only data, once each. A literal that
+// ends another one is placed inside it, sharing its tail and terminator.
+void Codegen_Strings(Codegen *cg) {
+    StringPool *pool = cg->module->strings;
+    unsigned count = pool ? pool->strings->length : 0;
+    bool *referenced = calloc(count + 1, sizeof(bool));
+
+    for (unsigned i = 0; i < cg->module->functions->length; i++) {
+        IrFunction *fn = Array_At(cg->module->functions, i);
+
+        for (unsigned j = 0; j < fn->code->length; j++) {
+            IrInstruction *ins = Array_At(fn->code, j);
+            if (ins->op == IR_STRING)
+                referenced[ins->imm] = true;
+        }
+    }
+
+    CodegenString *strings = malloc((count + 1) * sizeof(CodegenString));
+    unsigned n = 0;
+
+    for (unsigned id = 0; id < count; id++)
+        if (referenced[id])
+            strings[n++] = (CodegenString) {StringPool_At(pool, id), id};
+
+    free(referenced);
+
+    if (n == 0) {
+        free(strings);
+        return;
+    }
+
+    qsort(strings, n, sizeof(CodegenString), Codegen_CompareTails);
+
+    // The string each one is placed in, found from the back
+    unsigned *container = malloc(n * sizeof(unsigned));
+    unsigned shared = 0;
+    unsigned bytes = 0;
+
+    for (unsigned k = n; k-- > 0;) {
+        PooledString *s = strings[k].s;
+        container[k] = k;
+
+        if (k + 1 < n) {
+            PooledString *next = strings[k + 1].s;
+            if (s->length <= next->length && memcmp(next->text + next->length - s->length, s->text, s->length) == 0)
+                container[k] = container[k + 1];
+        }
+    }
+
+    EMIT("\t.section .rodata\n");
+
+    for (unsigned k = 0; k < n; k++) {
+        if (container[k] != k)
+            continue;
+
+        EMIT(".Lstr%u:\n", strings[k].id);
+        Codegen_StringData(cg, strings[k].s);
+        bytes += strings[k].s->length + 1;
+    }
+
+    for (unsigned k = 0; k < n; k++) {
+        if (container[k] == k)
+            continue;
+
+        CodegenString *outer = &strings[container[k]];
+        EMIT("\t.set .Lstr%u, .Lstr%u + %u\n", strings[k].id, outer->id, outer->s->length - strings[k].s->length);
+        shared++;
+    }
+
+    EMIT_PRINT("Pooled %u string literal(s) into %u distinct, %u of them sharing the tail of another, in %u byte(s) "
+               "of read-only data.\n", pool->literals, n, shared, bytes);
+
+    free(container);
+    free(strings);
+}
+
+// The header and counters of the profile, and the file the program writes them to
+void Codegen_ProfileData(Codegen *cg) {
+    Profile *profile = cg->module->profile;
+    PooledString path = {(char *) profile->path, (unsigned) strlen(profile->path), 0};
+
+    EMIT("\t.data\n");
+    EMIT("\t.align 8\n");
+    EMIT(".Lprofile:\n");
+    EMIT("\t.quad %#llx, %#llx, %u\n", PROFILE_MAGIC, profile->signature, profile->sites);
+    EMIT(".Lprofile.counts:\n");
+    EMIT("\t.zero %u\n", 8 * profile->sites);
+
+    EMIT("\t.section .rodata\n");
+    EMIT(".Lprofile.path:\n");
+    Codegen_StringData(cg, &path);
+}
+
+// Writes the profile through system calls, leaving the return value of the program alone
+void Codegen_ProfileWriter(Codegen *cg) {
+    Profile *profile = cg->module->profile;
+
+    EMIT(".Lprofile.write:\n");
+    EMIT("\tpush rax\n");
+    EMIT("\tmov eax, 2\n");                   // open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644)
+    EMIT("\tlea rdi, [rip + .Lprofile.path]\n");
+    EMIT("\tmov esi, 0x241\n");
+    EMIT("\tmov edx, 0644\n");
+    EMIT("\tsyscall\n");
+    EMIT("\ttest eax, eax\n");
+    EMIT("\tjs .Lprofile.done\n");
+    EMIT("\tmov edi, eax\n");
+    EMIT("\tmov eax, 1\n");                   // write(fd, profile, size)
+    EMIT("\tlea rsi, [rip + .Lprofile]\n");
+    EMIT("\tmov edx, %u\n", 8 * (3 + profile->sites));
+    EMIT("\tsyscall\n");
+    EMIT("\tmov eax, 3\n");                   // close(fd)
+    EMIT("\tsyscall\n");
+    EMIT(".Lprofile.done:\n");
+    EMIT("\tpop rax\n");
+    EMIT("\tret\n\n");
+}
+
+// Procedures follow the top level by how often they were entered, keeping the hot ones together
+// and the ones never entered out of the way
+void Codegen_Order(Codegen *cg) {
+    Array *functions = cg->module->functions;
+    unsigned never = 0;
+
+    for (unsigned i = 2; i < functions->length; i++) {
+        IrFunction *fn = Array_At(functions, i);
+        unsigned long long count = fn->def->node.func_def.entered.count;
+        unsigned k = i;
+
+        for (; k > 1; k--) {
+            IrFunction *prev = Array_At(functions, k - 1);
+            if (prev->def->node.func_def.entered.count >= count)
+                break;
+            functions->base[k] = prev;
+        }
+
+        functions->base[k] = fn;
+    }
+
+    for (unsigned i = 1; i < functions->length; i++) {
+        IrFunction *fn = Array_At(functions, i);
+        if (fn->def->node.func_def.entered.count == 0)
+            never++;
+    }
+
+    if (functions->length > 1) {
+        EMIT_PRINT("Ordered %u procedure(s) by their entries in the profile, %u never entered placed last.\n",
+                   functions->length - 1, never);
+    }
+}
+
+void Codegen_Module(Codegen *cg) {
+    unsigned allocated = 0;
+    unsigned spilled = 0;
+    unsigned saved = 0;
+
+    EMIT("\t.intel_syntax noprefix\n");
+
+    if (cg->module->globals->length > 0) {
+        EMIT("\t.bss\n");
+
+        for (unsigned i = 0; i < cg->module->globals->length; i++) {
+            IrGlobal *global = Array_At(cg->module->globals, i);
+            EMIT("\t.align 8\n");
+            EMIT("%s:\n", global->name);
+            EMIT("\t.zero %u\n", global->size);
+        }
+    }
+
+    Codegen_Strings(cg);
+
+    bool instrumented = cg->module->profile && cg->module->profile->generate;
+
+    if (instrumented)
+        Codegen_ProfileData(cg);
+
+    if (Profile_Guides(cg->module->profile))
+        Codegen_Order(cg);
+
+    EMIT("\t.text\n");
+
+    for (unsigned i = 0; i < cg->module->functions->length; i++) {
+        CodeCacheStats stats;
+
+        if (i == 0 && !cg->module->entry)
+            continue;
+
+        IrFunction *fn = Array_At(cg->module->functions, i);
+        double start = Trace_Now();
+
+        Codegen_Procedure(cg, fn, &stats);
+
+        Trace_Span("procedure", fn->def ? fn->def->node.func_def.id->value : "(program)", start);
+
+        allocated += stats.allocated;
+        spilled += stats.spilled;
+        saved += stats.saved;
+    }
+
+    if (instrumented)
+        Codegen_ProfileWriter(cg);
+
+    EMIT("\t.section .note.GNU-stack,\"\",@progbits\n");
+
+    EMIT_PRINT("Kept %u value(s) in registers and spilled %u, saving %u callee-saved register(s).\n", allocated,
+               spilled, saved);
+
+    if (cg->module->tail_calls > 0) {
+        EMIT_PRINT("Turned %u call(s) into tail calls.\n", cg->module->tail_calls);
+    }
+
+    if (cg->module->cold > 0) {
+        EMIT_PRINT("Moved %u check alternative(s) rarely taken in the profile past the end of their procedure.\n",
+                   cg->module->cold);
+    }
+}
+
+Status Codegen_Program(Node *program, Options *opts) {
+    Vectorizer *vec = Vectorizer_Create(opts->vector, opts->vectorize_report);
+
+    double start = Trace_Now();
+    IrModule *module = Ir_Lower(program, vec);
+    Trace_Span("phase", "lower", start);
+
+    if (vec->vectorized + vec->declined > 0) {
+        EMIT_PRINT("Vectorized %u loop(s), declined %u.\n", vec->vectorized, vec->declined);
+    }
+
+    Vectorizer_Destroy(vec);
+
+    if (!module) {
+        EMIT_PRINT("Lowering to the intermediate representation failed.\n");
+        return STATUS_FAIL;
+    }
+
+    module->entry = !opts->module;
+
+    if (opts->print_ir) {
+        for (unsigned i = 0; i < module->functions->length; i++)
+            IrFunction_Print(Array_At(module->functions, i));
+    }
+
+    FILE *out = fopen(opts->output, "w");
+
+    if (!out) {
+        EMIT_PRINT("Could not open \"%s\" for writing.\n", opts->output);
+        IrModule_Destroy(module);
+        return STATUS_FAIL;
+    }
+
+    CodeCache cache = {opts->code_cache, (unsigned long long) opts->code_cache_size << 20, 0, 0, 0, 0};
+    bool cached = opts->code_cache && CodeCache_Open(&cache) == STATUS_OK;
+    Codegen cg = {out, module, NULL, NULL, 0, 0, 0, cached ? &cache : NULL, 14695981039346656037ULL};
+
+    bool instrumented = module->profile && module->profile->generate;
+    long long settings[] = {CODE_CACHE_VERSION, module->vector, module->isa, instrumented};
+
+    for (unsigned i = 0; i < sizeof(settings) / sizeof(settings[0]); i++)
+        cg.seed = Codegen_Mix(cg.seed, settings[i]);
+
+    Codegen_Module(&cg);
+
+    fclose(out);
+    IrModule_Destroy(module);
+
+    if (cg.cache) {
+        CodeCache_Evict(&cache);
+        EMIT_PRINT("Reused %u procedure(s) from the code cache, generated %u, evicted %u least recently used.\n",
+                   cache.hits, cache.misses, cache.evicted);
+
+        if (cache.failed > 0) {
+            EMIT_PRINT("Could not cache %u procedure(s) in \"%s\".\n", cache.failed, cache.dir);
+        }
+    }
+
+    EMIT_PRINT("Wrote \"%s\".\n", opts->output);
+    return STATUS_OK;
+}
+
+#undef EMIT
@@ -0,0 +1,163 @@
+#include "include/compile.h"
+#include "include/tokenizer.h"
+#include "include/io.h"
+#include "include/parse.h"
+#include "include/semantic.h"
+#include "include/optimize.h"
+#include "include/codegen.h"
+#include "include/profile.h"
+#include "include/module.h"
+#include "include/trace.h"
+#include "include/dump.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "include/memory.h"
+
+// Parses, analyses, optimizes and generates code for the input of the options
+Status Compile_Source(Options *opts, AstCache *cache, FILE *dump) {
+    char *module = NULL;
+
+    if (opts->module && !(module = Module_Name(opts->input)))
+        return STATUS_FAIL;
+
+    Memory_Phase("read");
+    double start = Trace_Now();
+    char *str = read_file(opts->input);
+    Trace_Span("phase", "read", start);
+
+    if (!str) {
+        printf("Failed to read file.\n");
+        free(module);
+        return STATUS_FAIL;
+    }
+
+    char *dir = Module_Directory(opts->input);
+
+    Memory_Phase("parse");
+    start = Trace_Now();
+
+    // An unchanged source is loaded from the cache, without being tokenized or parsed
+    AstCacheKey key = AstCache_Key(str);
+    bool cached = cache->dir || cache->modules;
+    Node *n = cached ? AstCache_Load(cache, opts->input, key) : NULL;
+
+    Parser *parser = NULL;
+    char *primed = NULL;
+
+    if (!n) {
+        primed = Tokenizer_Prime(str);
+
+        Array *offsets = Array_Create();
+
+        // An edited one only has the statements the edit touches parsed again
+        if (cached)
+            n = AstCache_Reparse(cache, opts->input, primed, offsets);
+
+        if (!n) {
+            Tokenizer *tokenizer = Tokenizer_Create(primed);
+
+            parser = Parser_CreateParser(tokenizer);
+            parser->offsets = offsets;
+            parser->dir = dir;
+
+            n = Parser_ParseProgram(parser);
+
+            Tokenizer_Destroy(tokenizer);
+        }
+
+        if (n && cached)
+            AstCache_Store(cache, opts->input, key, n, primed, offsets);
+
+        Array_Destroy(offsets);
+    }
+
+    Trace_Span("phase", "parse", start);
+    free(str);
+
+    Status status = STATUS_FAIL;
+
+    if (n) {
+        printf("Natron -> Syntactic analysis successful.\n");
+
+        if (opts->dump_ast)
+            Dump_Program(n, opts->dump_ast, dump);
+
+        Memory_Phase("semantic");
+        start = Trace_Now();
+        SemanticAnalysis *sa = SemanticAnalysis_Create(n);
+        Status analysed = SemanticAnalysis_RunAnalysis(sa);
+        Trace_Span("phase", "semantic", start);
+
+        if (analysed == STATUS_FAIL) {
+            printf("Notamide -> Semantic analysis failed.\n");
+        } else {
+            printf("Notamide -> Semantic analysis OK.\n");
+
+            start = Trace_Now();
+            Status exported = module ? Module_Export(n, opts->input, module) : STATUS_OK;
+
+            if (module)
+                Trace_Span("phase", "export", start);
+
+            if (exported == STATUS_OK) {
+                Memory_Phase("optimize");
+                start = Trace_Now();
+                Profile *profile = Profile_Create(n, opts);
+                Optimize_Program(n, opts);
+                Trace_Span("phase", "optimize", start);
+
+                Memory_Phase("codegen");
+                start = Trace_Now();
+                status = opts->output ? Codegen_Program(n, opts) : STATUS_OK;
+                Trace_Span("phase", "codegen", start);
+
+                Profile_Destroy(profile);
+            }
+        }
+
+        Memory_Phase("cleanup");
+        Node_DestroyRecurse(n);
+        SemanticAnalysis_Destroy(sa);
+    } else {
+        printf("Natron -> Parsing failed.\n");
+    }
+
+    Memory_Phase("cleanup");
+
+    if (parser)
+        Parser_DestroyParser(parser);
+
+    free(primed);
+    free(dir);
+    free(module);
+
+    return status;
+}
+
+// Traces the compile of the file as a whole when asked to, around the phases and procedures
+Status Compile_Run(Options *opts, AstCache *cache) {
+    FILE *dump = opts->dump_file ? fopen(opts->dump_file, "w") : stdout;
+
+    if (!dump) {
+        printf("Could not open \"%s\" for writing.\n", opts->dump_file);
+        return STATUS_FAIL;
+    }
+
+    if (opts->trace && !Trace_Open(opts->trace, opts->input)) {
+        if (dump != stdout)
+            fclose(dump);
+        return STATUS_FAIL;
+    }
+
+    double start = Trace_Now();
+    Status status = Compile_Source(opts, cache, dump);
+    Trace_Span("file", opts->input, start);
+
+    Trace_Close();
+
+    if (dump != stdout)
+        fclose(dump);
+
+    return status;
+}
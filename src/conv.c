@@ -1,54 +1,61 @@
-#include "include/conv.h"
-#include "include/bool.h"
-
-#include <string.h>
-#include <math.h>
-
-int stoi(char *str) {
-    int rslt = 0;
-
-    for (unsigned int i = 0; i < strlen(str); i ++) {
-        int old = rslt;
-        rslt = rslt * 10 + ctoi(str[i]);
-
-        // Check for arithmetic overflow
-        if (rslt < old) {
-            // TODO Procrastination my friend
-        }
-    }
-
-    return rslt;
-}
-
-int ctoi(char c) {
-    return c - '0';
-}
-
-float stof(char *str) {
-    float rslt = 0.0f;
-
-    bool region = false; // false - Integer, true - Real
-    float real_ix = 1.0f;
-
-    for (unsigned int i = 0; i < strlen(str); i ++) {
-        char c = str[i];
-        int val = (c == '.') ? -1 : ctoi(c);
-
-        if (c == '.') {
-            region = true;
-            continue;
-        }
-
-        // Integer region
-        if (!region) {
-            rslt = rslt * 10 + val;
-            continue;
-        }
-
-        // Real region
-        rslt = rslt + (powf(10.0f, -real_ix) * (float) val);
-        real_ix ++;
-    }
-
-    return rslt;
+#include "include/conv.h"
+
+#include <limits.h>
+#include <stdlib.h>
+
+// Decimal digits. Fails if the value does not fit in a qword.
+bool stoi(const char *str, long long *n) {
+    unsigned long long rslt = 0;
+
+    for (const char *c = str; *c; c++) {
+        int digit = ctoi(*c);
+
+        if (rslt > (unsigned long long) (LLONG_MAX - digit) / 10)
+            return false;
+
+        rslt = rslt * 10 + digit;
+    }
+
+    *n = (long long) rslt;
+    return true;
+}
+
+int ctoi(char c) {
+    return c - '0';
+}
+
+// Powers of ten that doubles hold exactly
+const double Conv_PowersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14,
+                                   1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Correctly rounded. The digits are gathered into an integer, and if it fits the 53 bits of a
+// double, a single division by an exact power of ten rounds correctly. Anything longer is left to
+// strtod.
+double stof(const char *str) {
+    unsigned long long mantissa = 0;
+    unsigned digits = 0;    // Significant ones
+    unsigned scale = 0;     // Past the point
+    bool point = false;
+
+    for (const char *c = str; *c; c++) {
+        if (*c == '.') {
+            point = true;
+            continue;
+        }
+
+        if (digits == 19)
+            return strtod(str, NULL);
+
+        mantissa = mantissa * 10 + ctoi(*c);
+
+        if (mantissa > 0)
+            digits++;
+        if (point)
+            scale++;
+    }
+
+    if (mantissa > (1ull << 53) || scale >= sizeof(Conv_PowersOfTen) / sizeof(double))
+        return strtod(str, NULL);
+
+    return (double) mantissa / Conv_PowersOfTen[scale];
 }
\ No newline at end of file
@@ -0,0 +1,430 @@
+#include "include/cse.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "include/memory.h"
+
+// Available computations tracked per region. Older ones are dropped beyond this,
+// which keeps lookups and kills linear in the size of a block.
+#define CSE_WINDOW 64
+
+Cse *Cse_Create() {
+    Cse *cse = malloc(sizeof(Cse));
+    cse->entries = Array_Create();
+    cse->temps = 0;
+    cse->eliminated = 0;
+    return cse;
+}
+
+void Cse_Destroy(Cse *cse) {
+    Array_DestroyCallBack(cse->entries, free);
+    free(cse);
+}
+
+bool Cse_Commutative(BinaryType op) {
+    return op == BIN_ADD || op == BIN_MUL || op == BIN_EQUAL;
+}
+
+unsigned Cse_Combine(BinaryType op, unsigned l, unsigned r) {
+    unsigned operands = Cse_Commutative(op) ? (l + r) ^ (l * r) : l * 31 + r;
+    return (operands * 16777619u) ^ (op + 5);
+}
+
+unsigned Cse_Hash(Node *n) {
+    switch (n->type) {
+        case NODE_INTEGER_LITERAL:
+            return (unsigned) n->node.int_lit.n * 2654435761u + 1;
+        case NODE_FLOAT_LITERAL: {
+            unsigned long long bits;
+            memcpy(&bits, &n->node.float_lit.f, sizeof(bits));
+            return (unsigned) (bits ^ bits >> 32) * 2654435761u + 2;
+        }
+        case NODE_VARIABLE_REFERENCE:
+            return (unsigned) ((uintptr_t) n->node.var_ref.decl >> 4) * 2246822519u + 3;
+        case NODE_SIZE:
+            return (unsigned) ((uintptr_t) n->node.size.type >> 4) * 3266489917u + 4;
+        case NODE_BINARY_EXPRESSION:
+            return Cse_Combine(n->node.binary.op, Cse_Hash(n->node.binary.left), Cse_Hash(n->node.binary.right));
+        default:
+            return 0;
+    }
+}
+
+// Structural equality of two pure expressions
+bool Cse_Equal(Node *a, Node *b) {
+    if (a->type != b->type)
+        return false;
+
+    switch (a->type) {
+        case NODE_INTEGER_LITERAL:
+            return a->node.int_lit.n == b->node.int_lit.n;
+        case NODE_FLOAT_LITERAL:
+            return a->node.float_lit.f == b->node.float_lit.f;
+        case NODE_VARIABLE_REFERENCE:
+            return a->node.var_ref.decl && a->node.var_ref.decl == b->node.var_ref.decl;
+        case NODE_SIZE:
+            return a->node.size.type == b->node.size.type;
+        case NODE_BINARY_EXPRESSION:
+            if (a->node.binary.op != b->node.binary.op)
+                return false;
+            if (Cse_Equal(a->node.binary.left, b->node.binary.left) &&
+                Cse_Equal(a->node.binary.right, b->node.binary.right))
+                return true;
+            return Cse_Commutative(a->node.binary.op) &&
+                   Cse_Equal(a->node.binary.left, b->node.binary.right) &&
+                   Cse_Equal(a->node.binary.right, b->node.binary.left);
+        default:
+            return false;
+    }
+}
+
+bool Cse_References(Node *expr, Node *decl) {
+    if (!expr)
+        return false;
+
+    if (expr->type == NODE_VARIABLE_REFERENCE)
+        return expr->node.var_ref.decl == decl;
+
+    if (expr->type == NODE_BINARY_EXPRESSION)
+        return Cse_References(expr->node.binary.left, decl) || Cse_References(expr->node.binary.right, decl);
+
+    return false;
+}
+
+bool Cse_Contains(Node *tree, Node *n) {
+    if (!tree)
+        return false;
+
+    if (tree == n)
+        return true;
+
+    if (tree->type == NODE_BINARY_EXPRESSION)
+        return Cse_Contains(tree->node.binary.left, n) || Cse_Contains(tree->node.binary.right, n);
+
+    return false;
+}
+
+// An assignment to the variable invalidates every computation reading it
+void Cse_Kill(Array *table, Node *decl) {
+    unsigned i = 0;
+    while (i < table->length) {
+        CseEntry *e = Array_At(table, i);
+        if (Cse_References(e->expr, decl)) {
+            Array_Remove(table, i);
+            continue;
+        }
+        i++;
+    }
+}
+
+// A call may assign to any variable in scope
+void Cse_KillAll(Array *table) {
+    while (table->length > 0)
+        Array_Remove(table, table->length - 1);
+}
+
+// Apply the kills of a statement that is not value-numbered in the current region
+void Cse_KillConstruct(Array *table, Node *n) {
+    if (!n)
+        return;
+
+    switch (n->type) {
+        case NODE_VARIABLE_ASSIGNMENT:
+            Cse_KillConstruct(table, n->node.var_assign.value);
+            Cse_KillConstruct(table, n->node.var_assign.index);
+            Cse_Kill(table, n->node.var_assign.decl);
+            break;
+        case NODE_INDEX:
+            Cse_KillConstruct(table, n->node.index.expr);
+            break;
+        case NODE_REDUCE:
+            Cse_KillConstruct(table, n->node.reduce.expr);
+            break;
+        case NODE_FUNCTION_CALL:
+            Cse_KillAll(table);
+            break;
+        case NODE_BINARY_EXPRESSION:
+            Cse_KillConstruct(table, n->node.binary.left);
+            Cse_KillConstruct(table, n->node.binary.right);
+            break;
+        case NODE_VARIABLE_DECLARATION:
+            Cse_KillConstruct(table, n->node.var_decl.value);
+            break;
+        case NODE_RETURN:
+            Cse_KillConstruct(table, n->node.ret.expr);
+            break;
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                Cse_KillConstruct(table, Array_At(n->node.block.nodes, i));
+            break;
+        case NODE_CHECK:
+            Cse_KillConstruct(table, n->node.check.expr);
+            Cse_KillConstruct(table, n->node.check.block);
+            Cse_KillConstruct(table, n->node.check.sub);
+            break;
+        case NODE_LOOP:
+            Cse_KillConstruct(table, n->node.loop.from);
+            Cse_KillConstruct(table, n->node.loop.to);
+            Cse_KillConstruct(table, n->node.loop.block);
+            break;
+        default:
+            break;
+    }
+}
+
+Array *Cse_Copy(Array *table) {
+    Array *copy = Array_Create();
+    for (unsigned i = 0; i < table->length; i++)
+        Array_Push(copy, Array_At(table, i));
+    return copy;
+}
+
+// Move the first occurrence of a computation into a temporary declared
+// right before the statement that held it
+void Cse_Hoist(Cse *cse, CseEntry *e) {
+    char name[32];
+    snprintf(name, sizeof(name), "cse.%u", cse->temps++);
+
+    Token *id = Token_Create(name, TT_IDEN);
+    Node *decl = Node_DeclareVariable(id, e->expr, e->expr->etype, MQ_CONST, e->block);
+    Token_Destroy(id);
+
+    *e->slot = Node_Reference(decl, e->expr->super);
+
+    Array *nodes = e->block->node.block.nodes;
+    for (unsigned i = 0; i < nodes->length; i++) {
+        if (Array_At(nodes, i) == e->stmt) {
+            Array_Insert(nodes, i, decl);
+            break;
+        }
+    }
+
+    e->temp = decl;
+    e->slot = NULL;
+
+    // Computations enclosing the first occurrence now refer to the temporary
+    for (unsigned i = 0; i < cse->entries->length; i++) {
+        CseEntry *other = Array_At(cse->entries, i);
+        if (other->stmt == e->stmt && !other->temp)
+            other->hash = Cse_Hash(other->expr);
+    }
+}
+
+// Replace a recomputation by a reference to the temporary holding its value
+void Cse_Replace(Cse *cse, Array *table, Node **slot, CseEntry *e) {
+    if (!e->temp)
+        Cse_Hoist(cse, e);
+
+    Node *old = *slot;
+
+    // Forget computations recorded within the recomputation
+    unsigned i = 0;
+    while (i < table->length) {
+        CseEntry *inner = Array_At(table, i);
+        if (!inner->temp && Cse_Contains(old, inner->expr)) {
+            Array_Remove(table, i);
+            continue;
+        }
+        i++;
+    }
+
+    *slot = Node_Reference(e->temp, old->super);
+
+    Node_Unreference(old);
+    Node_DestroyRecurse(old);
+
+    cse->eliminated++;
+}
+
+void Cse_Call(Cse *, Array *, Node *, Node *, Node *, bool *);
+
+// Value-number the expression held in the slot, bottom-up.
+// Returns whether it is a pure computation, along with its hash.
+bool Cse_Expression(Cse *cse, Array *table, Node **slot, Node *blk, Node *stmt, bool record, bool *killed,
+                    unsigned *hash) {
+    Node *n = *slot;
+
+    if (!n)
+        return false;
+
+    switch (n->type) {
+        case NODE_INTEGER_LITERAL:
+        case NODE_FLOAT_LITERAL:
+        case NODE_SIZE:
+            *hash = Cse_Hash(n);
+            return true;
+        case NODE_VARIABLE_REFERENCE:
+            *hash = Cse_Hash(n);
+            return n->node.var_ref.decl && !n->node.var_ref.next;
+        case NODE_FUNCTION_CALL:
+            Cse_Call(cse, table, n, blk, stmt, killed);
+            return false;
+        // Elements may change behind the back of any variable, only the index is value-numbered
+        case NODE_INDEX:
+            Cse_Expression(cse, table, &n->node.index.expr, blk, stmt, record, killed, hash);
+            return false;
+        case NODE_REDUCE:
+            Cse_Expression(cse, table, &n->node.reduce.expr, blk, stmt, record, killed, hash);
+            return false;
+        case NODE_BINARY_EXPRESSION:
+            break;
+        default:
+            return false;
+    }
+
+    // The right-hand side of '&&' and '||' is only evaluated conditionally
+    bool conditional = n->node.binary.op == BIN_AND || n->node.binary.op == BIN_OR;
+
+    unsigned l, r;
+    bool left = Cse_Expression(cse, table, &n->node.binary.left, blk, stmt, record, killed, &l);
+    bool right = Cse_Expression(cse, table, &n->node.binary.right, blk, stmt, record && !conditional, killed, &r);
+
+    if (!left || !right)
+        return false;
+
+    *hash = Cse_Combine(n->node.binary.op, l, r);
+
+    for (unsigned i = 0; i < table->length; i++) {
+        CseEntry *e = Array_At(table, i);
+        if (e->hash == *hash && Cse_Equal(e->expr, n)) {
+            Cse_Replace(cse, table, slot, e);
+            *hash = Cse_Hash(*slot);
+            return true;
+        }
+    }
+
+    // Past a call, the computation can no longer be moved ahead of the statement
+    if (!record || *killed || !n->etype)
+        return true;
+
+    CseEntry *e = malloc(sizeof(CseEntry));
+    e->expr = n;
+    e->slot = slot;
+    e->block = blk;
+    e->stmt = stmt;
+    e->temp = NULL;
+    e->hash = *hash;
+
+    Array_Push(cse->entries, e);
+    Array_Push(table, e);
+
+    if (table->length > CSE_WINDOW)
+        Array_Remove(table, 0);
+
+    return true;
+}
+
+void Cse_Call(Cse *cse, Array *table, Node *call, Node *blk, Node *stmt, bool *killed) {
+    Array *args = call->node.fcall.exprs;
+    unsigned hash;
+
+    for (unsigned i = 0; i < args->length; i++)
+        Cse_Expression(cse, table, (Node **) &args->base[i], blk, stmt, true, killed, &hash);
+
+    Cse_KillAll(table);
+    *killed = true;
+}
+
+void Cse_Statement(Cse *cse, Array *table, Node *blk, Node *stmt) {
+    bool killed = false;
+    unsigned hash;
+
+    switch (stmt->type) {
+        case NODE_VARIABLE_DECLARATION:
+            Cse_Expression(cse, table, &stmt->node.var_decl.value, blk, stmt, true, &killed, &hash);
+            break;
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            Cse_Expression(cse, table, &stmt->node.var_assign.value, blk, stmt, true, &killed, &hash);
+            Cse_Expression(cse, table, &stmt->node.var_assign.index, blk, stmt, true, &killed, &hash);
+            Cse_Kill(table, stmt->node.var_assign.decl);
+            break;
+
+        case NODE_RETURN:
+            Cse_Expression(cse, table, &stmt->node.ret.expr, blk, stmt, true, &killed, &hash);
+            break;
+
+        // Nested regions see what is available here, but what they compute is not available after them
+        case NODE_BLOCK: {
+            Array *region = Cse_Copy(table);
+            Cse_Block(cse, region, stmt);
+            Array_Destroy(region);
+            Cse_KillConstruct(table, stmt);
+            break;
+        }
+
+        case NODE_CHECK:
+            Cse_Expression(cse, table, &stmt->node.check.expr, blk, stmt, true, &killed, &hash);
+
+            for (Node *chk = stmt; chk; chk = chk->node.check.sub) {
+                Array *region = Cse_Copy(table);
+                bool region_killed = false;
+
+                // Later conditions are evaluated conditionally
+                if (chk != stmt)
+                    Cse_Expression(cse, region, &chk->node.check.expr, blk, stmt, false, &region_killed, &hash);
+
+                Cse_Block(cse, region, chk->node.check.block);
+                Array_Destroy(region);
+            }
+
+            Cse_KillConstruct(table, stmt);
+            break;
+
+        // Only what the body leaves intact is available at the start of every iteration
+        case NODE_LOOP: {
+            Cse_Expression(cse, table, &stmt->node.loop.from, blk, stmt, true, &killed, &hash);
+            Cse_Expression(cse, table, &stmt->node.loop.to, blk, stmt, true, &killed, &hash);
+            Cse_KillConstruct(table, stmt->node.loop.block);
+
+            Array *region = Cse_Copy(table);
+            Cse_Block(cse, region, stmt->node.loop.block);
+            Array_Destroy(region);
+            break;
+        }
+
+        // Procedure bodies do not run where they are defined
+        case NODE_FUNCTION_DEFINITION: {
+            Array *body = Array_Create();
+            Cse_Block(cse, body, stmt->node.func_def.block);
+            Array_Destroy(body);
+            break;
+        }
+
+        // Expression statement, its own value is discarded
+        default:
+            if (stmt->type == NODE_BINARY_EXPRESSION) {
+                bool conditional = stmt->node.binary.op == BIN_AND || stmt->node.binary.op == BIN_OR;
+                Cse_Expression(cse, table, &stmt->node.binary.left, blk, stmt, true, &killed, &hash);
+                Cse_Expression(cse, table, &stmt->node.binary.right, blk, stmt, !conditional, &killed, &hash);
+            } else if (stmt->type == NODE_FUNCTION_CALL) {
+                Cse_Call(cse, table, stmt, blk, stmt, &killed);
+            }
+            break;
+    }
+}
+
+void Cse_Block(Cse *cse, Array *table, Node *blk) {
+    Array *nodes = blk->node.block.nodes;
+
+    unsigned i = 0;
+    while (i < nodes->length) {
+        Node *stmt = Array_At(nodes, i);
+
+        Cse_Statement(cse, table, blk, stmt);
+
+        // Temporaries may have been inserted ahead of the statement
+        while (Array_At(nodes, i) != stmt)
+            i++;
+
+        i++;
+    }
+}
+
+void Cse_Program(Cse *cse, Node *program) {
+    Array *table = Array_Create();
+    Cse_Block(cse, table, program->node.program.nodes);
+    Array_Destroy(table);
+}
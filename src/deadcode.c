@@ -0,0 +1,425 @@
+#include "include/deadcode.h"
+
+#include <stdlib.h>
+#include "include/memory.h"
+
+DeadCode *DeadCode_Create(bool checks) {
+    DeadCode *dc = malloc(sizeof(DeadCode));
+    dc->dead = Array_Create();
+    dc->bounds = Bounds_Create(checks);
+    dc->statements = 0;
+    dc->variables = 0;
+    dc->procedures = 0;
+    return dc;
+}
+
+void DeadCode_Destroy(DeadCode *dc) {
+    Array_DestroyCallBack(dc->dead, (void *) Node_DestroyRecurse);
+    Bounds_Destroy(dc->bounds);
+    free(dc);
+}
+
+// Whether control never continues past the statement
+bool DeadCode_Terminates(Node *n) {
+    if (!n)
+        return false;
+
+    if (n->type == NODE_RETURN)
+        return true;
+
+    if (n->type == NODE_BLOCK) {
+        for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+            if (DeadCode_Terminates(Array_At(n->node.block.nodes, i)))
+                return true;
+        return false;
+    }
+
+    // Every alternative has to terminate, including a final 'otherwise'
+    if (n->type == NODE_CHECK) {
+        for (Node *chk = n; chk; chk = chk->node.check.sub) {
+            if (!DeadCode_Terminates(chk->node.check.block))
+                return false;
+            if (!chk->node.check.sub)
+                return chk->node.check.expr == NULL;
+        }
+    }
+
+    return false;
+}
+
+void DeadCode_ResetReachable(Node *n) {
+    if (!n)
+        return;
+
+    switch (n->type) {
+        case NODE_FUNCTION_DEFINITION:
+            n->node.func_def.reachable = false;
+            DeadCode_ResetReachable(n->node.func_def.block);
+            break;
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                DeadCode_ResetReachable(Array_At(n->node.block.nodes, i));
+            break;
+        case NODE_CHECK:
+            DeadCode_ResetReachable(n->node.check.block);
+            DeadCode_ResetReachable(n->node.check.sub);
+            break;
+        case NODE_LOOP:
+            DeadCode_ResetReachable(n->node.loop.block);
+            break;
+        default:
+            break;
+    }
+}
+
+void DeadCode_MarkStatement(Node *);
+
+void DeadCode_MarkExpression(Node *n) {
+    if (!n)
+        return;
+
+    if (n->type == NODE_BINARY_EXPRESSION) {
+        DeadCode_MarkExpression(n->node.binary.left);
+        DeadCode_MarkExpression(n->node.binary.right);
+        return;
+    }
+
+    if (n->type == NODE_INDEX) {
+        DeadCode_MarkExpression(n->node.index.expr);
+        return;
+    }
+
+    if (n->type == NODE_REDUCE) {
+        DeadCode_MarkExpression(n->node.reduce.expr);
+        return;
+    }
+
+    if (n->type == NODE_FUNCTION_CALL) {
+        for (unsigned i = 0; i < n->node.fcall.exprs->length; i++)
+            DeadCode_MarkExpression(Array_At(n->node.fcall.exprs, i));
+
+        Node *def = n->node.fcall.def;
+
+        if (!def || def->node.func_def.reachable)
+            return;
+
+        def->node.func_def.reachable = true;
+        DeadCode_MarkStatement(def->node.func_def.block);
+    }
+}
+
+// Procedure bodies are only visited through their call sites
+void DeadCode_MarkStatement(Node *n) {
+    if (!n)
+        return;
+
+    switch (n->type) {
+        case NODE_VARIABLE_DECLARATION:
+            DeadCode_MarkExpression(n->node.var_decl.value);
+            break;
+        case NODE_VARIABLE_ASSIGNMENT:
+            DeadCode_MarkExpression(n->node.var_assign.value);
+            DeadCode_MarkExpression(n->node.var_assign.index);
+            break;
+        case NODE_RETURN:
+            DeadCode_MarkExpression(n->node.ret.expr);
+            break;
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                DeadCode_MarkStatement(Array_At(n->node.block.nodes, i));
+            break;
+        case NODE_CHECK:
+            DeadCode_MarkExpression(n->node.check.expr);
+            DeadCode_MarkStatement(n->node.check.block);
+            DeadCode_MarkStatement(n->node.check.sub);
+            break;
+        case NODE_LOOP:
+            DeadCode_MarkExpression(n->node.loop.from);
+            DeadCode_MarkExpression(n->node.loop.to);
+            DeadCode_MarkStatement(n->node.loop.block);
+            break;
+        case NODE_FUNCTION_DEFINITION:
+            break;
+        default:
+            DeadCode_MarkExpression(n);
+            break;
+    }
+}
+
+// The entry point is the sequence of top-level statements
+void DeadCode_MarkReachable(Node *program) {
+    Array *nodes = program->node.program.nodes->node.block.nodes;
+
+    DeadCode_ResetReachable(program->node.program.nodes);
+    DeadCode_MarkStatement(program->node.program.nodes);
+
+    // The procedures a module exports are entered from the modules importing it
+    for (unsigned i = 0; i < nodes->length; i++) {
+        Node *n = Array_At(nodes, i);
+
+        if (n->type != NODE_FUNCTION_DEFINITION || !n->node.func_def.module || n->node.func_def.external ||
+            n->node.func_def.reachable)
+            continue;
+
+        n->node.func_def.reachable = true;
+        DeadCode_MarkStatement(n->node.func_def.block);
+    }
+}
+
+// Detach a statement from the program. It is destroyed along with the pass.
+void DeadCode_Remove(DeadCode *dc, Node *n) {
+    if (n->type == NODE_VARIABLE_DECLARATION || n->type == NODE_FUNCTION_DEFINITION)
+        Block_Undeclare(n->super, n);
+
+    Node_Unreference(n);
+    Array_Push(dc->dead, n);
+}
+
+// Whether the index may be out of the bounds of the array, as far as the enclosing loops tell
+bool DeadCode_OutOfBounds(DeadCode *dc, Node *decl, Node *index) {
+    BoundsRange r;
+    long long length = decl->node.var_decl.type->content.array.length;
+
+    return !Bounds_Range(dc->bounds, index, &r) || r.lo < 0 || r.hi >= length;
+}
+
+// Whether a statement stores into the array at an index that has yet to be checked
+bool DeadCode_StoresChecked(Node *n, Node *decl) {
+    if (!n)
+        return false;
+
+    switch (n->type) {
+        case NODE_VARIABLE_ASSIGNMENT:
+            return n->node.var_assign.decl == decl && n->node.var_assign.checked;
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                if (DeadCode_StoresChecked(Array_At(n->node.block.nodes, i), decl))
+                    return true;
+            return false;
+        case NODE_CHECK:
+            for (Node *chk = n; chk; chk = chk->node.check.sub)
+                if (DeadCode_StoresChecked(chk->node.check.block, decl))
+                    return true;
+            return false;
+        case NODE_LOOP:
+            return DeadCode_StoresChecked(n->node.loop.block, decl);
+        case NODE_FUNCTION_DEFINITION:
+            return DeadCode_StoresChecked(n->node.func_def.block, decl);
+        default:
+            return false;
+    }
+}
+
+// Whether evaluating the expression may fail a bounds check, which has to happen whether or not
+// its value is used
+bool DeadCode_MayTrap(DeadCode *dc, Node *n) {
+    if (!n || !dc->bounds->enabled)
+        return false;
+
+    switch (n->type) {
+        case NODE_BINARY_EXPRESSION:
+            return DeadCode_MayTrap(dc, n->node.binary.left) || DeadCode_MayTrap(dc, n->node.binary.right);
+        case NODE_INDEX:
+            if (DeadCode_MayTrap(dc, n->node.index.expr))
+                return true;
+            return n->node.index.checked &&
+                   DeadCode_OutOfBounds(dc, n->node.index.array->node.var_ref.decl, n->node.index.expr);
+        case NODE_REDUCE:
+            return DeadCode_MayTrap(dc, n->node.reduce.expr);
+        case NODE_FUNCTION_CALL:
+            for (unsigned i = 0; i < n->node.fcall.exprs->length; i++)
+                if (DeadCode_MayTrap(dc, Array_At(n->node.fcall.exprs, i)))
+                    return true;
+            return false;
+        default:
+            return false;
+    }
+}
+
+// Whether the expression has to be evaluated even if its value is not used
+bool DeadCode_Needed(DeadCode *dc, Node *n) {
+    return Node_HasSideEffects(n) || DeadCode_MayTrap(dc, n);
+}
+
+// Remove a store that is never read. The stored value is kept as a statement
+// if evaluating it has side effects or may trap.
+Node *DeadCode_Discard(DeadCode *dc, Node *n, Node **value) {
+    Node *keep = NULL;
+
+    if (DeadCode_Needed(dc, *value)) {
+        keep = *value;
+        *value = NULL;
+    }
+
+    DeadCode_Remove(dc, n);
+    return keep;
+}
+
+// Whether the store has to check its index, which may be out of bounds
+bool DeadCode_Checks(DeadCode *dc, Node *n) {
+    return n->node.var_assign.index && n->node.var_assign.checked && dc->bounds->enabled &&
+           DeadCode_OutOfBounds(dc, n->node.var_assign.decl, n->node.var_assign.index);
+}
+
+// An element store also keeps the side effects of its index, which is evaluated last. One that has
+// to check its index only loses its value, and is left to check the index without storing anything.
+Node *DeadCode_DiscardAssignment(DeadCode *dc, Node *n) {
+    Node *index = n->node.var_assign.index;
+
+    if (DeadCode_Checks(dc, n)) {
+        Node *value = n->node.var_assign.value;
+        n->node.var_assign.value = NULL;
+
+        if (!DeadCode_Needed(dc, value)) {
+            DeadCode_Remove(dc, value);
+            return n;
+        }
+
+        Array *keep = Array_Create();
+        Array_Push(keep, value);
+        Array_Push(keep, n);
+
+        return Node_CreateBlock(keep, n->super);
+    }
+
+    if (!DeadCode_Needed(dc, index))
+        return DeadCode_Discard(dc, n, &n->node.var_assign.value);
+
+    n->node.var_assign.index = NULL;
+
+    Array *keep = Array_Create();
+    Node *value = DeadCode_Discard(dc, n, &n->node.var_assign.value);
+
+    if (value)
+        Array_Push(keep, value);
+    Array_Push(keep, index);
+
+    return Node_CreateBlock(keep, n->super);
+}
+
+// Returns the statement to keep in place of the given one, or NULL
+Node *DeadCode_Statement(DeadCode *dc, Node *n, bool *changed) {
+    switch (n->type) {
+        // The body runs whenever it is called, outside of the loops around the definition
+        case NODE_FUNCTION_DEFINITION: {
+            if (!n->node.func_def.reachable) {
+                dc->procedures += !n->node.func_def.external;
+                *changed = true;
+                DeadCode_Remove(dc, n);
+                return NULL;
+            }
+
+            Array *loops = dc->bounds->loops;
+            dc->bounds->loops = Array_Create();
+
+            if (DeadCode_Block(dc, n->node.func_def.block))
+                *changed = true;
+
+            Array_Destroy(dc->bounds->loops);
+            dc->bounds->loops = loops;
+            return n;
+        }
+
+        case NODE_VARIABLE_DECLARATION:
+            if (n->node.var_decl.refs > 0)
+                return n;
+            // The array is left for the stores that are kept for their bounds checks
+            if (dc->bounds->enabled && n->node.var_decl.type->type == TYPE_ARRAY &&
+                DeadCode_StoresChecked(n->super, n))
+                return n;
+            dc->variables++;
+            *changed = true;
+            return DeadCode_Discard(dc, n, &n->node.var_decl.value);
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            if (!n->node.var_assign.decl || n->node.var_assign.decl->node.var_decl.refs > 0)
+                return n;
+            if (!n->node.var_assign.value && DeadCode_Checks(dc, n))
+                return n;
+            dc->statements++;
+            *changed = true;
+            return DeadCode_DiscardAssignment(dc, n);
+
+        case NODE_BLOCK:
+            if (DeadCode_Block(dc, n))
+                *changed = true;
+            return n;
+
+        case NODE_CHECK:
+            for (Node *chk = n; chk; chk = chk->node.check.sub)
+                if (DeadCode_Block(dc, chk->node.check.block))
+                    *changed = true;
+            return n;
+
+        // A loop whose body has been emptied only has to evaluate its bounds
+        case NODE_LOOP:
+            Array_Push(dc->bounds->loops, n);
+            if (DeadCode_Block(dc, n->node.loop.block))
+                *changed = true;
+            Array_Remove(dc->bounds->loops, dc->bounds->loops->length - 1);
+
+            if (n->node.loop.block->node.block.nodes->length > 0 || DeadCode_Needed(dc, n->node.loop.from) ||
+                DeadCode_Needed(dc, n->node.loop.to))
+                return n;
+            dc->statements++;
+            *changed = true;
+            DeadCode_Remove(dc, n);
+            return NULL;
+
+        case NODE_RETURN:
+        case NODE_COMPLEX:
+            return n;
+
+        default:
+            // Expression statement
+            if (DeadCode_Needed(dc, n))
+                return n;
+            dc->statements++;
+            *changed = true;
+            DeadCode_Remove(dc, n);
+            return NULL;
+    }
+}
+
+// Returns whether anything has been removed
+bool DeadCode_Block(DeadCode *dc, Node *blk) {
+    Array *nodes = blk->node.block.nodes;
+    bool changed = false;
+
+    unsigned i = 0;
+    while (i < nodes->length) {
+        Node *n = DeadCode_Statement(dc, Array_At(nodes, i), &changed);
+
+        if (!n) {
+            Array_Remove(nodes, i);
+            continue;
+        }
+
+        Array_Set(nodes, i, n);
+        i++;
+
+        if (!DeadCode_Terminates(n))
+            continue;
+
+        // Everything past a terminating statement is unreachable
+        while (i < nodes->length) {
+            dc->statements++;
+            changed = true;
+            DeadCode_Remove(dc, Array_At(nodes, i));
+            Array_Remove(nodes, i);
+        }
+    }
+
+    return changed;
+}
+
+// Removing code may leave further declarations and procedures unused,
+// so the program is swept until nothing changes.
+void DeadCode_Program(DeadCode *dc, Node *program) {
+    bool changed = true;
+
+    while (changed) {
+        DeadCode_MarkReachable(program);
+        changed = DeadCode_Block(dc, program->node.program.nodes);
+    }
+}
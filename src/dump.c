@@ -0,0 +1,401 @@
+#include "include/dump.h"
+#include "include/param.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/memory.h"
+
+void Dump_Flush(Dump *d) {
+    fwrite(d->buffer, 1, d->length, d->out);
+    d->length = 0;
+}
+
+void Dump_Write(Dump *d, const char *str, size_t n) {
+    while (n > 0) {
+        if (d->length == DUMP_BUFFER)
+            Dump_Flush(d);
+
+        size_t k = DUMP_BUFFER - d->length < n ? DUMP_BUFFER - d->length : n;
+        memcpy(d->buffer + d->length, str, k);
+        d->length += k;
+        str += k;
+        n -= k;
+    }
+}
+
+void Dump_String(Dump *d, const char *str) {
+    Dump_Write(d, str, strlen(str));
+}
+
+void Dump_Indent(Dump *d) {
+    static const char spaces[] = "                                ";
+
+    for (unsigned n = 2 * d->depth; n > 0;) {
+        unsigned k = n < sizeof(spaces) - 1 ? n : sizeof(spaces) - 1;
+        Dump_Write(d, spaces, k);
+        n -= k;
+    }
+}
+
+// Escaped the same for JSON and S-expressions
+void Dump_Quoted(Dump *d, const char *str) {
+    char escape[8];
+
+    Dump_Write(d, "\"", 1);
+
+    for (const char *c = str; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            escape[0] = '\\';
+            escape[1] = *c;
+            Dump_Write(d, escape, 2);
+        } else if ((unsigned char) *c < 0x20) {
+            snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char) *c);
+            Dump_Write(d, escape, 6);
+        } else {
+            Dump_Write(d, c, 1);
+        }
+    }
+
+    Dump_Write(d, "\"", 1);
+}
+
+void Dump_Separate(Dump *d) {
+    if (d->separate && d->format != DUMP_TEXT)
+        Dump_Write(d, d->format == DUMP_JSON ? "," : " ", 1);
+}
+
+// The name of a field, the value follows
+void Dump_Key(Dump *d, const char *key) {
+    Dump_Separate(d);
+
+    if (d->format == DUMP_TEXT) {
+        Dump_Indent(d);
+        Dump_String(d, key);
+    } else if (d->format == DUMP_JSON) {
+        Dump_Quoted(d, key);
+        Dump_Write(d, ":", 1);
+    } else {
+        Dump_Write(d, "(", 1);
+        Dump_String(d, key);
+    }
+}
+
+// Starts a node of the kind, its fields follow up to Dump_End
+void Dump_Begin(Dump *d, const char *kind) {
+    Dump_Separate(d);
+
+    if (d->format == DUMP_TEXT) {
+        Dump_Indent(d);
+        Dump_String(d, kind);
+        Dump_Write(d, "\n", 1);
+        d->depth++;
+    } else if (d->format == DUMP_JSON) {
+        Dump_String(d, "{\"kind\":");
+        Dump_Quoted(d, kind);
+    } else {
+        Dump_Write(d, "(", 1);
+        Dump_String(d, kind);
+    }
+
+    d->separate = true;
+}
+
+void Dump_End(Dump *d) {
+    if (d->format == DUMP_TEXT)
+        d->depth--;
+    else
+        Dump_Write(d, d->format == DUMP_JSON ? "}" : ")", 1);
+
+    d->separate = true;
+}
+
+void Dump_Text(Dump *d, const char *key, const char *value) {
+    Dump_Key(d, key);
+
+    if (d->format == DUMP_TEXT) {
+        Dump_String(d, ": ");
+        Dump_String(d, value);
+        Dump_Write(d, "\n", 1);
+    } else if (d->format == DUMP_JSON) {
+        Dump_Quoted(d, value);
+    } else {
+        Dump_Write(d, " ", 1);
+        Dump_Quoted(d, value);
+        Dump_Write(d, ")", 1);
+    }
+
+    d->separate = true;
+}
+
+// A number, written the same in every format
+void Dump_Number(Dump *d, const char *key, const char *format, ...) {
+    char number[64];
+    va_list args;
+
+    va_start(args, format);
+    vsnprintf(number, sizeof(number), format, args);
+    va_end(args);
+
+    Dump_Key(d, key);
+    Dump_String(d, d->format == DUMP_TEXT ? ": " : d->format == DUMP_SEXPR ? " " : "");
+    Dump_String(d, number);
+    Dump_String(d, d->format == DUMP_TEXT ? "\n" : d->format == DUMP_SEXPR ? ")" : "");
+
+    d->separate = true;
+}
+
+// Flags are only written when they are set
+void Dump_Flag(Dump *d, const char *key, bool set) {
+    if (!set)
+        return;
+
+    Dump_Key(d, key);
+    Dump_String(d, d->format == DUMP_TEXT ? "\n" : d->format == DUMP_JSON ? "true" : ")");
+
+    d->separate = true;
+}
+
+// An element of a list of names
+void Dump_Value(Dump *d, const char *value) {
+    Dump_Separate(d);
+
+    if (d->format == DUMP_TEXT) {
+        Dump_Indent(d);
+        Dump_String(d, value);
+        Dump_Write(d, "\n", 1);
+    } else {
+        Dump_Quoted(d, value);
+    }
+
+    d->separate = true;
+}
+
+// A field holding a node, or a list of them, up to Dump_Close
+void Dump_Open(Dump *d, const char *key, bool list) {
+    Dump_Key(d, key);
+
+    if (d->format == DUMP_TEXT) {
+        Dump_Write(d, "\n", 1);
+        d->depth++;
+    } else if (d->format == DUMP_JSON && list) {
+        Dump_Write(d, "[", 1);
+    }
+
+    d->separate = d->format == DUMP_SEXPR;
+}
+
+void Dump_Close(Dump *d, bool list) {
+    if (d->format == DUMP_TEXT)
+        d->depth--;
+    else if (d->format == DUMP_SEXPR)
+        Dump_Write(d, ")", 1);
+    else if (list)
+        Dump_Write(d, "]", 1);
+
+    d->separate = true;
+}
+
+void Dump_Node(Dump *d, Node *n);
+
+void Dump_Child(Dump *d, const char *key, Node *n) {
+    Dump_Open(d, key, false);
+    Dump_Node(d, n);
+    Dump_Close(d, false);
+}
+
+void Dump_Children(Dump *d, const char *key, Array *nodes) {
+    Dump_Open(d, key, true);
+
+    for (unsigned i = 0; nodes && i < nodes->length; i++)
+        Dump_Node(d, Array_At(nodes, i));
+
+    Dump_Close(d, true);
+}
+
+void Dump_Node(Dump *d, Node *n) {
+    if (!n) {
+        Dump_Separate(d);
+
+        if (d->format == DUMP_TEXT) {
+            Dump_Indent(d);
+            Dump_String(d, "(none)\n");
+        } else {
+            Dump_String(d, d->format == DUMP_JSON ? "null" : "nil");
+        }
+
+        d->separate = true;
+        return;
+    }
+
+    switch (n->type) {
+        case NODE_PROGRAM:
+            Dump_Begin(d, "Program");
+
+            if (n->node.program.imports && n->node.program.imports->length > 0) {
+                Dump_Open(d, "imports", true);
+                for (unsigned i = 0; i < n->node.program.imports->length; i++)
+                    Dump_Value(d, Array_At(n->node.program.imports, i));
+                Dump_Close(d, true);
+            }
+
+            Dump_Child(d, "block", n->node.program.nodes);
+            break;
+
+        case NODE_STRING_LITERAL:
+            Dump_Begin(d, "StringLiteral");
+            Dump_Text(d, "value", n->node.str_lit.str);
+            break;
+
+        case NODE_INTEGER_LITERAL:
+            Dump_Begin(d, "IntegerLiteral");
+            Dump_Number(d, "value", "%lld", n->node.int_lit.n);
+            break;
+
+        case NODE_FLOAT_LITERAL:
+            Dump_Begin(d, "FloatLiteral");
+            Dump_Number(d, "value", "%.17g", n->node.float_lit.f);
+            break;
+
+        case NODE_VARIABLE_DECLARATION:
+            Dump_Begin(d, "VariableDeclaration");
+            Dump_Text(d, "mutable", ModificationQualifier_String(n->node.var_decl.mutable));
+            Dump_Text(d, "id", n->node.var_decl.id->value);
+            Dump_Text(d, "type", Type_Identifier(n->node.var_decl.type));
+            Dump_Child(d, "value", n->node.var_decl.value);
+            break;
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            Dump_Begin(d, "VariableAssignment");
+            Dump_Text(d, "id", n->node.var_assign.id->value);
+            if (n->node.var_assign.index)
+                Dump_Child(d, "index", n->node.var_assign.index);
+            Dump_Child(d, "value", n->node.var_assign.value);
+            break;
+
+        case NODE_BINARY_EXPRESSION:
+            Dump_Begin(d, "BinaryExpression");
+            Dump_Text(d, "op", BinaryType_ToString(n->node.binary.op));
+            Dump_Child(d, "left", n->node.binary.left);
+            Dump_Child(d, "right", n->node.binary.right);
+            break;
+
+        case NODE_FUNCTION_CALL:
+            Dump_Begin(d, "FunctionCall");
+            Dump_Text(d, "id", n->node.fcall.id->value);
+            Dump_Children(d, "args", n->node.fcall.exprs);
+            break;
+
+        case NODE_VARIABLE_REFERENCE:
+            Dump_Begin(d, "VariableReference");
+            Dump_Text(d, "id", n->node.var_ref.id->value);
+            if (n->node.var_ref.next)
+                Dump_Child(d, "next", n->node.var_ref.next);
+            break;
+
+        case NODE_BLOCK:
+            Dump_Begin(d, "Block");
+            Dump_Children(d, "nodes", n->node.block.nodes);
+            break;
+
+        case NODE_FUNCTION_DEFINITION:
+            Dump_Begin(d, "FunctionDefinition");
+            Dump_Text(d, "id", n->node.func_def.id->value);
+            Dump_Text(d, "type", Type_Identifier(n->node.func_def.type));
+            if (n->node.func_def.external)
+                Dump_Text(d, "module", n->node.func_def.module);
+
+            Dump_Open(d, "params", true);
+            for (unsigned i = 0; i < n->node.func_def.params->length; i++) {
+                FunctionParameter *param = Array_At(n->node.func_def.params, i);
+                Dump_Begin(d, "Parameter");
+                Dump_Text(d, "id", param->id->value);
+                Dump_Text(d, "type", Type_Identifier(param->type));
+                Dump_End(d);
+            }
+            Dump_Close(d, true);
+
+            Dump_Child(d, "block", n->node.func_def.block);
+            break;
+
+        case NODE_RETURN:
+            Dump_Begin(d, n->node.ret.jump ? "Jump" : "Return");
+            Dump_Child(d, "value", n->node.ret.expr);
+            break;
+
+        case NODE_CHECK:
+            Dump_Begin(d, "Check");
+            Dump_Child(d, "condition", n->node.check.expr);
+            Dump_Child(d, "block", n->node.check.block);
+            if (n->node.check.sub)
+                Dump_Child(d, "otherwise", n->node.check.sub);
+            break;
+
+        case NODE_SIZE:
+            Dump_Begin(d, "Size");
+            Dump_Text(d, "type", Type_Identifier(n->node.size.type));
+            break;
+
+        case NODE_LOOP:
+            Dump_Begin(d, "Loop");
+            Dump_Text(d, "counter", n->node.loop.var->node.var_decl.id->value);
+            Dump_Text(d, "type", Type_Identifier(n->node.loop.var->node.var_decl.type));
+            Dump_Child(d, "from", n->node.loop.from);
+            Dump_Child(d, "to", n->node.loop.to);
+            Dump_Child(d, "block", n->node.loop.block);
+            break;
+
+        case NODE_INDEX:
+            Dump_Begin(d, "Index");
+            Dump_Text(d, "array", n->node.index.array->node.var_ref.id->value);
+            Dump_Child(d, "index", n->node.index.expr);
+            break;
+
+        case NODE_REDUCE:
+            Dump_Begin(d, "Reduce");
+            Dump_Child(d, "value", n->node.reduce.expr);
+            break;
+
+        case NODE_COMPLEX: {
+            ComplexType *complx = n->node.complx.type->content.complx.ref;
+            Dump_Begin(d, "Complex");
+            Dump_Text(d, "id", complx->id->value);
+            Dump_Flag(d, "ordered", complx->ordered);
+
+            Dump_Open(d, "fields", true);
+            for (unsigned i = 0; i < complx->fields->length; i++) {
+                ComplexField *field = Array_At(complx->fields, i);
+                Dump_Begin(d, "Field");
+                Dump_Text(d, "id", field->id->value);
+                Dump_Text(d, "type", Type_Identifier(field->type));
+                Dump_End(d);
+            }
+            Dump_Close(d, true);
+            break;
+        }
+
+        default:
+            Dump_Begin(d, NodeType_ToString(n->type));
+            break;
+    }
+
+    Dump_End(d);
+}
+
+// Prints the tree in the format, through a single buffer
+void Dump_Program(Node *program, unsigned format, FILE *out) {
+    Dump *d = malloc(sizeof(Dump));
+    d->out = out;
+    d->format = format;
+    d->depth = 0;
+    d->separate = false;
+    d->length = 0;
+
+    Dump_Node(d, program);
+
+    if (format != DUMP_TEXT)
+        Dump_Write(d, "\n", 1);
+
+    Dump_Flush(d);
+    free(d);
+}
@@ -0,0 +1,365 @@
+#include "include/fold.h"
+#include "include/pure.h"
+#include "include/ir.h"
+
+#include <stdlib.h>
+#include <limits.h>
+
+// The truth value of a literal condition. Fails for anything that is not a literal.
+bool Fold_Truth(Node *n, bool *truth) {
+    if (!n)
+        return false;
+
+    if (n->type == NODE_INTEGER_LITERAL) {
+        *truth = n->node.int_lit.n != 0;
+        return true;
+    }
+
+    if (n->type == NODE_FLOAT_LITERAL) {
+        *truth = n->node.float_lit.f != 0.0;
+        return true;
+    }
+
+    return false;
+}
+
+// In bytes, that of a qword for values of no primitive type
+unsigned Fold_Width(Type *type) {
+    unsigned width = Ir_Width(type);
+    return width ? width : 8;
+}
+
+// Integers are held the way registers of their width hold them at run time. Results that overflow
+// the width are left for the runtime to wrap around.
+Node *Fold_IntegerBinary(BinaryType op, long long a, long long b, unsigned width) {
+    long long r;
+
+    switch (op) {
+        case BIN_ADD:
+            if (__builtin_add_overflow(a, b, &r) || Ir_Truncate(r, width) != r)
+                return NULL;
+            break;
+        case BIN_SUB:
+            if (__builtin_sub_overflow(a, b, &r) || Ir_Truncate(r, width) != r)
+                return NULL;
+            break;
+        case BIN_MUL:
+            if (__builtin_mul_overflow(a, b, &r) || Ir_Truncate(r, width) != r)
+                return NULL;
+            break;
+        case BIN_DIV:
+            // Left for the runtime to deal with
+            if (b == 0 || (a == LLONG_MIN && b == -1))
+                return NULL;
+            r = a / b;
+            if (Ir_Truncate(r, width) != r)
+                return NULL;
+            break;
+        case BIN_OR:
+            r = a || b;
+            break;
+        case BIN_AND:
+            r = a && b;
+            break;
+        case BIN_EQUAL:
+            r = a == b;
+            break;
+        case BIN_LGREATER:
+            r = a > b;
+            break;
+        case BIN_RGREATER:
+            r = a < b;
+            break;
+        default:
+            return NULL;
+    }
+
+    return Node_CreateIntegerLiteral(r);
+}
+
+Node *Fold_FloatBinary(BinaryType op, double a, double b) {
+    switch (op) {
+        case BIN_ADD:
+            return Node_CreateFloatLiteral(a + b);
+        case BIN_SUB:
+            return Node_CreateFloatLiteral(a - b);
+        case BIN_MUL:
+            return Node_CreateFloatLiteral(a * b);
+        case BIN_DIV:
+            if (b == 0.0)
+                return NULL;
+            return Node_CreateFloatLiteral(a / b);
+        case BIN_OR:
+            return Node_CreateIntegerLiteral(a != 0.0 || b != 0.0);
+        case BIN_AND:
+            return Node_CreateIntegerLiteral(a != 0.0 && b != 0.0);
+        case BIN_EQUAL:
+            return Node_CreateIntegerLiteral(a == b);
+        case BIN_LGREATER:
+            return Node_CreateIntegerLiteral(a > b);
+        case BIN_RGREATER:
+            return Node_CreateIntegerLiteral(a < b);
+        default:
+            return NULL;
+    }
+}
+
+// Evaluate a binary expression over two literals. Returns a new literal or NULL.
+Node *Fold_Binary(Node *expr) {
+    Node *left = expr->node.binary.left;
+    Node *right = expr->node.binary.right;
+
+    if (!Node_IsLiteral(left) || !Node_IsLiteral(right))
+        return NULL;
+
+    Node *r;
+
+    if (left->type == NODE_INTEGER_LITERAL && right->type == NODE_INTEGER_LITERAL) {
+        long long a = Ir_Truncate(left->node.int_lit.n, Fold_Width(left->etype));
+        long long b = Ir_Truncate(right->node.int_lit.n, Fold_Width(right->etype));
+        r = Fold_IntegerBinary(expr->node.binary.op, a, b, Fold_Width(expr->etype));
+    } else {
+        double a = (left->type == NODE_FLOAT_LITERAL) ? left->node.float_lit.f : left->node.int_lit.n;
+        double b = (right->type == NODE_FLOAT_LITERAL) ? right->node.float_lit.f : right->node.int_lit.n;
+        r = Fold_FloatBinary(expr->node.binary.op, a, b);
+    }
+
+    if (r) {
+        r->super = expr->super;
+        r->etype = expr->etype;
+    }
+
+    return r;
+}
+
+// Evaluate a call to a pure procedure with literal arguments. Returns a new literal or NULL.
+Node *Fold_Call(FoldStatistics *stats, Node *call) {
+    Node *def = call->node.fcall.def;
+    Array *args = call->node.fcall.exprs;
+
+    if (!def || !def->node.func_def.pure)
+        return NULL;
+
+    for (unsigned i = 0; i < args->length; i++)
+        if (((Node *) Array_At(args, i))->type != NODE_INTEGER_LITERAL)
+            return NULL;
+
+    long long value;
+    PureStatus status = Pure_Evaluate(call, &value);
+
+    if (status == PURE_LIMIT)
+        stats->abandoned++;
+
+    if (status != PURE_EVALUATED)
+        return NULL;
+
+    Node *lit = Node_CreateIntegerLiteral(value);
+    lit->super = call->super;
+    lit->etype = call->etype;
+
+    stats->evaluated++;
+    return lit;
+}
+
+// Returns the folded expression, destroying the original if it was replaced
+Node *Fold_Expression(FoldStatistics *stats, Node *expr) {
+    if (!expr)
+        return NULL;
+
+    if (expr->type == NODE_BINARY_EXPRESSION) {
+        expr->node.binary.left = Fold_Expression(stats, expr->node.binary.left);
+        expr->node.binary.right = Fold_Expression(stats, expr->node.binary.right);
+
+        Node *folded = Fold_Binary(expr);
+
+        if (!folded)
+            return expr;
+
+        stats->folded++;
+        Node_DestroyRecurse(expr);
+        return folded;
+    }
+
+    // Constants are propagated once their initializer has been folded down to a literal
+    if (expr->type == NODE_VARIABLE_REFERENCE) {
+        Node *decl = expr->node.var_ref.decl;
+
+        if (!decl || expr->node.var_ref.next)
+            return expr;
+
+        if (decl->node.var_decl.mutable != MQ_CONST || !Node_IsLiteral(decl->node.var_decl.value))
+            return expr;
+
+        // A vector holds the literal in every lane, it cannot stand in for the vector
+        if (decl->node.var_decl.type->type == TYPE_VECTOR)
+            return expr;
+
+        Node *lit = Node_DuplicateLiteral(decl->node.var_decl.value, expr->super);
+        lit->etype = expr->etype;
+
+        if (lit->type == NODE_INTEGER_LITERAL)
+            lit->node.int_lit.n = Ir_Truncate(lit->node.int_lit.n, Fold_Width(decl->node.var_decl.type));
+
+        stats->propagated++;
+        Node_Unreference(expr);
+        Node_DestroyRecurse(expr);
+        return lit;
+    }
+
+    if (expr->type == NODE_FUNCTION_CALL) {
+        Array *args = expr->node.fcall.exprs;
+        for (unsigned i = 0; i < args->length; i++)
+            Array_Set(args, i, Fold_Expression(stats, Array_At(args, i)));
+
+        Node *folded = Fold_Call(stats, expr);
+
+        if (!folded)
+            return expr;
+
+        Node_Unreference(expr);
+        Node_DestroyRecurse(expr);
+        return folded;
+    }
+
+    if (expr->type == NODE_INDEX) {
+        expr->node.index.expr = Fold_Expression(stats, expr->node.index.expr);
+        return expr;
+    }
+
+    if (expr->type == NODE_REDUCE) {
+        expr->node.reduce.expr = Fold_Expression(stats, expr->node.reduce.expr);
+        return expr;
+    }
+
+    // Types are laid out by the semantic analysis
+    if (expr->type == NODE_SIZE) {
+        Node *lit = Node_CreateIntegerLiteral((int) Type_Size(expr->node.size.type));
+        lit->super = expr->super;
+        lit->etype = expr->etype;
+
+        stats->folded++;
+        Node_DestroyRecurse(expr);
+        return lit;
+    }
+
+    return expr;
+}
+
+// Fold a check chain. Alternatives whose condition is always false are dropped,
+// the first one that always holds becomes the final 'otherwise'.
+// Returns the new head of the chain, or NULL if no alternative remains.
+Node *Fold_Check(FoldStatistics *stats, Node *chk) {
+    if (!chk)
+        return NULL;
+
+    chk->node.check.expr = Fold_Expression(stats, chk->node.check.expr);
+    Fold_Block(stats, chk->node.check.block);
+    chk->node.check.sub = Fold_Check(stats, chk->node.check.sub);
+
+    bool truth;
+
+    if (!Fold_Truth(chk->node.check.expr, &truth))
+        return chk;
+
+    stats->pruned++;
+
+    if (truth) {
+        Node_Unreference(chk->node.check.sub);
+        Node_DestroyRecurse(chk->node.check.expr);
+        Node_DestroyRecurse(chk->node.check.sub);
+        chk->node.check.expr = NULL;
+        chk->node.check.sub = NULL;
+        return chk;
+    }
+
+    Node *sub = chk->node.check.sub;
+    chk->node.check.sub = NULL;
+    Node_Unreference(chk);
+    Node_DestroyRecurse(chk);
+
+    return sub;
+}
+
+// Returns the folded statement, or NULL if it has been eliminated
+Node *Fold_Statement(FoldStatistics *stats, Node *n) {
+    switch (n->type) {
+        case NODE_VARIABLE_DECLARATION:
+            n->node.var_decl.value = Fold_Expression(stats, n->node.var_decl.value);
+            return n;
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            n->node.var_assign.value = Fold_Expression(stats, n->node.var_assign.value);
+            n->node.var_assign.index = Fold_Expression(stats, n->node.var_assign.index);
+            return n;
+
+        case NODE_RETURN:
+            n->node.ret.expr = Fold_Expression(stats, n->node.ret.expr);
+            return n;
+
+        case NODE_BLOCK:
+            Fold_Block(stats, n);
+            return n;
+
+        case NODE_FUNCTION_DEFINITION:
+            Fold_Block(stats, n->node.func_def.block);
+            return n;
+
+        case NODE_CHECK: {
+            Node *chk = Fold_Check(stats, n);
+
+            // A check that always holds is replaced by its block
+            if (chk && !chk->node.check.expr) {
+                Node *blk = chk->node.check.block;
+                chk->node.check.block = NULL;
+                Node_DestroyRecurse(chk);
+                return blk;
+            }
+
+            return chk;
+        }
+
+        case NODE_LOOP: {
+            n->node.loop.from = Fold_Expression(stats, n->node.loop.from);
+            n->node.loop.to = Fold_Expression(stats, n->node.loop.to);
+            Fold_Block(stats, n->node.loop.block);
+
+            Node *from = n->node.loop.from;
+            Node *to = n->node.loop.to;
+
+            // A loop that never runs
+            if (from->type == NODE_INTEGER_LITERAL && to->type == NODE_INTEGER_LITERAL &&
+                to->node.int_lit.n <= from->node.int_lit.n) {
+                stats->pruned++;
+                Node_Unreference(n);
+                Node_DestroyRecurse(n);
+                return NULL;
+            }
+
+            return n;
+        }
+
+        default:
+            return Fold_Expression(stats, n);
+    }
+}
+
+void Fold_Block(FoldStatistics *stats, Node *blk) {
+    Array *nodes = blk->node.block.nodes;
+
+    unsigned i = 0;
+    while (i < nodes->length) {
+        Node *n = Fold_Statement(stats, Array_At(nodes, i));
+
+        if (!n) {
+            Array_Remove(nodes, i);
+            continue;
+        }
+
+        Array_Set(nodes, i, n);
+        i++;
+    }
+}
+
+void Fold_Program(FoldStatistics *stats, Node *program) {
+    Fold_Block(stats, program->node.program.nodes);
+}
@@ -1,15 +1,19 @@
-#ifndef LFLOW_ARR_H
-#define LFLOW_ARR_H
-
-typedef struct {
-    void **base;
-    unsigned int length;
-} Array;
-
-Array *Array_Create();
-void Array_Destroy(Array *);
-void Array_DestroyCallBack(Array *, void (*)(void *));
-void Array_Push(Array *, void *);
-void *Array_At(Array *, unsigned);
-
+#ifndef LFLOW_ARR_H
+#define LFLOW_ARR_H
+
+typedef struct {
+    void **base;
+    unsigned int length;
+    unsigned int capacity;  // Allocated elements, doubled when full
+} Array;
+
+Array *Array_Create();
+void Array_Destroy(Array *);
+void Array_DestroyCallBack(Array *, void (*)(void *));
+void Array_Push(Array *, void *);
+void *Array_At(Array *, unsigned);
+void Array_Set(Array *, unsigned, void *);
+void Array_Remove(Array *, unsigned);
+void Array_Insert(Array *, unsigned, void *);
+
 #endif
\ No newline at end of file
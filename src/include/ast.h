@@ -1,204 +1,284 @@
-#ifndef LFLOW_AST_H
-#define LFLOW_AST_H
-
-#include "arr.h"
-#include "bool.h"
-#include "token.h"
-#include "type.h"
-
-typedef enum {
-    NODE_PROGRAM,
-    NODE_STRING_LITERAL,
-    NODE_INTEGER_LITERAL,
-    NODE_FLOAT_LITERAL,
-    NODE_VARIABLE_DECLARATION,
-    NODE_VARIABLE_ASSIGNMENT,
-    NODE_BINARY_EXPRESSION,
-    NODE_FUNCTION_CALL,
-    NODE_VARIABLE_REFERENCE,
-    NODE_BLOCK,
-    NODE_FUNCTION_DEFINITION,
-    NODE_RETURN,
-    NODE_CHECK,
-    NODE_SIZE
-} NodeType;
-
-const char *NodeType_ToString(NodeType);
-
-typedef enum {
-
-    // Arithmetics
-    BIN_ADD,
-    BIN_SUB,
-    BIN_MUL,
-    BIN_DIV,
-
-    // Logical boolean oeprations
-    BIN_OR,
-    BIN_AND,
-    BIN_EQUAL,
-    BIN_LGREATER,
-    BIN_RGREATER,
-
-    BIN_UNDEF
-} BinaryType;
-
-const char *BinaryType_ToString(BinaryType);
-
-BinaryType BinaryType_FromTokenType(TokenType);
-
-typedef enum {
-    MQ_CONST,
-    MQ_VARYING,
-    MQ_UNDEF
-} ModificationQualifier;
-
-ModificationQualifier ModificationQualifier_FromTokenType(TokenType);
-
-const char *ModificationQualifier_String(ModificationQualifier);
-
-typedef struct Node Node;
-
-struct Node {
-    NodeType type;
-    Node *super;    // Semantic analysis: Super-scope
-    union {
-        struct {
-            Node *nodes;
-        } program;
-
-        // Literals
-        struct {
-            char *str;
-        } str_lit;
-
-        struct {
-            int n;
-        } int_lit;
-
-        struct {
-            float f;
-        } float_lit;
-
-        // Var  Declaration
-        struct {
-            Token *id;
-            Type *type;
-            bool defined;
-            Node *value;
-            ModificationQualifier mutable;
-        } var_decl;
-
-        // Assignment
-        struct {
-            Token *id;
-            Node *value;
-        } var_assign;
-
-        // Binary operation
-        struct {
-            Node *left;
-            Node *right;
-            BinaryType op;
-        } binary;
-
-        // Function call
-        struct {
-            Token *id;
-            Array *exprs;
-        } fcall;
-
-        // Variable reference
-        struct {
-            Token *id;
-            Node *next;
-        } var_ref;
-
-        // Compound / Block statement
-        // Also a semantic scope
-        struct {
-            Array *nodes;
-
-            Array *declarations;    // } Managed and accessed by the
-            Node *super;            // } semantic analysis stage
-            Node *sub;              // }
-        } block;
-
-        // Function definition
-        struct {
-            Token *id;
-            Type *type;
-            Array *params;
-            Node *block;
-        } func_def;
-
-        // Return statement
-        struct {
-            Node *expr;
-        } ret;
-
-        // Check statement
-        struct {
-            Node *expr;
-            Node *block;
-            Node *sub;
-        } check;
-
-        // Size directive
-        struct {
-            Type *type;
-        } size;
-
-    } node;
-};
-
-typedef enum {
-    ELEMENT_VARIABLE,
-    ELEMENT_FUNCTION,
-    ELEMENT_COMPLEX
-} ElementType;
-
-typedef struct {
-    ElementType type;
-    Node *n;
-} Element;
-
-Node *Node_CreateBase(NodeType, Node *);
-
-void Node_DestroyBase(Node *);
-
-Node *Node_CreateProgram(Node *);
-
-Node *Node_CreateStringLiteral(char *);
-
-Node *Node_CreateIntegerLiteral(int);
-
-Node *Node_CreateFloatLiteral(float);
-
-Node *Node_CreateVariableDeclaration(Token *, Node *, Token *, ModificationQualifier, Node *);
-
-Node *Node_CreateVariableAssignment(Token *, Node *, Node *);
-
-Node *Node_CreateBinaryOperation(Node *, Node *, BinaryType, Node *);
-
-Node *Node_CreateFunctionCall(Token *, Array *, Node *);
-
-Node *Node_CreateVariableReference(Token *, Node *);
-
-Node *Node_CreateBlock(Array *, Node *);
-
-Node *Node_CreateFunctionDefinition(Token *, Token *, Array *, Node *, Node *);
-
-Node *Node_CreateReturn(Node *, Node *);
-
-Node *Node_CreateCheck(Node *, Node *, Node *, Node *);
-
-Node *Node_CreateSize(Type *, Node *);
-
-Element Block_FindElement(Node *, Token *);
-
-void Node_DestroyRecurse(Node *);
-
-void Node_Print(unsigned, Node *);
-
+#ifndef LFLOW_AST_H
+#define LFLOW_AST_H
+
+#include "arr.h"
+#include "bool.h"
+#include "token.h"
+#include "type.h"
+#include "pool.h"
+#include "profile.h"
+
+typedef enum {
+    NODE_PROGRAM,
+    NODE_STRING_LITERAL,
+    NODE_INTEGER_LITERAL,
+    NODE_FLOAT_LITERAL,
+    NODE_VARIABLE_DECLARATION,
+    NODE_VARIABLE_ASSIGNMENT,
+    NODE_BINARY_EXPRESSION,
+    NODE_FUNCTION_CALL,
+    NODE_VARIABLE_REFERENCE,
+    NODE_BLOCK,
+    NODE_FUNCTION_DEFINITION,
+    NODE_RETURN,
+    NODE_CHECK,
+    NODE_SIZE,
+    NODE_LOOP,
+    NODE_INDEX,
+    NODE_REDUCE,
+    NODE_COMPLEX
+} NodeType;
+
+const char *NodeType_ToString(NodeType);
+
+typedef enum {
+
+    // Arithmetics
+    BIN_ADD,
+    BIN_SUB,
+    BIN_MUL,
+    BIN_DIV,
+
+    // Logical boolean oeprations
+    BIN_OR,
+    BIN_AND,
+    BIN_EQUAL,
+    BIN_LGREATER,
+    BIN_RGREATER,
+
+    BIN_UNDEF
+} BinaryType;
+
+const char *BinaryType_ToString(BinaryType);
+
+BinaryType BinaryType_FromTokenType(TokenType);
+
+typedef enum {
+    MQ_CONST,
+    MQ_VARYING,
+    MQ_UNDEF
+} ModificationQualifier;
+
+ModificationQualifier ModificationQualifier_FromTokenType(TokenType);
+
+const char *ModificationQualifier_String(ModificationQualifier);
+
+typedef struct Node Node;
+
+struct Node {
+    NodeType type;
+    Node *super;    // Semantic analysis: Super-scope
+    Type *etype;    // Semantic analysis: Effective type of an expression
+    union {
+        struct {
+            Node *nodes;
+            StringPool *strings;    // Of all string literals
+            Profile *profile;       // Instrumentation or profile counts, NULL if there is neither
+            Array *imports;         // Names of the modules whose interfaces were loaded, NULL if none can be
+        } program;
+
+        // Literals
+        struct {
+            const char *str;    // } Interned in the string pool of the program
+            unsigned id;        // }
+        } str_lit;
+
+        struct {
+            long long n;
+        } int_lit;
+
+        struct {
+            double f;
+        } float_lit;
+
+        // Var  Declaration
+        struct {
+            Token *id;
+            Type *type;
+            bool defined;
+            Node *value;
+            ModificationQualifier mutable;
+            unsigned refs;  // Semantic analysis: Number of references (reads)
+            bool imported;  // Declared by the interface of another module
+        } var_decl;
+
+        // Assignment, of an element if there is an index. The value is evaluated ahead of the index.
+        struct {
+            Token *id;
+            Node *value;
+            Node *index;
+            bool checked;   // Bounds check needed on the index
+            Node *decl;     // Semantic analysis: Assigned declaration
+        } var_assign;
+
+        // Binary operation
+        struct {
+            Node *left;
+            Node *right;
+            BinaryType op;
+        } binary;
+
+        // Function call
+        struct {
+            Token *id;
+            Array *exprs;
+            Node *def;      // Semantic analysis: Called definition
+        } fcall;
+
+        // Variable reference
+        struct {
+            Token *id;
+            Node *next;
+            Node *decl;     // Semantic analysis: Referenced declaration
+        } var_ref;
+
+        // Compound / Block statement
+        // Also a semantic scope
+        struct {
+            Array *nodes;
+
+            Array *declarations;    // } Managed and accessed by the
+            Node *super;            // } semantic analysis stage
+            Node *sub;              // }
+
+            Node **index;           // } Declarations by name once there are many, open addressing.
+            unsigned slots;         // } Holds the first 'indexed' of them, the rest are added on
+            unsigned indexed;       // } the next lookup.
+        } block;
+
+        // Function definition
+        struct {
+            Token *id;
+            Type *type;
+            Array *params;
+            Node *block;
+            Array *param_decls; // Semantic analysis: Parameters declared in the body scope
+            unsigned refs;      // Semantic analysis: Number of call sites
+            bool reachable;     // Dead code elimination: Called from the entry point
+            int inline_state;   // Inlining: 0 - pending, 1 - in progress, 2 - done
+            bool pure;          // Purity analysis: No effects, the result depends on the arguments only
+            ProfileCounter entered;
+            const char *module; // } Separate compilation: Module exporting the procedure, NULL if it is
+            bool external;      // } private. External ones are declared by its interface, without a body.
+        } func_def;
+
+        // Return statement
+        struct {
+            Node *expr;
+            bool jump;      // 'jmp': The call is guaranteed to be a tail call
+        } ret;
+
+        // Check statement
+        struct {
+            Node *expr;
+            Node *block;
+            Node *sub;
+            ProfileCounter taken;   // } Times the block ran, and on the last alternative
+            ProfileCounter missed;  // } but for an 'otherwise', times no block did
+        } check;
+
+        // Size directive
+        struct {
+            Type *type;
+        } size;
+
+        // Counted loop, the counter runs from 'from' up to but excluding 'to'
+        struct {
+            Node *var;      // Declaration of the counter in the scope of the body
+            Node *from;
+            Node *to;       // Evaluated once, before the first iteration
+            Node *block;
+        } loop;
+
+        // Element of an array or lane of a vector
+        struct {
+            Node *array;    // Reference to the array
+            Node *expr;
+            bool checked;   // Bounds check needed, cleared once the index is proven to be in range
+        } index;
+
+        // Sum of the lanes of a vector
+        struct {
+            Node *expr;
+        } reduce;
+
+        // Complex type definition
+        struct {
+            Type *type;
+            bool registered;    // Semantic analysis: The type belongs to the analysis from then on
+            bool imported;      // Declared by the interface of another module
+        } complx;
+
+    } node;
+};
+
+typedef enum {
+    ELEMENT_VARIABLE,
+    ELEMENT_FUNCTION,
+    ELEMENT_COMPLEX
+} ElementType;
+
+typedef struct {
+    ElementType type;
+    Node *n;
+} Element;
+
+Node *Node_CreateBase(NodeType, Node *);
+
+void Node_DestroyBase(Node *);
+
+Node *Node_CreateProgram(Node *, StringPool *);
+
+Node *Node_CreateStringLiteral(const char *, unsigned);
+
+Node *Node_CreateIntegerLiteral(long long);
+
+Node *Node_CreateFloatLiteral(double);
+
+Node *Node_CreateVariableDeclaration(Token *, Node *, Token *, ModificationQualifier, Node *);
+
+Node *Node_CreateVariableAssignment(Token *, Node *, Node *);
+
+Node *Node_CreateBinaryOperation(Node *, Node *, BinaryType, Node *);
+
+Node *Node_CreateFunctionCall(Token *, Array *, Node *);
+
+Node *Node_CreateVariableReference(Token *, Node *);
+
+Node *Node_CreateBlock(Array *, Node *);
+
+Node *Node_CreateFunctionDefinition(Token *, Token *, Array *, Node *, Node *);
+
+Node *Node_CreateReturn(Node *, Node *);
+
+Node *Node_CreateCheck(Node *, Node *, Node *, Node *);
+
+Node *Node_CreateSize(Type *, Node *);
+
+Node *Node_CreateLoop(Node *, Node *, Node *, Node *, Node *);
+
+Node *Node_CreateIndex(Node *, Node *, Node *);
+
+Node *Node_CreateReduce(Node *, Node *);
+Node *Node_CreateComplex(Type *, Node *);
+
+Node *Node_DeclareVariable(Token *, Node *, Type *, ModificationQualifier, Node *);
+
+Node *Node_Reference(Node *, Node *);
+
+Element Block_FindElement(Node *, Token *);
+
+void Block_Undeclare(Node *, Node *);
+
+bool Node_IsLiteral(Node *);
+
+Node *Node_DuplicateLiteral(Node *, Node *);
+
+bool Node_HasSideEffects(Node *);
+
+void Node_Unreference(Node *);
+
+void Node_DestroyRecurse(Node *);
+
+
 #endif
\ No newline at end of file
@@ -0,0 +1,81 @@
+#ifndef LFLOW_ASTCACHE_H
+#define LFLOW_ASTCACHE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ast.h"
+#include "status.h"
+
+#define AST_CACHE_PRINT(...) \
+        printf("Natron -> "); \
+        printf(__VA_ARGS__);
+
+// "LFAST\0\0\0", the first quadword of a cached syntax tree
+#define AST_CACHE_MAGIC 0x000000545341464cULL
+// Raised whenever the format or the trees the parser builds change
+#define AST_CACHE_VERSION 3
+
+#define AST_CACHE_NONE 0xffffffffu
+
+// Cached trees are keyed by the source they were parsed from
+typedef struct {
+    uint64_t hash;      // FNV-1a of the source
+    uint64_t length;
+} AstCacheKey;
+
+typedef struct {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t root;      // Record of the top-level block
+    AstCacheKey key;
+    uint32_t records;
+    uint32_t entries;   // } Of the list table and the string table
+    uint32_t bytes;     // }
+    uint32_t strings;   // Texts of the string pool, whose offsets lead the list table
+    uint32_t literals;  // String literals of the source, duplicates included
+    uint32_t offsets;   // Entries where each top-level statement begins in the primed source
+    uint32_t source;    // The primed source, in the string table
+    uint32_t reserved;
+} AstCacheHeader;
+
+// A node with its children by record, tokens by offset into the string table. The records
+// follow the tree in pre-order, so children always come after their parent.
+typedef struct {
+    uint32_t type;
+    int32_t super;      // Record of the enclosing block, -1 if there is none
+    uint32_t token;     // } Identifier and type name, AST_CACHE_NONE if absent
+    uint32_t type_name; // }
+    int32_t child[4];   // Records of the children in the order of the node, -1 if absent
+    uint32_t list;      // } Entries of the list table: statements, arguments,
+    uint32_t count;     // } or pairs of identifier and type name for parameters and fields
+    uint32_t flags;     // Operator, qualifier, 'jmp', 'ordered' or string literal id
+    uint32_t reserved;
+    union {
+        int64_t n;
+        double f;
+    } value;
+} AstCacheRecord;
+
+// The last image of an input, kept in memory by a compile server
+typedef struct {
+    char *input;        // Real path of the source
+    AstCacheKey key;
+    void *image;
+    size_t size;
+} AstCacheModule;
+
+typedef struct {
+    const char *dir;    // Images on disk, NULL if there are none
+    Array *modules;     // Images in memory, NULL unless serving
+} AstCache;
+
+AstCacheKey AstCache_Key(const char *);
+
+Node *AstCache_Load(AstCache *, const char *, AstCacheKey);
+Node *AstCache_Reparse(AstCache *, const char *, const char *, Array *);
+Status AstCache_Store(AstCache *, const char *, AstCacheKey, Node *, const char *, Array *);
+
+void AstCache_Release(AstCache *);
+
+#endif
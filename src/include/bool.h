@@ -1,9 +1,9 @@
-#ifndef LFLOW_BOOL_H
-#define LFLOW_BOOL_H
-
-typedef enum {
-    false,
-    true,
-} bool;
-
+#ifndef LFLOW_BOOL_H
+#define LFLOW_BOOL_H
+
+typedef enum {
+    false,
+    true,
+} bool;
+
 #endif
\ No newline at end of file
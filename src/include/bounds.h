@@ -0,0 +1,28 @@
+#ifndef LFLOW_BOUNDS_H
+#define LFLOW_BOUNDS_H
+
+#include "ast.h"
+
+// Values an integer expression may take, both ends included
+typedef struct {
+    long long lo;
+    long long hi;
+} BoundsRange;
+
+typedef struct {
+    bool enabled;       // Checks that cannot be proven unnecessary are kept, all of them are dropped otherwise
+    Array *loops;       // Enclosing the current statement, innermost last
+
+    unsigned accesses;  // Array accesses visited
+    unsigned proven;    // Accesses whose index is always in range
+} Bounds;
+
+Bounds *Bounds_Create(bool);
+void Bounds_Destroy(Bounds *);
+
+bool Bounds_Range(Bounds *, Node *, BoundsRange *);
+
+void Bounds_Statement(Bounds *, Node *);
+void Bounds_Program(Bounds *, Node *);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef LFLOW_CODECACHE_H
+#define LFLOW_CODECACHE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bool.h"
+#include "status.h"
+
+#define CODE_CACHE_PRINT(...) \
+        printf("Emitide -> "); \
+        printf(__VA_ARGS__);
+
+// "LFCODE\0\0", the first quadword of a cached procedure
+#define CODE_CACHE_MAGIC 0x000045444f43464cULL
+// Raised whenever the code generated from the same input changes
+#define CODE_CACHE_VERSION 2
+// Megabytes the cached procedures may take by default
+#define CODE_CACHE_SIZE 64
+
+// What the register allocation of a procedure came to, reported as if it had been run
+typedef struct {
+    uint32_t allocated;
+    uint32_t spilled;
+    uint32_t saved;
+} CodeCacheStats;
+
+typedef struct {
+    uint64_t magic;
+    uint64_t key;
+    uint32_t version;
+    CodeCacheStats stats;
+    uint64_t length;    // Of the assembly following
+} CodeCacheHeader;
+
+// Procedures by a hash of everything their code is generated from. The least recently used ones
+// are evicted once the entries take more than the limit.
+typedef struct {
+    const char *dir;
+    unsigned long long limit;   // In bytes
+    unsigned hits;
+    unsigned misses;
+    unsigned evicted;
+    unsigned failed;            // Procedures that could not be written to the cache
+} CodeCache;
+
+Status CodeCache_Open(CodeCache *);
+bool CodeCache_Load(CodeCache *, uint64_t, FILE *, CodeCacheStats *);
+void CodeCache_Store(CodeCache *, uint64_t, CodeCacheStats *, const char *, size_t);
+void CodeCache_Evict(CodeCache *);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef LFLOW_CODEGEN_H
+#define LFLOW_CODEGEN_H
+
+#include <stdio.h>
+
+#include "ir.h"
+#include "regalloc.h"
+#include "options.h"
+#include "codecache.h"
+
+typedef struct {
+    FILE *out;
+    IrModule *module;
+    IrFunction *fn;
+    Allocation *alloc;
+    unsigned saved;     // Number of callee-saved registers pushed by the prologue
+    unsigned checks;    // Bounds checks emitted, which jump to a trap at the end of the function
+    unsigned clears;    // Loops clearing arrays, keeps their labels apart
+    CodeCache *cache;   // Of generated procedures, NULL if there is none
+    uint64_t seed;      // Hash of the options and the module the procedures are generated under
+} Codegen;
+
+// Arrays of up to this many quadwords are cleared without a loop
+#define CODEGEN_UNROLLED_CLEAR 8
+
+void Codegen_Function(Codegen *, IrFunction *);
+void Codegen_Procedure(Codegen *, IrFunction *, CodeCacheStats *);
+void Codegen_Module(Codegen *);
+
+Status Codegen_Program(Node *, Options *);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef LFLOW_COMPILE_H
+#define LFLOW_COMPILE_H
+
+#include "options.h"
+#include "astcache.h"
+
+Status Compile_Run(Options *, AstCache *);
+
+#endif
@@ -1,8 +1,10 @@
-#ifndef LFLOW_CONV_H
-#define LFLOW_CONV_H
-
-int ctoi(char);
-int stoi(char *);
-float stof(char *);
-
+#ifndef LFLOW_CONV_H
+#define LFLOW_CONV_H
+
+#include "bool.h"
+
+int ctoi(char);
+bool stoi(const char *, long long *);
+double stof(const char *);
+
 #endif
\ No newline at end of file
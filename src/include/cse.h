@@ -0,0 +1,32 @@
+#ifndef LFLOW_CSE_H
+#define LFLOW_CSE_H
+
+#include "ast.h"
+
+// An available pure computation
+typedef struct {
+    Node *expr;     // First occurrence
+    Node **slot;    // Where the first occurrence is stored
+    Node *block;    // Block of the statement holding the first occurrence
+    Node *stmt;     // Statement holding the first occurrence
+    Node *temp;     // Declaration holding the value, once it has been reused
+    unsigned hash;
+} CseEntry;
+
+typedef struct {
+    Array *entries;         // Every entry created, owned by the pass
+
+    unsigned temps;         // Temporaries introduced
+    unsigned eliminated;    // Recomputations replaced by a temporary
+} Cse;
+
+Cse *Cse_Create();
+void Cse_Destroy(Cse *);
+
+unsigned Cse_Hash(Node *);
+bool Cse_Equal(Node *, Node *);
+
+void Cse_Block(Cse *, Array *, Node *);
+void Cse_Program(Cse *, Node *);
+
+#endif
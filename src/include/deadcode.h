@@ -0,0 +1,25 @@
+#ifndef LFLOW_DEADCODE_H
+#define LFLOW_DEADCODE_H
+
+#include "ast.h"
+#include "bounds.h"
+
+typedef struct {
+    Array *dead;            // Removed nodes, destroyed once the pass is done
+    Bounds *bounds;         // Accesses that may fail their bounds check are kept while checks are enabled
+
+    unsigned statements;    // Unreachable or effect-free statements removed
+    unsigned variables;     // Unreferenced variable declarations removed
+    unsigned procedures;    // Procedures unreachable from the entry point removed
+} DeadCode;
+
+DeadCode *DeadCode_Create(bool);
+void DeadCode_Destroy(DeadCode *);
+
+bool DeadCode_Terminates(Node *);
+
+void DeadCode_MarkReachable(Node *);
+bool DeadCode_Block(DeadCode *, Node *);
+void DeadCode_Program(DeadCode *, Node *);
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef LFLOW_DUMP_H
+#define LFLOW_DUMP_H
+
+#include <stdio.h>
+
+#include "ast.h"
+#include "bool.h"
+
+#define DUMP_NONE 0
+#define DUMP_TEXT 1     // Indented lines
+#define DUMP_JSON 2     // Compact, a node is an object with its kind and its fields
+#define DUMP_SEXPR 3    // (kind (field value) ...)
+
+#define DUMP_BUFFER 65536
+
+// Output of a syntax tree, gathered in the buffer and written out as it fills up
+typedef struct {
+    FILE *out;
+    unsigned format;
+    unsigned depth;     // Indentation of text
+    bool separate;      // A value was written that the next one is separated from
+    unsigned length;
+    char buffer[DUMP_BUFFER];
+} Dump;
+
+void Dump_Program(Node *, unsigned, FILE *);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef LFLOW_FOLD_H
+#define LFLOW_FOLD_H
+
+#include "ast.h"
+
+typedef struct {
+    unsigned folded;        // Binary expressions evaluated at compile time
+    unsigned propagated;    // References to constants replaced by their value
+    unsigned pruned;        // Check alternatives and loops decided at compile time
+    unsigned evaluated;     // Calls to pure procedures replaced by their result
+    unsigned abandoned;     // Calls to pure procedures that ran past the evaluation limits
+} FoldStatistics;
+
+bool Fold_Truth(Node *, bool *);
+
+Node *Fold_Binary(Node *);
+Node *Fold_Call(FoldStatistics *, Node *);
+
+Node *Fold_Expression(FoldStatistics *, Node *);
+Node *Fold_Check(FoldStatistics *, Node *);
+Node *Fold_Statement(FoldStatistics *, Node *);
+void Fold_Block(FoldStatistics *, Node *);
+void Fold_Program(FoldStatistics *, Node *);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef LFLOW_INLINE_H
+#define LFLOW_INLINE_H
+
+#include "ast.h"
+
+// Estimated cost of a call over an inlined body, in nodes
+#define INLINE_CALL_COST 3
+// Estimated saving per reference to a parameter bound to a literal
+#define INLINE_CONSTANT_BONUS 2
+// Procedures with a single call site may be this many times larger
+#define INLINE_SINGLE_SITE_FACTOR 4
+// Procedures hot in the profile may be this many times larger
+#define INLINE_HOT_FACTOR 4
+
+typedef struct {
+    int threshold;
+    bool report;
+
+    Array *rejected;    // Call sites already reported as not inlined
+    Profile *profile;   // Of the program, NULL if there is none
+
+    unsigned temps;
+    unsigned inlined;
+    unsigned declined;
+} Inliner;
+
+Inliner *Inliner_Create(int, bool);
+void Inliner_Destroy(Inliner *);
+
+unsigned Inline_Size(Node *);
+bool Inline_Within(Node *, Node *);
+bool Inline_TailReturns(Array *, unsigned);
+
+void Inline_Procedure(Inliner *, Node *);
+void Inline_Block(Inliner *, Node *, Node *);
+void Inline_Program(Inliner *, Node *);
+
+#endif
@@ -1,6 +1,6 @@
-#ifndef LFLOW_IO_H
-#define LFLOW_IO_H
-
-char *read_file(char *);
-
+#ifndef LFLOW_IO_H
+#define LFLOW_IO_H
+
+char *read_file(char *);
+
 #endif
\ No newline at end of file
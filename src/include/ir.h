@@ -0,0 +1,134 @@
+#ifndef LFLOW_IR_H
+#define LFLOW_IR_H
+
+#include <stdio.h>
+
+#include "ast.h"
+#include "status.h"
+#include "vectorize.h"
+
+#define EMIT_PRINT(...) \
+        printf("Emitide -> "); \
+        printf(__VA_ARGS__);
+
+typedef enum {
+    IR_IMMEDIATE,   // dst = imm
+    IR_MOVE,        // dst = a
+    IR_EXTEND,      // dst = a, sign-extended to the width of dst
+    IR_ADD,         // dst = a + b
+    IR_SUB,         // dst = a - b
+    IR_MUL,         // dst = a * b
+    IR_DIV,         // dst = a / b
+    IR_EQUAL,       // dst = a == b
+    IR_GREATER,     // dst = a > b
+    IR_LESS,        // dst = a < b
+    IR_LOAD,        // dst = global
+    IR_STORE,       // global = a
+    IR_CHECK,       // trap unless 0 <= a < imm, the length of the target array
+    IR_ELEMENT,     // dst = target[a]
+    IR_SET_ELEMENT, // target[a] = b
+    IR_CLEAR,       // every element of target = 0
+    IR_PARAMETER,   // dst = parameter #imm
+    IR_CALL,        // dst = target(args), dst may be unused
+    IR_TAIL_CALL,   // return target(args), reusing the frame
+    IR_RETURN,      // return a, a may be unused
+    IR_JUMP,        // goto label, imm is set on the way back from code laid out past the end
+    IR_BRANCH,      // if a == 0 goto label
+    IR_BRANCH_SET,  // if a != 0 goto label
+    IR_LABEL,
+    IR_VSPLAT,      // every lane of vd = a, zero if a is unused
+    IR_VSERIES,     // lane k of vd = a + k * b
+    IR_VADD,        // vd = va + vb, lane by lane
+    IR_VSUB,        // vd = va - vb
+    IR_VMUL,        // vd = va * vb
+    IR_VSUM,        // dst = a + the sum of the lanes of va
+    IR_VLOAD,       // vd = target[a] and the elements following it
+    IR_VSTORE,      // target[a] and the elements following it = va
+    IR_VEND,        // vector code is left
+    IR_ADDRESS,     // dst = address of target, vector values are kept in memory and handled by address
+    IR_PSPLAT,      // dst = address of the temporary at imm, every lane of which is set to a
+    IR_PADD,        // dst = address of the temporary at imm, set to *a + *b lane by lane
+    IR_PSUB,        // dst = address of the temporary at imm, set to *a - *b
+    IR_PMUL,        // dst = address of the temporary at imm, set to *a * *b
+    IR_PSUM,        // dst = the sum of the lanes of *a
+    IR_PCOPY,       // *a = *b
+    IR_STRING,      // dst = address of the text of string literal imm, in read-only data
+    IR_COUNT        // increment profile counter imm
+} IrOpcode;
+
+const char *IrOpcode_ToString(IrOpcode);
+
+#define IR_NONE (-1)
+
+typedef struct {
+    IrOpcode op;
+    int dst;            // } Virtual registers, IR_NONE if unused
+    int a;              // }
+    int b;              // }
+    long long imm;
+    unsigned width;     // Operand width in bytes
+    unsigned label;
+    Node *target;       // Called procedure, accessed global or array declaration
+    int *args;          // Call arguments
+    unsigned nargs;
+    int vd;             // } Vector registers, IR_NONE if unused.
+    int va;             // } These are assigned by the lowering,
+    int vb;             // } not by the register allocator.
+    unsigned size;      // Of the vectors in memory in bytes
+} IrInstruction;
+
+// Arguments passed in registers under the System V calling convention
+#define IR_REGISTER_ARGS 6
+
+typedef struct {
+    Node *decl;
+    unsigned offset;    // From the bottom of the array area of the frame
+} IrArray;
+
+typedef struct {
+    char *name;         // Assembly symbol
+    Node *def;          // NULL for the top-level statements
+    Array *code;
+    unsigned *widths;   // Width of every virtual register in bytes
+    unsigned vregs;
+    unsigned labels;
+    Array *arrays;      // Local arrays, kept in the frame below the spill slots
+    unsigned frame;     // Bytes taken by them and by vector temporaries
+} IrFunction;
+
+typedef struct {
+    Node *decl;
+    char *name;
+    unsigned size;      // In bytes
+} IrGlobal;
+
+typedef struct {
+    Array *functions;
+    Array *externals;   // Procedures of imported modules, called by name but defined there
+    Array *globals;     // Top-level arrays and variables accessed from procedures
+    unsigned tail_calls;
+    unsigned vector;    // Size of the vector registers in bytes, 0 if there is no vectorized loop
+    unsigned isa;       // Size of the largest vector registers of the target in bytes
+    StringPool *strings;    // Of the program
+    Profile *profile;       // Of the program, NULL if there is none
+    unsigned cold;          // Check alternatives laid out past the end of their function
+    bool entry;             // The top level is the entry point, which a module leaves out
+} IrModule;
+
+IrModule *IrModule_Create();
+void IrModule_Destroy(IrModule *);
+
+IrFunction *IrModule_FindFunction(IrModule *, Node *);
+IrGlobal *IrModule_FindGlobal(IrModule *, Node *);
+IrArray *IrFunction_FindArray(IrFunction *, Node *);
+
+unsigned Ir_Width(Type *);
+long long Ir_Truncate(long long, unsigned);
+
+bool IrInstruction_Uses(IrInstruction *, int);
+
+IrModule *Ir_Lower(Node *, Vectorizer *);
+
+void IrFunction_Print(IrFunction *);
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef LFLOW_LOOP_H
+#define LFLOW_LOOP_H
+
+#include "ast.h"
+
+typedef struct {
+    unsigned temps;         // Temporaries introduced
+    unsigned loops;         // Loops visited
+    unsigned inductions;    // Induction variables found, counters included
+    unsigned reduced;       // Multiplications by an induction variable turned into additions
+    unsigned hoisted;       // Loop-invariant computations moved ahead of their loop
+} LoopStatistics;
+
+// A variable changed by the same invariant amount once per iteration
+typedef struct {
+    Node *decl;
+    Node *step;     // NULL for the counter, which advances by one
+    BinaryType op;  // BIN_ADD or BIN_SUB
+    Node *update;   // The statement of the body that advances it, NULL for the counter
+} Induction;
+
+// A product of an induction variable and an invariant, kept up to date by additions
+typedef struct {
+    Induction *iv;
+    Node *factor;   // Copy of the invariant, owned by the reduction
+    Node *temp;
+    Node *advance;  // Statement keeping the temporary up to date
+} Reduction;
+
+typedef struct {
+    LoopStatistics *stats;
+    Node *loop;
+    Node *body;
+    Node *blk;          // } The loop statement is found at this index of this block,
+    unsigned at;        // } temporaries are declared ahead of it
+    Array *assigned;    // Variables assigned within the body
+    bool calls;         // Whether the body or the bounds call procedures
+    Array *inductions;
+    Array *reductions;
+    Array *hoisted;     // Declarations of the hoisted computations
+} LoopContext;
+
+unsigned Loop_Assignments(LoopContext *, Node *);
+void Loop_Scan(LoopContext *, Node *);
+bool Loop_Invariant(LoopContext *, Node *);
+bool Loop_Refers(Node *, Node *);
+Induction *Loop_FindInduction(LoopContext *, Node *);
+void Loop_Inductions(LoopContext *);
+
+void Loop_Optimize(LoopStatistics *, Node *, Node *);
+void Loop_Block(LoopStatistics *, Node *);
+void Loop_Program(LoopStatistics *, Node *);
+
+#endif
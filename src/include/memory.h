@@ -0,0 +1,38 @@
+#ifndef LFLOW_MEMORY_H
+#define LFLOW_MEMORY_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "bool.h"
+
+#define MEMORY_PRINT(...) \
+        printf("Memoride -> "); \
+        printf(__VA_ARGS__);
+
+extern bool Memory_Enabled;
+
+void Memory_Enable();
+void Memory_Phase(const char *);
+void Memory_Report();
+
+void *Memory_Alloc(size_t, const char *);
+void *Memory_Calloc(size_t, size_t, const char *);
+void *Memory_Realloc(void *, size_t, const char *);
+char *Memory_Strdup(const char *, const char *);
+char *Memory_Strndup(const char *, size_t, const char *);
+void Memory_Free(void *);
+
+// Sources including this header after the system ones have their allocations accounted for, under
+// the name of the procedure making them. Only while accounting is enabled, they go straight to the
+// C library otherwise. Frees always go through Memory_Free, as procedures pass 'free' to others.
+#ifndef LFLOW_MEMORY_INTERNAL
+#define malloc(size) (Memory_Enabled ? Memory_Alloc(size, __func__) : malloc(size))
+#define calloc(n, size) (Memory_Enabled ? Memory_Calloc(n, size, __func__) : calloc(n, size))
+#define realloc(ptr, size) (Memory_Enabled ? Memory_Realloc(ptr, size, __func__) : realloc(ptr, size))
+#define strdup(str) (Memory_Enabled ? Memory_Strdup(str, __func__) : strdup(str))
+#define strndup(str, n) (Memory_Enabled ? Memory_Strndup(str, n, __func__) : strndup(str, n))
+#define free Memory_Free
+#endif
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef LFLOW_MODULE_H
+#define LFLOW_MODULE_H
+
+#include <stdio.h>
+
+#include "ast.h"
+#include "status.h"
+
+#define MODULE_PRINT(...) \
+        printf("Modulide -> "); \
+        printf(__VA_ARGS__);
+
+char *Module_Directory(const char *);
+char *Module_Name(const char *);
+
+Status Module_Export(Node *, const char *, const char *);
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef LFLOW_OPTIMIZE_H
+#define LFLOW_OPTIMIZE_H
+
+#include <stdio.h>
+
+#include "ast.h"
+#include "options.h"
+
+#define OPTIMIZE_PRINT(...) \
+        printf("Optimide -> "); \
+        printf(__VA_ARGS__);
+
+void Optimize_Program(Node *, Options *);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef LFLOW_OPTIONS_H
+#define LFLOW_OPTIONS_H
+
+#include "bool.h"
+#include "status.h"
+
+typedef struct {
+    char *input;            // Source file
+    bool module;            // Compile the input as a module: export its procedures and write its interface
+    char *ast_cache;        // Directory of syntax trees keyed by their source, NULL disables caching
+    char *code_cache;       // Directory of generated procedures keyed by their input, NULL disables caching
+    int code_cache_size;    // Megabytes the generated procedures may take before the oldest are evicted
+
+    int inline_threshold;   // Largest procedure body (in nodes) worth inlining at a call site
+    bool inline_report;     // Print every inlining decision
+
+    char *output;           // Assembly output, no code is generated if NULL
+    unsigned dump_ast;      // Format to print the syntax tree in once parsed, DUMP_NONE not to print it
+    char *dump_file;        // File the syntax tree is written to, NULL to print it with the messages
+    bool print_ir;          // Print the intermediate representation
+
+    unsigned vector;        // Vector register size in bytes, 0 disables vectorization
+    bool vectorize_report;  // Print every vectorization decision
+
+    bool bounds_checks;     // Check array indices that cannot be proven to be in range
+
+    char *profile_generate; // Profile the instrumented program writes on exit, NULL if not instrumenting
+    char *profile_use;      // Profile to optimize by, NULL if there is none
+
+    char *server;           // Socket to serve compile requests on, NULL to compile once
+    char *connect;          // Socket of a server to send the compile to, NULL to compile here
+
+    bool memory_report;     // Account for the allocations of every phase, reporting them and the leaks at exit
+    char *trace;            // Chrome trace events of the phases and procedures, NULL if not tracing
+} Options;
+
+void Options_Default(Options *);
+Status Options_Parse(Options *, int, char **);
+void Options_Usage(const char *);
+
+#endif
@@ -1,60 +1,80 @@
-#ifndef LFLOW_PARSE_H
-#define LFLOW_PARSE_H
-
-#include <stdio.h>
-
-#include "tokenizer.h"
-#include "ast.h"
-
-#define SYNTAX_ERR(...) \
-        printf("Natron -> "); \
-        printf(__VA_ARGS__);
-
-#define WARN(...) \
-        printf("Warning: "); \
-        printf(__VA_ARGS__);
-
-typedef struct {
-    Tokenizer *tokenizer;
-    Token *current;
-    Token *next;
-
-    Node *lastBlock;
-    Node *rootBlock;
-} Parser;
-
-typedef enum {
-    CURRENT,
-    NEXT
-} TokenDesignation;
-
-Parser *Parser_CreateParser(Tokenizer *);
-void Parser_DestroyParser(Parser *);
-
-void Parser_Consume(Parser *);
-
-bool Parser_Compare(Parser *, TokenDesignation, TokenType, const char *);
-
-Node *Parser_ParseProgram(Parser *);
-Node *Parser_ParseNext(Parser *);
-
-Node *Parser_ParseStringLiteral(Parser *);
-Node *Parser_ParseIntegerLiteral(Parser *);
-Node *Parser_ParseRealLiteral(Parser *);
-Node *Parser_ParseVariableReference(Parser *);
-
-Node *Parser_ParseFunctionCall(Parser *);
-Node *Parser_ParseVariableDeclaration(Parser *);
-Node *Parser_ParseVariableAssignment(Parser *);
-
-Node *Parser_ParseSubExpression(Parser *);
-Node *Parser_ParseExpression(Parser *);
-Node *Parser_ParseSecondDegree(Parser *);
-Node *Parser_ParseAtom(Parser *);
-Node *Parser_ParseBlock(Parser *);
-Node *Parser_ParseFunctionDefinition(Parser *);
-Node *Parser_ParseReturn(Parser *);
-Node *Parser_ParseCheck(Parser *);
-Node *Parser_ParseSize(Parser *);
-
+#ifndef LFLOW_PARSE_H
+#define LFLOW_PARSE_H
+
+#include <stdio.h>
+
+#include "tokenizer.h"
+#include "ast.h"
+
+#define SYNTAX_ERR(...) \
+        printf("Natron -> "); \
+        printf(__VA_ARGS__);
+
+#define WARN(...) \
+        printf("Warning: "); \
+        printf(__VA_ARGS__);
+
+typedef struct {
+    Tokenizer *tokenizer;
+    Token *current;
+    Token *next;
+    unsigned int position;  // } Where the current and next tokens begin in the input
+    unsigned int ahead;     // }
+
+    Node *lastBlock;
+    Node *rootBlock;
+
+    StringPool *strings;    // Handed over to the program
+    Array *offsets;         // Where each top-level statement begins, recorded if set
+
+    const char *dir;        // Directory of the interfaces of imported modules
+    Array *imports;         // Names of the modules imported so far, handed over to the program. NULL
+                            // where imports cannot be resolved, which fails them without a word.
+    const char *module;     // Module whose interface is being parsed, NULL when parsing a source
+} Parser;
+
+typedef enum {
+    CURRENT,
+    NEXT
+} TokenDesignation;
+
+Parser *Parser_CreateParser(Tokenizer *);
+void Parser_DestroyParser(Parser *);
+
+void Parser_Consume(Parser *);
+
+bool Parser_Compare(Parser *, TokenDesignation, TokenType, const char *);
+
+Node *Parser_ParseProgram(Parser *);
+Status Parser_ParseStatements(Parser *, Array *);
+Status Parser_ParseImport(Parser *, Array *);
+Node *Parser_ParseNext(Parser *);
+
+Node *Parser_ParseStringLiteral(Parser *);
+Node *Parser_ParseIntegerLiteral(Parser *);
+Node *Parser_ParseRealLiteral(Parser *);
+Node *Parser_ParseVariableReference(Parser *);
+Node *Parser_ParseSubscript(Parser *);
+Node *Parser_ParseIndex(Parser *);
+Token *Parser_ParseTypeName(Parser *);
+
+Node *Parser_ParseFunctionCall(Parser *);
+Node *Parser_ParseVariableDeclaration(Parser *);
+Node *Parser_ParseVariableAssignment(Parser *);
+
+Node *Parser_ParseSubExpression(Parser *);
+Node *Parser_ParseExpression(Parser *);
+Node *Parser_ParseSecondDegree(Parser *);
+Node *Parser_ParseAtom(Parser *);
+Node *Parser_ParseBlock(Parser *);
+Node *Parser_ParseFunctionDefinition(Parser *);
+Node *Parser_ParseReturn(Parser *);
+Node *Parser_ParseJump(Parser *);
+Node *Parser_ParseCheck(Parser *);
+Node *Parser_ParseLoop(Parser *);
+Node *Parser_ParseSize(Parser *);
+
+Node *Parser_ParseReduce(Parser *);
+Node *Parser_ParseComplex(Parser *);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef LFLOW_POOL_H
+#define LFLOW_POOL_H
+
+#include "arr.h"
+#include "bool.h"
+
+typedef struct {
+    char *text;
+    unsigned length;
+    unsigned hash;
+} PooledString;
+
+// The string literals of a program, each distinct text once. Literals refer to their text by id.
+typedef struct {
+    Array *strings;     // By id
+    unsigned *slots;    // Open addressing on the hashes, id + 1 or 0 when free
+    unsigned capacity;  // Number of slots, a power of two
+    unsigned literals;  // Interned, duplicates included
+} StringPool;
+
+StringPool *StringPool_Create();
+void StringPool_Destroy(StringPool *);
+
+unsigned StringPool_Hash(const char *, unsigned);
+unsigned StringPool_Intern(StringPool *, const char *);
+bool StringPool_Contains(StringPool *, const char *);
+PooledString *StringPool_At(StringPool *, unsigned);
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef LFLOW_PROFILE_H
+#define LFLOW_PROFILE_H
+
+#include <stdio.h>
+
+#include "arr.h"
+#include "bool.h"
+#include "options.h"
+
+#define PROFILE_PRINT(...) \
+        printf("Profilide -> "); \
+        printf(__VA_ARGS__);
+
+// "LFPROF01", the first quadword of a profile
+#define PROFILE_MAGIC 0x3130464f5250464cULL
+
+// Procedures entered at least once for every this many entries of the hottest one are hot
+#define PROFILE_HOT_SHARE 10
+
+// A counter of instrumented code, and its value from the profile
+typedef struct {
+    unsigned site;              // Counter number starting at 1, 0 if there is none
+    unsigned long long count;   // From the profile
+} ProfileCounter;
+
+// The counters of a program, numbered in source order ahead of the optimizations. A profile is
+// the magic, the signature and the number of counters followed by their values, all quadwords.
+typedef struct {
+    bool generate;                  // Instrumenting, otherwise the counts come from the profile
+    const char *path;
+    unsigned sites;
+    unsigned long long signature;   // Of the procedures and checks, tells profiles of other programs apart
+    unsigned long long hottest;     // Most entries of a procedure
+} Profile;
+
+typedef struct Node Node;
+
+Profile *Profile_Create(Node *, Options *);
+void Profile_Destroy(Profile *);
+
+bool Profile_Guides(Profile *);
+bool Profile_Hot(Profile *, unsigned long long);
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef LFLOW_PURE_H
+#define LFLOW_PURE_H
+
+#include "ast.h"
+
+// Statements and expressions a single call may take when evaluated at compile time
+#define PURE_STEPS 1000000
+// Nested calls a single call may make when evaluated at compile time
+#define PURE_DEPTH 64
+
+typedef enum {
+    PURE_EVALUATED,
+    PURE_UNSUPPORTED,   // Arrays, strings, traps and the like are left to the runtime
+    PURE_LIMIT          // Ran past the step or depth limit
+} PureStatus;
+
+unsigned Pure_Program(Node *);
+
+PureStatus Pure_Evaluate(Node *, long long *);
+
+#endif
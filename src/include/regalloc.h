@@ -0,0 +1,55 @@
+#ifndef LFLOW_REGALLOC_H
+#define LFLOW_REGALLOC_H
+
+#include "ir.h"
+
+typedef enum {
+    REG_RAX,
+    REG_RBX,
+    REG_RCX,
+    REG_RDX,
+    REG_RSI,
+    REG_RDI,
+    REG_RBP,
+    REG_RSP,
+    REG_R8,
+    REG_R9,
+    REG_R10,
+    REG_R11,
+    REG_R12,
+    REG_R13,
+    REG_R14,
+    REG_R15,
+    REG_NONE
+} Register;
+
+const char *Register_Name(Register, unsigned);
+
+bool Register_CalleeSaved(Register);
+
+// Spill costs grow by this factor per loop nesting level
+#define REGALLOC_LOOP_WEIGHT 10
+
+typedef struct {
+    int vreg;
+    unsigned start;     // } First and last instruction the value is live at
+    unsigned end;       // }
+    bool crosses_call;  // Live across a call, so caller-saved registers are clobbered
+    double cost;        // Weighted number of definitions and uses
+    Register reg;
+    int slot;           // Stack slot of a spilled value, -1 otherwise
+} Interval;
+
+typedef struct {
+    Interval *intervals;    // Indexed by virtual register
+    unsigned count;
+    unsigned slots;
+    unsigned callee_saved;  // Mask of the callee-saved registers in use
+    unsigned allocated;
+    unsigned spilled;
+} Allocation;
+
+Allocation *RegAlloc_Function(IrFunction *);
+void Allocation_Destroy(Allocation *);
+
+#endif
@@ -7,6 +7,7 @@
 
 #include "complex.h"
 #include "ast.h"
+#include "pool.h"
 #include "status.h"
 
 #define SEMANTIC_PRINT(...) \
@@ -17,6 +18,8 @@ typedef struct {
     Array *types;
     Node *program;
     Node *currentBlock;
+    Node *currentFunction;
+    StringPool *names;      // Declared so far in any scope, a name not in it cannot be taken
 } SemanticAnalysis;
 
 Type *SemanticAnalysis_ResolveType(SemanticAnalysis *, Type *, Node *);
@@ -24,7 +27,7 @@ Type *SemanticAnalysis_ResolveType(SemanticAnalysis *, Type *, Node *);
 SemanticAnalysis *SemanticAnalysis_Create(Node *);
 void SemanticAnalysis_Destroy(SemanticAnalysis *);
 
-PrimitiveType PrimitiveType_FitInteger(int);
+PrimitiveType PrimitiveType_FitInteger(long long);
 
 Status SemanticAnalysis_RunAnalysis(SemanticAnalysis *);
 
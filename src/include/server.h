@@ -0,0 +1,22 @@
+#ifndef LFLOW_SERVER_H
+#define LFLOW_SERVER_H
+
+#include <stdio.h>
+
+#include "options.h"
+#include "status.h"
+
+#define SERVER_PRINT(...) \
+        printf("Servide -> "); \
+        printf(__VA_ARGS__);
+
+// Largest request a client may send: its working directory and arguments
+#define SERVER_REQUEST_MAX (1 << 20)
+
+// Ends every reply: a NUL and the status of the compile
+#define SERVER_TRAILER 2
+
+Status Server_Run(Options *);
+Status Server_Request(const char *, int, char **, Status *);
+
+#endif
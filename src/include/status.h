@@ -1,9 +1,9 @@
-#ifndef LFLOW_STATUS_H
-#define LFLOW_STATUS_H
-
-typedef enum {
-    STATUS_FAIL,
-    STATUS_OK
-} Status;
-
+#ifndef LFLOW_STATUS_H
+#define LFLOW_STATUS_H
+
+typedef enum {
+    STATUS_FAIL,
+    STATUS_OK
+} Status;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef LFLOW_TRACE_H
+#define LFLOW_TRACE_H
+
+#include <stdio.h>
+
+#include "bool.h"
+#include "status.h"
+
+#define TRACE_PRINT(...) \
+        printf("Tracide -> "); \
+        printf(__VA_ARGS__);
+
+extern bool Trace_Enabled;
+
+Status Trace_Open(const char *, const char *);
+void Trace_Close();
+
+double Trace_Now();
+void Trace_Span(const char *, const char *, double);
+
+#endif
@@ -15,6 +15,8 @@ typedef enum {
     TYPE_VOID,      // No type (void)
     TYPE_PRIMITIVE,
     TYPE_COMPLEX,
+    TYPE_ARRAY,     // Fixed number of primitive elements
+    TYPE_VECTOR,    // Primitive lanes filling a vector register, computed with lane by lane
     TYPE_PLACEHOLDER
 } TypeClass;
 
@@ -30,6 +32,7 @@ const char *PrimitiveType_String(PrimitiveType);
 typedef struct {
     Token *id;
     Type *type;
+    unsigned offset;    // Layout: In bytes from the start of the complex value
 } ComplexField;
 
 ComplexField *ComplexField_Create(Token *, Type *);
@@ -38,13 +41,20 @@ void ComplexField_Destroy(ComplexField *);
 
 typedef struct {
     Token *id;
-    Array *fields;
+    Array *fields;      // In the order of declaration
+    bool ordered;       // The fields keep that order in memory, for layouts shared with other code
+
+    unsigned size;      // } Layout: In bytes. The padding between and after the fields
+    unsigned alignment; // } is included in the size.
+    unsigned padding;   // }
 } ComplexType;
 
 ComplexType *ComplexType_Create(Token *, Array *);
 
 void ComplexType_Destroy(ComplexType *);
 
+void ComplexType_Layout(ComplexType *);
+
 struct Type {
     TypeClass type;
 
@@ -63,6 +73,13 @@ struct Type {
             Token *id;
         } placeholder;
 
+        // Also describes vectors, whose length is the number of lanes
+        struct {
+            Type *element;
+            unsigned length;
+            char *id;       // "element[length]" or "element<lanes>"
+        } array;
+
     } content;
 
 };
@@ -75,6 +92,10 @@ Type *Type_CreateComplex(Token *, ComplexType *);
 
 Type *Type_CreatePlaceholder(Token *);
 
+Type *Type_CreateArray(Type *, unsigned);
+
+Type *Type_CreateVector(Type *, unsigned);
+
 void Type_Destroy(Type *);
 void Type_DestroyHard(Type *);
 
@@ -82,8 +103,13 @@ const char *Type_Identifier(Type *);
 
 bool Type_Compare(Type *, Type *);
 
+bool Type_Assignable(Type *, Type *);
+
 int Type_Quantify(Type *);
 
+unsigned Type_Size(Type *);
+unsigned Type_Alignment(Type *);
+
 Type *Type_Larger(Type *, Type *);
 
 #endif //LFLOW_TYPE_H
@@ -1,7 +0,0 @@
-#ifndef LFLOW_UTIL_H
-#define LFLOW_UTIL_H
-
-char *repeat(char, unsigned);
-char *indent(unsigned);
-
-#endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef LFLOW_VECTORIZE_H
+#define LFLOW_VECTORIZE_H
+
+#include "ast.h"
+#include "loop.h"
+
+// Vector register sizes in bytes
+#define VECTOR_SSE2 16
+#define VECTOR_AVX2 32
+
+// xmm0 to xmm14 hold values, xmm15 is a scratch register
+#define VECTOR_REGISTERS 15
+
+typedef struct {
+    unsigned width;     // Vector register size in bytes, 0 disables vectorization
+    bool report;
+
+    unsigned vectorized;
+    unsigned declined;
+} Vectorizer;
+
+Vectorizer *Vectorizer_Create(unsigned, bool);
+void Vectorizer_Destroy(Vectorizer *);
+
+// An induction variable, held by the lanes as its values over consecutive iterations
+typedef struct {
+    Induction *iv;
+    bool read;          // By a vectorized computation
+    bool read_after;    // Past the statement that advances it
+    bool advanced;      // Whether that statement has been passed
+    int reg;            // } Vector registers, IR_NONE if unused. The stride advances every lane
+    int stride;         // } past all of them at once, the step by a single iteration.
+    int step;           // } After holds the variable past the statement that advances it.
+    int after;          // }
+} VectorInduction;
+
+typedef enum {
+    VECTOR_INDUCTION,   // v = v + step
+    VECTOR_REDUCTION,   // acc = acc + expr
+    VECTOR_TEMPORARY,   // t: T = expr
+    VECTOR_STORE        // a[counter] = expr
+} VectorStatementKind;
+
+typedef struct {
+    VectorStatementKind kind;
+    Node *decl;
+    Node *expr;             // Accumulated per iteration, or the value of the temporary or element
+    BinaryType op;
+    VectorInduction *iv;    // Advanced by the statement
+    int reg;                // Partial sums or the temporary, one per lane
+} VectorStatement;
+
+typedef struct {
+    Node *leaf;
+    int reg;
+} VectorInvariant;
+
+typedef struct {
+    LoopStatistics stats;
+    LoopContext loop;
+    unsigned width;         // Of the elements in bytes
+    unsigned lanes;
+    Array *inductions;      // The counter comes first
+    Array *invariants;      // Splat across the lanes ahead of the loop
+    Array *statements;      // In the order of the body
+    unsigned registers;     // Taken throughout the loop, expression temporaries follow
+    unsigned temps;         // Most expression temporaries taken by a single statement
+} VectorPlan;
+
+bool Vectorize_Plan(Vectorizer *, VectorPlan *, Node *, Node *);
+void VectorPlan_Release(VectorPlan *);
+
+VectorInduction *VectorPlan_FindInduction(VectorPlan *, Node *);
+VectorStatement *VectorPlan_FindTemporary(VectorPlan *, Node *);
+VectorInvariant *VectorPlan_FindInvariant(VectorPlan *, Node *);
+
+#endif
@@ -1,14 +1,15 @@
-#ifndef LFLOW_XSTRING_H
-#define LFLOW_XSTRING_H
-
-typedef struct {
-    char *str;
-    unsigned int length;
-} XString;
-
-XString *XString_Create();
-void XString_Destroy(XString *);
-void XString_Append(XString *, char);
-char XString_Last(XString *);
-
+#ifndef LFLOW_XSTRING_H
+#define LFLOW_XSTRING_H
+
+typedef struct {
+    char *str;
+    unsigned int length;
+    unsigned int capacity;  // Allocated bytes, the terminator included, doubled when full
+} XString;
+
+XString *XString_Create();
+void XString_Destroy(XString *);
+void XString_Append(XString *, char);
+char XString_Last(XString *);
+
 #endif
\ No newline at end of file
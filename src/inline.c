@@ -0,0 +1,771 @@
+#include "include/inline.h"
+#include "include/deadcode.h"
+#include "include/optimize.h"
+#include "include/param.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "include/memory.h"
+
+Inliner *Inliner_Create(int threshold, bool report) {
+    Inliner *inl = malloc(sizeof(Inliner));
+    inl->threshold = threshold;
+    inl->report = report;
+    inl->rejected = Array_Create();
+    inl->profile = NULL;
+    inl->temps = 0;
+    inl->inlined = 0;
+    inl->declined = 0;
+    return inl;
+}
+
+void Inliner_Destroy(Inliner *inl) {
+    Array_Destroy(inl->rejected);
+    free(inl);
+}
+
+// Number of nodes in a subtree
+unsigned Inline_Size(Node *n) {
+    if (!n)
+        return 0;
+
+    unsigned size = 1;
+
+    switch (n->type) {
+        case NODE_VARIABLE_DECLARATION:
+            return size + Inline_Size(n->node.var_decl.value);
+        case NODE_VARIABLE_ASSIGNMENT:
+            return size + Inline_Size(n->node.var_assign.value) + Inline_Size(n->node.var_assign.index);
+        case NODE_INDEX:
+            return size + Inline_Size(n->node.index.expr);
+        case NODE_REDUCE:
+            return size + Inline_Size(n->node.reduce.expr);
+        case NODE_BINARY_EXPRESSION:
+            return size + Inline_Size(n->node.binary.left) + Inline_Size(n->node.binary.right);
+        case NODE_FUNCTION_CALL:
+            for (unsigned i = 0; i < n->node.fcall.exprs->length; i++)
+                size += Inline_Size(Array_At(n->node.fcall.exprs, i));
+            return size;
+        case NODE_BLOCK:
+            size = 0;
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                size += Inline_Size(Array_At(n->node.block.nodes, i));
+            return size;
+        case NODE_FUNCTION_DEFINITION:
+            return size + Inline_Size(n->node.func_def.block);
+        case NODE_RETURN:
+            return size + Inline_Size(n->node.ret.expr);
+        case NODE_CHECK:
+            return size + Inline_Size(n->node.check.expr) + Inline_Size(n->node.check.block) +
+                   Inline_Size(n->node.check.sub);
+        case NODE_LOOP:
+            return size + Inline_Size(n->node.loop.from) + Inline_Size(n->node.loop.to) +
+                   Inline_Size(n->node.loop.block);
+        default:
+            return size;
+    }
+}
+
+bool Inline_ContainsReturn(Node *n) {
+    if (!n)
+        return false;
+
+    switch (n->type) {
+        case NODE_RETURN:
+            return true;
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                if (Inline_ContainsReturn(Array_At(n->node.block.nodes, i)))
+                    return true;
+            return false;
+        case NODE_CHECK:
+            return Inline_ContainsReturn(n->node.check.block) || Inline_ContainsReturn(n->node.check.sub);
+        case NODE_LOOP:
+            return Inline_ContainsReturn(n->node.loop.block);
+        default:
+            return false;
+    }
+}
+
+// Jumps would turn into ordinary calls within the body of the caller
+bool Inline_ContainsJump(Node *n) {
+    if (!n)
+        return false;
+
+    switch (n->type) {
+        case NODE_RETURN:
+            return n->node.ret.jump;
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                if (Inline_ContainsJump(Array_At(n->node.block.nodes, i)))
+                    return true;
+            return false;
+        case NODE_CHECK:
+            return Inline_ContainsJump(n->node.check.block) || Inline_ContainsJump(n->node.check.sub);
+        case NODE_LOOP:
+            return Inline_ContainsJump(n->node.loop.block);
+        default:
+            return false;
+    }
+}
+
+bool Inline_ContainsDefinition(Node *n) {
+    if (!n)
+        return false;
+
+    switch (n->type) {
+        case NODE_FUNCTION_DEFINITION:
+            return true;
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                if (Inline_ContainsDefinition(Array_At(n->node.block.nodes, i)))
+                    return true;
+            return false;
+        case NODE_CHECK:
+            return Inline_ContainsDefinition(n->node.check.block) || Inline_ContainsDefinition(n->node.check.sub);
+        case NODE_LOOP:
+            return Inline_ContainsDefinition(n->node.loop.block);
+        default:
+            return false;
+    }
+}
+
+bool Inline_HasOtherwise(Node *chk) {
+    for (; chk; chk = chk->node.check.sub)
+        if (!chk->node.check.expr)
+            return true;
+    return false;
+}
+
+// Whether the block is the given one or nested within it
+bool Inline_Within(Node *blk, Node *scope) {
+    for (; blk; blk = blk->node.block.super)
+        if (blk == scope)
+            return true;
+    return false;
+}
+
+// Whether the statement assigns to the variable
+bool Inline_Assigns(Node *n, Node *decl) {
+    if (!n)
+        return false;
+
+    switch (n->type) {
+        case NODE_VARIABLE_ASSIGNMENT:
+            return n->node.var_assign.decl == decl;
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                if (Inline_Assigns(Array_At(n->node.block.nodes, i), decl))
+                    return true;
+            return false;
+        case NODE_CHECK:
+            return Inline_Assigns(n->node.check.block, decl) || Inline_Assigns(n->node.check.sub, decl);
+        case NODE_LOOP:
+            return Inline_Assigns(n->node.loop.block, decl);
+        default:
+            return false;
+    }
+}
+
+// Whether the body may change variables declared outside of it, calls included
+bool Inline_WritesOutward(Node *n, Node *body) {
+    if (!n)
+        return false;
+
+    switch (n->type) {
+        case NODE_VARIABLE_ASSIGNMENT:
+            return !Inline_Within(n->node.var_assign.decl->super, body) || Node_HasSideEffects(n->node.var_assign.value) ||
+                   Node_HasSideEffects(n->node.var_assign.index);
+        case NODE_VARIABLE_DECLARATION:
+            return Node_HasSideEffects(n->node.var_decl.value);
+        case NODE_RETURN:
+            return Node_HasSideEffects(n->node.ret.expr);
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                if (Inline_WritesOutward(Array_At(n->node.block.nodes, i), body))
+                    return true;
+            return false;
+        case NODE_CHECK:
+            return Node_HasSideEffects(n->node.check.expr) || Inline_WritesOutward(n->node.check.block, body) ||
+                   Inline_WritesOutward(n->node.check.sub, body);
+        case NODE_LOOP:
+            return Node_HasSideEffects(n->node.loop.from) || Node_HasSideEffects(n->node.loop.to) ||
+                   Inline_WritesOutward(n->node.loop.block, body);
+        default:
+            return Node_HasSideEffects(n);
+    }
+}
+
+// Whether the body only returns at its end. A check whose alternatives all return
+// guards the statements after it, which are then moved into a final 'otherwise'.
+bool Inline_TailReturns(Array *stmts, unsigned from) {
+    for (unsigned k = from; k < stmts->length; k++) {
+        Node *s = Array_At(stmts, k);
+        bool last = k == stmts->length - 1;
+
+        // Anything past it is dead
+        if (s->type == NODE_RETURN)
+            return true;
+
+        if (!Inline_ContainsReturn(s))
+            continue;
+
+        if (s->type == NODE_BLOCK) {
+            if (!Inline_TailReturns(s->node.block.nodes, 0))
+                return false;
+            if (last || DeadCode_Terminates(s))
+                return true;
+            return false;
+        }
+
+        if (s->type == NODE_CHECK) {
+            bool all = true;
+
+            for (Node *chk = s; chk; chk = chk->node.check.sub) {
+                if (!Inline_TailReturns(chk->node.check.block->node.block.nodes, 0))
+                    return false;
+                if (!DeadCode_Terminates(chk->node.check.block))
+                    all = false;
+            }
+
+            if (last)
+                return true;
+
+            if (!all)
+                return false;
+
+            if (Inline_HasOtherwise(s))
+                return true;
+
+            return Inline_TailReturns(stmts, k + 1);
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+typedef struct {
+    Array *from;    // Declarations of the procedure
+    Array *to;      // } and their copies at the call site
+    Node *result;   // Receives returned values, NULL if they are discarded
+} InlineContext;
+
+Node *Inline_Map(InlineContext *ctx, Node *decl) {
+    for (unsigned i = 0; i < ctx->from->length; i++)
+        if (Array_At(ctx->from, i) == decl)
+            return Array_At(ctx->to, i);
+    return decl;
+}
+
+Node *Inline_CopyExpression(InlineContext *ctx, Node *n, Node *super) {
+    Node *c;
+
+    switch (n->type) {
+        case NODE_INTEGER_LITERAL:
+        case NODE_FLOAT_LITERAL:
+            return Node_DuplicateLiteral(n, super);
+
+        case NODE_VARIABLE_REFERENCE:
+            return Node_Reference(Inline_Map(ctx, n->node.var_ref.decl), super);
+
+        case NODE_STRING_LITERAL:
+            c = Node_CreateStringLiteral(n->node.str_lit.str, n->node.str_lit.id);
+            c->super = super;
+            break;
+
+        case NODE_BINARY_EXPRESSION:
+            c = Node_CreateBinaryOperation(Inline_CopyExpression(ctx, n->node.binary.left, super),
+                                           Inline_CopyExpression(ctx, n->node.binary.right, super),
+                                           n->node.binary.op, super);
+            break;
+
+        case NODE_FUNCTION_CALL: {
+            Array *args = Array_Create();
+            for (unsigned i = 0; i < n->node.fcall.exprs->length; i++)
+                Array_Push(args, Inline_CopyExpression(ctx, Array_At(n->node.fcall.exprs, i), super));
+            c = Node_CreateFunctionCall(n->node.fcall.id, args, super);
+            c->node.fcall.def = n->node.fcall.def;
+            if (c->node.fcall.def)
+                c->node.fcall.def->node.func_def.refs++;
+            break;
+        }
+
+        case NODE_SIZE:
+            c = Node_CreateSize(n->node.size.type, super);
+            break;
+
+        case NODE_INDEX:
+            c = Node_CreateIndex(Inline_CopyExpression(ctx, n->node.index.array, super),
+                                 Inline_CopyExpression(ctx, n->node.index.expr, super), super);
+            c->node.index.checked = n->node.index.checked;
+            break;
+
+        case NODE_REDUCE:
+            c = Node_CreateReduce(Inline_CopyExpression(ctx, n->node.reduce.expr, super), super);
+            break;
+
+        default:
+            return NULL;
+    }
+
+    c->etype = n->etype;
+    return c;
+}
+
+void Inline_CopyStatements(InlineContext *, Array *, unsigned, Node *);
+
+Node *Inline_CopyBlock(InlineContext *ctx, Node *blk, Node *super) {
+    Node *c = Node_CreateBlock(Array_Create(), super);
+    Inline_CopyStatements(ctx, blk->node.block.nodes, 0, c);
+    return c;
+}
+
+Node *Inline_CopyCheck(InlineContext *ctx, Node *chk, Node *super) {
+    Node *head = NULL;
+    Node *tail = NULL;
+
+    for (; chk; chk = chk->node.check.sub) {
+        Node *expr = chk->node.check.expr ? Inline_CopyExpression(ctx, chk->node.check.expr, super) : NULL;
+        Node *c = Node_CreateCheck(expr, Inline_CopyBlock(ctx, chk->node.check.block, super), NULL, super);
+        c->node.check.taken = chk->node.check.taken;
+        c->node.check.missed = chk->node.check.missed;
+
+        if (tail)
+            tail->node.check.sub = c;
+        else
+            head = c;
+
+        tail = c;
+    }
+
+    return head;
+}
+
+Node *Inline_CopyLoop(InlineContext *ctx, Node *loop, Node *super) {
+    Node *var = loop->node.loop.var;
+    Node *from = Inline_CopyExpression(ctx, loop->node.loop.from, super);
+    Node *to = Inline_CopyExpression(ctx, loop->node.loop.to, super);
+    Node *blk = Node_CreateBlock(Array_Create(), super);
+
+    Node *c = Node_DeclareVariable(var->node.var_decl.id, NULL, var->node.var_decl.type, MQ_CONST, blk);
+    Array_Push(ctx->from, var);
+    Array_Push(ctx->to, c);
+
+    Inline_CopyStatements(ctx, loop->node.loop.block->node.block.nodes, 0, blk);
+
+    return Node_CreateLoop(c, from, to, blk, super);
+}
+
+// Returns NULL for statements that vanish at the call site
+Node *Inline_CopyStatement(InlineContext *ctx, Node *s, Node *dst) {
+    switch (s->type) {
+        case NODE_VARIABLE_DECLARATION: {
+            Node *value = s->node.var_decl.value ? Inline_CopyExpression(ctx, s->node.var_decl.value, dst) : NULL;
+            Node *d = Node_DeclareVariable(s->node.var_decl.id, value, s->node.var_decl.type, s->node.var_decl.mutable,
+                                           dst);
+            Array_Push(ctx->from, s);
+            Array_Push(ctx->to, d);
+            return d;
+        }
+
+        // A dead element store may be left without a value, checking its index alone
+        case NODE_VARIABLE_ASSIGNMENT: {
+            Node *value = s->node.var_assign.value ? Inline_CopyExpression(ctx, s->node.var_assign.value, dst) : NULL;
+            Node *a = Node_CreateVariableAssignment(s->node.var_assign.id, value, dst);
+            a->node.var_assign.decl = Inline_Map(ctx, s->node.var_assign.decl);
+            if (s->node.var_assign.index) {
+                a->node.var_assign.index = Inline_CopyExpression(ctx, s->node.var_assign.index, dst);
+                a->node.var_assign.checked = s->node.var_assign.checked;
+            }
+            return a;
+        }
+
+        // Returns only occur at the end of the body, so they become a store of the result
+        case NODE_RETURN: {
+            Node *expr = s->node.ret.expr;
+
+            if (!expr)
+                return NULL;
+
+            if (ctx->result) {
+                Node *a = Node_CreateVariableAssignment(ctx->result->node.var_decl.id,
+                                                        Inline_CopyExpression(ctx, expr, dst), dst);
+                a->node.var_assign.decl = ctx->result;
+                return a;
+            }
+
+            if (Node_HasSideEffects(expr))
+                return Inline_CopyExpression(ctx, expr, dst);
+
+            return NULL;
+        }
+
+        case NODE_BLOCK:
+            return Inline_CopyBlock(ctx, s, dst);
+
+        case NODE_CHECK:
+            return Inline_CopyCheck(ctx, s, dst);
+
+        case NODE_LOOP:
+            return Inline_CopyLoop(ctx, s, dst);
+
+        default:
+            return Inline_CopyExpression(ctx, s, dst);
+    }
+}
+
+void Inline_CopyStatements(InlineContext *ctx, Array *src, unsigned from, Node *dst) {
+    Array *nodes = dst->node.block.nodes;
+
+    for (unsigned k = from; k < src->length; k++) {
+        Node *s = Array_At(src, k);
+        bool last = k == src->length - 1;
+
+        // A guarding check: the rest only runs when none of its alternatives is taken
+        if (s->type == NODE_CHECK && !last && Inline_ContainsReturn(s) && !Inline_HasOtherwise(s)) {
+            Node *chk = Inline_CopyCheck(ctx, s, dst);
+
+            Node *tail = chk;
+            while (tail->node.check.sub)
+                tail = tail->node.check.sub;
+
+            Node *rest = Node_CreateBlock(Array_Create(), dst);
+            Inline_CopyStatements(ctx, src, k + 1, rest);
+            tail->node.check.sub = Node_CreateCheck(NULL, rest, NULL, dst);
+
+            // The rest runs whenever the guard would have been missed
+            tail->node.check.sub->node.check.taken = tail->node.check.missed;
+            tail->node.check.missed = (ProfileCounter) {0, 0};
+
+            Array_Push(nodes, chk);
+            return;
+        }
+
+        Node *c = Inline_CopyStatement(ctx, s, dst);
+
+        if (c)
+            Array_Push(nodes, c);
+
+        if (DeadCode_Terminates(s))
+            return;
+    }
+}
+
+// Replace the call held in the slot by the body of the procedure, placed ahead of the statement.
+// Returns whether the statement itself was the call and has been consumed.
+bool Inline_Call(Inliner *inl, Node *blk, Node *stmt, Node **slot) {
+    Node *call = *slot;
+    Node *def = call->node.fcall.def;
+    Array *nodes = blk->node.block.nodes;
+    bool discard = call == stmt;
+
+    unsigned at = 0;
+    while (Array_At(nodes, at) != stmt)
+        at++;
+
+    InlineContext ctx = {Array_Create(), Array_Create(), NULL};
+
+    if (!discard && def->node.func_def.type->type != TYPE_VOID) {
+        char name[32];
+        snprintf(name, sizeof(name), "inl.%u", inl->temps++);
+
+        Token *id = Token_Create(name, TT_IDEN);
+        ctx.result = Node_DeclareVariable(id, NULL, def->node.func_def.type, MQ_VARYING, blk);
+        Token_Destroy(id);
+
+        Array_Insert(nodes, at++, ctx.result);
+    }
+
+    Node *body = Node_CreateBlock(Array_Create(), blk);
+
+    // Bind the arguments to copies of the parameters. Parameters the procedure never
+    // assigns to are bound as constants so that literal arguments get propagated.
+    Array *args = call->node.fcall.exprs;
+
+    for (unsigned i = 0; i < args->length; i++) {
+        FunctionParameter *param = Array_At(def->node.func_def.params, i);
+        Node *decl = Array_At(def->node.func_def.param_decls, i);
+        ModificationQualifier modQua = Inline_Assigns(def->node.func_def.block, decl) ? MQ_VARYING : MQ_CONST;
+
+        Node *copy = Node_DeclareVariable(param->id, Array_At(args, i), decl->node.var_decl.type, modQua, body);
+        Array_Push(body->node.block.nodes, copy);
+
+        Array_Push(ctx.from, decl);
+        Array_Push(ctx.to, copy);
+    }
+
+    Array_Destroy(args);
+    call->node.fcall.exprs = Array_Create();
+
+    Inline_CopyStatements(&ctx, def->node.func_def.block->node.block.nodes, 0, body);
+
+    Array_Insert(nodes, at, body);
+
+    Node_Unreference(call);
+
+    if (discard)
+        Array_Remove(nodes, at + 1);
+    else
+        *slot = Node_Reference(ctx.result, call->super);
+
+    Node_DestroyRecurse(call);
+
+    Array_Destroy(ctx.from);
+    Array_Destroy(ctx.to);
+
+    return discard;
+}
+
+typedef struct {
+    bool call;      // A call is evaluated before the current point
+    Array *reads;   // Variables read before the current point
+} InlineScan;
+
+// Whether any of the first n variables read is visible to the procedure
+bool Inline_ReadsVisible(Array *reads, unsigned n, Node *def) {
+    for (unsigned i = 0; i < n; i++) {
+        Node *decl = Array_At(reads, i);
+        if (Inline_Within(def->node.func_def.block, decl->super))
+            return true;
+    }
+    return false;
+}
+
+bool Inline_Decide(Inliner *inl, Node *call, Node *fn, bool conditional, bool called, Array *reads, unsigned nreads) {
+    Node *def = call->node.fcall.def;
+
+    if (!def)
+        return false;
+
+    Inline_Procedure(inl, def);
+
+    Array *args = call->node.fcall.exprs;
+    bool impure_args = false;
+    int bonus = 0;
+
+    for (unsigned i = 0; i < args->length; i++) {
+        Node *arg = Array_At(args, i);
+        Node *param = Array_At(def->node.func_def.param_decls, i);
+
+        if (Node_IsLiteral(arg))
+            bonus += INLINE_CONSTANT_BONUS * (int) param->node.var_decl.refs;
+
+        if (Node_HasSideEffects(arg))
+            impure_args = true;
+    }
+
+    int cost = (int) Inline_Size(def->node.func_def.block) - INLINE_CALL_COST - (int) args->length;
+    int limit = inl->threshold;
+
+    // The out-of-line copy disappears along with its only call site
+    if (def->node.func_def.refs == 1)
+        limit *= INLINE_SINGLE_SITE_FACTOR;
+
+    bool guided = Profile_Guides(inl->profile);
+
+    if (guided && Profile_Hot(inl->profile, def->node.func_def.entered.count))
+        limit *= INLINE_HOT_FACTOR;
+
+    const char *reason = NULL;
+
+    if (def->node.func_def.external)
+        reason = "defined in another module";
+    else if (def == fn || def->node.func_def.inline_state == 1)
+        reason = "recursive call";
+    else if (conditional)
+        reason = "only conditionally evaluated";
+    else if (Inline_ContainsDefinition(def->node.func_def.block))
+        reason = "defines nested procedures";
+    else if (Inline_ContainsJump(def->node.func_def.block))
+        reason = "contains guaranteed tail calls";
+    else if (!Inline_TailReturns(def->node.func_def.block->node.block.nodes, 0))
+        reason = "returns before its end";
+    else if (guided && def->node.func_def.entered.count == 0)
+        reason = "never entered in the profile";
+    else if (cost - bonus > limit)
+        reason = "too large";
+    else if (called)
+        reason = "an earlier call in the statement would run after it";
+    else if (nreads > 0 && (impure_args || (Inline_WritesOutward(def->node.func_def.block, def->node.func_def.block) &&
+                                            Inline_ReadsVisible(reads, nreads, def))))
+        reason = "may change variables read earlier in the statement";
+
+    const char *caller = fn ? fn->node.func_def.id->value : "(program)";
+
+    if (reason) {
+        for (unsigned i = 0; i < inl->rejected->length; i++)
+            if (Array_At(inl->rejected, i) == call)
+                return false;
+
+        Array_Push(inl->rejected, call);
+        inl->declined++;
+
+        if (inl->report) {
+            OPTIMIZE_PRINT("Not inlining '%s' into '%s': %s (cost %d, bonus %d, limit %d).\n",
+                           def->node.func_def.id->value, caller, reason, cost, bonus, limit);
+        }
+
+        return false;
+    }
+
+    inl->inlined++;
+
+    if (inl->report) {
+        OPTIMIZE_PRINT("Inlining '%s' into '%s' (cost %d, bonus %d, limit %d).\n", def->node.func_def.id->value,
+                       caller, cost, bonus, limit);
+    }
+
+    return true;
+}
+
+// Find the first call in evaluation order that should be inlined
+Node **Inline_Find(Inliner *inl, Node **slot, Node *fn, bool conditional, InlineScan *scan) {
+    Node *n = *slot;
+
+    if (!n)
+        return NULL;
+
+    switch (n->type) {
+        case NODE_VARIABLE_REFERENCE:
+            Array_Push(scan->reads, n->node.var_ref.decl);
+            return NULL;
+
+        // The element is read once the index has been computed
+        case NODE_INDEX: {
+            Node **found = Inline_Find(inl, &n->node.index.expr, fn, conditional, scan);
+            if (!found)
+                Array_Push(scan->reads, n->node.index.array->node.var_ref.decl);
+            return found;
+        }
+
+        case NODE_REDUCE:
+            return Inline_Find(inl, &n->node.reduce.expr, fn, conditional, scan);
+
+        case NODE_BINARY_EXPRESSION: {
+            Node **found = Inline_Find(inl, &n->node.binary.left, fn, conditional, scan);
+            if (found)
+                return found;
+
+            // The right-hand side of '&&' and '||' is only evaluated conditionally
+            bool cond = conditional || n->node.binary.op == BIN_AND || n->node.binary.op == BIN_OR;
+            return Inline_Find(inl, &n->node.binary.right, fn, cond, scan);
+        }
+
+        case NODE_FUNCTION_CALL: {
+            bool called = scan->call;
+            unsigned nreads = scan->reads->length;
+            Array *args = n->node.fcall.exprs;
+
+            for (unsigned i = 0; i < args->length; i++) {
+                Node **found = Inline_Find(inl, (Node **) &args->base[i], fn, conditional, scan);
+                if (found)
+                    return found;
+            }
+
+            if (Inline_Decide(inl, n, fn, conditional, called, scan->reads, nreads))
+                return slot;
+
+            scan->call = true;
+            return NULL;
+        }
+
+        default:
+            return NULL;
+    }
+}
+
+// Inline the calls of an expression of the statement. Returns whether the statement has been consumed.
+bool Inline_Statement(Inliner *inl, Node *blk, Node *stmt, Node **slot, Node *fn) {
+    while (true) {
+        InlineScan scan = {false, Array_Create()};
+        Node **found = Inline_Find(inl, slot, fn, false, &scan);
+        Array_Destroy(scan.reads);
+
+        if (!found)
+            return false;
+
+        if (Inline_Call(inl, blk, stmt, found))
+            return true;
+    }
+}
+
+void Inline_Procedure(Inliner *inl, Node *def) {
+    if (def->node.func_def.inline_state != 0)
+        return;
+
+    def->node.func_def.inline_state = 1;
+    Inline_Block(inl, def->node.func_def.block, def);
+    def->node.func_def.inline_state = 2;
+}
+
+// Callees are processed before their callers, so inlined bodies need no further work
+void Inline_Block(Inliner *inl, Node *blk, Node *fn) {
+    Array *nodes = blk->node.block.nodes;
+
+    unsigned i = 0;
+    while (i < nodes->length) {
+        Node *stmt = Array_At(nodes, i);
+        Node *next = Array_At(nodes, i + 1);
+        bool consumed = false;
+
+        switch (stmt->type) {
+            case NODE_FUNCTION_DEFINITION:
+                Inline_Procedure(inl, stmt);
+                break;
+
+            case NODE_BLOCK:
+                Inline_Block(inl, stmt, fn);
+                break;
+
+            // Only the first condition is evaluated unconditionally
+            case NODE_CHECK:
+                Inline_Statement(inl, blk, stmt, &stmt->node.check.expr, fn);
+                for (Node *chk = stmt; chk; chk = chk->node.check.sub)
+                    Inline_Block(inl, chk->node.check.block, fn);
+                break;
+
+            // Inlining the bound would move it ahead of the first value
+            case NODE_LOOP:
+                Inline_Statement(inl, blk, stmt, &stmt->node.loop.from, fn);
+                Inline_Block(inl, stmt->node.loop.block, fn);
+                break;
+
+            case NODE_VARIABLE_DECLARATION:
+                Inline_Statement(inl, blk, stmt, &stmt->node.var_decl.value, fn);
+                break;
+
+            case NODE_VARIABLE_ASSIGNMENT:
+                Inline_Statement(inl, blk, stmt, &stmt->node.var_assign.value, fn);
+                break;
+
+            case NODE_RETURN:
+                Inline_Statement(inl, blk, stmt, &stmt->node.ret.expr, fn);
+                break;
+
+            default: {
+                Node *root = stmt;
+                consumed = Inline_Statement(inl, blk, stmt, &root, fn);
+                break;
+            }
+        }
+
+        // Inlined bodies have been inserted ahead of the statement
+        Node *resume = consumed ? next : stmt;
+
+        if (!resume)
+            break;
+
+        while (Array_At(nodes, i) != resume)
+            i++;
+
+        if (!consumed)
+            i++;
+    }
+}
+
+void Inline_Program(Inliner *inl, Node *program) {
+    inl->profile = program->node.program.profile;
+    Inline_Block(inl, program->node.program.nodes, NULL);
+}
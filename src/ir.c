@@ -0,0 +1,1422 @@
+#include "include/ir.h"
+#include "include/param.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "include/memory.h"
+
+#define CASE(x) case x: return #x;
+
+const char *IrOpcode_ToString(IrOpcode op) {
+    switch (op) {
+        CASE(IR_IMMEDIATE)
+        CASE(IR_MOVE)
+        CASE(IR_EXTEND)
+        CASE(IR_ADD)
+        CASE(IR_SUB)
+        CASE(IR_MUL)
+        CASE(IR_DIV)
+        CASE(IR_EQUAL)
+        CASE(IR_GREATER)
+        CASE(IR_LESS)
+        CASE(IR_LOAD)
+        CASE(IR_STORE)
+        CASE(IR_CHECK)
+        CASE(IR_ELEMENT)
+        CASE(IR_SET_ELEMENT)
+        CASE(IR_CLEAR)
+        CASE(IR_PARAMETER)
+        CASE(IR_CALL)
+        CASE(IR_TAIL_CALL)
+        CASE(IR_RETURN)
+        CASE(IR_JUMP)
+        CASE(IR_BRANCH)
+        CASE(IR_BRANCH_SET)
+        CASE(IR_LABEL)
+        CASE(IR_VSPLAT)
+        CASE(IR_VSERIES)
+        CASE(IR_VADD)
+        CASE(IR_VSUB)
+        CASE(IR_VMUL)
+        CASE(IR_VSUM)
+        CASE(IR_VLOAD)
+        CASE(IR_VSTORE)
+        CASE(IR_VEND)
+        CASE(IR_ADDRESS)
+        CASE(IR_PSPLAT)
+        CASE(IR_PADD)
+        CASE(IR_PSUB)
+        CASE(IR_PMUL)
+        CASE(IR_PSUM)
+        CASE(IR_PCOPY)
+        CASE(IR_STRING)
+        CASE(IR_COUNT)
+        default:
+            return "Unknown opcode";
+    }
+}
+
+#undef CASE
+
+IrModule *IrModule_Create() {
+    IrModule *module = malloc(sizeof(IrModule));
+    module->functions = Array_Create();
+    module->externals = Array_Create();
+    module->globals = Array_Create();
+    module->tail_calls = 0;
+    module->vector = 0;
+    module->isa = VECTOR_SSE2;
+    module->strings = NULL;
+    module->profile = NULL;
+    module->cold = 0;
+    module->entry = true;
+    return module;
+}
+
+void IrFunction_Destroy(IrFunction *fn) {
+    for (unsigned i = 0; i < fn->code->length; i++) {
+        IrInstruction *ins = Array_At(fn->code, i);
+        free(ins->args);
+        free(ins);
+    }
+
+    Array_Destroy(fn->code);
+    Array_DestroyCallBack(fn->arrays, free);
+    free(fn->widths);
+    free(fn->name);
+    free(fn);
+}
+
+void IrGlobal_Destroy(IrGlobal *global) {
+    free(global->name);
+    free(global);
+}
+
+void IrModule_Destroy(IrModule *module) {
+    Array_DestroyCallBack(module->functions, (void *) IrFunction_Destroy);
+    Array_DestroyCallBack(module->externals, (void *) IrFunction_Destroy);
+    Array_DestroyCallBack(module->globals, (void *) IrGlobal_Destroy);
+    free(module);
+}
+
+IrFunction *IrModule_FindFunction(IrModule *module, Node *def) {
+    for (unsigned i = 0; i < module->functions->length; i++) {
+        IrFunction *fn = Array_At(module->functions, i);
+        if (fn->def == def)
+            return fn;
+    }
+    for (unsigned i = 0; i < module->externals->length; i++) {
+        IrFunction *fn = Array_At(module->externals, i);
+        if (fn->def == def)
+            return fn;
+    }
+    return NULL;
+}
+
+IrGlobal *IrModule_FindGlobal(IrModule *module, Node *decl) {
+    for (unsigned i = 0; i < module->globals->length; i++) {
+        IrGlobal *global = Array_At(module->globals, i);
+        if (global->decl == decl)
+            return global;
+    }
+    return NULL;
+}
+
+IrArray *IrFunction_FindArray(IrFunction *fn, Node *decl) {
+    for (unsigned i = 0; i < fn->arrays->length; i++) {
+        IrArray *array = Array_At(fn->arrays, i);
+        if (array->decl == decl)
+            return array;
+    }
+    return NULL;
+}
+
+// Size of a primitive in bytes, 0 for anything else
+unsigned Ir_Width(Type *type) {
+    if (!type || type->type != TYPE_PRIMITIVE)
+        return 0;
+
+    return Type_Quantify(type) / 8;
+}
+
+// The value as a register of the given width holds it, sign-extended from there
+long long Ir_Truncate(long long value, unsigned width) {
+    if (width >= 8)
+        return value;
+
+    unsigned shift = 64 - 8 * width;
+    return (long long) ((unsigned long long) value << shift) >> shift;
+}
+
+bool IrInstruction_Uses(IrInstruction *ins, int vreg) {
+    if (vreg == IR_NONE)
+        return false;
+
+    if (ins->a == vreg || ins->b == vreg)
+        return true;
+
+    for (unsigned i = 0; i < ins->nargs; i++)
+        if (ins->args[i] == vreg)
+            return true;
+
+    return false;
+}
+
+bool Ir_Defined(IrModule *module, const char *sym) {
+    for (unsigned i = 0; i < module->functions->length; i++)
+        if (strcmp(((IrFunction *) Array_At(module->functions, i))->name, sym) == 0)
+            return true;
+
+    return false;
+}
+
+// Symbols are derived from the source names, made unique where procedures share one. Those
+// linked between modules are qualified by the module instead, in which they are unique.
+char *Ir_Symbol(IrModule *module, Node *def) {
+    const char *name = def->node.func_def.id->value;
+    char *sym = malloc(strlen(name) + 24 + (def->node.func_def.module ? strlen(def->node.func_def.module) : 0));
+
+    if (def->node.func_def.module) {
+        sprintf(sym, "flow.%s.%s", def->node.func_def.module, name);
+        return sym;
+    }
+
+    sprintf(sym, "flow.%s", name);
+
+    // Procedures of the same name in different scopes are numbered in the order they are lowered,
+    // rather than by where they stand in the module, so that their code can be cached
+    for (unsigned k = 1; Ir_Defined(module, sym); k++)
+        sprintf(sym, "flow.%s.%u", name, k);
+
+    return sym;
+}
+
+IrFunction *IrFunction_Create(IrModule *module, Node *def) {
+    IrFunction *fn = malloc(sizeof(IrFunction));
+
+    if (def) {
+        fn->name = Ir_Symbol(module, def);
+    } else {
+        fn->name = malloc(5);
+        strcpy(fn->name, "main");
+    }
+
+    fn->def = def;
+    fn->code = Array_Create();
+    fn->widths = NULL;
+    fn->vregs = 0;
+    fn->labels = 0;
+    fn->arrays = Array_Create();
+    fn->frame = 0;
+
+    Array_Push(def && def->node.func_def.external ? module->externals : module->functions, fn);
+    return fn;
+}
+
+int IrFunction_Register(IrFunction *fn, unsigned width) {
+    fn->widths = realloc(fn->widths, (fn->vregs + 1) * sizeof(unsigned));
+    fn->widths[fn->vregs] = width;
+    return (int) fn->vregs++;
+}
+
+IrInstruction *IrFunction_Emit(IrFunction *fn, IrOpcode op, int dst, int a, int b, unsigned width) {
+    IrInstruction *ins = malloc(sizeof(IrInstruction));
+    ins->op = op;
+    ins->dst = dst;
+    ins->a = a;
+    ins->b = b;
+    ins->imm = 0;
+    ins->width = width;
+    ins->label = 0;
+    ins->target = NULL;
+    ins->args = NULL;
+    ins->nargs = 0;
+    ins->vd = IR_NONE;
+    ins->va = IR_NONE;
+    ins->vb = IR_NONE;
+    ins->size = 0;
+    Array_Push(fn->code, ins);
+    return ins;
+}
+
+// Room in the frame, returns its offset
+unsigned IrFunction_Reserve(IrFunction *fn, unsigned size) {
+    unsigned offset = fn->frame;
+    fn->frame += (size + 7) / 8 * 8;
+    return offset;
+}
+
+IrInstruction *IrFunction_EmitVector(IrFunction *fn, IrOpcode op, int vd, int va, int vb, unsigned width) {
+    IrInstruction *ins = IrFunction_Emit(fn, op, IR_NONE, IR_NONE, IR_NONE, width);
+    ins->vd = vd;
+    ins->va = va;
+    ins->vb = vb;
+    return ins;
+}
+
+void IrFunction_Label(IrFunction *fn, unsigned label) {
+    IrFunction_Emit(fn, IR_LABEL, IR_NONE, IR_NONE, IR_NONE, 0)->label = label;
+}
+
+void IrFunction_Jump(IrFunction *fn, IrOpcode op, int cond, unsigned label) {
+    IrInstruction *ins = IrFunction_Emit(fn, op, IR_NONE, cond, IR_NONE, cond == IR_NONE ? 0 : fn->widths[cond]);
+    ins->label = label;
+}
+
+typedef struct {
+    Node *decl;
+    int vreg;
+} IrLocal;
+
+typedef struct {
+    IrModule *module;
+    IrFunction *fn;
+    Array *locals;      // Variables of the function being lowered
+    Array *declared;    // } Every variable declaration
+    Array *owners;      // } and the procedure it belongs to, NULL for the top level
+    Vectorizer *vec;
+    Array *cold;        // Check alternatives of the function left to lower past its end
+    bool failed;
+} IrLowering;
+
+typedef struct {
+    Node *block;
+    unsigned label;     // Of the block
+    unsigned resume;    // Past the check
+} IrColdBlock;
+
+void IrLowering_Fail(IrLowering *l) {
+    l->failed = true;
+}
+
+int IrLowering_Local(IrLowering *l, Node *decl) {
+    for (unsigned i = 0; i < l->locals->length; i++) {
+        IrLocal *local = Array_At(l->locals, i);
+        if (local->decl == decl)
+            return local->vreg;
+    }
+    return IR_NONE;
+}
+
+void IrLowering_Declare(IrLowering *l, Node *decl, int vreg) {
+    IrLocal *local = malloc(sizeof(IrLocal));
+    local->decl = decl;
+    local->vreg = vreg;
+    Array_Push(l->locals, local);
+}
+
+Node *IrLowering_Owner(IrLowering *l, Node *decl, bool *found) {
+    for (unsigned i = 0; i < l->declared->length; i++) {
+        if (Array_At(l->declared, i) == decl) {
+            *found = true;
+            return Array_At(l->owners, i);
+        }
+    }
+    *found = false;
+    return NULL;
+}
+
+void IrLowering_Global(IrLowering *l, Node *decl) {
+    if (IrModule_FindGlobal(l->module, decl))
+        return;
+
+    // Scalars take a whole quadword
+    unsigned size = Type_Size(decl->node.var_decl.type);
+
+    IrGlobal *global = malloc(sizeof(IrGlobal));
+    global->decl = decl;
+    global->name = malloc(strlen(decl->node.var_decl.id->value) + 24);
+    global->size = size > 8 ? size : 8;
+    sprintf(global->name, "flow.var.%u.%s", l->module->globals->length, decl->node.var_decl.id->value);
+    Array_Push(l->module->globals, global);
+}
+
+// A variable accessed from a procedure other than its own. Top-level variables
+// are moved to memory, locals of enclosing procedures are not supported.
+void IrLowering_Access(IrLowering *l, Node *decl, Node *fn) {
+    if (!decl)
+        return;
+
+    bool found;
+    Node *owner = IrLowering_Owner(l, decl, &found);
+
+    if (found && owner == fn)
+        return;
+
+    if (!found || owner) {
+        EMIT_PRINT("Procedure '%s' accesses the variable '%s' of an enclosing procedure, which is not supported.\n",
+                   fn->node.func_def.id->value, decl->node.var_decl.id->value);
+        IrLowering_Fail(l);
+        return;
+    }
+
+    IrLowering_Global(l, decl);
+}
+
+void IrLowering_CollectExpression(IrLowering *l, Node *n, Node *fn) {
+    if (!n)
+        return;
+
+    switch (n->type) {
+        case NODE_VARIABLE_REFERENCE:
+            if (fn)
+                IrLowering_Access(l, n->node.var_ref.decl, fn);
+            break;
+        case NODE_INDEX:
+            IrLowering_CollectExpression(l, n->node.index.array, fn);
+            IrLowering_CollectExpression(l, n->node.index.expr, fn);
+            break;
+        case NODE_BINARY_EXPRESSION:
+            IrLowering_CollectExpression(l, n->node.binary.left, fn);
+            IrLowering_CollectExpression(l, n->node.binary.right, fn);
+            break;
+        case NODE_REDUCE:
+            IrLowering_CollectExpression(l, n->node.reduce.expr, fn);
+            break;
+        case NODE_FUNCTION_CALL:
+            for (unsigned i = 0; i < n->node.fcall.exprs->length; i++)
+                IrLowering_CollectExpression(l, Array_At(n->node.fcall.exprs, i), fn);
+            break;
+        default:
+            break;
+    }
+}
+
+// Find every procedure and the variables that have to live in memory
+void IrLowering_Collect(IrLowering *l, Node *n, Node *fn) {
+    if (!n)
+        return;
+
+    switch (n->type) {
+        case NODE_VARIABLE_DECLARATION:
+            Array_Push(l->declared, n);
+            Array_Push(l->owners, fn);
+            IrLowering_CollectExpression(l, n->node.var_decl.value, fn);
+
+            if (n->node.var_decl.type && n->node.var_decl.type->type == TYPE_VECTOR &&
+                Type_Size(n->node.var_decl.type) > l->module->isa) {
+                EMIT_PRINT("The vector '%s' of type '%s' needs AVX2, which --vectorize=avx2 enables.\n",
+                           n->node.var_decl.id->value, Type_Identifier(n->node.var_decl.type));
+                IrLowering_Fail(l);
+            }
+
+            // Top-level arrays are kept out of the frame of the program
+            if (!fn && n->node.var_decl.type && n->node.var_decl.type->type == TYPE_ARRAY)
+                IrLowering_Global(l, n);
+            break;
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            if (fn)
+                IrLowering_Access(l, n->node.var_assign.decl, fn);
+            IrLowering_CollectExpression(l, n->node.var_assign.value, fn);
+            IrLowering_CollectExpression(l, n->node.var_assign.index, fn);
+            break;
+
+        case NODE_RETURN:
+            IrLowering_CollectExpression(l, n->node.ret.expr, fn);
+            break;
+
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                IrLowering_Collect(l, Array_At(n->node.block.nodes, i), fn);
+            break;
+
+        case NODE_CHECK:
+            for (Node *chk = n; chk; chk = chk->node.check.sub) {
+                IrLowering_CollectExpression(l, chk->node.check.expr, fn);
+                IrLowering_Collect(l, chk->node.check.block, fn);
+            }
+            break;
+
+        case NODE_LOOP:
+            Array_Push(l->declared, n->node.loop.var);
+            Array_Push(l->owners, fn);
+            IrLowering_CollectExpression(l, n->node.loop.from, fn);
+            IrLowering_CollectExpression(l, n->node.loop.to, fn);
+            IrLowering_Collect(l, n->node.loop.block, fn);
+            break;
+
+        case NODE_FUNCTION_DEFINITION:
+            IrFunction_Create(l->module, n);
+            if (n->node.func_def.external)
+                break;
+            for (unsigned i = 0; i < n->node.func_def.param_decls->length; i++) {
+                Array_Push(l->declared, Array_At(n->node.func_def.param_decls, i));
+                Array_Push(l->owners, n);
+            }
+            IrLowering_Collect(l, n->node.func_def.block, n);
+            break;
+
+        default:
+            IrLowering_CollectExpression(l, n, fn);
+            break;
+    }
+}
+
+// Widen a value to the given width. Narrower uses simply read the low part of the register.
+int IrLowering_Coerce(IrLowering *l, int vreg, unsigned width) {
+    if (vreg == IR_NONE || l->fn->widths[vreg] >= width)
+        return vreg;
+
+    // A literal that has just been loaded is simply loaded wider
+    IrInstruction *last = Array_At(l->fn->code, l->fn->code->length - 1);
+
+    if (last && last->op == IR_IMMEDIATE && last->dst == vreg) {
+        last->width = width;
+        l->fn->widths[vreg] = width;
+        return vreg;
+    }
+
+    int r = IrFunction_Register(l->fn, width);
+    IrFunction_Emit(l->fn, IR_EXTEND, r, vreg, IR_NONE, width);
+    return r;
+}
+
+unsigned IrLowering_Width(IrLowering *l, Type *type, const char *what) {
+    unsigned width = Ir_Width(type);
+
+    if (width == 0) {
+        EMIT_PRINT("Values of type '%s' (%s) are not supported by the native backend.\n", Type_Identifier(type), what);
+        IrLowering_Fail(l);
+        return 8;
+    }
+
+    return width;
+}
+
+int IrLowering_Expression(IrLowering *, Node *);
+
+// '&&' and '||' only evaluate their right-hand side when needed
+int IrLowering_ShortCircuit(IrLowering *l, Node *n) {
+    IrFunction *fn = l->fn;
+    bool and = n->node.binary.op == BIN_AND;
+
+    int dst = IrFunction_Register(fn, IrLowering_Width(l, n->etype, "condition"));
+    unsigned done = fn->labels++;
+
+    IrFunction_Emit(fn, IR_IMMEDIATE, dst, IR_NONE, IR_NONE, fn->widths[dst]);
+
+    int left = IrLowering_Expression(l, n->node.binary.left);
+
+    if (and) {
+        IrFunction_Jump(fn, IR_BRANCH, left, done);
+        IrFunction_Jump(fn, IR_BRANCH, IrLowering_Expression(l, n->node.binary.right), done);
+        IrFunction_Emit(fn, IR_IMMEDIATE, dst, IR_NONE, IR_NONE, fn->widths[dst])->imm = 1;
+        IrFunction_Label(fn, done);
+        return dst;
+    }
+
+    unsigned right = fn->labels++;
+    unsigned one = fn->labels++;
+
+    IrFunction_Jump(fn, IR_BRANCH, left, right);
+    IrFunction_Jump(fn, IR_JUMP, IR_NONE, one);
+    IrFunction_Label(fn, right);
+    IrFunction_Jump(fn, IR_BRANCH, IrLowering_Expression(l, n->node.binary.right), done);
+    IrFunction_Label(fn, one);
+    IrFunction_Emit(fn, IR_IMMEDIATE, dst, IR_NONE, IR_NONE, fn->widths[dst])->imm = 1;
+    IrFunction_Label(fn, done);
+    return dst;
+}
+
+int IrLowering_Binary(IrLowering *l, Node *n) {
+    BinaryType op = n->node.binary.op;
+
+    if (op == BIN_AND || op == BIN_OR)
+        return IrLowering_ShortCircuit(l, n);
+
+    int a = IrLowering_Expression(l, n->node.binary.left);
+    int b = IrLowering_Expression(l, n->node.binary.right);
+
+    if (a == IR_NONE || b == IR_NONE)
+        return IR_NONE;
+
+    unsigned width = l->fn->widths[a] > l->fn->widths[b] ? l->fn->widths[a] : l->fn->widths[b];
+    a = IrLowering_Coerce(l, a, width);
+    b = IrLowering_Coerce(l, b, width);
+
+    IrOpcode code;
+
+    switch (op) {
+        case BIN_ADD:
+            code = IR_ADD;
+            break;
+        case BIN_SUB:
+            code = IR_SUB;
+            break;
+        case BIN_MUL:
+            code = IR_MUL;
+            break;
+        case BIN_DIV:
+            code = IR_DIV;
+            break;
+        case BIN_EQUAL:
+            code = IR_EQUAL;
+            break;
+        case BIN_LGREATER:
+            code = IR_GREATER;
+            break;
+        case BIN_RGREATER:
+            code = IR_LESS;
+            break;
+        default:
+            EMIT_PRINT("Unsupported binary operation %s.\n", BinaryType_ToString(op));
+            IrLowering_Fail(l);
+            return IR_NONE;
+    }
+
+    bool compare = code == IR_EQUAL || code == IR_GREATER || code == IR_LESS;
+    int dst = IrFunction_Register(l->fn, compare ? IrLowering_Width(l, n->etype, "comparison") : width);
+
+    IrFunction_Emit(l->fn, code, dst, a, b, width);
+    return dst;
+}
+
+int *IrLowering_Arguments(IrLowering *l, Node *n) {
+    Node *def = n->node.fcall.def;
+    Array *exprs = n->node.fcall.exprs;
+
+    int *args = malloc((exprs->length + 1) * sizeof(int));
+
+    for (unsigned i = 0; i < exprs->length; i++) {
+        Node *param = Array_At(def->node.func_def.param_decls, i);
+        int v = IrLowering_Expression(l, Array_At(exprs, i));
+        args[i] = IrLowering_Coerce(l, v, IrLowering_Width(l, param->node.var_decl.type, "parameter"));
+    }
+
+    return args;
+}
+
+int IrLowering_Call(IrLowering *l, Node *n) {
+    Node *def = n->node.fcall.def;
+    Array *exprs = n->node.fcall.exprs;
+    int *args = IrLowering_Arguments(l, n);
+
+    int dst = IR_NONE;
+
+    if (def->node.func_def.type->type != TYPE_VOID)
+        dst = IrFunction_Register(l->fn, IrLowering_Width(l, def->node.func_def.type, "return value"));
+
+    IrInstruction *ins = IrFunction_Emit(l->fn, IR_CALL, dst, IR_NONE, IR_NONE, dst == IR_NONE ? 0 : l->fn->widths[dst]);
+    ins->target = def;
+    ins->args = args;
+    ins->nargs = exprs->length;
+
+    return dst;
+}
+
+int IrLowering_Variable(IrLowering *l, Node *decl) {
+    IrFunction *fn = l->fn;
+    int local = IrLowering_Local(l, decl);
+
+    if (local != IR_NONE)
+        return local;
+
+    IrGlobal *global = IrModule_FindGlobal(l->module, decl);
+
+    if (!global) {
+        EMIT_PRINT("The variable '%s' has no storage.\n", decl->node.var_decl.id->value);
+        IrLowering_Fail(l);
+        return IR_NONE;
+    }
+
+    int dst = IrFunction_Register(fn, IrLowering_Width(l, decl->node.var_decl.type, "variable"));
+    IrFunction_Emit(fn, IR_LOAD, dst, IR_NONE, IR_NONE, fn->widths[dst])->target = decl;
+    return dst;
+}
+
+// Arrays and vectors are either globals or kept in the frame of the procedure that declares them
+bool IrLowering_InMemory(IrLowering *l, Node *decl) {
+    if (IrModule_FindGlobal(l->module, decl) || IrFunction_FindArray(l->fn, decl))
+        return true;
+
+    EMIT_PRINT("The variable '%s' has no storage.\n", decl->node.var_decl.id->value);
+    IrLowering_Fail(l);
+    return false;
+}
+
+// The index of an element, checked against the length of the array unless proven to be in bounds
+int IrLowering_Index(IrLowering *l, Node *decl, Node *expr, bool checked) {
+    if (!IrLowering_InMemory(l, decl))
+        return IR_NONE;
+
+    int index = IrLowering_Expression(l, expr);
+    if (index == IR_NONE)
+        return IR_NONE;
+
+    if (checked) {
+        IrInstruction *ins = IrFunction_Emit(l->fn, IR_CHECK, IR_NONE, index, IR_NONE, l->fn->widths[index]);
+        ins->imm = decl->node.var_decl.type->content.array.length;
+        ins->target = decl;
+    }
+
+    return index;
+}
+
+int IrLowering_Element(IrLowering *l, Node *n) {
+    IrFunction *fn = l->fn;
+    Node *decl = n->node.index.array->node.var_ref.decl;
+
+    int index = IrLowering_Index(l, decl, n->node.index.expr, n->node.index.checked);
+    if (index == IR_NONE)
+        return IR_NONE;
+
+    int dst = IrFunction_Register(fn, IrLowering_Width(l, n->etype, "element"));
+    IrFunction_Emit(fn, IR_ELEMENT, dst, index, IR_NONE, fn->widths[dst])->target = decl;
+    return dst;
+}
+
+int IrLowering_VectorAddress(IrLowering *l, Node *decl) {
+    if (!IrLowering_InMemory(l, decl))
+        return IR_NONE;
+
+    int dst = IrFunction_Register(l->fn, 8);
+    IrFunction_Emit(l->fn, IR_ADDRESS, dst, IR_NONE, IR_NONE, 8)->target = decl;
+    return dst;
+}
+
+// An operation on vectors whose result is kept in a temporary of its own
+int IrLowering_Packed(IrLowering *l, IrOpcode op, int a, int b, Type *type) {
+    IrFunction *fn = l->fn;
+    int dst = IrFunction_Register(fn, 8);
+
+    IrInstruction *ins = IrFunction_Emit(fn, op, dst, a, b, Ir_Width(type->content.array.element));
+    ins->size = Type_Size(type);
+    ins->imm = IrFunction_Reserve(fn, ins->size);
+    return dst;
+}
+
+// The lanes of a vector operand, a scalar is broadcast to every lane
+int IrLowering_Lanes(IrLowering *l, Node *n, Type *type) {
+    int v = IrLowering_Expression(l, n);
+
+    if (v == IR_NONE || n->etype->type == TYPE_VECTOR)
+        return v;
+
+    v = IrLowering_Coerce(l, v, Ir_Width(type->content.array.element));
+    return IrLowering_Packed(l, IR_PSPLAT, v, IR_NONE, type);
+}
+
+int IrLowering_VectorBinary(IrLowering *l, Node *n) {
+    BinaryType op = n->node.binary.op;
+    int a = IrLowering_Lanes(l, n->node.binary.left, n->etype);
+    int b = IrLowering_Lanes(l, n->node.binary.right, n->etype);
+
+    if (a == IR_NONE || b == IR_NONE)
+        return IR_NONE;
+
+    return IrLowering_Packed(l, op == BIN_ADD ? IR_PADD : op == BIN_SUB ? IR_PSUB : IR_PMUL, a, b, n->etype);
+}
+
+int IrLowering_Reduce(IrLowering *l, Node *n) {
+    IrFunction *fn = l->fn;
+    Node *expr = n->node.reduce.expr;
+
+    int a = IrLowering_Expression(l, expr);
+    if (a == IR_NONE)
+        return IR_NONE;
+
+    int dst = IrFunction_Register(fn, IrLowering_Width(l, n->etype, "lane"));
+    IrFunction_Emit(fn, IR_PSUM, dst, a, IR_NONE, fn->widths[dst])->size = Type_Size(expr->etype);
+    return dst;
+}
+
+int IrLowering_Expression(IrLowering *l, Node *n) {
+    IrFunction *fn = l->fn;
+
+    switch (n->type) {
+        case NODE_INTEGER_LITERAL: {
+            int dst = IrFunction_Register(fn, IrLowering_Width(l, n->etype, "literal"));
+            IrFunction_Emit(fn, IR_IMMEDIATE, dst, IR_NONE, IR_NONE, fn->widths[dst])->imm =
+                    Ir_Truncate(n->node.int_lit.n, fn->widths[dst]);
+            return dst;
+        }
+
+        case NODE_SIZE: {
+            int dst = IrFunction_Register(fn, 8);
+            IrFunction_Emit(fn, IR_IMMEDIATE, dst, IR_NONE, IR_NONE, 8)->imm = Type_Size(n->node.size.type);
+            return dst;
+        }
+
+        case NODE_VARIABLE_REFERENCE: {
+            if (n->node.var_ref.next) {
+                EMIT_PRINT("Member access is not supported by the native backend.\n");
+                IrLowering_Fail(l);
+                return IR_NONE;
+            }
+
+            if (n->etype && n->etype->type == TYPE_VECTOR)
+                return IrLowering_VectorAddress(l, n->node.var_ref.decl);
+
+            return IrLowering_Variable(l, n->node.var_ref.decl);
+        }
+
+        case NODE_INDEX:
+            return IrLowering_Element(l, n);
+
+        case NODE_REDUCE:
+            return IrLowering_Reduce(l, n);
+
+        case NODE_BINARY_EXPRESSION:
+            if (n->etype && n->etype->type == TYPE_VECTOR)
+                return IrLowering_VectorBinary(l, n);
+
+            return IrLowering_Binary(l, n);
+
+        case NODE_FUNCTION_CALL:
+            return IrLowering_Call(l, n);
+
+        case NODE_STRING_LITERAL: {
+            int dst = IrFunction_Register(fn, 8);
+            IrFunction_Emit(fn, IR_STRING, dst, IR_NONE, IR_NONE, 8)->imm = n->node.str_lit.id;
+            return dst;
+        }
+
+        case NODE_FLOAT_LITERAL:
+            EMIT_PRINT("Floating point values are not supported by the native backend.\n");
+            IrLowering_Fail(l);
+            return IR_NONE;
+
+        default:
+            EMIT_PRINT("Unsupported expression %s.\n", NodeType_ToString(n->type));
+            IrLowering_Fail(l);
+            return IR_NONE;
+    }
+}
+
+void IrLowering_Assign(IrLowering *l, Node *decl, int v, unsigned width) {
+    IrFunction *fn = l->fn;
+    IrGlobal *global = IrModule_FindGlobal(l->module, decl);
+
+    if (global) {
+        IrFunction_Emit(fn, IR_STORE, IR_NONE, v, IR_NONE, width)->target = decl;
+        return;
+    }
+
+    int local = IrLowering_Local(l, decl);
+
+    if (local == IR_NONE) {
+        local = IrFunction_Register(fn, width);
+        IrLowering_Declare(l, decl, local);
+    }
+
+    IrFunction_Emit(fn, IR_MOVE, local, v, IR_NONE, width);
+}
+
+void IrLowering_Store(IrLowering *l, Node *decl, Node *value) {
+    IrFunction *fn = l->fn;
+    unsigned width = IrLowering_Width(l, decl->node.var_decl.type, "variable");
+    int v;
+
+    if (value) {
+        v = IrLowering_Expression(l, value);
+        if (v == IR_NONE)
+            return;
+        v = IrLowering_Coerce(l, v, width);
+    } else {
+        // Uninitialized variables start out as zero
+        v = IrFunction_Register(fn, width);
+        IrFunction_Emit(fn, IR_IMMEDIATE, v, IR_NONE, IR_NONE, width);
+    }
+
+    IrLowering_Assign(l, decl, v, width);
+}
+
+// The value is computed ahead of the index. A dead store left without a value only checks it.
+void IrLowering_StoreElement(IrLowering *l, Node *n) {
+    IrFunction *fn = l->fn;
+    Node *decl = n->node.var_assign.decl;
+
+    if (!n->node.var_assign.value) {
+        IrLowering_Index(l, decl, n->node.var_assign.index, n->node.var_assign.checked);
+        return;
+    }
+    unsigned width = IrLowering_Width(l, decl->node.var_decl.type->content.array.element, "element");
+
+    int v = IrLowering_Expression(l, n->node.var_assign.value);
+    if (v == IR_NONE)
+        return;
+    v = IrLowering_Coerce(l, v, width);
+
+    int index = IrLowering_Index(l, decl, n->node.var_assign.index, n->node.var_assign.checked);
+    if (index == IR_NONE)
+        return;
+
+    IrFunction_Emit(fn, IR_SET_ELEMENT, IR_NONE, index, v, width)->target = decl;
+}
+
+void IrLowering_StoreVector(IrLowering *l, Node *decl, Node *value) {
+    Type *type = decl->node.var_decl.type;
+
+    int v = IrLowering_Lanes(l, value, type);
+    if (v == IR_NONE)
+        return;
+
+    int address = IrLowering_VectorAddress(l, decl);
+    if (address == IR_NONE)
+        return;
+
+    IrInstruction *ins = IrFunction_Emit(l->fn, IR_PCOPY, IR_NONE, address, v, Ir_Width(type->content.array.element));
+    ins->size = Type_Size(type);
+}
+
+// Arrays and vectors start out as zero every time their declaration is reached, unless a
+// vector is initialized. Those of procedures get their place in the frame the first time.
+void IrLowering_DeclareArray(IrLowering *l, Node *decl) {
+    IrFunction *fn = l->fn;
+    Type *type = decl->node.var_decl.type;
+    unsigned width = IrLowering_Width(l, type->content.array.element, "element");
+
+    if (!IrModule_FindGlobal(l->module, decl) && !IrFunction_FindArray(fn, decl)) {
+        IrArray *array = malloc(sizeof(IrArray));
+        array->decl = decl;
+        array->offset = IrFunction_Reserve(fn, Type_Size(type));
+        Array_Push(fn->arrays, array);
+    }
+
+    if (decl->node.var_decl.value) {
+        IrLowering_StoreVector(l, decl, decl->node.var_decl.value);
+        return;
+    }
+
+    IrFunction_Emit(fn, IR_CLEAR, IR_NONE, IR_NONE, IR_NONE, width)->target = decl;
+}
+
+void IrLowering_Statement(IrLowering *, Node *);
+
+// Vector instructions that read or write a scalar register
+void IrLowering_Vector(IrLowering *l, IrOpcode op, int vd, int a, int b, unsigned width) {
+    IrInstruction *ins = IrFunction_EmitVector(l->fn, op, vd, IR_NONE, IR_NONE, width);
+    ins->a = a;
+    ins->b = b;
+}
+
+// Lanes of a vectorized expression, computed into the target if given. Intermediate
+// results take the temporaries from *next on, leaves are read where they are.
+int IrLowering_VectorExpression(IrLowering *l, VectorPlan *plan, Node *n, int target, int *next) {
+    // The counter is the index of the element of the first lane
+    if (n->type == NODE_INDEX) {
+        int vd = target != IR_NONE ? target : (*next)++;
+        IrInstruction *ins = IrFunction_EmitVector(l->fn, IR_VLOAD, vd, IR_NONE, IR_NONE, plan->width);
+        ins->a = IrLowering_Expression(l, n->node.index.expr);
+        ins->target = n->node.index.array->node.var_ref.decl;
+        return vd;
+    }
+
+    if (n->type == NODE_BINARY_EXPRESSION) {
+        BinaryType op = n->node.binary.op;
+        int a = IrLowering_VectorExpression(l, plan, n->node.binary.left, IR_NONE, next);
+        int b = IrLowering_VectorExpression(l, plan, n->node.binary.right, IR_NONE, next);
+        int vd = target != IR_NONE ? target : (*next)++;
+
+        IrFunction_EmitVector(l->fn, op == BIN_ADD ? IR_VADD : op == BIN_SUB ? IR_VSUB : IR_VMUL, vd, a, b,
+                              plan->width);
+        return vd;
+    }
+
+    VectorInduction *vi = VectorPlan_FindInduction(plan, n);
+    if (vi)
+        return vi->advanced ? vi->after : vi->reg;
+
+    VectorStatement *temp = VectorPlan_FindTemporary(plan, n);
+    if (temp)
+        return temp->reg;
+
+    return VectorPlan_FindInvariant(plan, n)->reg;
+}
+
+// As many iterations as there are lanes run at once while all of them remain, the
+// scalar loop that follows runs the rest. Induction variables are held by the lanes
+// as their values over consecutive iterations, sums are accumulated lane by lane
+// and added up once the vector loop is done.
+void IrLowering_VectorLoop(IrLowering *l, VectorPlan *plan, Node *n, int end) {
+    IrFunction *fn = l->fn;
+    unsigned width = plan->width;
+    unsigned lanes = plan->lanes;
+
+    int *strides = malloc(plan->inductions->length * sizeof(int));
+
+    for (unsigned i = 0; i < plan->inductions->length; i++) {
+        VectorInduction *vi = Array_At(plan->inductions, i);
+        Node *decl = vi->iv->decl;
+        unsigned vw = IrLowering_Width(l, decl->node.var_decl.type, "induction variable");
+        int step = IrFunction_Register(fn, vw);
+
+        if (vi->iv->step) {
+            int s = IrLowering_Coerce(l, IrLowering_Expression(l, vi->iv->step), vw);
+
+            if (vi->iv->op == BIN_SUB) {
+                int zero = IrFunction_Register(fn, vw);
+                IrFunction_Emit(fn, IR_IMMEDIATE, zero, IR_NONE, IR_NONE, vw);
+                IrFunction_Emit(fn, IR_SUB, step, zero, s, vw);
+            } else {
+                IrFunction_Emit(fn, IR_MOVE, step, s, IR_NONE, vw);
+            }
+        } else {
+            IrFunction_Emit(fn, IR_IMMEDIATE, step, IR_NONE, IR_NONE, vw)->imm = 1;
+        }
+
+        int count = IrFunction_Register(fn, vw);
+        IrFunction_Emit(fn, IR_IMMEDIATE, count, IR_NONE, IR_NONE, vw)->imm = lanes;
+
+        strides[i] = IrFunction_Register(fn, vw);
+        IrFunction_Emit(fn, IR_MUL, strides[i], step, count, vw);
+
+        if (!vi->read)
+            continue;
+
+        int first = IrLowering_Coerce(l, IrLowering_Variable(l, decl), width);
+        int increment = IrLowering_Coerce(l, step, width);
+        IrLowering_Vector(l, IR_VSERIES, vi->reg, first, increment, width);
+        IrLowering_Vector(l, IR_VSPLAT, vi->stride, IrLowering_Coerce(l, strides[i], width), IR_NONE, width);
+
+        if (vi->read_after)
+            IrLowering_Vector(l, IR_VSPLAT, vi->step, increment, IR_NONE, width);
+    }
+
+    for (unsigned i = 0; i < plan->invariants->length; i++) {
+        VectorInvariant *inv = Array_At(plan->invariants, i);
+        int v = IrLowering_Coerce(l, IrLowering_Expression(l, inv->leaf), width);
+        IrLowering_Vector(l, IR_VSPLAT, inv->reg, v, IR_NONE, width);
+    }
+
+    for (unsigned i = 0; i < plan->statements->length; i++) {
+        VectorStatement *vs = Array_At(plan->statements, i);
+        if (vs->kind == VECTOR_REDUCTION)
+            IrLowering_Vector(l, IR_VSPLAT, vs->reg, IR_NONE, IR_NONE, width);
+    }
+
+    // The vector loop runs while the counter is at least a vector short of the bound
+    int bound = IrLowering_Coerce(l, end, 8);
+    int shortfall = IrFunction_Register(fn, 8);
+    IrFunction_Emit(fn, IR_IMMEDIATE, shortfall, IR_NONE, IR_NONE, 8)->imm = lanes - 1;
+    int limit = IrFunction_Register(fn, 8);
+    IrFunction_Emit(fn, IR_SUB, limit, bound, shortfall, 8);
+
+    unsigned head = fn->labels++;
+    unsigned exit = fn->labels++;
+
+    IrFunction_Label(fn, head);
+
+    Node *var = n->node.loop.var;
+    int cond = IrFunction_Register(fn, 1);
+    IrFunction_Emit(fn, IR_LESS, cond, IrLowering_Coerce(l, IrLowering_Variable(l, var), 8), limit, 8);
+    IrFunction_Jump(fn, IR_BRANCH, cond, exit);
+
+    for (unsigned i = 0; i < plan->statements->length; i++) {
+        VectorStatement *vs = Array_At(plan->statements, i);
+        int next = (int) plan->registers;
+
+        switch (vs->kind) {
+            case VECTOR_INDUCTION:
+                if (vs->iv->read_after)
+                    IrFunction_EmitVector(fn, IR_VADD, vs->iv->after, vs->iv->reg, vs->iv->step, width);
+                vs->iv->advanced = true;
+                break;
+
+            case VECTOR_REDUCTION: {
+                int v = IrLowering_VectorExpression(l, plan, vs->expr, IR_NONE, &next);
+                IrFunction_EmitVector(fn, vs->op == BIN_SUB ? IR_VSUB : IR_VADD, vs->reg, vs->reg, v, width);
+                break;
+            }
+
+            case VECTOR_TEMPORARY:
+                // A temporary that is a plain copy shares the register of its value
+                vs->reg = IrLowering_VectorExpression(l, plan, vs->expr, vs->reg, &next);
+                break;
+
+            case VECTOR_STORE: {
+                int v = IrLowering_VectorExpression(l, plan, vs->expr, IR_NONE, &next);
+                IrInstruction *ins = IrFunction_EmitVector(fn, IR_VSTORE, IR_NONE, v, IR_NONE, width);
+                ins->a = IrLowering_Variable(l, var);
+                ins->target = vs->decl;
+                break;
+            }
+        }
+    }
+
+    for (unsigned i = 0; i < plan->inductions->length; i++) {
+        VectorInduction *vi = Array_At(plan->inductions, i);
+        Node *decl = vi->iv->decl;
+        unsigned vw = fn->widths[strides[i]];
+
+        if (vi->read)
+            IrFunction_EmitVector(fn, IR_VADD, vi->reg, vi->reg, vi->stride, width);
+        vi->advanced = false;
+
+        int v = IrFunction_Register(fn, vw);
+        IrFunction_Emit(fn, IR_ADD, v, IrLowering_Variable(l, decl), strides[i], vw);
+        IrLowering_Assign(l, decl, v, vw);
+    }
+
+    IrFunction_Jump(fn, IR_JUMP, IR_NONE, head);
+    IrFunction_Label(fn, exit);
+
+    for (unsigned i = 0; i < plan->statements->length; i++) {
+        VectorStatement *vs = Array_At(plan->statements, i);
+
+        if (vs->kind != VECTOR_REDUCTION)
+            continue;
+
+        int acc = IrLowering_Variable(l, vs->decl);
+        int sum = IrFunction_Register(fn, width);
+        IrInstruction *ins = IrFunction_EmitVector(fn, IR_VSUM, IR_NONE, vs->reg, IR_NONE, width);
+        ins->dst = sum;
+        ins->a = acc;
+        IrLowering_Assign(l, vs->decl, sum, width);
+    }
+
+    IrFunction_Emit(fn, IR_VEND, IR_NONE, IR_NONE, IR_NONE, 0);
+
+    l->module->vector = l->vec->width;
+    free(strides);
+}
+
+// The bound is kept in a register of its own, the body may change the variables it was computed from
+void IrLowering_Loop(IrLowering *l, Node *n) {
+    IrFunction *fn = l->fn;
+    Node *var = n->node.loop.var;
+    unsigned width = IrLowering_Width(l, var->node.var_decl.type, "loop counter");
+
+    IrLowering_Store(l, var, n->node.loop.from);
+
+    int bound = IrLowering_Expression(l, n->node.loop.to);
+    if (bound == IR_NONE)
+        return;
+
+    int end = IrFunction_Register(fn, width);
+    IrFunction_Emit(fn, IR_MOVE, end, IrLowering_Coerce(l, bound, width), IR_NONE, width);
+
+    VectorPlan plan;
+
+    if (Vectorize_Plan(l->vec, &plan, n, fn->def))
+        IrLowering_VectorLoop(l, &plan, n, end);
+
+    VectorPlan_Release(&plan);
+
+    unsigned head = fn->labels++;
+    unsigned exit = fn->labels++;
+
+    IrFunction_Label(fn, head);
+
+    int cond = IrFunction_Register(fn, 1);
+    IrFunction_Emit(fn, IR_LESS, cond, IrLowering_Variable(l, var), end, width);
+    IrFunction_Jump(fn, IR_BRANCH, cond, exit);
+
+    IrLowering_Statement(l, n->node.loop.block);
+
+    int one = IrFunction_Register(fn, width);
+    IrFunction_Emit(fn, IR_IMMEDIATE, one, IR_NONE, IR_NONE, width)->imm = 1;
+
+    int next = IrFunction_Register(fn, width);
+    IrFunction_Emit(fn, IR_ADD, next, IrLowering_Variable(l, var), one, width);
+    IrLowering_Assign(l, var, next, width);
+
+    IrFunction_Jump(fn, IR_JUMP, IR_NONE, head);
+    IrFunction_Label(fn, exit);
+}
+
+unsigned IrLowering_ReturnWidth(IrLowering *l) {
+    // The top-level statements return the exit code
+    if (!l->fn->def)
+        return 4;
+
+    return IrLowering_Width(l, l->fn->def->node.func_def.type, "return value");
+}
+
+unsigned IrLowering_StackArguments(Node *def) {
+    unsigned count = def->node.func_def.params->length;
+    return count > IR_REGISTER_ARGS ? count - IR_REGISTER_ARGS : 0;
+}
+
+// A call whose result is returned as is becomes a jump that reuses the frame of the caller.
+// The arguments passed on the stack have to fit into the area of the incoming ones.
+bool IrLowering_TailCall(IrLowering *l, Node *n) {
+    Node *call = n->node.ret.expr;
+    Node *caller = l->fn->def;
+
+    if (!caller || !call || call->type != NODE_FUNCTION_CALL || !call->node.fcall.def)
+        return false;
+
+    Node *callee = call->node.fcall.def;
+    const char *reason = NULL;
+
+    if (Ir_Width(callee->node.func_def.type) != Ir_Width(caller->node.func_def.type))
+        reason = "its result would have to be widened";
+    else if (IrLowering_StackArguments(callee) > IrLowering_StackArguments(caller))
+        reason = "it passes more arguments on the stack than the caller received";
+
+    if (reason) {
+        if (n->node.ret.jump) {
+            EMIT_PRINT("The jump from '%s' to '%s' cannot be a tail call: %s.\n", caller->node.func_def.id->value,
+                       callee->node.func_def.id->value, reason);
+            IrLowering_Fail(l);
+        }
+        return false;
+    }
+
+    int *args = IrLowering_Arguments(l, call);
+
+    IrInstruction *ins = IrFunction_Emit(l->fn, IR_TAIL_CALL, IR_NONE, IR_NONE, IR_NONE, 0);
+    ins->target = callee;
+    ins->args = args;
+    ins->nargs = call->node.fcall.exprs->length;
+
+    l->module->tail_calls++;
+    return true;
+}
+
+void IrLowering_Count(IrLowering *l, ProfileCounter *counter) {
+    Profile *profile = l->module->profile;
+
+    if (profile && profile->generate && counter->site > 0)
+        IrFunction_Emit(l->fn, IR_COUNT, IR_NONE, IR_NONE, IR_NONE, 8)->imm = counter->site - 1;
+}
+
+// Times the alternatives past this one ran, including none of them
+unsigned long long IrLowering_Skipped(Node *chk) {
+    unsigned long long skipped = 0;
+
+    for (Node *sub = chk->node.check.sub; sub; sub = sub->node.check.sub)
+        skipped += sub->node.check.taken.count;
+
+    for (; chk->node.check.sub; chk = chk->node.check.sub);
+    return skipped + chk->node.check.missed.count;
+}
+
+// A block the profile shows to be skipped more often than run goes past the end of the function,
+// leaving the test of the next alternative to fall through
+void IrLowering_Check(IrLowering *l, Node *n) {
+    IrFunction *fn = l->fn;
+    bool guided = Profile_Guides(l->module->profile);
+    unsigned end = fn->labels++;
+
+    for (Node *chk = n; chk; chk = chk->node.check.sub) {
+        if (!chk->node.check.expr) {
+            IrLowering_Count(l, &chk->node.check.taken);
+            IrLowering_Statement(l, chk->node.check.block);
+            break;
+        }
+
+        int cond = IrLowering_Expression(l, chk->node.check.expr);
+
+        if (guided && chk->node.check.taken.count < IrLowering_Skipped(chk)) {
+            IrColdBlock *cold = malloc(sizeof(IrColdBlock));
+            cold->block = chk->node.check.block;
+            cold->label = fn->labels++;
+            cold->resume = end;
+            Array_Push(l->cold, cold);
+
+            IrFunction_Jump(fn, IR_BRANCH_SET, cond, cold->label);
+            l->module->cold++;
+        } else {
+            unsigned next = fn->labels++;
+            IrFunction_Jump(fn, IR_BRANCH, cond, next);
+            IrLowering_Count(l, &chk->node.check.taken);
+            IrLowering_Statement(l, chk->node.check.block);
+            IrFunction_Jump(fn, IR_JUMP, IR_NONE, end);
+            IrFunction_Label(fn, next);
+        }
+
+        if (!chk->node.check.sub)
+            IrLowering_Count(l, &chk->node.check.missed);
+    }
+
+    IrFunction_Label(fn, end);
+}
+
+void IrLowering_Statement(IrLowering *l, Node *n) {
+    IrFunction *fn = l->fn;
+
+    switch (n->type) {
+        case NODE_VARIABLE_DECLARATION:
+            if (n->node.var_decl.type &&
+                (n->node.var_decl.type->type == TYPE_ARRAY || n->node.var_decl.type->type == TYPE_VECTOR))
+                IrLowering_DeclareArray(l, n);
+            else
+                IrLowering_Store(l, n, n->node.var_decl.value);
+            break;
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            if (n->node.var_assign.index)
+                IrLowering_StoreElement(l, n);
+            else if (n->node.var_assign.decl->node.var_decl.type->type == TYPE_VECTOR)
+                IrLowering_StoreVector(l, n->node.var_assign.decl, n->node.var_assign.value);
+            else
+                IrLowering_Store(l, n->node.var_assign.decl, n->node.var_assign.value);
+            break;
+
+        case NODE_RETURN: {
+            if (IrLowering_TailCall(l, n))
+                break;
+
+            if (!n->node.ret.expr) {
+                IrFunction_Jump(fn, IR_RETURN, IR_NONE, 0);
+                break;
+            }
+
+            unsigned width = IrLowering_ReturnWidth(l);
+            int v = IrLowering_Coerce(l, IrLowering_Expression(l, n->node.ret.expr), width);
+            IrFunction_Emit(fn, IR_RETURN, IR_NONE, v, IR_NONE, width);
+            break;
+        }
+
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                IrLowering_Statement(l, Array_At(n->node.block.nodes, i));
+            break;
+
+        case NODE_CHECK:
+            IrLowering_Check(l, n);
+            break;
+
+        case NODE_LOOP:
+            IrLowering_Loop(l, n);
+            break;
+
+        // Lowered on their own
+        case NODE_FUNCTION_DEFINITION:
+            break;
+
+        // Only the layout is needed, which is known by now
+        case NODE_COMPLEX:
+            break;
+
+        // An element that is not used, accessed for its bounds check alone
+        case NODE_INDEX:
+            IrLowering_Index(l, n->node.index.array->node.var_ref.decl, n->node.index.expr, n->node.index.checked);
+            break;
+
+        default:
+            IrLowering_Expression(l, n);
+            break;
+    }
+}
+
+void IrLowering_Function(IrLowering *l, IrFunction *fn, Node *body) {
+    l->fn = fn;
+    l->locals = Array_Create();
+    l->cold = Array_Create();
+
+    if (fn->def) {
+        Array *params = fn->def->node.func_def.param_decls;
+
+        for (unsigned i = 0; i < params->length; i++) {
+            Node *decl = Array_At(params, i);
+            int v = IrFunction_Register(fn, IrLowering_Width(l, decl->node.var_decl.type, "parameter"));
+            IrFunction_Emit(fn, IR_PARAMETER, v, IR_NONE, IR_NONE, fn->widths[v])->imm = i;
+            IrLowering_Declare(l, decl, v);
+        }
+    }
+
+    if (fn->def)
+        IrLowering_Count(l, &fn->def->node.func_def.entered);
+
+    IrLowering_Statement(l, body);
+
+    // Falling off the end returns zero
+    if (fn->def && fn->def->node.func_def.type->type == TYPE_VOID) {
+        IrFunction_Jump(fn, IR_RETURN, IR_NONE, 0);
+    } else {
+        unsigned width = IrLowering_ReturnWidth(l);
+        int v = IrFunction_Register(fn, width);
+        IrFunction_Emit(fn, IR_IMMEDIATE, v, IR_NONE, IR_NONE, width);
+        IrFunction_Emit(fn, IR_RETURN, IR_NONE, v, IR_NONE, width);
+    }
+
+    // Blocks laid out here may lay out further ones
+    for (unsigned i = 0; i < l->cold->length; i++) {
+        IrColdBlock *cold = Array_At(l->cold, i);
+        IrFunction_Label(fn, cold->label);
+        IrLowering_Statement(l, cold->block);
+        IrInstruction *back = IrFunction_Emit(fn, IR_JUMP, IR_NONE, IR_NONE, IR_NONE, 0);
+        back->label = cold->resume;
+        back->imm = 1;
+    }
+
+    Array_DestroyCallBack(l->cold, free);
+    l->cold = NULL;
+
+    Array_DestroyCallBack(l->locals, free);
+    l->locals = NULL;
+}
+
+IrModule *Ir_Lower(Node *program, Vectorizer *vec) {
+    IrLowering l;
+    l.module = IrModule_Create();
+    l.module->strings = program->node.program.strings;
+    l.module->profile = program->node.program.profile;
+    l.vec = vec;
+    l.declared = Array_Create();
+    l.owners = Array_Create();
+    l.locals = NULL;
+    l.cold = NULL;
+    l.failed = false;
+
+    IrFunction *main = IrFunction_Create(l.module, NULL);
+
+    // SSE2 is always there, AVX2 once it is asked for
+    if (vec->width > l.module->isa)
+        l.module->isa = vec->width;
+
+    IrLowering_Collect(&l, program->node.program.nodes, NULL);
+
+    for (unsigned i = 0; i < l.module->functions->length && !l.failed; i++) {
+        IrFunction *fn = Array_At(l.module->functions, i);
+        IrLowering_Function(&l, fn, fn == main ? program->node.program.nodes : fn->def->node.func_def.block);
+    }
+
+    Array_Destroy(l.declared);
+    Array_Destroy(l.owners);
+
+    if (l.failed) {
+        IrModule_Destroy(l.module);
+        return NULL;
+    }
+
+    return l.module;
+}
+
+void IrFunction_Print(IrFunction *fn) {
+    printf("%s:\n", fn->name);
+
+    for (unsigned i = 0; i < fn->code->length; i++) {
+        IrInstruction *ins = Array_At(fn->code, i);
+
+        if (ins->op == IR_LABEL) {
+            printf(" L%u:\n", ins->label);
+            continue;
+        }
+
+        printf("  %4u %-12s w%u", i, IrOpcode_ToString(ins->op), ins->width);
+
+        if (ins->dst != IR_NONE)
+            printf(" v%d <-", ins->dst);
+        if (ins->vd != IR_NONE)
+            printf(" x%d <-", ins->vd);
+        if (ins->a != IR_NONE)
+            printf(" v%d", ins->a);
+        if (ins->b != IR_NONE)
+            printf(" v%d", ins->b);
+        if (ins->va != IR_NONE)
+            printf(" x%d", ins->va);
+        if (ins->vb != IR_NONE)
+            printf(" x%d", ins->vb);
+        for (unsigned k = 0; k < ins->nargs; k++)
+            printf(" v%d", ins->args[k]);
+
+        if (ins->op == IR_IMMEDIATE || ins->op == IR_PARAMETER || ins->op == IR_CHECK || ins->op == IR_STRING ||
+            ins->op == IR_COUNT)
+            printf(" #%lld", ins->imm);
+        if (ins->size > 0)
+            printf(" (%u bytes)", ins->size);
+        if (ins->op == IR_JUMP || ins->op == IR_BRANCH || ins->op == IR_BRANCH_SET)
+            printf(" L%u", ins->label);
+        if (ins->target && ins->target->type == NODE_FUNCTION_DEFINITION)
+            printf(" %s", ins->target->node.func_def.id->value);
+        if (ins->target && ins->target->type == NODE_VARIABLE_DECLARATION)
+            printf(" %s", ins->target->node.var_decl.id->value);
+
+        printf("\n");
+    }
+}
@@ -0,0 +1,480 @@
+#include "include/loop.h"
+#include "include/cse.h"
+#include "include/fold.h"
+#include "include/inline.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "include/memory.h"
+
+unsigned Loop_Assignments(LoopContext *ctx, Node *decl) {
+    unsigned count = 0;
+    for (unsigned i = 0; i < ctx->assigned->length; i++)
+        if (Array_At(ctx->assigned, i) == decl)
+            count++;
+    return count;
+}
+
+// Record every assignment within the body and whether it calls procedures
+void Loop_Scan(LoopContext *ctx, Node *n) {
+    if (!n)
+        return;
+
+    switch (n->type) {
+        case NODE_VARIABLE_DECLARATION:
+            ctx->calls |= Node_HasSideEffects(n->node.var_decl.value);
+            break;
+        case NODE_VARIABLE_ASSIGNMENT:
+            Array_Push(ctx->assigned, n->node.var_assign.decl);
+            ctx->calls |= Node_HasSideEffects(n->node.var_assign.value) ||
+                          Node_HasSideEffects(n->node.var_assign.index);
+            break;
+        case NODE_RETURN:
+            ctx->calls |= Node_HasSideEffects(n->node.ret.expr);
+            break;
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                Loop_Scan(ctx, Array_At(n->node.block.nodes, i));
+            break;
+        case NODE_CHECK:
+            for (Node *chk = n; chk; chk = chk->node.check.sub) {
+                ctx->calls |= Node_HasSideEffects(chk->node.check.expr);
+                Loop_Scan(ctx, chk->node.check.block);
+            }
+            break;
+        case NODE_LOOP:
+            ctx->calls |= Node_HasSideEffects(n->node.loop.from) || Node_HasSideEffects(n->node.loop.to);
+            Loop_Scan(ctx, n->node.loop.block);
+            break;
+        case NODE_FUNCTION_DEFINITION:
+            Loop_Scan(ctx, n->node.func_def.block);
+            break;
+        default:
+            ctx->calls |= Node_HasSideEffects(n);
+            break;
+    }
+}
+
+// Whether the expression has the same value throughout the loop. Any call may change
+// variables in scope, so only constants remain invariant in a loop that makes one.
+bool Loop_Invariant(LoopContext *ctx, Node *n) {
+    if (!n)
+        return false;
+
+    switch (n->type) {
+        case NODE_INTEGER_LITERAL:
+        case NODE_FLOAT_LITERAL:
+        case NODE_SIZE:
+            return true;
+
+        case NODE_VARIABLE_REFERENCE: {
+            Node *decl = n->node.var_ref.decl;
+
+            if (!decl || n->node.var_ref.next)
+                return false;
+
+            if (Inline_Within(decl->super, ctx->body) || Loop_Assignments(ctx, decl) > 0)
+                return false;
+
+            return !ctx->calls || decl->node.var_decl.mutable == MQ_CONST;
+        }
+
+        case NODE_BINARY_EXPRESSION: {
+            Node *right = n->node.binary.right;
+
+            // Hoisting a division could make it fault where the loop would not have run it
+            if (n->node.binary.op == BIN_DIV) {
+                bool truth;
+                if (!Fold_Truth(right, &truth) || !truth)
+                    return false;
+            }
+
+            return Loop_Invariant(ctx, n->node.binary.left) && Loop_Invariant(ctx, right);
+        }
+
+        default:
+            return false;
+    }
+}
+
+// Copy a pure expression
+Node *Loop_Copy(Node *n, Node *super) {
+    Node *c;
+
+    switch (n->type) {
+        case NODE_INTEGER_LITERAL:
+        case NODE_FLOAT_LITERAL:
+            return Node_DuplicateLiteral(n, super);
+        case NODE_VARIABLE_REFERENCE:
+            return Node_Reference(n->node.var_ref.decl, super);
+        case NODE_SIZE:
+            c = Node_CreateSize(n->node.size.type, super);
+            break;
+        case NODE_BINARY_EXPRESSION:
+            c = Node_CreateBinaryOperation(Loop_Copy(n->node.binary.left, super),
+                                           Loop_Copy(n->node.binary.right, super), n->node.binary.op, super);
+            break;
+        default:
+            return NULL;
+    }
+
+    c->etype = n->etype;
+    return c;
+}
+
+// Declare a temporary ahead of the loop
+Node *Loop_Temporary(LoopContext *ctx, const char *prefix, Node *value, Type *type, ModificationQualifier modQua) {
+    char name[32];
+    snprintf(name, sizeof(name), "%s.%u", prefix, ctx->stats->temps++);
+
+    Token *id = Token_Create(name, TT_IDEN);
+    Node *decl = Node_DeclareVariable(id, value, type, modQua, ctx->blk);
+    Token_Destroy(id);
+
+    Array_Insert(ctx->blk->node.block.nodes, ctx->at++, decl);
+    return decl;
+}
+
+// A temporary holding base * factor, computed in the width of the given type
+Node *Loop_Scaled(LoopContext *ctx, const char *prefix, Node *base, Node *factor, Type *type) {
+    if (Node_IsLiteral(base) && Node_IsLiteral(factor)) {
+        Node *product = Node_CreateBinaryOperation(base, factor, BIN_MUL, ctx->blk);
+        product->etype = type;
+
+        Node *lit = Fold_Binary(product);
+
+        if (lit) {
+            Node_DestroyRecurse(product);
+            return Loop_Temporary(ctx, prefix, lit, type, MQ_VARYING);
+        }
+
+        Node_DestroyBase(product);
+    }
+
+    Node *decl = Loop_Temporary(ctx, prefix, base, type, MQ_VARYING);
+
+    Node *value = Node_CreateBinaryOperation(Node_Reference(decl, ctx->blk), factor, BIN_MUL, ctx->blk);
+    value->etype = type;
+
+    Node *scale = Node_CreateVariableAssignment(decl->node.var_decl.id, value, ctx->blk);
+    scale->node.var_assign.decl = decl;
+    Array_Insert(ctx->blk->node.block.nodes, ctx->at++, scale);
+
+    return decl;
+}
+
+typedef bool (*LoopVisitor)(LoopContext *, Node **);
+
+// Visit the expressions of the body outermost first, a visitor returns whether it has handled one.
+// Procedure bodies do not run as part of the loop.
+void Loop_WalkExpression(LoopContext *ctx, Node **slot, LoopVisitor visit) {
+    Node *n = *slot;
+
+    if (!n || visit(ctx, slot))
+        return;
+
+    if (n->type == NODE_BINARY_EXPRESSION) {
+        Loop_WalkExpression(ctx, &n->node.binary.left, visit);
+        Loop_WalkExpression(ctx, &n->node.binary.right, visit);
+    } else if (n->type == NODE_FUNCTION_CALL) {
+        for (unsigned i = 0; i < n->node.fcall.exprs->length; i++)
+            Loop_WalkExpression(ctx, (Node **) &n->node.fcall.exprs->base[i], visit);
+    } else if (n->type == NODE_INDEX) {
+        Loop_WalkExpression(ctx, &n->node.index.expr, visit);
+    } else if (n->type == NODE_REDUCE) {
+        Loop_WalkExpression(ctx, &n->node.reduce.expr, visit);
+    }
+}
+
+void Loop_WalkStatement(LoopContext *ctx, Node **slot, LoopVisitor visit) {
+    Node *n = *slot;
+
+    switch (n->type) {
+        case NODE_VARIABLE_DECLARATION:
+            Loop_WalkExpression(ctx, &n->node.var_decl.value, visit);
+            break;
+        case NODE_VARIABLE_ASSIGNMENT:
+            Loop_WalkExpression(ctx, &n->node.var_assign.value, visit);
+            Loop_WalkExpression(ctx, &n->node.var_assign.index, visit);
+            break;
+        case NODE_RETURN:
+            Loop_WalkExpression(ctx, &n->node.ret.expr, visit);
+            break;
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                Loop_WalkStatement(ctx, (Node **) &n->node.block.nodes->base[i], visit);
+            break;
+        case NODE_CHECK:
+            for (Node *chk = n; chk; chk = chk->node.check.sub) {
+                Loop_WalkExpression(ctx, &chk->node.check.expr, visit);
+                Loop_WalkStatement(ctx, &chk->node.check.block, visit);
+            }
+            break;
+        case NODE_LOOP:
+            Loop_WalkExpression(ctx, &n->node.loop.from, visit);
+            Loop_WalkExpression(ctx, &n->node.loop.to, visit);
+            Loop_WalkStatement(ctx, &n->node.loop.block, visit);
+            break;
+        case NODE_FUNCTION_DEFINITION:
+            break;
+        default:
+            Loop_WalkExpression(ctx, slot, visit);
+            break;
+    }
+}
+
+// Move an invariant computation ahead of the loop, sharing the temporary of an equal one
+bool Loop_Hoist(LoopContext *ctx, Node **slot) {
+    Node *n = *slot;
+
+    if (n->type != NODE_BINARY_EXPRESSION || !n->etype || !Loop_Invariant(ctx, n))
+        return false;
+
+    for (unsigned i = 0; i < ctx->hoisted->length; i++) {
+        Node *decl = Array_At(ctx->hoisted, i);
+
+        if (Cse_Equal(decl->node.var_decl.value, n)) {
+            *slot = Node_Reference(decl, n->super);
+            Node_Unreference(n);
+            Node_DestroyRecurse(n);
+            ctx->stats->hoisted++;
+            return true;
+        }
+    }
+
+    Node *decl = Loop_Temporary(ctx, "licm", n, n->etype, MQ_CONST);
+    *slot = Node_Reference(decl, n->super);
+
+    Array_Push(ctx->hoisted, decl);
+    ctx->stats->hoisted++;
+    return true;
+}
+
+Induction *Loop_FindInduction(LoopContext *ctx, Node *n) {
+    if (n->type != NODE_VARIABLE_REFERENCE || n->node.var_ref.next)
+        return NULL;
+
+    for (unsigned i = 0; i < ctx->inductions->length; i++) {
+        Induction *iv = Array_At(ctx->inductions, i);
+        if (iv->decl == n->node.var_ref.decl)
+            return iv;
+    }
+
+    return NULL;
+}
+
+Induction *Loop_AddInduction(LoopContext *ctx, Node *decl, Node *step, BinaryType op, Node *update) {
+    Induction *iv = malloc(sizeof(Induction));
+    iv->decl = decl;
+    iv->step = step;
+    iv->op = op;
+    iv->update = update;
+
+    Array_Push(ctx->inductions, iv);
+    ctx->stats->inductions++;
+    return iv;
+}
+
+bool Loop_Refers(Node *n, Node *decl) {
+    return n->type == NODE_VARIABLE_REFERENCE && !n->node.var_ref.next && n->node.var_ref.decl == decl;
+}
+
+// Besides the counter, variables advanced by an invariant amount by a statement that runs
+// on every iteration, and by no other
+void Loop_Inductions(LoopContext *ctx) {
+    Loop_AddInduction(ctx, ctx->loop->node.loop.var, NULL, BIN_ADD, NULL);
+
+    // A procedure may change variables behind the back of the loop
+    if (ctx->calls)
+        return;
+
+    Array *nodes = ctx->body->node.block.nodes;
+
+    for (unsigned i = 0; i < nodes->length; i++) {
+        Node *s = Array_At(nodes, i);
+
+        if (s->type != NODE_VARIABLE_ASSIGNMENT || s->node.var_assign.index)
+            continue;
+
+        Node *decl = s->node.var_assign.decl;
+        Node *value = s->node.var_assign.value;
+
+        if (!decl || Inline_Within(decl->super, ctx->body) || Loop_Assignments(ctx, decl) != 1)
+            continue;
+
+        if (value->type != NODE_BINARY_EXPRESSION || Loop_FindInduction(ctx, value))
+            continue;
+
+        Node *left = value->node.binary.left;
+        Node *right = value->node.binary.right;
+        BinaryType op = value->node.binary.op;
+
+        if ((op == BIN_ADD || op == BIN_SUB) && Loop_Refers(left, decl) && Loop_Invariant(ctx, right))
+            Loop_AddInduction(ctx, decl, right, op, s);
+        else if (op == BIN_ADD && Loop_Refers(right, decl) && Loop_Invariant(ctx, left))
+            Loop_AddInduction(ctx, decl, left, op, s);
+    }
+}
+
+// Replace iv * factor by a temporary that starts out as first * factor and is
+// advanced by step * factor along with the induction variable
+bool Loop_Reduce(LoopContext *ctx, Node **slot) {
+    Node *n = *slot;
+
+    if (n->type != NODE_BINARY_EXPRESSION || n->node.binary.op != BIN_MUL || !n->etype)
+        return false;
+
+    Node *factor = n->node.binary.right;
+    Induction *iv = Loop_FindInduction(ctx, n->node.binary.left);
+
+    if (!iv) {
+        factor = n->node.binary.left;
+        iv = Loop_FindInduction(ctx, n->node.binary.right);
+    }
+
+    if (!iv || !Loop_Invariant(ctx, factor))
+        return false;
+
+    Type *type = n->etype;
+
+    // The variable has to wrap around like the product does
+    if (iv->step && !Type_Compare(iv->decl->node.var_decl.type, type))
+        return false;
+
+    Reduction *red = NULL;
+
+    for (unsigned i = 0; i < ctx->reductions->length && !red; i++) {
+        Reduction *r = Array_At(ctx->reductions, i);
+        if (r->iv == iv && Type_Compare(r->temp->node.var_decl.type, type) && Cse_Equal(r->factor, factor))
+            red = r;
+    }
+
+    if (!red) {
+        red = malloc(sizeof(Reduction));
+        red->iv = iv;
+        red->factor = Loop_Copy(factor, ctx->blk);
+
+        Node *first = iv->step ? Node_Reference(iv->decl, ctx->blk) : Loop_Copy(ctx->loop->node.loop.from, ctx->blk);
+        red->temp = Loop_Scaled(ctx, "sr", first, Loop_Copy(factor, ctx->blk), type);
+
+        Node *step;
+
+        if (iv->step) {
+            Node *scaled = Loop_Scaled(ctx, "sr", Loop_Copy(iv->step, ctx->blk), Loop_Copy(factor, ctx->blk), type);
+            step = Node_Reference(scaled, ctx->body);
+        } else {
+            step = Loop_Copy(factor, ctx->body);
+        }
+
+        Node *value = Node_CreateBinaryOperation(Node_Reference(red->temp, ctx->body), step, iv->op, ctx->body);
+        value->etype = type;
+
+        red->advance = Node_CreateVariableAssignment(red->temp->node.var_decl.id, value, ctx->body);
+        red->advance->node.var_assign.decl = red->temp;
+
+        Array_Push(ctx->reductions, red);
+    }
+
+    *slot = Node_Reference(red->temp, n->super);
+    Node_Unreference(n);
+    Node_DestroyRecurse(n);
+
+    ctx->stats->reduced++;
+    return true;
+}
+
+void Loop_Optimize(LoopStatistics *stats, Node *blk, Node *loop) {
+    Array *nodes = blk->node.block.nodes;
+
+    LoopContext ctx = {stats, loop, loop->node.loop.block, blk, 0, Array_Create(), false, Array_Create(),
+                       Array_Create(), Array_Create()};
+
+    while (Array_At(nodes, ctx.at) != loop)
+        ctx.at++;
+
+    stats->loops++;
+
+    // Bounds that call procedures are evaluated first, so that whatever they change
+    // is seen by the temporaries that follow
+    if (Node_HasSideEffects(loop->node.loop.from) || Node_HasSideEffects(loop->node.loop.to)) {
+        Node **bounds[] = {&loop->node.loop.from, &loop->node.loop.to};
+
+        for (unsigned i = 0; i < 2; i++) {
+            Node *bound = *bounds[i];
+            Node *decl = Loop_Temporary(&ctx, "loop", bound, bound->etype, MQ_CONST);
+            *bounds[i] = Node_Reference(decl, bound->super);
+        }
+    }
+
+    Loop_Scan(&ctx, ctx.body);
+
+    Loop_WalkStatement(&ctx, &loop->node.loop.block, Loop_Hoist);
+
+    Loop_Inductions(&ctx);
+
+    Loop_WalkStatement(&ctx, &loop->node.loop.block, Loop_Reduce);
+
+    // Temporaries advance right after their variable, the counter does so past the end of the body
+    Array *body = ctx.body->node.block.nodes;
+
+    for (unsigned i = 0; i < ctx.reductions->length; i++) {
+        Reduction *red = Array_At(ctx.reductions, i);
+        unsigned at = body->length;
+
+        for (unsigned k = 0; red->iv->update && k < body->length; k++)
+            if (Array_At(body, k) == red->iv->update)
+                at = k + 1;
+
+        Array_Insert(body, at, red->advance);
+    }
+
+    Array_Destroy(ctx.assigned);
+    Array_DestroyCallBack(ctx.inductions, free);
+    for (unsigned i = 0; i < ctx.reductions->length; i++) {
+        Reduction *red = Array_At(ctx.reductions, i);
+        Node_Unreference(red->factor);
+        Node_DestroyRecurse(red->factor);
+        free(red);
+    }
+
+    Array_Destroy(ctx.reductions);
+    Array_Destroy(ctx.hoisted);
+}
+
+// Outer loops are processed first, so that computations invariant in several
+// nested loops are moved out of all of them
+void Loop_Block(LoopStatistics *stats, Node *blk) {
+    Array *nodes = blk->node.block.nodes;
+
+    for (unsigned i = 0; i < nodes->length; i++) {
+        Node *n = Array_At(nodes, i);
+
+        switch (n->type) {
+            case NODE_LOOP:
+                Loop_Optimize(stats, blk, n);
+
+                // Temporaries have been declared ahead of the loop
+                while (Array_At(nodes, i) != n)
+                    i++;
+
+                Loop_Block(stats, n->node.loop.block);
+                break;
+            case NODE_BLOCK:
+                Loop_Block(stats, n);
+                break;
+            case NODE_CHECK:
+                for (Node *chk = n; chk; chk = chk->node.check.sub)
+                    Loop_Block(stats, chk->node.check.block);
+                break;
+            case NODE_FUNCTION_DEFINITION:
+                Loop_Block(stats, n->node.func_def.block);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void Loop_Program(LoopStatistics *stats, Node *program) {
+    Loop_Block(stats, program->node.program.nodes);
+}
@@ -0,0 +1,294 @@
+#define LFLOW_MEMORY_INTERNAL
+
+#include "include/memory.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEMORY_PHASES 16
+#define MEMORY_LARGEST 4
+
+// Live allocation, found by its address
+typedef struct {
+    void *ptr;          // NULL if the slot is free
+    size_t size;
+    const char *site;   // Procedure that made it
+    unsigned phase;     // Made in
+} MemoryBlock;
+
+typedef struct {
+    size_t size;
+    const char *site;
+} MemoryLargest;
+
+typedef struct {
+    const char *name;
+    unsigned long long allocations;
+    unsigned long long bytes;       // Requested, reallocations included
+    unsigned long long frees;
+    size_t peak;                    // Live bytes at most while it ran, those of earlier phases included
+    MemoryLargest largest[MEMORY_LARGEST];
+} MemoryPhase;
+
+bool Memory_Enabled = false;
+
+struct {
+    MemoryBlock *blocks;    // Open addressing on the address, linear probing
+    unsigned capacity;      // Number of slots, a power of two
+    unsigned count;
+    size_t live;
+    MemoryPhase phases[MEMORY_PHASES];
+    unsigned n_phases;
+    unsigned phase;
+} Memory;
+
+void Memory_Enable() {
+    Memory_Enabled = true;
+    Memory.capacity = 1024;
+    Memory.blocks = calloc(Memory.capacity, sizeof(MemoryBlock));
+    Memory_Phase("start");
+}
+
+// Following phases are accounted under the name, until the next one starts
+void Memory_Phase(const char *name) {
+    if (!Memory_Enabled)
+        return;
+
+    unsigned i = 0;
+
+    while (i < Memory.n_phases && strcmp(Memory.phases[i].name, name) != 0)
+        i++;
+
+    if (i == Memory.n_phases) {
+        // Past the last one, everything goes to the last one
+        if (Memory.n_phases == MEMORY_PHASES)
+            return;
+
+        Memory.phases[i] = (MemoryPhase) {.name = name};
+        Memory.n_phases++;
+    }
+
+    Memory.phase = i;
+
+    if (Memory.live > Memory.phases[i].peak)
+        Memory.phases[i].peak = Memory.live;
+}
+
+unsigned Memory_Hash(void *ptr) {
+    unsigned long long h = (unsigned long long) (size_t) ptr;
+    return (unsigned) ((h >> 4) * 11400714819323198485ull >> 32);
+}
+
+// The slot holding the address, or the free slot it would go to
+MemoryBlock *Memory_Slot(void *ptr) {
+    unsigned mask = Memory.capacity - 1;
+
+    for (unsigned i = Memory_Hash(ptr) & mask;; i = (i + 1) & mask)
+        if (Memory.blocks[i].ptr == NULL || Memory.blocks[i].ptr == ptr)
+            return &Memory.blocks[i];
+}
+
+// The slots are kept at most half full
+void Memory_Grow() {
+    MemoryBlock *old = Memory.blocks;
+    unsigned capacity = Memory.capacity;
+
+    Memory.capacity *= 2;
+    Memory.blocks = calloc(Memory.capacity, sizeof(MemoryBlock));
+
+    for (unsigned i = 0; i < capacity; i++)
+        if (old[i].ptr)
+            *Memory_Slot(old[i].ptr) = old[i];
+
+    free(old);
+}
+
+void Memory_Track(void *ptr, size_t size, const char *site) {
+    if (!ptr)
+        return;
+
+    MemoryPhase *phase = &Memory.phases[Memory.phase];
+    MemoryBlock *block = Memory_Slot(ptr);
+
+    phase->allocations++;
+    phase->bytes += size;
+
+    if (!block->ptr)
+        Memory.count++;
+    else
+        Memory.live -= block->size;
+
+    *block = (MemoryBlock) {ptr, size, site, Memory.phase};
+    Memory.live += size;
+
+    if (Memory.live > phase->peak)
+        phase->peak = Memory.live;
+
+    // Kept from largest to smallest
+    for (unsigned i = 0; i < MEMORY_LARGEST; i++) {
+        if (size > phase->largest[i].size) {
+            memmove(&phase->largest[i + 1], &phase->largest[i], (MEMORY_LARGEST - i - 1) * sizeof(MemoryLargest));
+            phase->largest[i] = (MemoryLargest) {size, site};
+            break;
+        }
+    }
+
+    if (2 * Memory.count > Memory.capacity)
+        Memory_Grow();
+}
+
+// Removal from linear probing, moving back the blocks that would no longer be found. False if the
+// block was made before accounting was enabled, or by the C library.
+bool Memory_Untrack(void *ptr) {
+    if (!ptr)
+        return false;
+
+    MemoryBlock *block = Memory_Slot(ptr);
+
+    if (!block->ptr)
+        return false;
+
+    Memory.live -= block->size;
+    Memory.count--;
+
+    unsigned mask = Memory.capacity - 1;
+    unsigned hole = (unsigned) (block - Memory.blocks);
+
+    for (unsigned i = (hole + 1) & mask; Memory.blocks[i].ptr; i = (i + 1) & mask) {
+        unsigned home = Memory_Hash(Memory.blocks[i].ptr) & mask;
+
+        // Stays unless its home is cyclically past the hole, up to where it is
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            Memory.blocks[hole] = Memory.blocks[i];
+            hole = i;
+        }
+    }
+
+    Memory.blocks[hole].ptr = NULL;
+    return true;
+}
+
+void *Memory_Alloc(size_t size, const char *site) {
+    void *ptr = malloc(size);
+
+    if (Memory_Enabled)
+        Memory_Track(ptr, size, site);
+
+    return ptr;
+}
+
+void *Memory_Calloc(size_t n, size_t size, const char *site) {
+    void *ptr = calloc(n, size);
+
+    if (Memory_Enabled)
+        Memory_Track(ptr, n * size, site);
+
+    return ptr;
+}
+
+void *Memory_Realloc(void *old, size_t size, const char *site) {
+    // The old block is only found by its address once realloc has freed it
+    uintptr_t key = (uintptr_t) old;
+    void *ptr = realloc(old, size);
+
+    if (Memory_Enabled && ptr) {
+        Memory_Untrack((void *) key);
+        Memory_Track(ptr, size, site);
+    }
+
+    return ptr;
+}
+
+char *Memory_Strdup(const char *str, const char *site) {
+    char *ptr = strdup(str);
+
+    if (Memory_Enabled && ptr)
+        Memory_Track(ptr, strlen(ptr) + 1, site);
+
+    return ptr;
+}
+
+char *Memory_Strndup(const char *str, size_t n, const char *site) {
+    char *ptr = strndup(str, n);
+
+    if (Memory_Enabled && ptr)
+        Memory_Track(ptr, strlen(ptr) + 1, site);
+
+    return ptr;
+}
+
+void Memory_Free(void *ptr) {
+    if (Memory_Enabled && Memory_Untrack(ptr))
+        Memory.phases[Memory.phase].frees++;
+
+    free(ptr);
+}
+
+typedef struct {
+    const char *site;
+    const char *phase;
+    unsigned long long blocks;
+    unsigned long long bytes;
+} MemoryLeak;
+
+int Memory_CompareLeaks(const void *a, const void *b) {
+    const MemoryLeak *x = a, *y = b;
+    return x->bytes < y->bytes ? 1 : x->bytes > y->bytes ? -1 : 0;
+}
+
+// Reports every phase, then what is still live grouped by the procedure and phase that made it
+void Memory_Report() {
+    if (!Memory_Enabled)
+        return;
+
+    for (unsigned i = 0; i < Memory.n_phases; i++) {
+        MemoryPhase *p = &Memory.phases[i];
+
+        if (p->allocations == 0 && p->frees == 0)
+            continue;
+
+        MEMORY_PRINT("%-10s %9llu allocation(s) %11llu byte(s) %9llu free(s), at most %zu byte(s) live\n", p->name,
+                     p->allocations, p->bytes, p->frees, p->peak);
+
+        for (unsigned k = 0; k < MEMORY_LARGEST && p->largest[k].size; k++) {
+            MEMORY_PRINT("%-10s   %zu byte(s) in %s\n", "", p->largest[k].size, p->largest[k].site);
+        }
+    }
+
+    MemoryLeak *leaks = malloc((Memory.count + 1) * sizeof(MemoryLeak));
+    unsigned n = 0;
+
+    for (unsigned i = 0; i < Memory.capacity; i++) {
+        MemoryBlock *b = &Memory.blocks[i];
+
+        if (!b->ptr)
+            continue;
+
+        unsigned k = 0;
+
+        while (k < n && (leaks[k].site != b->site || leaks[k].phase != Memory.phases[b->phase].name))
+            k++;
+
+        if (k == n)
+            leaks[n++] = (MemoryLeak) {b->site, Memory.phases[b->phase].name, 0, 0};
+
+        leaks[k].blocks++;
+        leaks[k].bytes += b->size;
+    }
+
+    qsort(leaks, n, sizeof(MemoryLeak), Memory_CompareLeaks);
+
+    if (n == 0) {
+        MEMORY_PRINT("No allocation is left.\n");
+    } else {
+        MEMORY_PRINT("%u allocation(s) of %zu byte(s) are left:\n", Memory.count, Memory.live);
+    }
+
+    for (unsigned k = 0; k < n; k++) {
+        MEMORY_PRINT("%11llu byte(s) in %6llu block(s) from %s during %s\n", leaks[k].bytes, leaks[k].blocks,
+                     leaks[k].site, leaks[k].phase);
+    }
+
+    free(leaks);
+}
@@ -0,0 +1,197 @@
+#include "include/module.h"
+#include "include/tokenizer.h"
+#include "include/param.h"
+#include "include/fold.h"
+#include "include/io.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/memory.h"
+
+// Imports are resolved next to the importing source, where interfaces are written as well
+char *Module_Directory(const char *input) {
+    const char *slash = strrchr(input, '/');
+
+    if (!slash)
+        return strdup(".");
+
+    return strndup(input, slash == input ? 1 : (size_t) (slash - input));
+}
+
+// The file name of the source without its extension, NULL unless it can be imported by that name
+char *Module_Name(const char *input) {
+    const char *base = strrchr(input, '/') ? strrchr(input, '/') + 1 : input;
+    const char *dot = strrchr(base, '.');
+    char *name = strndup(base, dot && dot != base ? (size_t) (dot - base) : strlen(base));
+
+    Tokenizer *tokenizer = Tokenizer_Create(name);
+    bool valid = *name && Tokenizer_Next(tokenizer) == STATUS_OK && tokenizer->current &&
+                 tokenizer->current->type == TT_IDEN && strcmp(tokenizer->current->value, name) == 0;
+    Tokenizer_Destroy(tokenizer);
+
+    if (!valid) {
+        MODULE_PRINT("The module \"%s\" cannot be imported as '%s', which is not an identifier.\n", input, name);
+        free(name);
+        return NULL;
+    }
+
+    return name;
+}
+
+// Exported constants are folded to the literal the interface gives them
+bool Module_Constant(Node *decl, FILE *out) {
+    FoldStatistics stats = {0};
+    decl->node.var_decl.value = Fold_Expression(&stats, decl->node.var_decl.value);
+
+    Node *value = decl->node.var_decl.value;
+
+    if (value->type != NODE_INTEGER_LITERAL)
+        return false;
+
+    long long n = value->node.int_lit.n;
+
+    fprintf(out, "const %s: %s = ", decl->node.var_decl.id->value, Type_Identifier(decl->node.var_decl.type));
+
+    // There are no negative literals, only subtractions folded again on import
+    if (n == LLONG_MIN)
+        fprintf(out, "0 - %lld - 1;\n", LLONG_MAX);
+    else if (n < 0)
+        fprintf(out, "0 - %lld;\n", -n);
+    else
+        fprintf(out, "%lld;\n", n);
+
+    return true;
+}
+
+// Complex types are exported in the order their fields are laid out in, so that the modules
+// importing one lay it out the same
+void Module_Complex(ComplexType *complx, FILE *out) {
+    unsigned n = complx->fields->length;
+    ComplexField **order = malloc((n + 1) * sizeof(ComplexField *));
+
+    for (unsigned i = 0; i < n; i++) {
+        ComplexField *field = Array_At(complx->fields, i);
+        unsigned j = i;
+
+        for (; j > 0 && order[j - 1]->offset > field->offset; j--)
+            order[j] = order[j - 1];
+
+        order[j] = field;
+    }
+
+    fprintf(out, "complex ordered %s {", complx->id->value);
+
+    for (unsigned i = 0; i < n; i++)
+        fprintf(out, " %s: %s;", order[i]->id->value, Type_Identifier(order[i]->type));
+
+    fprintf(out, " }\n");
+    free(order);
+}
+
+void Module_Procedure(Node *def, FILE *out) {
+    fprintf(out, "procedure %s(", def->node.func_def.id->value);
+
+    for (unsigned i = 0; i < def->node.func_def.params->length; i++) {
+        FunctionParameter *param = Array_At(def->node.func_def.params, i);
+        Node *decl = Array_At(def->node.func_def.param_decls, i);
+        fprintf(out, "%s%s: %s", i > 0 ? ", " : "", param->id->value, Type_Identifier(decl->node.var_decl.type));
+    }
+
+    fprintf(out, "): %s;\n", Type_Identifier(def->node.func_def.type));
+}
+
+// Exports the top-level procedures of an analysed program under the module name and writes its
+// interface: the modules it imports, then its complex types, constants and procedure signatures
+// in the order of the source. A module has no entry point, so the top level may hold nothing else.
+Status Module_Export(Node *program, const char *input, const char *name) {
+    Array *nodes = program->node.program.nodes->node.block.nodes;
+    Array *imports = program->node.program.imports;
+    unsigned procedures = 0, types = 0, constants = 0;
+
+    char *text = NULL;
+    size_t length = 0;
+    FILE *out = open_memstream(&text, &length);
+    Status status = STATUS_OK;
+
+    for (unsigned i = 0; imports && i < imports->length; i++)
+        fprintf(out, "import %s;\n", (char *) Array_At(imports, i));
+
+    for (unsigned i = 0; i < nodes->length && status == STATUS_OK; i++) {
+        Node *n = Array_At(nodes, i);
+
+        switch (n->type) {
+            case NODE_COMPLEX:
+                if (n->node.complx.imported)
+                    break;
+                Module_Complex(n->node.complx.type->content.complx.ref, out);
+                types++;
+                break;
+
+            case NODE_FUNCTION_DEFINITION:
+                if (n->node.func_def.external)
+                    break;
+                n->node.func_def.module = name;
+                Module_Procedure(n, out);
+                procedures++;
+                break;
+
+            case NODE_VARIABLE_DECLARATION:
+                if (n->node.var_decl.imported)
+                    break;
+                if (n->node.var_decl.mutable == MQ_CONST) {
+                    if (!Module_Constant(n, out)) {
+                        MODULE_PRINT("The constant '%s' of the module '%s' needs a value known at compile time to be "
+                                     "exported.\n", n->node.var_decl.id->value, name);
+                        status = STATUS_FAIL;
+                    }
+                    constants++;
+                    break;
+                }
+                // There is no entry point to initialize variables either
+                // Fall through
+
+            default:
+                MODULE_PRINT("The module '%s' has a top-level statement of type %s. Modules have no entry point to "
+                             "run it and may only define procedures, complex types and constants.\n", name,
+                             NodeType_ToString(n->type));
+                status = STATUS_FAIL;
+                break;
+        }
+    }
+
+    fclose(out);
+
+    char *dir = Module_Directory(input);
+    char *path = malloc(strlen(dir) + strlen(name) + 8);
+    sprintf(path, "%s/%s.flowi", dir, name);
+
+    // An unchanged interface is left alone, along with everything built from it
+    char *old = status == STATUS_OK ? read_file(path) : NULL;
+
+    if (status == STATUS_FAIL) {
+        MODULE_PRINT("No interface was written for the module '%s'.\n", name);
+    } else if (old && strcmp(old, text) == 0) {
+        MODULE_PRINT("The interface of the module '%s' in \"%s\" is unchanged.\n", name, path);
+    } else {
+        FILE *file = fopen(path, "w");
+
+        if (!file || fwrite(text, 1, length, file) != length) {
+            MODULE_PRINT("Could not write the interface of the module '%s' to \"%s\".\n", name, path);
+            status = STATUS_FAIL;
+        } else {
+            MODULE_PRINT("Wrote the interface of the module '%s' to \"%s\": %u procedure(s), %u complex type(s) "
+                         "and %u constant(s).\n", name, path, procedures, types, constants);
+        }
+
+        if (file)
+            fclose(file);
+    }
+
+    free(old);
+    free(path);
+    free(dir);
+    free(text);
+
+    return status;
+}
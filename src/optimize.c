@@ -0,0 +1,77 @@
+#include "include/optimize.h"
+#include "include/fold.h"
+#include "include/deadcode.h"
+#include "include/cse.h"
+#include "include/inline.h"
+#include "include/loop.h"
+#include "include/bounds.h"
+#include "include/pure.h"
+
+void Optimize_Program(Node *program, Options *opts) {
+    FoldStatistics fold = {0};
+    DeadCode *dc = DeadCode_Create(opts->bounds_checks);
+
+    // Calls to pure procedures with literal arguments are folded to their result
+    unsigned pure = Pure_Program(program);
+
+    Fold_Program(&fold, program);
+    DeadCode_Program(dc, program);
+
+    // Inlined bodies open up further folding and leave procedures unused. Instrumented code keeps
+    // every procedure out of line, where its entries are counted.
+    if (opts->inline_threshold > 0 && !opts->profile_generate) {
+        Inliner *inl = Inliner_Create(opts->inline_threshold, opts->inline_report);
+
+        Inline_Program(inl, program);
+
+        OPTIMIZE_PRINT("Inlined %u call(s), declined %u.\n", inl->inlined, inl->declined);
+
+        if (inl->inlined > 0) {
+            Fold_Program(&fold, program);
+            DeadCode_Program(dc, program);
+        }
+
+        Inliner_Destroy(inl);
+    }
+
+    OPTIMIZE_PRINT("Folded %u expression(s), propagated %u constant(s), pruned %u check alternative(s) and loop(s).\n",
+                   fold.folded, fold.propagated, fold.pruned);
+
+    OPTIMIZE_PRINT("Found %u pure procedure(s), evaluated %u call(s) to them at compile time, abandoned %u at the limits.\n",
+                   pure, fold.evaluated, fold.abandoned);
+
+    OPTIMIZE_PRINT("Removed %u dead statement(s), %u unused variable(s) and %u unreachable procedure(s).\n",
+                   dc->statements, dc->variables, dc->procedures);
+
+    DeadCode_Destroy(dc);
+
+    // Ahead of the loop optimizations, which hide the ranges of counters behind temporaries
+    Bounds *bounds = Bounds_Create(opts->bounds_checks);
+
+    Bounds_Program(bounds, program);
+
+    if (opts->bounds_checks) {
+        OPTIMIZE_PRINT("Proved %u of %u array access(es) to be in bounds, %u check(s) remain.\n", bounds->proven,
+                       bounds->accesses, bounds->accesses - bounds->proven);
+    } else {
+        OPTIMIZE_PRINT("Bounds checks are disabled, %u array access(es) are unchecked.\n", bounds->accesses);
+    }
+
+    Bounds_Destroy(bounds);
+
+    LoopStatistics loops = {0};
+
+    Loop_Program(&loops, program);
+
+    OPTIMIZE_PRINT("Found %u induction variable(s) in %u loop(s), strength-reduced %u multiplication(s), hoisted %u invariant computation(s).\n",
+                   loops.inductions, loops.loops, loops.reduced, loops.hoisted);
+
+    Cse *cse = Cse_Create();
+
+    Cse_Program(cse, program);
+
+    OPTIMIZE_PRINT("Reused %u common subexpression(s) through %u temporar%s.\n", cse->eliminated, cse->temps,
+                   cse->temps == 1 ? "y" : "ies");
+
+    Cse_Destroy(cse);
+}
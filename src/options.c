@@ -0,0 +1,263 @@
+#include "include/options.h"
+#include "include/vectorize.h"
+#include "include/codecache.h"
+#include "include/dump.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void Options_Default(Options *opts) {
+    opts->input = "main.flow";
+    opts->module = false;
+    opts->ast_cache = NULL;
+    opts->code_cache = NULL;
+    opts->code_cache_size = CODE_CACHE_SIZE;
+    opts->inline_threshold = 24;
+    opts->inline_report = false;
+    opts->output = NULL;
+    opts->dump_ast = DUMP_NONE;
+    opts->dump_file = NULL;
+    opts->print_ir = false;
+    opts->vector = VECTOR_SSE2;
+    opts->vectorize_report = false;
+    opts->bounds_checks = true;
+    opts->profile_generate = NULL;
+    opts->profile_use = NULL;
+    opts->server = NULL;
+    opts->connect = NULL;
+    opts->memory_report = false;
+    opts->trace = NULL;
+}
+
+void Options_Usage(const char *program) {
+    printf("Usage: %s [options] [file]\n", program);
+    printf("  --module               Compile FILE as a module for others to import, writing its interface\n");
+    printf("  --ast-cache=DIR        Keep parsed syntax trees in DIR, reparsing only what an edit touches\n");
+    printf("  --code-cache=DIR       Keep generated procedures in DIR, regenerating only those that changed\n");
+    printf("  --code-cache-size=N    Evict the least recently used procedures past N megabytes (default 64)\n");
+    printf("  --inline-threshold=N   Inline procedures of up to N nodes (default 24, 0 disables)\n");
+    printf("  --inline-report        Report every inlining decision\n");
+    printf("  -o FILE                Write x86-64 assembly to FILE\n");
+    printf("  --dump-ast=FORMAT[:F]  Print the syntax tree as text, or write it to F as text, json or sexpr\n");
+    printf("  --print-ir             Print the intermediate representation\n");
+    printf("  --vectorize=ISA        Vectorize loops with none, sse2 (default) or avx2\n");
+    printf("  --vectorize-report     Report every vectorization decision\n");
+    printf("  --no-bounds-checks     Do not check array indices at run time\n");
+    printf("  --profile-generate=F   Count procedure entries and check branches, writing them to F on exit\n");
+    printf("  --profile-use=F        Inline, lay out branches and order procedures by the profile in F\n");
+    printf("  --server=SOCKET        Serve compiles on SOCKET, keeping syntax trees in memory between them\n");
+    printf("  --connect=SOCKET       Have the server on SOCKET compile, compiling here if there is none\n");
+    printf("  --memory-report        Report the allocations of every phase and those left at exit\n");
+    printf("  --trace=FILE           Write Chrome trace events of every phase and procedure to FILE\n");
+}
+
+// Parse an integer option value, rejecting anything that is not a plain non-negative number
+Status Options_Integer(const char *str, int *out) {
+    char *end;
+    long val = strtol(str, &end, 10);
+
+    if (*str == 0 || *end != 0 || val < 0 || val > 1000000)
+        return STATUS_FAIL;
+
+    *out = (int) val;
+    return STATUS_OK;
+}
+
+#define VALUE_OF(arg, prefix) (strncmp(arg, prefix, strlen(prefix)) == 0 ? arg + strlen(prefix) : NULL)
+
+Status Options_Parse(Options *opts, int argc, char **argv) {
+    for (int i = 1; i < argc; i++) {
+        char *arg = argv[i];
+        char *val;
+
+        if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            Options_Usage(argv[0]);
+            return STATUS_FAIL;
+        }
+
+        if (strcmp(arg, "--module") == 0) {
+            opts->module = true;
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--ast-cache="))) {
+            if (*val == 0) {
+                printf("Missing directory after \"--ast-cache=\".\n");
+                return STATUS_FAIL;
+            }
+            opts->ast_cache = val;
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--code-cache="))) {
+            if (*val == 0) {
+                printf("Missing directory after \"--code-cache=\".\n");
+                return STATUS_FAIL;
+            }
+            opts->code_cache = val;
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--code-cache-size="))) {
+            if (!Options_Integer(val, &opts->code_cache_size)) {
+                printf("Invalid code cache size \"%s\".\n", val);
+                return STATUS_FAIL;
+            }
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--inline-threshold="))) {
+            if (!Options_Integer(val, &opts->inline_threshold)) {
+                printf("Invalid inlining threshold \"%s\".\n", val);
+                return STATUS_FAIL;
+            }
+            continue;
+        }
+
+        if (strcmp(arg, "--inline-report") == 0) {
+            opts->inline_report = true;
+            continue;
+        }
+
+        if (strcmp(arg, "-o") == 0) {
+            if (i + 1 >= argc) {
+                printf("Missing output file after \"-o\".\n");
+                return STATUS_FAIL;
+            }
+            opts->output = argv[++i];
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--dump-ast="))) {
+            // The file follows the format, the json and sexpr dumps are not mixed with the messages
+            char *file = strchr(val, ':');
+            size_t length = file ? (size_t) (file - val) : strlen(val);
+
+            if (length == 4 && strncmp(val, "text", 4) == 0) {
+                opts->dump_ast = DUMP_TEXT;
+            } else if (length == 4 && strncmp(val, "json", 4) == 0) {
+                opts->dump_ast = DUMP_JSON;
+            } else if (length == 5 && strncmp(val, "sexpr", 5) == 0) {
+                opts->dump_ast = DUMP_SEXPR;
+            } else {
+                printf("Invalid syntax tree format \"%.*s\", expected text, json or sexpr.\n", (int) length, val);
+                return STATUS_FAIL;
+            }
+
+            if (file && file[1] == 0) {
+                printf("Missing file after \"--dump-ast=%.*s:\".\n", (int) length, val);
+                return STATUS_FAIL;
+            }
+
+            if (!file && opts->dump_ast != DUMP_TEXT) {
+                printf("The %s syntax tree is written to a file, use \"--dump-ast=%s:FILE\".\n", val, val);
+                return STATUS_FAIL;
+            }
+
+            opts->dump_file = file ? file + 1 : NULL;
+            continue;
+        }
+
+        if (strcmp(arg, "--print-ir") == 0) {
+            opts->print_ir = true;
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--vectorize="))) {
+            if (strcmp(val, "none") == 0) {
+                opts->vector = 0;
+            } else if (strcmp(val, "sse2") == 0) {
+                opts->vector = VECTOR_SSE2;
+            } else if (strcmp(val, "avx2") == 0) {
+                opts->vector = VECTOR_AVX2;
+            } else {
+                printf("Invalid instruction set \"%s\", expected none, sse2 or avx2.\n", val);
+                return STATUS_FAIL;
+            }
+            continue;
+        }
+
+        if (strcmp(arg, "--vectorize-report") == 0) {
+            opts->vectorize_report = true;
+            continue;
+        }
+
+        if (strcmp(arg, "--no-bounds-checks") == 0) {
+            opts->bounds_checks = false;
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--profile-generate="))) {
+            if (*val == 0) {
+                printf("Missing profile after \"--profile-generate=\".\n");
+                return STATUS_FAIL;
+            }
+            opts->profile_generate = val;
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--profile-use="))) {
+            if (*val == 0) {
+                printf("Missing profile after \"--profile-use=\".\n");
+                return STATUS_FAIL;
+            }
+            opts->profile_use = val;
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--server="))) {
+            if (*val == 0) {
+                printf("Missing socket after \"--server=\".\n");
+                return STATUS_FAIL;
+            }
+            opts->server = val;
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--connect="))) {
+            if (*val == 0) {
+                printf("Missing socket after \"--connect=\".\n");
+                return STATUS_FAIL;
+            }
+            opts->connect = val;
+            continue;
+        }
+
+        if (strcmp(arg, "--memory-report") == 0) {
+            opts->memory_report = true;
+            continue;
+        }
+
+        if ((val = VALUE_OF(arg, "--trace="))) {
+            if (*val == 0) {
+                printf("Missing file after \"--trace=\".\n");
+                return STATUS_FAIL;
+            }
+            opts->trace = val;
+            continue;
+        }
+
+        if (arg[0] == '-') {
+            printf("Unknown option \"%s\".\n", arg);
+            Options_Usage(argv[0]);
+            return STATUS_FAIL;
+        }
+
+        opts->input = arg;
+    }
+
+    if (opts->profile_generate && opts->profile_use) {
+        printf("A profile cannot be generated and used at once.\n");
+        return STATUS_FAIL;
+    }
+
+    if (opts->server && opts->connect) {
+        printf("A server cannot send its compiles to another.\n");
+        return STATUS_FAIL;
+    }
+
+    return STATUS_OK;
+}
+
+#undef VALUE_OF
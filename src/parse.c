@@ -1,814 +1,1337 @@
-#include "include/parse.h"
-#include "include/conv.h"
-#include "include/param.h"
-
-#include <stdlib.h>
-#include <string.h>
-
-Parser *Parser_CreateParser(Tokenizer *tokenizer) {
-    Parser *parser = malloc(sizeof(Parser));
-    parser->tokenizer = tokenizer;
-    parser->current = NULL;
-    parser->next = NULL;
-    parser->lastBlock = NULL;
-
-    Parser_Consume(parser);
-    Parser_Consume(parser);
-
-    return parser;
-}
-
-void Parser_DestroyParser(Parser *parser) {
-    if (parser->current)
-        Token_Destroy(parser->current);
-
-    if (parser->next)
-        Token_Destroy(parser->next);
-
-    free(parser);
-}
-
-void Parser_Consume(Parser *parser) {
-    if (parser->current)
-        Token_Destroy(parser->current);
-    parser->current = parser->next;
-    Tokenizer_Next(parser->tokenizer);
-    parser->next = Token_Dup(parser->tokenizer->current);
-}
-
-bool Parser_Compare(Parser *p, TokenDesignation td, TokenType tt, const char *str) {
-    Token *tok = (td == CURRENT) ? p->current : p->next;
-    if (!tok)
-        return false;
-    if (str != NULL)
-        return (strcmp(tok->value, str) == 0) && tok->type == tt;
-    else
-        return tok->type == tt;
-}
-
-Node *Parser_ParseProgram(Parser *parser) {
-    Array *arr = Array_Create();
-    Node *blk = Node_CreateBlock(arr, NULL);
-
-    parser->lastBlock = blk;
-    parser->rootBlock = blk;
-
-    while (true) {
-        if (Parser_Compare(parser, CURRENT, TT_UNKNOWN, NULL))
-            break;
-
-        Node *n = Parser_ParseNext(parser);
-
-        if (n == NULL) {
-            Array_DestroyCallBack(arr, (void *) Node_DestroyRecurse);
-            Node_DestroyRecurse(blk);
-            return NULL;
-        }
-
-        Array_Push(arr, n);
-    }
-
-    return Node_CreateProgram(blk);
-}
-
-Node *Parser_ParseNext(Parser *parser) {
-
-    if (Parser_Compare(parser, CURRENT, TT_KW_VARYING, NULL) || Parser_Compare(parser, CURRENT, TT_KW_CONSTANT, NULL))
-        return Parser_ParseVariableDeclaration(parser);
-
-    if (Parser_Compare(parser, CURRENT, TT_IDEN, NULL) && Parser_Compare(parser, NEXT, TT_EQUALS, NULL))
-        return Parser_ParseVariableAssignment(parser);
-
-    if (Parser_Compare(parser, CURRENT, TT_KW_PROCEDURE, NULL))
-        return Parser_ParseFunctionDefinition(parser);
-
-    if (Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL))
-        return Parser_ParseBlock(parser);
-
-    if (Parser_Compare(parser, CURRENT, TT_KW_RETURN, NULL))
-        return Parser_ParseReturn(parser);
-
-    if (Parser_Compare(parser, CURRENT, TT_KW_CHECK, NULL))
-        return Parser_ParseCheck(parser);
-
-    // Last resort
-    Node *n = Parser_ParseExpression(parser);
-
-    if (!n)
-        return NULL;
-
-    if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
-        SYNTAX_ERR("Expected ';' after expression.\n");
-        Node_DestroyRecurse(n);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // Skip ';'
-    return n;
-}
-
-Node *Parser_ParseStringLiteral(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_LSTRING, NULL)) {
-        SYNTAX_ERR("Expected string literal, got %s\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-    Node *lit = Node_CreateStringLiteral(parser->current->value);
-    Parser_Consume(parser); // Next token
-    return lit;
-}
-
-Node *Parser_ParseIntegerLiteral(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_LINT, NULL)) {
-        SYNTAX_ERR("Expected integer literal, got %s\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-    Node *lit = Node_CreateIntegerLiteral(stoi(parser->current->value));
-    Parser_Consume(parser); // Next token
-    return lit;
-}
-
-Node *Parser_ParseRealLiteral(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_LFLOAT, NULL)) {
-        SYNTAX_ERR("Expected float literal, got %s\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-    Node *lit = Node_CreateFloatLiteral(stof(parser->current->value));
-    Parser_Consume(parser); // Next token
-    return lit;
-}
-
-Node *Parser_ParseVariableReference(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-        SYNTAX_ERR("Expected identifier, got %s.\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-    Node *ref = Node_CreateVariableReference(parser->current, parser->lastBlock);
-    Parser_Consume(parser); // SKip to the next token
-    return ref;
-}
-
-Node *Parser_ParseVariableAssignment(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-        SYNTAX_ERR("Expected identifier. got %s.\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-
-    Token *id = Token_Dup(parser->current);
-
-    Parser_Consume(parser);
-
-    if (!Parser_Compare(parser, CURRENT, TT_EQUALS, NULL)) {
-        SYNTAX_ERR("Expected '=' after identifier \"%s\".\n", parser->current->value);
-        return NULL;
-    }
-
-    Parser_Consume(parser);
-
-    Node *expr = Parser_ParseExpression(parser);
-
-    if (!expr) {
-        Token_Destroy(id);
-        return NULL;
-    }
-
-    if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
-        SYNTAX_ERR("Expected ';' after target expression, got \"%s\".\n", parser->current->value);
-        Token_Destroy(id);
-        Node_DestroyRecurse(expr);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // Skip ';'
-
-    Node *n = Node_CreateVariableAssignment(id, expr, parser->lastBlock);
-    Token_Destroy(id);
-    return n;
-}
-
-// identifier "(" expression ["," expression] ... ")"
-Node *Parser_ParseFunctionCall(Parser *parser) {
-
-    Token *identifier;
-
-    // identifier
-    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-        SYNTAX_ERR("Expected identifier, got %s\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-
-    identifier = Token_Dup(parser->current);
-
-    Parser_Consume(parser);
-
-    // (
-    if (!Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
-        SYNTAX_ERR("Expected '(' after identifier \"\"");
-        Token_Destroy(identifier);
-        return NULL;
-    }
-
-    Parser_Consume(parser);
-
-    Array *exprs = Array_Create();
-
-    // Parameters (expr. seq.)
-    while (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL) && parser->current != NULL) {
-        // Expression
-        Node *expr = Parser_ParseExpression(parser);
-
-        Array_Push(exprs, expr);
-
-//         ',' or ')'
-        if (Parser_Compare(parser, CURRENT, TT_COMMA, NULL) && !Parser_Compare(parser, NEXT, TT_RPAREN, NULL)) {
-            Parser_Consume(parser);
-            continue;
-        }
-
-        if (Parser_Compare(parser, CURRENT, TT_RPAREN, NULL))
-            continue;
-
-        SYNTAX_ERR("Expected ')' or ',' and more expressions.\n");
-        Token_Destroy(identifier);
-        Array_DestroyCallBack(exprs, (void *) Node_DestroyRecurse);
-        return NULL;
-
-    }
-
-    if (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL)) {
-        SYNTAX_ERR("Expected ')' after the list of expressions. Got \"%s\"\n", parser->current->value);
-
-        Token_Destroy(identifier);
-        Array_DestroyCallBack(exprs, (void *) Node_DestroyRecurse);
-
-        return NULL;
-    }
-
-    Parser_Consume(parser); // SKip ')'
-
-    Node *fcall = Node_CreateFunctionCall(identifier, exprs, parser->lastBlock);
-    Token_Destroy(identifier);
-
-    return fcall;
-}
-
-// "varying" | "const" identifier ":" type "=" expression ";"
-Node *Parser_ParseVariableDeclaration(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_KW_VARYING, NULL) &&
-        !Parser_Compare(parser, CURRENT, TT_KW_CONSTANT, NULL)) {
-        SYNTAX_ERR("Expected modification qualifier ('varying' or 'const'). Got \"%s\" instead.\n",
-                   parser->current->value);
-        return NULL;
-    }
-
-    ModificationQualifier modQua = ModificationQualifier_FromTokenType(parser->current->type);
-
-    Parser_Consume(parser); // Skip the qualifier
-
-    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-        SYNTAX_ERR("Expected variable name (identifier). Got %s.\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-
-    Token *id = Token_Dup(parser->current);
-
-    Parser_Consume(parser); // Skip the identifier
-
-    if (!Parser_Compare(parser, CURRENT, TT_COLON, NULL)) {
-        SYNTAX_ERR("Expected colon ':' after identifier, got \"%s\".\n", parser->current->value);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // Skip the colon
-
-    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-        SYNTAX_ERR("Expected type (identifier) after ':', got %s.\n", TokenType_String(parser->current->type));
-        Token_Destroy(id);
-        return NULL;
-    }
-
-    Token *type = Token_Dup(parser->current);
-
-    Parser_Consume(parser); // Skip the type identifier
-
-    // No initial value
-    if (Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
-
-        if (modQua == MQ_CONST) {
-            SYNTAX_ERR(
-                    "Variables with the 'constant' qualifier may not be left unassigned upon declaration. Missing initial value for const \"%s\".\n",
-                    id->value);
-            Token_Destroy(id);
-            Token_Destroy(type);
-            return NULL;
-        }
-
-        Parser_Consume(parser); // Skip ';'
-
-        Node *n = Node_CreateVariableDeclaration(id, NULL, type, modQua, parser->lastBlock);
-
-        Token_Destroy(id);
-        Token_Destroy(type);
-
-        return n;
-    }
-
-    // Initial value
-    if (!Parser_Compare(parser, CURRENT, TT_EQUALS, NULL)) {
-        SYNTAX_ERR("Expected ';' or '=' and an initial value for the variable \"%s\", got %s.\n", id->value,
-                   TokenType_String(parser->current->type));
-        Token_Destroy(id);
-        Token_Destroy(type);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // SKip '='
-
-    Node *expr = Parser_ParseExpression(parser);
-
-    if (expr == NULL) {
-        Token_Destroy(id);
-        Token_Destroy(type);
-        return NULL;
-    }
-
-    if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
-        SYNTAX_ERR("Expected ';' after the expression, got %s.\n", TokenType_String(parser->current->type));
-        Token_Destroy(id);
-        Token_Destroy(type);
-        Node_DestroyRecurse(expr);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // Skip ';'
-
-    Node *n = Node_CreateVariableDeclaration(id, expr, type, modQua, parser->lastBlock);
-
-    Token_Destroy(id);
-    Token_Destroy(type);
-
-    return n;
-}
-
-Node *Parser_ParseSubExpression(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
-        SYNTAX_ERR("Expected '(' at the start of a subexpression, got %s.\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-    Parser_Consume(parser); // SKip the '('
-    Node *expr = Parser_ParseExpression(parser);
-    if (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL)) {
-        SYNTAX_ERR("Expected ')' after sub-expression.\n");
-        Node_DestroyRecurse(expr);
-        return NULL;
-    }
-    Parser_Consume(parser);
-    return expr;
-}
-
-Node *Parser_ParseExpression(Parser *parser) {
-    Node *left = Parser_ParseSecondDegree(parser);
-
-    if (!left)
-        return NULL;
-
-    // Addition / Subtraction / And / Or
-    while (Parser_Compare(parser, CURRENT, TT_PLUS, NULL) || Parser_Compare(parser, CURRENT, TT_MINUS, NULL) ||
-           Parser_Compare(parser, CURRENT, TT_AND_AND, NULL) || Parser_Compare(parser, CURRENT, TT_OR_OR, NULL)) {
-        BinaryType type = BinaryType_FromTokenType(parser->current->type);
-
-        if (type == BIN_UNDEF) {
-            SYNTAX_ERR("Unknown binary operation \"%s\".\n", parser->current->value);
-            Node_DestroyRecurse(left);
-            return NULL;
-        }
-
-        Parser_Consume(parser); // next token, skip operation
-
-        Node *right = Parser_ParseExpression(parser);
-
-        if (!right)
-            return NULL;
-
-        left = Node_CreateBinaryOperation(left, right, type, parser->lastBlock);
-    }
-
-    return left;
-}
-
-Node *Parser_ParseSecondDegree(Parser *parser) {
-    Node *left = Parser_ParseAtom(parser);
-
-    if (!left)
-        return NULL;
-
-    // Multiplication / Division / > / < / == / !=
-    while (Parser_Compare(parser, CURRENT, TT_ASTERISK, NULL) || Parser_Compare(parser, CURRENT, TT_SLASH, NULL) ||
-           Parser_Compare(parser, CURRENT, TT_DOUBLE_EQUALS, NULL) ||
-           Parser_Compare(parser, CURRENT, TT_LGREATER, NULL) ||
-           Parser_Compare(parser, CURRENT, TT_RGREATER, NULL) || Parser_Compare(parser, CURRENT, TT_NOT_EQUALS, NULL)) {
-        BinaryType type = BinaryType_FromTokenType(parser->current->type);
-
-        if (type == BIN_UNDEF) {
-            SYNTAX_ERR("Unknown binary operation \"%s\".\n", parser->current->value);
-            Node_DestroyRecurse(left);
-            return NULL;
-        }
-
-        Parser_Consume(parser); // next token, skip operation
-
-        Node *right = Parser_ParseSecondDegree(parser);
-
-        if (!right)
-            return NULL;
-
-        left = Node_CreateBinaryOperation(left, right, type, parser->lastBlock);
-    }
-
-    return left;
-}
-
-Node *Parser_ParseAtom(Parser *parser) {
-
-    // Size directive
-    if (Parser_Compare(parser, CURRENT, TT_KW_SIZE, NULL)) {
-        return Parser_ParseSize(parser);
-    }
-
-    // Sub-expression
-    if (Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
-        return Parser_ParseSubExpression(parser);
-    }
-
-    // Function call
-    if (Parser_Compare(parser, CURRENT, TT_IDEN, NULL) && Parser_Compare(parser, NEXT, TT_LPAREN, NULL)) {
-        if (Parser_Compare(parser, CURRENT, TT_IDEN, "if")) {
-            WARN("if is not a conditional statement, did you mean to use 'check' ?\n");
-        }
-        return Parser_ParseFunctionCall(parser);
-    }
-
-    // Integer Literal
-    if (Parser_Compare(parser, CURRENT, TT_LINT, NULL)) {
-        return Parser_ParseIntegerLiteral(parser);
-    }
-
-    // Real Literal
-    if (Parser_Compare(parser, CURRENT, TT_LFLOAT, NULL)) {
-        return Parser_ParseRealLiteral(parser);
-    }
-
-    // String Literal
-    if (Parser_Compare(parser, CURRENT, TT_LSTRING, NULL)) {
-        return Parser_ParseStringLiteral(parser);
-    }
-
-    // Variable reference
-    if (Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-        return Parser_ParseVariableReference(parser);
-    }
-
-    SYNTAX_ERR("Unknown atom starting with \"%s\".\n", parser->current->value);
-
-    return NULL;
-}
-
-Node *Parser_ParseBlock(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL)) {
-        SYNTAX_ERR("Block statements should start with a '{', got %s.\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-
-    Parser_Consume(parser); // Skip '{'
-
-    Array *blk = Array_Create();
-
-    while (!Parser_Compare(parser, CURRENT, TT_RBRACKET, NULL) && !Parser_Compare(parser, CURRENT, TT_UNKNOWN, NULL)) {
-        Node *n = Parser_ParseNext(parser);
-
-        if (!n) {
-            Array_DestroyCallBack(blk, (void *) Node_DestroyRecurse);
-            return NULL;
-        }
-
-        Array_Push(blk, n);
-    }
-
-    if (!Parser_Compare(parser, CURRENT, TT_RBRACKET, NULL)) {
-        SYNTAX_ERR("Reached end of file while parsing block statement. Missing closing bracket '}'.\n");
-        Array_DestroyCallBack(blk, (void *) Node_DestroyRecurse);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // Skip closing bracket
-
-    Node *block = Node_CreateBlock(blk, parser->lastBlock);
-
-    parser->lastBlock = block;
-
-    return block;
-}
-
-// "procedure" identifier "(" (identifier ":" type [","]) ")" ":" type block
-Node *Parser_ParseFunctionDefinition(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_KW_PROCEDURE, NULL)) {
-        SYNTAX_ERR("Expected 'procedure' keyword, got \"%s\".\n", parser->current->value);
-        return NULL;
-    }
-
-    Parser_Consume(parser);
-
-    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-        SYNTAX_ERR("Expected procedure identifier after 'procedure' keyword, got %s.\n",
-                   TokenType_String(parser->current->type));
-        return NULL;
-    }
-
-    Token *id = Token_Dup(parser->current);
-
-    Parser_Consume(parser); // Skip identifier
-
-    if (!Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
-        SYNTAX_ERR("Expected '(' after procedure identifier \"%s\", got %s.\n", id->value,
-                   TokenType_String(parser->current->type));
-        Token_Destroy(id);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // SKip '('
-
-    Array *params = Array_Create();
-
-    while (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL) && !Parser_Compare(parser, CURRENT, TT_UNKNOWN, NULL)) {
-        if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-            SYNTAX_ERR("Expected parameter identifier, got %s.\n", TokenType_String(parser->current->type));
-            Token_Destroy(id);
-            Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
-            return NULL;
-        }
-
-        Token *param_id = Token_Dup(parser->current);
-
-        Parser_Consume(parser); // Skip the identifier
-
-        if (!Parser_Compare(parser, CURRENT, TT_COLON, NULL)) {
-            SYNTAX_ERR("Expected ':' after parameter identifier, got %s.\n", TokenType_String(parser->current->type));
-            Token_Destroy(id);
-            Token_Destroy(param_id);
-            Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
-            return NULL;
-        }
-
-        Parser_Consume(parser); // Skip ':'
-
-        if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-            SYNTAX_ERR("Expected type identifier after ':' for parameter \"%s\", got %s.\n", param_id->value,
-                       TokenType_String(parser->current->type));
-            Token_Destroy(id);
-            Token_Destroy(param_id);
-            Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
-            return NULL;
-        }
-
-        Token *param_type = Token_Dup(parser->current);
-
-        Parser_Consume(parser); // Skip type identifier
-
-        if (!Parser_Compare(parser, CURRENT, TT_COMMA, NULL) && !Parser_Compare(parser, CURRENT, TT_RPAREN, NULL)) {
-            SYNTAX_ERR("Expected ')' or ',' and more parameters, got %s.\n", TokenType_String(parser->current->type));
-            Token_Destroy(id);
-            Token_Destroy(param_id);
-            Token_Destroy(param_type);
-            Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
-            return NULL;
-        }
-
-        FunctionParameter *param = FunctionParameter_Create(param_id, param_type);
-        Token_Destroy(param_id);
-        Token_Destroy(param_type);
-
-        Array_Push(params, param);
-
-        if (Parser_Compare(parser, CURRENT, TT_COMMA, NULL)) {
-            Parser_Consume(parser);
-        }
-    }
-
-    if (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL)) {
-        SYNTAX_ERR(
-                "Missing closing parentheses ')' after parameter list. Reached end of file while parsing function signature for \"%s\".\n",
-                id->value);
-        Token_Destroy(id);
-        Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // Skip ')'
-
-    if (!Parser_Compare(parser, CURRENT, TT_COLON, NULL)) {
-        SYNTAX_ERR("Expected ':' after ')', got %s in definition of function \"%s\".\n",
-                   TokenType_String(parser->current->type), id->value);
-        Token_Destroy(id);
-        Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // SKip ':'
-
-    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-        SYNTAX_ERR("Expected type identifier after ':' in definition of function \"%s\", got %s.\n", id->value,
-                   TokenType_String(parser->current->type));
-        Token_Destroy(id);
-        Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
-        return NULL;
-    }
-
-    Token *type = Token_Dup(parser->current);
-
-    Parser_Consume(parser); // SKip type identifier
-
-    if (!Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL)) {
-        SYNTAX_ERR("Expected '{' after type identifier for function \"%s\", got %s.\n", id->value,
-                   TokenType_String(parser->current->type));
-        Token_Destroy(id);
-        Token_Destroy(type);
-        Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
-        return NULL;
-    }
-
-    Node *blk = Parser_ParseBlock(parser); // Parse the block statement
-
-    if (!blk) {
-        Token_Destroy(id);
-        Token_Destroy(type);
-        Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
-        return NULL;
-    }
-
-    Node *fdef = Node_CreateFunctionDefinition(id, type, params, blk, parser->lastBlock);
-    Token_Destroy(id);
-    Token_Destroy(type);
-
-    return fdef;
-}
-
-Node *Parser_ParseReturn(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_KW_RETURN, NULL)) {
-        SYNTAX_ERR("Expected 'return', got %s.\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-
-    Parser_Consume(parser); // SKip 'return'
-
-    if (Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
-        Parser_Consume(parser); // SKip ';'
-        return Node_CreateReturn(NULL, parser->lastBlock);
-    }
-
-    Node *expr = Parser_ParseExpression(parser);
-
-    if (!expr)
-        return NULL;
-
-    if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
-        SYNTAX_ERR("Expected ';' after return expression, got %s.\n", TokenType_String(parser->current->type));
-        Node_DestroyRecurse(expr);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // Skip ';'
-
-    return Node_CreateReturn(expr, parser->lastBlock);
-}
-
-Node *Parser_ParseCheck(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_KW_CHECK, NULL)) {
-        SYNTAX_ERR("Expected 'check' keyword at the start of a check statement, got \"%s\".\n", parser->current->value);
-        return NULL;
-    }
-
-    Parser_Consume(parser); // Skip 'check'
-
-    Node *chk = Parser_ParseSubExpression(parser);
-
-    if (!chk)
-        return NULL;
-
-    if (!Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL)) {
-        SYNTAX_ERR("Expected '{' after check expression, got %s.\n", TokenType_String(parser->current->type));
-        Node_DestroyRecurse(chk);
-        return NULL;
-    }
-
-    Node *blk = Parser_ParseBlock(parser);
-
-    if (!blk) {
-        Node_DestroyRecurse(chk);
-        return NULL;
-    }
-
-    Node *check = Node_CreateCheck(chk, blk, NULL, parser->lastBlock);
-    Node *root = check;
-
-    bool flag = true; // false - The final 'otherwise' had already been commited
-
-    while (Parser_Compare(parser, CURRENT, TT_KW_OTHERWISE, NULL)) {
-
-        if (!flag) {
-            SYNTAX_ERR("No more checks allowed after a last-resort 'otherwise'.\n");
-            Node_DestroyRecurse(root);
-            return NULL;
-        }
-
-        Parser_Consume(parser); // Skip 'otherwise'
-
-        Node *expr = NULL;
-
-        // otherwise check
-        if (Parser_Compare(parser, CURRENT, TT_KW_CHECK, NULL)) {
-            Parser_Consume(parser); // SKip 'check'
-
-            if (!Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
-                SYNTAX_ERR("Expected '(' after 'otherwise check', got %s.\n", TokenType_String(parser->current->type));
-                Node_DestroyRecurse(chk);
-                Node_DestroyRecurse(blk);
-                return NULL;
-            }
-
-            expr = Parser_ParseSubExpression(parser);
-
-            if (!expr) {
-                Node_DestroyRecurse(chk);
-                Node_DestroyRecurse(blk);
-                return NULL;
-            }
-        }
-
-        if (!expr)
-            flag = false;
-
-        if (!Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL)) {
-            if (!expr) {
-                SYNTAX_ERR("Expected '{' after 'otherwise', got %s.\n", TokenType_String(parser->current->type));
-            } else {
-                SYNTAX_ERR("Expected '{' after otherwise-check expression, got %s.\n",
-                           TokenType_String(parser->current->type));
-            }
-            Node_DestroyRecurse(blk);
-            Node_DestroyRecurse(chk);
-            if (expr)
-                Node_DestroyRecurse(expr);
-            return NULL;
-        }
-
-        Node *otherwise_blk = Parser_ParseBlock(parser);
-
-        if (!otherwise_blk) {
-            Node_DestroyRecurse(blk);
-            Node_DestroyRecurse(chk);
-            if (expr)
-                Node_DestroyRecurse(expr);
-            return NULL;
-        }
-
-        // Create the sub-check
-        Node *subchk = Node_CreateCheck(expr, otherwise_blk, NULL, parser->lastBlock);
-        check->node.check.sub = subchk;
-        check = subchk;
-    }
-
-    return root;
-}
-
-Node *Parser_ParseSize(Parser *parser) {
-    if (!Parser_Compare(parser, CURRENT, TT_KW_SIZE, NULL)) {
-        SYNTAX_ERR("Expected 'size' keyword at the beginning of a size directive, got %s.\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-
-    Parser_Consume(parser);
-
-    if (!Parser_Compare(parser, CURRENT, TT_LSBRACKET, NULL)) {
-        SYNTAX_ERR("Expected '[' after 'size' keyword, got %s.\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-
-    Parser_Consume(parser);
-
-    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
-        SYNTAX_ERR("Expected size identifier after '[', got %s.\n", TokenType_String(parser->current->type));
-        return NULL;
-    }
-
-    Type *t = Type_CreatePlaceholder(parser->current);
-
-    Parser_Consume(parser);
-
-    if (!Parser_Compare(parser, CURRENT, TT_RSBRACKET, NULL)) {
-        SYNTAX_ERR("Expected ']' after type identifier '%s', got %s.\n", Type_Identifier(t), TokenType_String(parser->current->type));
-        return NULL;
-    }
-
-    Parser_Consume(parser);
-
-    return Node_CreateSize(t, parser->lastBlock);
-}
\ No newline at end of file
+#include "include/parse.h"
+#include "include/conv.h"
+#include "include/param.h"
+#include "include/io.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/memory.h"
+
+Parser *Parser_CreateParser(Tokenizer *tokenizer) {
+    Parser *parser = malloc(sizeof(Parser));
+    parser->tokenizer = tokenizer;
+    parser->current = NULL;
+    parser->next = NULL;
+    parser->position = 0;
+    parser->ahead = 0;
+    parser->lastBlock = NULL;
+    parser->strings = NULL;
+    parser->offsets = NULL;
+    parser->dir = ".";
+    parser->imports = NULL;
+    parser->module = NULL;
+
+    Parser_Consume(parser);
+    Parser_Consume(parser);
+
+    return parser;
+}
+
+void Parser_DestroyParser(Parser *parser) {
+    if (parser->current)
+        Token_Destroy(parser->current);
+
+    if (parser->next)
+        Token_Destroy(parser->next);
+
+    free(parser);
+}
+
+void Parser_Consume(Parser *parser) {
+    if (parser->current)
+        Token_Destroy(parser->current);
+    parser->current = parser->next;
+    parser->position = parser->ahead;
+    Tokenizer_Next(parser->tokenizer);
+    parser->next = Token_Dup(parser->tokenizer->current);
+    parser->ahead = parser->tokenizer->start;
+}
+
+bool Parser_Compare(Parser *p, TokenDesignation td, TokenType tt, const char *str) {
+    Token *tok = (td == CURRENT) ? p->current : p->next;
+    if (!tok)
+        return false;
+    if (str != NULL)
+        return (strcmp(tok->value, str) == 0) && tok->type == tt;
+    else
+        return tok->type == tt;
+}
+
+Node *Parser_ParseProgram(Parser *parser) {
+    Array *arr = Array_Create();
+    Node *blk = Node_CreateBlock(arr, NULL);
+
+    parser->lastBlock = blk;
+    parser->rootBlock = blk;
+    parser->strings = StringPool_Create();
+    parser->imports = Array_Create();
+
+    // The block takes the statements parsed so far with it
+    if (Parser_ParseStatements(parser, arr) == STATUS_FAIL) {
+        Node_DestroyRecurse(blk);
+        StringPool_Destroy(parser->strings);
+        Array_DestroyCallBack(parser->imports, free);
+        parser->imports = NULL;
+        return NULL;
+    }
+
+    Node *program = Node_CreateProgram(blk, parser->strings);
+    program->node.program.imports = parser->imports;
+    parser->imports = NULL;
+
+    return program;
+}
+
+// Top-level statements until the input runs out, in the root block the parser was set up with
+Status Parser_ParseStatements(Parser *parser, Array *arr) {
+    while (true) {
+        if (Parser_Compare(parser, CURRENT, TT_UNKNOWN, NULL))
+            break;
+
+        // The declarations of an interface come in place of the import
+        if (Parser_Compare(parser, CURRENT, TT_KW_IMPORT, NULL)) {
+            if (Parser_ParseImport(parser, arr) == STATUS_FAIL)
+                return STATUS_FAIL;
+            continue;
+        }
+
+        if (parser->offsets)
+            Array_Push(parser->offsets, (void *) (uintptr_t) parser->position);
+
+        Node *n = Parser_ParseNext(parser);
+
+        if (n == NULL)
+            return STATUS_FAIL;
+
+        Array_Push(arr, n);
+    }
+
+    return STATUS_OK;
+}
+
+// "import" identifier ";", parses the interface the module was compiled to, once however often it is imported.
+// Its declarations go to the top level along with those of the modules it imports in turn.
+Status Parser_ParseImport(Parser *parser, Array *arr) {
+    if (!parser->imports)
+        return STATUS_FAIL;
+
+    Parser_Consume(parser); // Skip 'import'
+
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL) || !Parser_Compare(parser, NEXT, TT_SEMI, NULL)) {
+        SYNTAX_ERR("Expected a module name and ';' after 'import', got %s.\n", TokenType_String(parser->current->type));
+        return STATUS_FAIL;
+    }
+
+    char *name = strdup(parser->current->value);
+
+    Parser_Consume(parser); // Skip the name
+    Parser_Consume(parser); // Skip ';'
+
+    for (unsigned i = 0; i < parser->imports->length; i++) {
+        if (strcmp(Array_At(parser->imports, i), name) == 0) {
+            free(name);
+            return STATUS_OK;
+        }
+    }
+
+    // Listed up front, so that modules importing each other stop there
+    Array_Push(parser->imports, name);
+
+    char *path = malloc(strlen(parser->dir) + strlen(name) + 8);
+    sprintf(path, "%s/%s.flowi", parser->dir, name);
+
+    char *str = read_file(path);
+
+    if (!str) {
+        SYNTAX_ERR("Could not read \"%s\", the interface of the module '%s'. Compile the module with --module first.\n",
+                   path, name);
+        free(path);
+        return STATUS_FAIL;
+    }
+
+    char *primed = Tokenizer_Prime(str);
+    Tokenizer *tokenizer = Tokenizer_Create(primed);
+    Parser *sub = Parser_CreateParser(tokenizer);
+    unsigned first = arr->length;
+
+    sub->lastBlock = parser->rootBlock;
+    sub->rootBlock = parser->rootBlock;
+    sub->strings = parser->strings;
+    sub->dir = parser->dir;
+    sub->imports = parser->imports;
+    sub->module = name;
+
+    Status status = Parser_ParseStatements(sub, arr);
+
+    for (unsigned i = first; i < arr->length && status == STATUS_OK; i++) {
+        Node *n = Array_At(arr, i);
+
+        if (n->type == NODE_COMPLEX) {
+            n->node.complx.imported = true;
+        } else if (n->type == NODE_VARIABLE_DECLARATION && n->node.var_decl.mutable == MQ_CONST) {
+            n->node.var_decl.imported = true;
+        } else if (n->type != NODE_FUNCTION_DEFINITION) {
+            SYNTAX_ERR("An interface only declares procedures, complex types and constants, \"%s\" has a %s.\n",
+                       path, NodeType_ToString(n->type));
+            status = STATUS_FAIL;
+        }
+    }
+
+    if (status == STATUS_FAIL) {
+        SYNTAX_ERR("The interface of the module '%s' could not be imported.\n", name);
+    }
+
+    Parser_DestroyParser(sub);
+    Tokenizer_Destroy(tokenizer);
+    free(primed);
+    free(str);
+    free(path);
+
+    return status;
+}
+
+Node *Parser_ParseNext(Parser *parser) {
+
+    if (Parser_Compare(parser, CURRENT, TT_KW_VARYING, NULL) || Parser_Compare(parser, CURRENT, TT_KW_CONSTANT, NULL))
+        return Parser_ParseVariableDeclaration(parser);
+
+    if (Parser_Compare(parser, CURRENT, TT_IDEN, NULL) &&
+        (Parser_Compare(parser, NEXT, TT_EQUALS, NULL) || Parser_Compare(parser, NEXT, TT_LSBRACKET, NULL)))
+        return Parser_ParseVariableAssignment(parser);
+
+    if (Parser_Compare(parser, CURRENT, TT_KW_PROCEDURE, NULL))
+        return Parser_ParseFunctionDefinition(parser);
+
+    if (Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL))
+        return Parser_ParseBlock(parser);
+
+    if (Parser_Compare(parser, CURRENT, TT_KW_RETURN, NULL))
+        return Parser_ParseReturn(parser);
+
+    if (Parser_Compare(parser, CURRENT, TT_KW_CHECK, NULL))
+        return Parser_ParseCheck(parser);
+
+    if (Parser_Compare(parser, CURRENT, TT_KW_JMP, NULL))
+        return Parser_ParseJump(parser);
+
+    if (Parser_Compare(parser, CURRENT, TT_KW_LOOP, NULL))
+        return Parser_ParseLoop(parser);
+
+    if (Parser_Compare(parser, CURRENT, TT_KW_COMPLEX, NULL))
+        return Parser_ParseComplex(parser);
+
+    if (Parser_Compare(parser, CURRENT, TT_KW_IMPORT, NULL)) {
+        SYNTAX_ERR("Modules can only be imported at the top level.\n");
+        return NULL;
+    }
+
+    // Last resort
+    Node *n = Parser_ParseExpression(parser);
+
+    if (!n)
+        return NULL;
+
+    if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
+        SYNTAX_ERR("Expected ';' after expression.\n");
+        Node_DestroyRecurse(n);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip ';'
+    return n;
+}
+
+Node *Parser_ParseStringLiteral(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_LSTRING, NULL)) {
+        SYNTAX_ERR("Expected string literal, got %s\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+    unsigned id = StringPool_Intern(parser->strings, parser->current->value);
+    Node *lit = Node_CreateStringLiteral(StringPool_At(parser->strings, id)->text, id);
+    Parser_Consume(parser); // Next token
+    return lit;
+}
+
+Node *Parser_ParseIntegerLiteral(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_LINT, NULL)) {
+        SYNTAX_ERR("Expected integer literal, got %s\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+    long long n;
+
+    if (!stoi(parser->current->value, &n)) {
+        SYNTAX_ERR("The integer literal %s does not fit in a qword.\n", parser->current->value);
+        return NULL;
+    }
+
+    Node *lit = Node_CreateIntegerLiteral(n);
+    Parser_Consume(parser); // Next token
+    return lit;
+}
+
+Node *Parser_ParseRealLiteral(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_LFLOAT, NULL)) {
+        SYNTAX_ERR("Expected float literal, got %s\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+    Node *lit = Node_CreateFloatLiteral(stof(parser->current->value));
+    Parser_Consume(parser); // Next token
+    return lit;
+}
+
+Node *Parser_ParseVariableReference(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        SYNTAX_ERR("Expected identifier, got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+    Node *ref = Node_CreateVariableReference(parser->current, parser->lastBlock);
+    Parser_Consume(parser); // SKip to the next token
+    return ref;
+}
+
+// "[" expression "]"
+Node *Parser_ParseSubscript(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_LSBRACKET, NULL)) {
+        SYNTAX_ERR("Expected '[' and an index, got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip '['
+
+    Node *expr = Parser_ParseExpression(parser);
+
+    if (!expr)
+        return NULL;
+
+    if (!Parser_Compare(parser, CURRENT, TT_RSBRACKET, NULL)) {
+        SYNTAX_ERR("Expected ']' after index, got %s.\n", TokenType_String(parser->current->type));
+        Node_DestroyRecurse(expr);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip ']'
+    return expr;
+}
+
+// identifier "[" expression "]"
+Node *Parser_ParseIndex(Parser *parser) {
+    Node *ref = Parser_ParseVariableReference(parser);
+
+    if (!ref)
+        return NULL;
+
+    Node *expr = Parser_ParseSubscript(parser);
+
+    if (!expr) {
+        Node_DestroyRecurse(ref);
+        return NULL;
+    }
+
+    return Node_CreateIndex(ref, expr, parser->lastBlock);
+}
+
+// identifier ["[" integer "]" | "<" integer ">"], arrays and vectors are named after their element type and length
+Token *Parser_ParseTypeName(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        SYNTAX_ERR("Expected type (identifier), got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Token *type = Token_Dup(parser->current);
+
+    Parser_Consume(parser); // Skip the type identifier
+
+    bool array = Parser_Compare(parser, CURRENT, TT_LSBRACKET, NULL);
+
+    if (!array && !Parser_Compare(parser, CURRENT, TT_RGREATER, NULL))
+        return type;
+
+    Parser_Consume(parser); // Skip '[' or '<'
+
+    if (!Parser_Compare(parser, CURRENT, TT_LINT, NULL) ||
+        !Parser_Compare(parser, NEXT, array ? TT_RSBRACKET : TT_LGREATER, NULL)) {
+        SYNTAX_ERR("Expected the length of the '%s' %s and '%c', got %s.\n", type->value, array ? "array" : "vector",
+                   array ? ']' : '>', TokenType_String(parser->current->type));
+        Token_Destroy(type);
+        return NULL;
+    }
+
+    char *name = malloc(strlen(type->value) + strlen(parser->current->value) + 3);
+    sprintf(name, array ? "%s[%s]" : "%s<%s>", type->value, parser->current->value);
+
+    Token *composite = Token_Create(name, TT_IDEN);
+    free(name);
+    Token_Destroy(type);
+
+    Parser_Consume(parser); // Skip the length
+    Parser_Consume(parser); // Skip ']' or '>'
+
+    return composite;
+}
+
+Node *Parser_ParseVariableAssignment(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        SYNTAX_ERR("Expected identifier. got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Token *id = Token_Dup(parser->current);
+
+    Parser_Consume(parser);
+
+    Node *index = NULL;
+
+    // Element assignment
+    if (Parser_Compare(parser, CURRENT, TT_LSBRACKET, NULL)) {
+        index = Parser_ParseSubscript(parser);
+
+        if (!index) {
+            Token_Destroy(id);
+            return NULL;
+        }
+    }
+
+    if (!Parser_Compare(parser, CURRENT, TT_EQUALS, NULL)) {
+        SYNTAX_ERR("Expected '=' after identifier \"%s\".\n", id->value);
+        Token_Destroy(id);
+        Node_DestroyRecurse(index);
+        return NULL;
+    }
+
+    Parser_Consume(parser);
+
+    Node *expr = Parser_ParseExpression(parser);
+
+    if (!expr) {
+        Token_Destroy(id);
+        Node_DestroyRecurse(index);
+        return NULL;
+    }
+
+    if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
+        SYNTAX_ERR("Expected ';' after target expression, got \"%s\".\n", parser->current->value);
+        Token_Destroy(id);
+        Node_DestroyRecurse(index);
+        Node_DestroyRecurse(expr);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip ';'
+
+    Node *n = Node_CreateVariableAssignment(id, expr, parser->lastBlock);
+    n->node.var_assign.index = index;
+    n->node.var_assign.checked = index != NULL;
+    Token_Destroy(id);
+    return n;
+}
+
+// identifier "(" expression ["," expression] ... ")"
+Node *Parser_ParseFunctionCall(Parser *parser) {
+
+    Token *identifier;
+
+    // identifier
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        SYNTAX_ERR("Expected identifier, got %s\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    identifier = Token_Dup(parser->current);
+
+    Parser_Consume(parser);
+
+    // (
+    if (!Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
+        SYNTAX_ERR("Expected '(' after identifier \"\"");
+        Token_Destroy(identifier);
+        return NULL;
+    }
+
+    Parser_Consume(parser);
+
+    Array *exprs = Array_Create();
+
+    // Parameters (expr. seq.)
+    while (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL) && parser->current != NULL) {
+        // Expression
+        Node *expr = Parser_ParseExpression(parser);
+
+        Array_Push(exprs, expr);
+
+//         ',' or ')'
+        if (Parser_Compare(parser, CURRENT, TT_COMMA, NULL) && !Parser_Compare(parser, NEXT, TT_RPAREN, NULL)) {
+            Parser_Consume(parser);
+            continue;
+        }
+
+        if (Parser_Compare(parser, CURRENT, TT_RPAREN, NULL))
+            continue;
+
+        SYNTAX_ERR("Expected ')' or ',' and more expressions.\n");
+        Token_Destroy(identifier);
+        Array_DestroyCallBack(exprs, (void *) Node_DestroyRecurse);
+        return NULL;
+
+    }
+
+    if (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL)) {
+        SYNTAX_ERR("Expected ')' after the list of expressions. Got \"%s\"\n", parser->current->value);
+
+        Token_Destroy(identifier);
+        Array_DestroyCallBack(exprs, (void *) Node_DestroyRecurse);
+
+        return NULL;
+    }
+
+    Parser_Consume(parser); // SKip ')'
+
+    Node *fcall = Node_CreateFunctionCall(identifier, exprs, parser->lastBlock);
+    Token_Destroy(identifier);
+
+    return fcall;
+}
+
+// "varying" | "const" identifier ":" type "=" expression ";"
+Node *Parser_ParseVariableDeclaration(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_KW_VARYING, NULL) &&
+        !Parser_Compare(parser, CURRENT, TT_KW_CONSTANT, NULL)) {
+        SYNTAX_ERR("Expected modification qualifier ('varying' or 'const'). Got \"%s\" instead.\n",
+                   parser->current->value);
+        return NULL;
+    }
+
+    ModificationQualifier modQua = ModificationQualifier_FromTokenType(parser->current->type);
+
+    Parser_Consume(parser); // Skip the qualifier
+
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        SYNTAX_ERR("Expected variable name (identifier). Got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Token *id = Token_Dup(parser->current);
+
+    Parser_Consume(parser); // Skip the identifier
+
+    if (!Parser_Compare(parser, CURRENT, TT_COLON, NULL)) {
+        SYNTAX_ERR("Expected colon ':' after identifier, got \"%s\".\n", parser->current->value);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip the colon
+
+    Token *type = Parser_ParseTypeName(parser);
+
+    if (!type) {
+        Token_Destroy(id);
+        return NULL;
+    }
+
+    // No initial value
+    if (Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
+
+        if (modQua == MQ_CONST) {
+            SYNTAX_ERR(
+                    "Variables with the 'constant' qualifier may not be left unassigned upon declaration. Missing initial value for const \"%s\".\n",
+                    id->value);
+            Token_Destroy(id);
+            Token_Destroy(type);
+            return NULL;
+        }
+
+        Parser_Consume(parser); // Skip ';'
+
+        Node *n = Node_CreateVariableDeclaration(id, NULL, type, modQua, parser->lastBlock);
+
+        Token_Destroy(id);
+        Token_Destroy(type);
+
+        return n;
+    }
+
+    // Initial value
+    if (!Parser_Compare(parser, CURRENT, TT_EQUALS, NULL)) {
+        SYNTAX_ERR("Expected ';' or '=' and an initial value for the variable \"%s\", got %s.\n", id->value,
+                   TokenType_String(parser->current->type));
+        Token_Destroy(id);
+        Token_Destroy(type);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // SKip '='
+
+    Node *expr = Parser_ParseExpression(parser);
+
+    if (expr == NULL) {
+        Token_Destroy(id);
+        Token_Destroy(type);
+        return NULL;
+    }
+
+    if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
+        SYNTAX_ERR("Expected ';' after the expression, got %s.\n", TokenType_String(parser->current->type));
+        Token_Destroy(id);
+        Token_Destroy(type);
+        Node_DestroyRecurse(expr);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip ';'
+
+    Node *n = Node_CreateVariableDeclaration(id, expr, type, modQua, parser->lastBlock);
+
+    Token_Destroy(id);
+    Token_Destroy(type);
+
+    return n;
+}
+
+Node *Parser_ParseSubExpression(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
+        SYNTAX_ERR("Expected '(' at the start of a subexpression, got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+    Parser_Consume(parser); // SKip the '('
+    Node *expr = Parser_ParseExpression(parser);
+    if (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL)) {
+        SYNTAX_ERR("Expected ')' after sub-expression.\n");
+        Node_DestroyRecurse(expr);
+        return NULL;
+    }
+    Parser_Consume(parser);
+    return expr;
+}
+
+Node *Parser_ParseExpression(Parser *parser) {
+    Node *left = Parser_ParseSecondDegree(parser);
+
+    if (!left)
+        return NULL;
+
+    // Addition / Subtraction / And / Or
+    while (Parser_Compare(parser, CURRENT, TT_PLUS, NULL) || Parser_Compare(parser, CURRENT, TT_MINUS, NULL) ||
+           Parser_Compare(parser, CURRENT, TT_AND_AND, NULL) || Parser_Compare(parser, CURRENT, TT_OR_OR, NULL)) {
+        BinaryType type = BinaryType_FromTokenType(parser->current->type);
+
+        if (type == BIN_UNDEF) {
+            SYNTAX_ERR("Unknown binary operation \"%s\".\n", parser->current->value);
+            Node_DestroyRecurse(left);
+            return NULL;
+        }
+
+        Parser_Consume(parser); // next token, skip operation
+
+        Node *right = Parser_ParseExpression(parser);
+
+        if (!right) {
+            Node_DestroyRecurse(left);
+            return NULL;
+        }
+
+        left = Node_CreateBinaryOperation(left, right, type, parser->lastBlock);
+    }
+
+    return left;
+}
+
+Node *Parser_ParseSecondDegree(Parser *parser) {
+    Node *left = Parser_ParseAtom(parser);
+
+    if (!left)
+        return NULL;
+
+    // Multiplication / Division / > / < / == / !=
+    while (Parser_Compare(parser, CURRENT, TT_ASTERISK, NULL) || Parser_Compare(parser, CURRENT, TT_SLASH, NULL) ||
+           Parser_Compare(parser, CURRENT, TT_DOUBLE_EQUALS, NULL) ||
+           Parser_Compare(parser, CURRENT, TT_LGREATER, NULL) ||
+           Parser_Compare(parser, CURRENT, TT_RGREATER, NULL) || Parser_Compare(parser, CURRENT, TT_NOT_EQUALS, NULL)) {
+        BinaryType type = BinaryType_FromTokenType(parser->current->type);
+
+        if (type == BIN_UNDEF) {
+            SYNTAX_ERR("Unknown binary operation \"%s\".\n", parser->current->value);
+            Node_DestroyRecurse(left);
+            return NULL;
+        }
+
+        Parser_Consume(parser); // next token, skip operation
+
+        Node *right = Parser_ParseSecondDegree(parser);
+
+        if (!right) {
+            Node_DestroyRecurse(left);
+            return NULL;
+        }
+
+        left = Node_CreateBinaryOperation(left, right, type, parser->lastBlock);
+    }
+
+    return left;
+}
+
+Node *Parser_ParseAtom(Parser *parser) {
+
+    // Size directive
+    if (Parser_Compare(parser, CURRENT, TT_KW_SIZE, NULL)) {
+        return Parser_ParseSize(parser);
+    }
+
+    // Horizontal sum
+    if (Parser_Compare(parser, CURRENT, TT_KW_REDUCE, NULL)) {
+        return Parser_ParseReduce(parser);
+    }
+
+    // Sub-expression
+    if (Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
+        return Parser_ParseSubExpression(parser);
+    }
+
+    // Function call
+    if (Parser_Compare(parser, CURRENT, TT_IDEN, NULL) && Parser_Compare(parser, NEXT, TT_LPAREN, NULL)) {
+        if (Parser_Compare(parser, CURRENT, TT_IDEN, "if")) {
+            WARN("if is not a conditional statement, did you mean to use 'check' ?\n");
+        }
+        return Parser_ParseFunctionCall(parser);
+    }
+
+    // Integer Literal
+    if (Parser_Compare(parser, CURRENT, TT_LINT, NULL)) {
+        return Parser_ParseIntegerLiteral(parser);
+    }
+
+    // Real Literal
+    if (Parser_Compare(parser, CURRENT, TT_LFLOAT, NULL)) {
+        return Parser_ParseRealLiteral(parser);
+    }
+
+    // String Literal
+    if (Parser_Compare(parser, CURRENT, TT_LSTRING, NULL)) {
+        return Parser_ParseStringLiteral(parser);
+    }
+
+    // Array element
+    if (Parser_Compare(parser, CURRENT, TT_IDEN, NULL) && Parser_Compare(parser, NEXT, TT_LSBRACKET, NULL)) {
+        return Parser_ParseIndex(parser);
+    }
+
+    // Variable reference
+    if (Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        return Parser_ParseVariableReference(parser);
+    }
+
+    SYNTAX_ERR("Unknown atom starting with \"%s\".\n", parser->current->value);
+
+    return NULL;
+}
+
+Node *Parser_ParseBlock(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL)) {
+        SYNTAX_ERR("Block statements should start with a '{', got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip '{'
+
+    // The block is created up front so that its statements are parsed into its scope
+    Node *block = Node_CreateBlock(Array_Create(), parser->lastBlock);
+    Array *blk = block->node.block.nodes;
+
+    parser->lastBlock = block;
+
+    while (!Parser_Compare(parser, CURRENT, TT_RBRACKET, NULL) && !Parser_Compare(parser, CURRENT, TT_UNKNOWN, NULL)) {
+        Node *n = Parser_ParseNext(parser);
+
+        if (!n) {
+            parser->lastBlock = block->super;
+            Node_DestroyRecurse(block);
+            return NULL;
+        }
+
+        Array_Push(blk, n);
+    }
+
+    parser->lastBlock = block->super;
+
+    if (!Parser_Compare(parser, CURRENT, TT_RBRACKET, NULL)) {
+        SYNTAX_ERR("Reached end of file while parsing block statement. Missing closing bracket '}'.\n");
+        Node_DestroyRecurse(block);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip closing bracket
+
+    return block;
+}
+
+// "procedure" identifier "(" (identifier ":" type [","]) ")" ":" type block
+Node *Parser_ParseFunctionDefinition(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_KW_PROCEDURE, NULL)) {
+        SYNTAX_ERR("Expected 'procedure' keyword, got \"%s\".\n", parser->current->value);
+        return NULL;
+    }
+
+    Parser_Consume(parser);
+
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        SYNTAX_ERR("Expected procedure identifier after 'procedure' keyword, got %s.\n",
+                   TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Token *id = Token_Dup(parser->current);
+
+    Parser_Consume(parser); // Skip identifier
+
+    if (!Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
+        SYNTAX_ERR("Expected '(' after procedure identifier \"%s\", got %s.\n", id->value,
+                   TokenType_String(parser->current->type));
+        Token_Destroy(id);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // SKip '('
+
+    Array *params = Array_Create();
+
+    while (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL) && !Parser_Compare(parser, CURRENT, TT_UNKNOWN, NULL)) {
+        if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+            SYNTAX_ERR("Expected parameter identifier, got %s.\n", TokenType_String(parser->current->type));
+            Token_Destroy(id);
+            Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
+            return NULL;
+        }
+
+        Token *param_id = Token_Dup(parser->current);
+
+        Parser_Consume(parser); // Skip the identifier
+
+        if (!Parser_Compare(parser, CURRENT, TT_COLON, NULL)) {
+            SYNTAX_ERR("Expected ':' after parameter identifier, got %s.\n", TokenType_String(parser->current->type));
+            Token_Destroy(id);
+            Token_Destroy(param_id);
+            Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
+            return NULL;
+        }
+
+        Parser_Consume(parser); // Skip ':'
+
+        if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+            SYNTAX_ERR("Expected type identifier after ':' for parameter \"%s\", got %s.\n", param_id->value,
+                       TokenType_String(parser->current->type));
+            Token_Destroy(id);
+            Token_Destroy(param_id);
+            Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
+            return NULL;
+        }
+
+        Token *param_type = Token_Dup(parser->current);
+
+        Parser_Consume(parser); // Skip type identifier
+
+        if (!Parser_Compare(parser, CURRENT, TT_COMMA, NULL) && !Parser_Compare(parser, CURRENT, TT_RPAREN, NULL)) {
+            SYNTAX_ERR("Expected ')' or ',' and more parameters, got %s.\n", TokenType_String(parser->current->type));
+            Token_Destroy(id);
+            Token_Destroy(param_id);
+            Token_Destroy(param_type);
+            Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
+            return NULL;
+        }
+
+        FunctionParameter *param = FunctionParameter_Create(param_id, param_type);
+        Token_Destroy(param_id);
+        Token_Destroy(param_type);
+
+        Array_Push(params, param);
+
+        if (Parser_Compare(parser, CURRENT, TT_COMMA, NULL)) {
+            Parser_Consume(parser);
+        }
+    }
+
+    if (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL)) {
+        SYNTAX_ERR(
+                "Missing closing parentheses ')' after parameter list. Reached end of file while parsing function signature for \"%s\".\n",
+                id->value);
+        Token_Destroy(id);
+        Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip ')'
+
+    if (!Parser_Compare(parser, CURRENT, TT_COLON, NULL)) {
+        SYNTAX_ERR("Expected ':' after ')', got %s in definition of function \"%s\".\n",
+                   TokenType_String(parser->current->type), id->value);
+        Token_Destroy(id);
+        Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // SKip ':'
+
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        SYNTAX_ERR("Expected type identifier after ':' in definition of function \"%s\", got %s.\n", id->value,
+                   TokenType_String(parser->current->type));
+        Token_Destroy(id);
+        Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
+        return NULL;
+    }
+
+    Token *type = Token_Dup(parser->current);
+
+    Parser_Consume(parser); // SKip type identifier
+
+    // Interfaces declare the procedures of their module, which defines them
+    if (parser->module) {
+        if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
+            SYNTAX_ERR("Expected ';' after the declaration of procedure \"%s\" in an interface, got %s.\n", id->value,
+                       TokenType_String(parser->current->type));
+            Token_Destroy(id);
+            Token_Destroy(type);
+            Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
+            return NULL;
+        }
+
+        Parser_Consume(parser); // Skip ';'
+
+        Node *decl = Node_CreateFunctionDefinition(id, type, params, Node_CreateBlock(Array_Create(), parser->lastBlock),
+                                                   parser->lastBlock);
+        decl->node.func_def.module = parser->module;
+        decl->node.func_def.external = true;
+        Token_Destroy(id);
+        Token_Destroy(type);
+
+        return decl;
+    }
+
+    if (!Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL)) {
+        SYNTAX_ERR("Expected '{' after type identifier for function \"%s\", got %s.\n", id->value,
+                   TokenType_String(parser->current->type));
+        Token_Destroy(id);
+        Token_Destroy(type);
+        Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
+        return NULL;
+    }
+
+    Node *blk = Parser_ParseBlock(parser); // Parse the block statement
+
+    if (!blk) {
+        Token_Destroy(id);
+        Token_Destroy(type);
+        Array_DestroyCallBack(params, (void *) FunctionParameter_Destroy);
+        return NULL;
+    }
+
+    Node *fdef = Node_CreateFunctionDefinition(id, type, params, blk, parser->lastBlock);
+    Token_Destroy(id);
+    Token_Destroy(type);
+
+    return fdef;
+}
+
+Node *Parser_ParseReturn(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_KW_RETURN, NULL)) {
+        SYNTAX_ERR("Expected 'return', got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Parser_Consume(parser); // SKip 'return'
+
+    if (Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
+        Parser_Consume(parser); // SKip ';'
+        return Node_CreateReturn(NULL, parser->lastBlock);
+    }
+
+    Node *expr = Parser_ParseExpression(parser);
+
+    if (!expr)
+        return NULL;
+
+    if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
+        SYNTAX_ERR("Expected ';' after return expression, got %s.\n", TokenType_String(parser->current->type));
+        Node_DestroyRecurse(expr);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip ';'
+
+    return Node_CreateReturn(expr, parser->lastBlock);
+}
+
+// A guaranteed tail call: 'jmp' procedure call ';'
+Node *Parser_ParseJump(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_KW_JMP, NULL)) {
+        SYNTAX_ERR("Expected 'jmp', got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip 'jmp'
+
+    Node *expr = Parser_ParseExpression(parser);
+
+    if (!expr)
+        return NULL;
+
+    if (expr->type != NODE_FUNCTION_CALL) {
+        SYNTAX_ERR("Expected a procedure call after 'jmp'.\n");
+        Node_DestroyRecurse(expr);
+        return NULL;
+    }
+
+    if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
+        SYNTAX_ERR("Expected ';' after jump, got %s.\n", TokenType_String(parser->current->type));
+        Node_DestroyRecurse(expr);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip ';'
+
+    Node *jmp = Node_CreateReturn(expr, parser->lastBlock);
+    jmp->node.ret.jump = true;
+    return jmp;
+}
+
+Node *Parser_ParseCheck(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_KW_CHECK, NULL)) {
+        SYNTAX_ERR("Expected 'check' keyword at the start of a check statement, got \"%s\".\n", parser->current->value);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip 'check'
+
+    Node *chk = Parser_ParseSubExpression(parser);
+
+    if (!chk)
+        return NULL;
+
+    if (!Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL)) {
+        SYNTAX_ERR("Expected '{' after check expression, got %s.\n", TokenType_String(parser->current->type));
+        Node_DestroyRecurse(chk);
+        return NULL;
+    }
+
+    Node *blk = Parser_ParseBlock(parser);
+
+    if (!blk) {
+        Node_DestroyRecurse(chk);
+        return NULL;
+    }
+
+    Node *check = Node_CreateCheck(chk, blk, NULL, parser->lastBlock);
+    Node *root = check;
+
+    bool flag = true; // false - The final 'otherwise' had already been commited
+
+    while (Parser_Compare(parser, CURRENT, TT_KW_OTHERWISE, NULL)) {
+
+        if (!flag) {
+            SYNTAX_ERR("No more checks allowed after a last-resort 'otherwise'.\n");
+            Node_DestroyRecurse(root);
+            return NULL;
+        }
+
+        Parser_Consume(parser); // Skip 'otherwise'
+
+        Node *expr = NULL;
+
+        // otherwise check
+        if (Parser_Compare(parser, CURRENT, TT_KW_CHECK, NULL)) {
+            Parser_Consume(parser); // SKip 'check'
+
+            if (!Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
+                SYNTAX_ERR("Expected '(' after 'otherwise check', got %s.\n", TokenType_String(parser->current->type));
+                Node_DestroyRecurse(chk);
+                Node_DestroyRecurse(blk);
+                return NULL;
+            }
+
+            expr = Parser_ParseSubExpression(parser);
+
+            if (!expr) {
+                Node_DestroyRecurse(chk);
+                Node_DestroyRecurse(blk);
+                return NULL;
+            }
+        }
+
+        if (!expr)
+            flag = false;
+
+        if (!Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL)) {
+            if (!expr) {
+                SYNTAX_ERR("Expected '{' after 'otherwise', got %s.\n", TokenType_String(parser->current->type));
+            } else {
+                SYNTAX_ERR("Expected '{' after otherwise-check expression, got %s.\n",
+                           TokenType_String(parser->current->type));
+            }
+            Node_DestroyRecurse(blk);
+            Node_DestroyRecurse(chk);
+            if (expr)
+                Node_DestroyRecurse(expr);
+            return NULL;
+        }
+
+        Node *otherwise_blk = Parser_ParseBlock(parser);
+
+        if (!otherwise_blk) {
+            Node_DestroyRecurse(blk);
+            Node_DestroyRecurse(chk);
+            if (expr)
+                Node_DestroyRecurse(expr);
+            return NULL;
+        }
+
+        // Create the sub-check
+        Node *subchk = Node_CreateCheck(expr, otherwise_blk, NULL, parser->lastBlock);
+        check->node.check.sub = subchk;
+        check = subchk;
+    }
+
+    return root;
+}
+
+// "loop" "(" identifier ":" type "=" expression "->" expression ")" block
+Node *Parser_ParseLoop(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_KW_LOOP, NULL)) {
+        SYNTAX_ERR("Expected 'loop' keyword at the start of a loop, got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip 'loop'
+
+    if (!Parser_Compare(parser, CURRENT, TT_LPAREN, NULL)) {
+        SYNTAX_ERR("Expected '(' after 'loop', got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip '('
+
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        SYNTAX_ERR("Expected loop counter (identifier) after '(', got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Token *id = Token_Dup(parser->current);
+
+    Parser_Consume(parser); // Skip the identifier
+
+    if (!Parser_Compare(parser, CURRENT, TT_COLON, NULL)) {
+        SYNTAX_ERR("Expected ':' after loop counter \"%s\", got %s.\n", id->value,
+                   TokenType_String(parser->current->type));
+        Token_Destroy(id);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip ':'
+
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        SYNTAX_ERR("Expected type identifier for loop counter \"%s\", got %s.\n", id->value,
+                   TokenType_String(parser->current->type));
+        Token_Destroy(id);
+        return NULL;
+    }
+
+    Token *type = Token_Dup(parser->current);
+
+    Parser_Consume(parser); // Skip the type identifier
+
+    if (!Parser_Compare(parser, CURRENT, TT_EQUALS, NULL)) {
+        SYNTAX_ERR("Expected '=' and the first value of loop counter \"%s\", got %s.\n", id->value,
+                   TokenType_String(parser->current->type));
+        Token_Destroy(id);
+        Token_Destroy(type);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip '='
+
+    Node *from = Parser_ParseExpression(parser);
+
+    if (!from) {
+        Token_Destroy(id);
+        Token_Destroy(type);
+        return NULL;
+    }
+
+    if (!Parser_Compare(parser, CURRENT, TT_POINT_RIGHT, NULL)) {
+        SYNTAX_ERR("Expected '->' and the loop bound, got %s.\n", TokenType_String(parser->current->type));
+        Token_Destroy(id);
+        Token_Destroy(type);
+        Node_DestroyRecurse(from);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip '->'
+
+    Node *to = Parser_ParseExpression(parser);
+
+    if (!to) {
+        Token_Destroy(id);
+        Token_Destroy(type);
+        Node_DestroyRecurse(from);
+        return NULL;
+    }
+
+    if (!Parser_Compare(parser, CURRENT, TT_RPAREN, NULL) || !Parser_Compare(parser, NEXT, TT_LBRACKET, NULL)) {
+        SYNTAX_ERR("Expected ')' and the loop body after the loop bound.\n");
+        Token_Destroy(id);
+        Token_Destroy(type);
+        Node_DestroyRecurse(from);
+        Node_DestroyRecurse(to);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip ')'
+
+    Node *blk = Parser_ParseBlock(parser);
+
+    if (!blk) {
+        Token_Destroy(id);
+        Token_Destroy(type);
+        Node_DestroyRecurse(from);
+        Node_DestroyRecurse(to);
+        return NULL;
+    }
+
+    // The counter lives in the scope of the body and cannot be assigned to
+    Node *var = Node_CreateVariableDeclaration(id, NULL, type, MQ_CONST, blk);
+
+    Token_Destroy(id);
+    Token_Destroy(type);
+
+    return Node_CreateLoop(var, from, to, blk, parser->lastBlock);
+}
+
+// "reduce" "[" expression "]"
+Node *Parser_ParseReduce(Parser *parser) {
+    Parser_Consume(parser); // Skip 'reduce'
+
+    Node *expr = Parser_ParseSubscript(parser);
+
+    if (!expr)
+        return NULL;
+
+    return Node_CreateReduce(expr, parser->lastBlock);
+}
+
+Node *Parser_ParseSize(Parser *parser) {
+    if (!Parser_Compare(parser, CURRENT, TT_KW_SIZE, NULL)) {
+        SYNTAX_ERR("Expected 'size' keyword at the beginning of a size directive, got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Parser_Consume(parser);
+
+    if (!Parser_Compare(parser, CURRENT, TT_LSBRACKET, NULL)) {
+        SYNTAX_ERR("Expected '[' after 'size' keyword, got %s.\n", TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Parser_Consume(parser);
+
+    Token *type = Parser_ParseTypeName(parser);
+
+    if (!type)
+        return NULL;
+
+    Type *t = Type_CreatePlaceholder(type);
+    Token_Destroy(type);
+
+    if (!Parser_Compare(parser, CURRENT, TT_RSBRACKET, NULL)) {
+        SYNTAX_ERR("Expected ']' after type identifier '%s', got %s.\n", Type_Identifier(t), TokenType_String(parser->current->type));
+        Type_Destroy(t);
+        return NULL;
+    }
+
+    Parser_Consume(parser);
+
+    return Node_CreateSize(t, parser->lastBlock);
+}
+
+// "complex" ["ordered"] identifier "{" { identifier ":" type ";" } "}"
+Node *Parser_ParseComplex(Parser *parser) {
+    Parser_Consume(parser); // Skip 'complex'
+
+    bool ordered = Parser_Compare(parser, CURRENT, TT_IDEN, "ordered") && Parser_Compare(parser, NEXT, TT_IDEN, NULL);
+
+    if (ordered)
+        Parser_Consume(parser); // Skip 'ordered'
+
+    if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL)) {
+        SYNTAX_ERR("Expected complex type identifier after 'complex' keyword, got %s.\n",
+                   TokenType_String(parser->current->type));
+        return NULL;
+    }
+
+    Token *id = Token_Dup(parser->current);
+
+    Parser_Consume(parser); // Skip identifier
+
+    if (!Parser_Compare(parser, CURRENT, TT_LBRACKET, NULL)) {
+        SYNTAX_ERR("Expected '{' after complex type identifier \"%s\", got %s.\n", id->value,
+                   TokenType_String(parser->current->type));
+        Token_Destroy(id);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip '{'
+
+    Array *fields = Array_Create();
+
+    while (!Parser_Compare(parser, CURRENT, TT_RBRACKET, NULL) && !Parser_Compare(parser, CURRENT, TT_UNKNOWN, NULL)) {
+        if (!Parser_Compare(parser, CURRENT, TT_IDEN, NULL) || !Parser_Compare(parser, NEXT, TT_COLON, NULL)) {
+            SYNTAX_ERR("Expected field identifier and ':' in complex type \"%s\", got %s.\n", id->value,
+                       TokenType_String(parser->current->type));
+            Token_Destroy(id);
+            Array_DestroyCallBack(fields, (void *) ComplexField_Destroy);
+            return NULL;
+        }
+
+        Token *field_id = Token_Dup(parser->current);
+
+        Parser_Consume(parser); // Skip identifier
+        Parser_Consume(parser); // Skip ':'
+
+        Token *field_type = Parser_ParseTypeName(parser);
+
+        if (!field_type) {
+            Token_Destroy(id);
+            Token_Destroy(field_id);
+            Array_DestroyCallBack(fields, (void *) ComplexField_Destroy);
+            return NULL;
+        }
+
+        if (!Parser_Compare(parser, CURRENT, TT_SEMI, NULL)) {
+            SYNTAX_ERR("Expected ';' after the type of field \"%s\", got %s.\n", field_id->value,
+                       TokenType_String(parser->current->type));
+            Token_Destroy(id);
+            Token_Destroy(field_id);
+            Token_Destroy(field_type);
+            Array_DestroyCallBack(fields, (void *) ComplexField_Destroy);
+            return NULL;
+        }
+
+        Parser_Consume(parser); // Skip ';'
+
+        Array_Push(fields, ComplexField_Create(field_id, Type_CreatePlaceholder(field_type)));
+        Token_Destroy(field_id);
+        Token_Destroy(field_type);
+    }
+
+    if (!Parser_Compare(parser, CURRENT, TT_RBRACKET, NULL)) {
+        SYNTAX_ERR("Missing closing bracket '}'. Reached end of file while parsing complex type \"%s\".\n", id->value);
+        Token_Destroy(id);
+        Array_DestroyCallBack(fields, (void *) ComplexField_Destroy);
+        return NULL;
+    }
+
+    Parser_Consume(parser); // Skip '}'
+
+    ComplexType *complx = ComplexType_Create(id, fields);
+    complx->ordered = ordered;
+
+    Node *n = Node_CreateComplex(Type_CreateComplex(id, complx), parser->lastBlock);
+    Token_Destroy(id);
+
+    return n;
+}
@@ -0,0 +1,102 @@
+#include "include/pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include "include/memory.h"
+
+#define POOL_INITIAL_SLOTS 64
+
+StringPool *StringPool_Create() {
+    StringPool *pool = malloc(sizeof(StringPool));
+    pool->strings = Array_Create();
+    pool->capacity = POOL_INITIAL_SLOTS;
+    pool->slots = calloc(pool->capacity, sizeof(unsigned));
+    pool->literals = 0;
+    return pool;
+}
+
+void StringPool_DestroyString(PooledString *s) {
+    free(s->text);
+    free(s);
+}
+
+void StringPool_Destroy(StringPool *pool) {
+    if (!pool)
+        return;
+
+    Array_DestroyCallBack(pool->strings, (void *) StringPool_DestroyString);
+    free(pool->slots);
+    free(pool);
+}
+
+// FNV-1a
+unsigned StringPool_Hash(const char *str, unsigned length) {
+    unsigned h = 2166136261u;
+
+    for (unsigned i = 0; i < length; i++)
+        h = (h ^ (unsigned char) str[i]) * 16777619u;
+
+    return h;
+}
+
+// The slot holding the text, or the free slot it would go to
+unsigned *StringPool_Slot(StringPool *pool, const char *str, unsigned length, unsigned hash) {
+    unsigned mask = pool->capacity - 1;
+
+    for (unsigned i = hash & mask;; i = (i + 1) & mask) {
+        if (pool->slots[i] == 0)
+            return &pool->slots[i];
+
+        PooledString *s = Array_At(pool->strings, pool->slots[i] - 1);
+
+        if (s->hash == hash && s->length == length && memcmp(s->text, str, length) == 0)
+            return &pool->slots[i];
+    }
+}
+
+// The slots are kept at most half full
+void StringPool_Grow(StringPool *pool) {
+    free(pool->slots);
+    pool->capacity *= 2;
+    pool->slots = calloc(pool->capacity, sizeof(unsigned));
+
+    for (unsigned id = 0; id < pool->strings->length; id++) {
+        PooledString *s = Array_At(pool->strings, id);
+        *StringPool_Slot(pool, s->text, s->length, s->hash) = id + 1;
+    }
+}
+
+// Returns the id of the text, which is copied the first time it is seen
+unsigned StringPool_Intern(StringPool *pool, const char *str) {
+    unsigned length = strlen(str);
+    unsigned hash = StringPool_Hash(str, length);
+    unsigned *slot = StringPool_Slot(pool, str, length, hash);
+
+    pool->literals++;
+
+    if (*slot != 0)
+        return *slot - 1;
+
+    PooledString *s = malloc(sizeof(PooledString));
+    s->text = malloc(length + 1);
+    memcpy(s->text, str, length + 1);
+    s->length = length;
+    s->hash = hash;
+
+    Array_Push(pool->strings, s);
+    *slot = pool->strings->length;
+
+    if (2 * pool->strings->length > pool->capacity)
+        StringPool_Grow(pool);
+
+    return pool->strings->length - 1;
+}
+
+bool StringPool_Contains(StringPool *pool, const char *str) {
+    unsigned length = strlen(str);
+    return *StringPool_Slot(pool, str, length, StringPool_Hash(str, length)) != 0;
+}
+
+PooledString *StringPool_At(StringPool *pool, unsigned id) {
+    return Array_At(pool->strings, id);
+}
@@ -0,0 +1,155 @@
+#include "include/profile.h"
+#include "include/ast.h"
+
+#include <stdlib.h>
+#include "include/memory.h"
+
+typedef struct {
+    Profile *profile;
+    Array *counters;    // By site
+    Array *procedures;
+} ProfileNumbering;
+
+// FNV-1a, folding the procedures and checks into the signature in the order of their counters
+void Profile_Sign(Profile *profile, const char *str) {
+    for (; *str; str++)
+        profile->signature = (profile->signature ^ (unsigned char) *str) * 1099511628211ULL;
+}
+
+void Profile_Site(ProfileNumbering *pn, ProfileCounter *counter, const char *what) {
+    Array_Push(pn->counters, counter);
+    counter->site = pn->counters->length;
+    Profile_Sign(pn->profile, what);
+}
+
+void Profile_Number(ProfileNumbering *pn, Node *n) {
+    if (!n)
+        return;
+
+    switch (n->type) {
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                Profile_Number(pn, Array_At(n->node.block.nodes, i));
+            break;
+
+        // Entries are counted by the module defining the procedure
+        case NODE_FUNCTION_DEFINITION:
+            if (n->node.func_def.external)
+                break;
+            Profile_Site(pn, &n->node.func_def.entered, n->node.func_def.id->value);
+            Array_Push(pn->procedures, n);
+            Profile_Number(pn, n->node.func_def.block);
+            break;
+
+        case NODE_CHECK:
+            for (Node *chk = n; chk; chk = chk->node.check.sub) {
+                Profile_Site(pn, &chk->node.check.taken, chk->node.check.expr ? "check" : "otherwise");
+                Profile_Number(pn, chk->node.check.block);
+
+                if (!chk->node.check.sub && chk->node.check.expr)
+                    Profile_Site(pn, &chk->node.check.missed, "missed");
+            }
+            break;
+
+        case NODE_LOOP:
+            Profile_Number(pn, n->node.loop.block);
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Reads the counts into the counters, unless the profile belongs to another program
+Status Profile_Load(ProfileNumbering *pn) {
+    Profile *profile = pn->profile;
+    FILE *file = fopen(profile->path, "rb");
+
+    if (!file) {
+        PROFILE_PRINT("Could not open the profile \"%s\", optimizing without one.\n", profile->path);
+        return STATUS_FAIL;
+    }
+
+    unsigned long long header[3];
+    unsigned long long *counts = malloc((profile->sites + 1) * sizeof(unsigned long long));
+    Status status = STATUS_FAIL;
+
+    if (fread(header, sizeof(unsigned long long), 3, file) != 3 || header[0] != PROFILE_MAGIC) {
+        PROFILE_PRINT("\"%s\" is not a profile, optimizing without one.\n", profile->path);
+    } else if (header[1] != profile->signature || header[2] != profile->sites) {
+        PROFILE_PRINT("The profile \"%s\" was taken of another program, optimizing without it.\n", profile->path);
+    } else if (fread(counts, sizeof(unsigned long long), profile->sites, file) != profile->sites) {
+        PROFILE_PRINT("The profile \"%s\" is truncated, optimizing without it.\n", profile->path);
+    } else {
+        status = STATUS_OK;
+    }
+
+    fclose(file);
+
+    if (status == STATUS_OK) {
+        for (unsigned i = 0; i < profile->sites; i++)
+            ((ProfileCounter *) Array_At(pn->counters, i))->count = counts[i];
+
+        for (unsigned i = 0; i < pn->procedures->length; i++) {
+            Node *def = Array_At(pn->procedures, i);
+            if (def->node.func_def.entered.count > profile->hottest)
+                profile->hottest = def->node.func_def.entered.count;
+        }
+
+        PROFILE_PRINT("Read %u counter(s) from \"%s\", the hottest procedure was entered %llu time(s).\n",
+                      profile->sites, profile->path, profile->hottest);
+    }
+
+    free(counts);
+    return status;
+}
+
+// Numbers the counters of the program and attaches the profile to it, NULL if there is none to use
+Profile *Profile_Create(Node *program, Options *opts) {
+    if (!opts->profile_generate && !opts->profile_use)
+        return NULL;
+
+    Profile *profile = malloc(sizeof(Profile));
+    profile->generate = opts->profile_generate != NULL;
+    profile->path = profile->generate ? opts->profile_generate : opts->profile_use;
+    profile->signature = 14695981039346656037ULL;
+    profile->hottest = 0;
+
+    ProfileNumbering pn = {profile, Array_Create(), Array_Create()};
+
+    Profile_Number(&pn, program->node.program.nodes);
+    profile->sites = pn.counters->length;
+
+    Status status = STATUS_OK;
+
+    if (profile->generate) {
+        PROFILE_PRINT("Instrumenting %u counter(s), written to \"%s\" when the program exits.\n", profile->sites,
+                      profile->path);
+    } else {
+        status = Profile_Load(&pn);
+    }
+
+    Array_Destroy(pn.counters);
+    Array_Destroy(pn.procedures);
+
+    if (status == STATUS_FAIL) {
+        free(profile);
+        return NULL;
+    }
+
+    program->node.program.profile = profile;
+    return profile;
+}
+
+void Profile_Destroy(Profile *profile) {
+    free(profile);
+}
+
+// Whether there are counts to optimize by
+bool Profile_Guides(Profile *profile) {
+    return profile && !profile->generate;
+}
+
+bool Profile_Hot(Profile *profile, unsigned long long count) {
+    return count > 0 && count * PROFILE_HOT_SHARE >= profile->hottest;
+}
@@ -0,0 +1,458 @@
+#include "include/pure.h"
+#include "include/inline.h"
+#include "include/ir.h"
+
+#include <stdlib.h>
+#include "include/memory.h"
+
+void Pure_Collect(Node *n, Array *defs) {
+    if (!n)
+        return;
+
+    switch (n->type) {
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                Pure_Collect(Array_At(n->node.block.nodes, i), defs);
+            break;
+        // Nothing is known of the body of an imported procedure
+        case NODE_FUNCTION_DEFINITION:
+            if (n->node.func_def.external)
+                break;
+            Array_Push(defs, n);
+            Pure_Collect(n->node.func_def.block, defs);
+            break;
+        case NODE_CHECK:
+            for (Node *chk = n; chk; chk = chk->node.check.sub)
+                Pure_Collect(chk->node.check.block, defs);
+            break;
+        case NODE_LOOP:
+            Pure_Collect(n->node.loop.block, defs);
+            break;
+        default:
+            break;
+    }
+}
+
+// Whether the subtree leaves the procedure pure: it writes only its own variables, reads only
+// those and constants, and calls only procedures that are pure themselves
+bool Pure_Subtree(Node *n, Node *def) {
+    if (!n)
+        return true;
+
+    Node *body = def->node.func_def.block;
+
+    switch (n->type) {
+        case NODE_BLOCK:
+            for (unsigned i = 0; i < n->node.block.nodes->length; i++)
+                if (!Pure_Subtree(Array_At(n->node.block.nodes, i), def))
+                    return false;
+            return true;
+
+        // Analysed on their own
+        case NODE_FUNCTION_DEFINITION:
+            return true;
+
+        case NODE_VARIABLE_DECLARATION:
+            return Pure_Subtree(n->node.var_decl.value, def);
+
+        case NODE_VARIABLE_ASSIGNMENT:
+            return Inline_Within(n->node.var_assign.decl->super, body) && Pure_Subtree(n->node.var_assign.value, def) &&
+                   Pure_Subtree(n->node.var_assign.index, def);
+
+        case NODE_RETURN:
+            return Pure_Subtree(n->node.ret.expr, def);
+
+        case NODE_CHECK:
+            for (Node *chk = n; chk; chk = chk->node.check.sub)
+                if (!Pure_Subtree(chk->node.check.expr, def) || !Pure_Subtree(chk->node.check.block, def))
+                    return false;
+            return true;
+
+        case NODE_LOOP:
+            return Pure_Subtree(n->node.loop.from, def) && Pure_Subtree(n->node.loop.to, def) &&
+                   Pure_Subtree(n->node.loop.block, def);
+
+        case NODE_BINARY_EXPRESSION:
+            return Pure_Subtree(n->node.binary.left, def) && Pure_Subtree(n->node.binary.right, def);
+
+        case NODE_FUNCTION_CALL:
+            if (!n->node.fcall.def || !n->node.fcall.def->node.func_def.pure)
+                return false;
+            for (unsigned i = 0; i < n->node.fcall.exprs->length; i++)
+                if (!Pure_Subtree(Array_At(n->node.fcall.exprs, i), def))
+                    return false;
+            return true;
+
+        case NODE_VARIABLE_REFERENCE: {
+            Node *decl = n->node.var_ref.decl;
+            return decl && (decl->node.var_decl.mutable == MQ_CONST || Inline_Within(decl->super, body));
+        }
+
+        case NODE_INDEX:
+            return Pure_Subtree(n->node.index.array, def) && Pure_Subtree(n->node.index.expr, def);
+
+        case NODE_REDUCE:
+            return Pure_Subtree(n->node.reduce.expr, def);
+
+        default:
+            return true;
+    }
+}
+
+// Every procedure starts out pure, those that break purity or call the ones that do are
+// struck off until nothing changes, which keeps recursive procedures pure. Returns the number left.
+unsigned Pure_Program(Node *program) {
+    Array *defs = Array_Create();
+    Pure_Collect(program->node.program.nodes, defs);
+
+    for (unsigned i = 0; i < defs->length; i++)
+        ((Node *) Array_At(defs, i))->node.func_def.pure = true;
+
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (unsigned i = 0; i < defs->length; i++) {
+            Node *def = Array_At(defs, i);
+
+            if (def->node.func_def.pure && !Pure_Subtree(def->node.func_def.block, def)) {
+                def->node.func_def.pure = false;
+                changed = true;
+            }
+        }
+    }
+
+    unsigned pure = 0;
+
+    for (unsigned i = 0; i < defs->length; i++)
+        if (((Node *) Array_At(defs, i))->node.func_def.pure)
+            pure++;
+
+    Array_Destroy(defs);
+    return pure;
+}
+
+// Values are held the way registers of their width hold them at run time, sign-extended from there
+typedef struct {
+    long long n;
+    unsigned width;
+} PureValue;
+
+typedef struct {
+    Node *decl;
+    long long n;
+} PureBinding;
+
+typedef struct {
+    Array *bindings;    // Innermost last
+    unsigned frame;     // First binding of the call being evaluated
+    unsigned steps;     // Left
+    unsigned depth;
+    bool returned;
+    long long result;
+    PureStatus status;
+} PureEvaluator;
+
+bool Pure_Fail(PureEvaluator *ev, PureStatus status) {
+    ev->status = status;
+    return false;
+}
+
+bool Pure_Step(PureEvaluator *ev) {
+    if (ev->steps == 0)
+        return Pure_Fail(ev, PURE_LIMIT);
+
+    ev->steps--;
+    return true;
+}
+
+PureBinding *Pure_Find(PureEvaluator *ev, Node *decl) {
+    for (unsigned i = ev->bindings->length; i > ev->frame; i--) {
+        PureBinding *b = Array_At(ev->bindings, i - 1);
+        if (b->decl == decl)
+            return b;
+    }
+    return NULL;
+}
+
+PureBinding *Pure_Bind(PureEvaluator *ev, Node *decl, long long n) {
+    PureBinding *b = malloc(sizeof(PureBinding));
+    b->decl = decl;
+    b->n = Ir_Truncate(n, Ir_Width(decl->node.var_decl.type));
+    Array_Push(ev->bindings, b);
+    return b;
+}
+
+void Pure_Unbind(PureEvaluator *ev, unsigned length) {
+    while (ev->bindings->length > length) {
+        free(Array_At(ev->bindings, ev->bindings->length - 1));
+        Array_Remove(ev->bindings, ev->bindings->length - 1);
+    }
+}
+
+// Wraps around like the machine instructions do, traps are left for the runtime
+bool Pure_Arithmetic(PureEvaluator *ev, BinaryType op, PureValue a, PureValue b, PureValue *out) {
+    unsigned long long x = (unsigned long long) a.n;
+    unsigned long long y = (unsigned long long) b.n;
+    unsigned width = a.width > b.width ? a.width : b.width;
+    long long r;
+
+    switch (op) {
+        case BIN_ADD:
+            r = (long long) (x + y);
+            break;
+        case BIN_SUB:
+            r = (long long) (x - y);
+            break;
+        case BIN_MUL:
+            r = (long long) (x * y);
+            break;
+        case BIN_DIV:
+            if (b.n == 0 || (b.n == -1 && a.n == Ir_Truncate(1ULL << (8 * width - 1), width)))
+                return Pure_Fail(ev, PURE_UNSUPPORTED);
+            r = a.n / b.n;
+            break;
+        default:
+            return Pure_Fail(ev, PURE_UNSUPPORTED);
+    }
+
+    *out = (PureValue) {Ir_Truncate(r, width), width};
+    return true;
+}
+
+bool Pure_Call(PureEvaluator *, Node *, PureValue *);
+
+bool Pure_Expression(PureEvaluator *ev, Node *n, PureValue *out) {
+    if (!n)
+        return Pure_Fail(ev, PURE_UNSUPPORTED);
+
+    if (!Pure_Step(ev))
+        return false;
+
+    switch (n->type) {
+        case NODE_INTEGER_LITERAL:
+            *out = (PureValue) {n->node.int_lit.n, Ir_Width(n->etype)};
+            return out->width > 0 || Pure_Fail(ev, PURE_UNSUPPORTED);
+
+        case NODE_VARIABLE_REFERENCE: {
+            Node *decl = n->node.var_ref.decl;
+            unsigned width = Ir_Width(decl->node.var_decl.type);
+            PureBinding *b = Pure_Find(ev, decl);
+
+            if (n->node.var_ref.next || width == 0)
+                return Pure_Fail(ev, PURE_UNSUPPORTED);
+
+            if (b) {
+                *out = (PureValue) {b->n, width};
+                return true;
+            }
+
+            Node *value = decl->node.var_decl.value;
+
+            if (decl->node.var_decl.mutable != MQ_CONST || !value || value->type != NODE_INTEGER_LITERAL)
+                return Pure_Fail(ev, PURE_UNSUPPORTED);
+
+            *out = (PureValue) {Ir_Truncate(value->node.int_lit.n, width), width};
+            return true;
+        }
+
+        case NODE_BINARY_EXPRESSION: {
+            BinaryType op = n->node.binary.op;
+            PureValue a, b;
+
+            if (!Pure_Expression(ev, n->node.binary.left, &a))
+                return false;
+
+            // The right operand is only evaluated when it decides
+            if (op == BIN_AND || op == BIN_OR) {
+                bool truth = a.n != 0;
+
+                if (truth == (op == BIN_AND)) {
+                    if (!Pure_Expression(ev, n->node.binary.right, &b))
+                        return false;
+                    truth = b.n != 0;
+                }
+
+                *out = (PureValue) {truth, Ir_Width(n->etype)};
+                return true;
+            }
+
+            if (!Pure_Expression(ev, n->node.binary.right, &b))
+                return false;
+
+            if (op == BIN_EQUAL || op == BIN_LGREATER || op == BIN_RGREATER) {
+                bool truth = op == BIN_EQUAL ? a.n == b.n : op == BIN_LGREATER ? a.n > b.n : a.n < b.n;
+                *out = (PureValue) {truth, Ir_Width(n->etype)};
+                return true;
+            }
+
+            return Pure_Arithmetic(ev, op, a, b, out);
+        }
+
+        case NODE_FUNCTION_CALL:
+            return Pure_Call(ev, n, out);
+
+        default:
+            return Pure_Fail(ev, PURE_UNSUPPORTED);
+    }
+}
+
+bool Pure_Statement(PureEvaluator *ev, Node *n) {
+    if (!Pure_Step(ev))
+        return false;
+
+    switch (n->type) {
+        case NODE_VARIABLE_DECLARATION: {
+            PureValue v = {0, 8};
+
+            if (!Ir_Width(n->node.var_decl.type))
+                return Pure_Fail(ev, PURE_UNSUPPORTED);
+
+            if (n->node.var_decl.value && !Pure_Expression(ev, n->node.var_decl.value, &v))
+                return false;
+
+            Pure_Bind(ev, n, v.n);
+            return true;
+        }
+
+        case NODE_VARIABLE_ASSIGNMENT: {
+            PureBinding *b = Pure_Find(ev, n->node.var_assign.decl);
+            PureValue v;
+
+            if (!b || n->node.var_assign.index)
+                return Pure_Fail(ev, PURE_UNSUPPORTED);
+
+            if (!Pure_Expression(ev, n->node.var_assign.value, &v))
+                return false;
+
+            b->n = Ir_Truncate(v.n, Ir_Width(b->decl->node.var_decl.type));
+            return true;
+        }
+
+        case NODE_RETURN: {
+            PureValue v = {0, 8};
+
+            if (n->node.ret.expr && !Pure_Expression(ev, n->node.ret.expr, &v))
+                return false;
+
+            ev->result = v.n;
+            ev->returned = true;
+            return true;
+        }
+
+        case NODE_BLOCK: {
+            unsigned mark = ev->bindings->length;
+            bool ok = true;
+
+            for (unsigned i = 0; i < n->node.block.nodes->length && ok && !ev->returned; i++)
+                ok = Pure_Statement(ev, Array_At(n->node.block.nodes, i));
+
+            Pure_Unbind(ev, mark);
+            return ok;
+        }
+
+        case NODE_CHECK:
+            for (Node *chk = n; chk; chk = chk->node.check.sub) {
+                PureValue cond = {1, 1};
+
+                if (chk->node.check.expr && !Pure_Expression(ev, chk->node.check.expr, &cond))
+                    return false;
+
+                if (cond.n != 0)
+                    return Pure_Statement(ev, chk->node.check.block);
+            }
+            return true;
+
+        case NODE_LOOP: {
+            Node *var = n->node.loop.var;
+            unsigned width = Ir_Width(var->node.var_decl.type);
+            unsigned mark = ev->bindings->length;
+            PureValue from, to;
+            bool ok = true;
+
+            if (!Pure_Expression(ev, n->node.loop.from, &from) || !Pure_Expression(ev, n->node.loop.to, &to))
+                return false;
+
+            PureBinding *counter = Pure_Bind(ev, var, from.n);
+            long long end = Ir_Truncate(to.n, width);
+
+            while (ok && !ev->returned && counter->n < end) {
+                ok = Pure_Statement(ev, n->node.loop.block);
+                counter->n = Ir_Truncate((long long) ((unsigned long long) counter->n + 1), width);
+            }
+
+            Pure_Unbind(ev, mark);
+            return ok;
+        }
+
+        case NODE_FUNCTION_DEFINITION:
+        case NODE_COMPLEX:
+            return true;
+
+        default: {
+            PureValue ignored;
+            return Pure_Expression(ev, n, &ignored);
+        }
+    }
+}
+
+// Arguments are evaluated in the frame of the caller, the body in a frame of its own
+bool Pure_Call(PureEvaluator *ev, Node *call, PureValue *out) {
+    Node *def = call->node.fcall.def;
+    Array *args = call->node.fcall.exprs;
+
+    if (!def || !def->node.func_def.pure || !Ir_Width(def->node.func_def.type))
+        return Pure_Fail(ev, PURE_UNSUPPORTED);
+
+    if (ev->depth >= PURE_DEPTH)
+        return Pure_Fail(ev, PURE_LIMIT);
+
+    long long *values = malloc((args->length + 1) * sizeof(long long));
+
+    for (unsigned i = 0; i < args->length; i++) {
+        PureValue v;
+
+        if (!Pure_Expression(ev, Array_At(args, i), &v)) {
+            free(values);
+            return false;
+        }
+
+        values[i] = v.n;
+    }
+
+    unsigned frame = ev->frame;
+    ev->frame = ev->bindings->length;
+
+    for (unsigned i = 0; i < args->length; i++)
+        Pure_Bind(ev, Array_At(def->node.func_def.param_decls, i), values[i]);
+
+    free(values);
+
+    ev->depth++;
+    bool ok = Pure_Statement(ev, def->node.func_def.block);
+    ev->depth--;
+
+    Pure_Unbind(ev, ev->frame);
+    ev->frame = frame;
+
+    // Falling off the end returns zero
+    unsigned width = Ir_Width(def->node.func_def.type);
+    *out = (PureValue) {ev->returned ? Ir_Truncate(ev->result, width) : 0, width};
+    ev->returned = false;
+
+    return ok;
+}
+
+// Runs a call to a pure procedure at compile time, yielding the value it returns
+PureStatus Pure_Evaluate(Node *call, long long *result) {
+    PureEvaluator ev = {Array_Create(), 0, PURE_STEPS, 0, false, 0, PURE_EVALUATED};
+    PureValue v;
+
+    if (Pure_Call(&ev, call, &v))
+        *result = v.n;
+
+    Pure_Unbind(&ev, 0);
+    Array_Destroy(ev.bindings);
+    return ev.status;
+}
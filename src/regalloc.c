@@ -0,0 +1,396 @@
+#include "include/regalloc.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "include/memory.h"
+
+const char *Register_Names[][4] = {
+        {"al",   "ax",   "eax",  "rax"},
+        {"bl",   "bx",   "ebx",  "rbx"},
+        {"cl",   "cx",   "ecx",  "rcx"},
+        {"dl",   "dx",   "edx",  "rdx"},
+        {"sil",  "si",   "esi",  "rsi"},
+        {"dil",  "di",   "edi",  "rdi"},
+        {"bpl",  "bp",   "ebp",  "rbp"},
+        {"spl",  "sp",   "esp",  "rsp"},
+        {"r8b",  "r8w",  "r8d",  "r8"},
+        {"r9b",  "r9w",  "r9d",  "r9"},
+        {"r10b", "r10w", "r10d", "r10"},
+        {"r11b", "r11w", "r11d", "r11"},
+        {"r12b", "r12w", "r12d", "r12"},
+        {"r13b", "r13w", "r13d", "r13"},
+        {"r14b", "r14w", "r14d", "r14"},
+        {"r15b", "r15w", "r15d", "r15"}
+};
+
+// The name of the sub-register of the given width in bytes
+const char *Register_Name(Register reg, unsigned width) {
+    switch (width) {
+        case 1:
+            return Register_Names[reg][0];
+        case 2:
+            return Register_Names[reg][1];
+        case 4:
+            return Register_Names[reg][2];
+        default:
+            return Register_Names[reg][3];
+    }
+}
+
+bool Register_CalleeSaved(Register reg) {
+    return reg == REG_RBX || reg == REG_RBP || (reg >= REG_R12 && reg <= REG_R15);
+}
+
+// rax and rdx are taken by division and return values, r10 and r11 are scratch
+// registers for spilled values. rdx is also the third argument register, arguments
+// are moved into place through the stack.
+const Register RegAlloc_CallerSaved[] = {REG_RCX, REG_RSI, REG_RDI, REG_R8, REG_R9};
+const Register RegAlloc_CalleeSaved[] = {REG_RBX, REG_R12, REG_R13, REG_R14, REG_R15};
+
+#define POOL_SIZE 5
+
+typedef struct {
+    unsigned start;
+    unsigned end;
+    int succ[2];
+    unsigned char *use;
+    unsigned char *def;
+    unsigned char *in;
+    unsigned char *out;
+} RegAllocBlock;
+
+void RegAlloc_Extend(Interval *it, unsigned pos) {
+    if (pos < it->start)
+        it->start = pos;
+    if (pos > it->end || it->end == UINT_MAX)
+        it->end = pos;
+}
+
+// Visit every virtual register read by the instruction
+#define FOR_USES(ins, v, body) \
+        { \
+            if ((ins)->a != IR_NONE) { int v = (ins)->a; body } \
+            if ((ins)->b != IR_NONE) { int v = (ins)->b; body } \
+            for (unsigned _k = 0; _k < (ins)->nargs; _k++) { int v = (ins)->args[_k]; body } \
+        }
+
+double RegAlloc_Weight(Interval *it) {
+    return it->cost / (double) (it->end - it->start + 1);
+}
+
+int RegAlloc_CompareStart(const void *a, const void *b) {
+    Interval *x = *(Interval **) a;
+    Interval *y = *(Interval **) b;
+
+    if (x->start != y->start)
+        return x->start < y->start ? -1 : 1;
+
+    return x->vreg - y->vreg;
+}
+
+Register RegAlloc_Free(Array *active, const Register *pool) {
+    for (unsigned i = 0; i < POOL_SIZE; i++) {
+        bool taken = false;
+
+        for (unsigned k = 0; k < active->length && !taken; k++)
+            if (((Interval *) Array_At(active, k))->reg == pool[i])
+                taken = true;
+
+        if (!taken)
+            return pool[i];
+    }
+
+    return REG_NONE;
+}
+
+// Liveness is computed over the basic blocks of the function, every value then
+// gets a single interval spanning all the instructions it is live at.
+void RegAlloc_Liveness(IrFunction *fn, Interval *intervals) {
+    Array *code = fn->code;
+    unsigned n = code->length;
+    unsigned nv = fn->vregs;
+
+    unsigned *labels = calloc(fn->labels + 1, sizeof(unsigned));
+    bool *leader = calloc(n + 1, sizeof(bool));
+
+    leader[0] = true;
+
+    for (unsigned i = 0; i < n; i++) {
+        IrInstruction *ins = Array_At(code, i);
+
+        if (ins->op == IR_LABEL) {
+            labels[ins->label] = i;
+            leader[i] = true;
+        }
+
+        if (ins->op == IR_JUMP || ins->op == IR_BRANCH || ins->op == IR_BRANCH_SET || ins->op == IR_RETURN ||
+            ins->op == IR_TAIL_CALL)
+            leader[i + 1] = true;
+    }
+
+    unsigned nb = 0;
+    unsigned *block_of = malloc((n + 1) * sizeof(unsigned));
+
+    for (unsigned i = 0; i < n; i++) {
+        if (leader[i] && i > 0)
+            nb++;
+        block_of[i] = nb;
+    }
+
+    nb = n > 0 ? nb + 1 : 0;
+
+    RegAllocBlock *blocks = calloc(nb + 1, sizeof(RegAllocBlock));
+
+    for (unsigned b = 0; b < nb; b++) {
+        blocks[b].use = calloc(nv + 1, 1);
+        blocks[b].def = calloc(nv + 1, 1);
+        blocks[b].in = calloc(nv + 1, 1);
+        blocks[b].out = calloc(nv + 1, 1);
+        blocks[b].start = UINT_MAX;
+        blocks[b].succ[0] = -1;
+        blocks[b].succ[1] = -1;
+    }
+
+    for (unsigned i = 0; i < n; i++) {
+        RegAllocBlock *blk = &blocks[block_of[i]];
+        IrInstruction *ins = Array_At(code, i);
+
+        if (blk->start == UINT_MAX)
+            blk->start = i;
+        blk->end = i;
+
+        FOR_USES(ins, v, {
+            if (!blk->def[v])
+                blk->use[v] = 1;
+        })
+
+        if (ins->dst != IR_NONE)
+            blk->def[ins->dst] = 1;
+    }
+
+    for (unsigned b = 0; b < nb; b++) {
+        IrInstruction *last = Array_At(code, blocks[b].end);
+        int next = b + 1 < nb ? (int) b + 1 : -1;
+
+        switch (last->op) {
+            case IR_JUMP:
+                blocks[b].succ[0] = (int) block_of[labels[last->label]];
+                break;
+            case IR_BRANCH:
+            case IR_BRANCH_SET:
+                blocks[b].succ[0] = next;
+                blocks[b].succ[1] = (int) block_of[labels[last->label]];
+                break;
+            case IR_RETURN:
+            case IR_TAIL_CALL:
+                break;
+            default:
+                blocks[b].succ[0] = next;
+                break;
+        }
+    }
+
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (int b = (int) nb - 1; b >= 0; b--) {
+            RegAllocBlock *blk = &blocks[b];
+
+            for (unsigned s = 0; s < 2; s++) {
+                if (blk->succ[s] < 0)
+                    continue;
+                for (unsigned v = 0; v < nv; v++)
+                    if (blocks[blk->succ[s]].in[v])
+                        blk->out[v] = 1;
+            }
+
+            for (unsigned v = 0; v < nv; v++) {
+                unsigned char in = blk->use[v] || (blk->out[v] && !blk->def[v]);
+                if (in != blk->in[v]) {
+                    blk->in[v] = in;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Loop nesting depth of every instruction, from backward branches. Returns from code laid out
+    // past the end of the function are not loops.
+    unsigned *depth = calloc(n + 1, sizeof(unsigned));
+
+    for (unsigned i = 0; i < n; i++) {
+        IrInstruction *ins = Array_At(code, i);
+        if (((ins->op == IR_JUMP && ins->imm == 0) || ins->op == IR_BRANCH) && labels[ins->label] <= i)
+            for (unsigned k = labels[ins->label]; k <= i; k++)
+                depth[k]++;
+    }
+
+    unsigned char *live = malloc(nv + 1);
+
+    for (unsigned b = 0; b < nb; b++) {
+        memcpy(live, blocks[b].out, nv);
+
+        for (int p = (int) blocks[b].end; p >= (int) blocks[b].start; p--) {
+            IrInstruction *ins = Array_At(code, p);
+
+            double weight = 1;
+            for (unsigned d = 0; d < depth[p]; d++)
+                weight *= REGALLOC_LOOP_WEIGHT;
+
+            for (unsigned v = 0; v < nv; v++)
+                if (live[v])
+                    RegAlloc_Extend(&intervals[v], p);
+
+            if (ins->dst != IR_NONE) {
+                RegAlloc_Extend(&intervals[ins->dst], p);
+                intervals[ins->dst].cost += weight;
+                live[ins->dst] = 0;
+            }
+
+            FOR_USES(ins, v, {
+                RegAlloc_Extend(&intervals[v], p);
+                intervals[v].cost += weight;
+                live[v] = 1;
+            })
+        }
+    }
+
+    // Caller-saved registers do not survive a call
+    for (unsigned i = 0; i < n; i++) {
+        IrInstruction *ins = Array_At(code, i);
+
+        if (ins->op != IR_CALL)
+            continue;
+
+        for (unsigned v = 0; v < nv; v++)
+            if (intervals[v].start < i && intervals[v].end > i && intervals[v].end != UINT_MAX)
+                intervals[v].crosses_call = true;
+    }
+
+    for (unsigned b = 0; b < nb; b++) {
+        free(blocks[b].use);
+        free(blocks[b].def);
+        free(blocks[b].in);
+        free(blocks[b].out);
+    }
+
+    free(live);
+    free(depth);
+    free(blocks);
+    free(block_of);
+    free(leader);
+    free(labels);
+}
+
+#undef FOR_USES
+
+Allocation *RegAlloc_Function(IrFunction *fn) {
+    Allocation *alloc = malloc(sizeof(Allocation));
+    alloc->count = fn->vregs;
+    alloc->intervals = malloc((fn->vregs + 1) * sizeof(Interval));
+    alloc->slots = 0;
+    alloc->callee_saved = 0;
+    alloc->allocated = 0;
+    alloc->spilled = 0;
+
+    for (unsigned v = 0; v < fn->vregs; v++) {
+        Interval *it = &alloc->intervals[v];
+        it->vreg = (int) v;
+        it->start = UINT_MAX;
+        it->end = UINT_MAX;
+        it->crosses_call = false;
+        it->cost = 0;
+        it->reg = REG_NONE;
+        it->slot = -1;
+    }
+
+    RegAlloc_Liveness(fn, alloc->intervals);
+
+    Interval **order = malloc((fn->vregs + 1) * sizeof(Interval *));
+    unsigned count = 0;
+
+    for (unsigned v = 0; v < fn->vregs; v++)
+        if (alloc->intervals[v].start != UINT_MAX)
+            order[count++] = &alloc->intervals[v];
+
+    qsort(order, count, sizeof(Interval *), RegAlloc_CompareStart);
+
+    Array *active = Array_Create();
+
+    for (unsigned i = 0; i < count; i++) {
+        Interval *cur = order[i];
+
+        // Values whose last use is the current instruction hand their register over,
+        // operands are always read before the result is written.
+        unsigned k = 0;
+        while (k < active->length) {
+            if (((Interval *) Array_At(active, k))->end <= cur->start)
+                Array_Remove(active, k);
+            else
+                k++;
+        }
+
+        Register reg = REG_NONE;
+
+        if (!cur->crosses_call)
+            reg = RegAlloc_Free(active, RegAlloc_CallerSaved);
+        if (reg == REG_NONE)
+            reg = RegAlloc_Free(active, RegAlloc_CalleeSaved);
+
+        if (reg != REG_NONE) {
+            cur->reg = reg;
+            Array_Push(active, cur);
+            continue;
+        }
+
+        // Spill whichever value is used least often per instruction of its lifetime
+        Interval *victim = cur;
+        unsigned victim_index = 0;
+
+        for (k = 0; k < active->length; k++) {
+            Interval *it = Array_At(active, k);
+
+            if (cur->crosses_call && !Register_CalleeSaved(it->reg))
+                continue;
+
+            if (RegAlloc_Weight(it) < RegAlloc_Weight(victim)) {
+                victim = it;
+                victim_index = k;
+            }
+        }
+
+        if (victim != cur) {
+            cur->reg = victim->reg;
+            victim->reg = REG_NONE;
+            Array_Remove(active, victim_index);
+            Array_Push(active, cur);
+        }
+
+        victim->slot = (int) alloc->slots++;
+    }
+
+    for (unsigned i = 0; i < count; i++) {
+        if (order[i]->reg == REG_NONE) {
+            alloc->spilled++;
+            continue;
+        }
+
+        alloc->allocated++;
+
+        if (Register_CalleeSaved(order[i]->reg))
+            alloc->callee_saved |= 1u << order[i]->reg;
+    }
+
+    Array_Destroy(active);
+    free(order);
+
+    return alloc;
+}
+
+void Allocation_Destroy(Allocation *alloc) {
+    free(alloc->intervals);
+    free(alloc);
+}
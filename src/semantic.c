@@ -1,24 +1,82 @@
 #include "include/semantic.h"
+#include "include/param.h"
+#include "include/trace.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
+#include <limits.h>
+#include "include/memory.h"
 
 SemanticAnalysis *SemanticAnalysis_Create(Node *program) {
     SemanticAnalysis *sa = malloc(sizeof(SemanticAnalysis));
     sa->program = program;
     sa->types = Array_Create();
+    sa->currentBlock = NULL;
+    sa->currentFunction = NULL;
+    sa->names = StringPool_Create();
 
     // Add the primitive types to the array
     Array_Push(sa->types, Type_CreatePrimitive(PRIMITIVE_BYTE));
     Array_Push(sa->types, Type_CreatePrimitive(PRIMITIVE_WORD));
     Array_Push(sa->types, Type_CreatePrimitive(PRIMITIVE_DWORD));
     Array_Push(sa->types, Type_CreatePrimitive(PRIMITIVE_QWORD));
+    Array_Push(sa->types, Type_CreateVoid());
 
     return sa;
 }
 
+// "element[length]" or "element<lanes>", array and vector types are created as they are
+// first used and shared from then on
+Type *SemanticAnalysis_ResolveArray(SemanticAnalysis *sa, Token *id) {
+    char *open = strpbrk(id->value, "[<");
+
+    if (!open)
+        return NULL;
+
+    bool vector = *open == '<';
+
+    Token *name = Token_Create(id->value, TT_IDEN);
+    name->value[open - id->value] = 0;
+
+    Type *element = SemanticAnalysis_FindType(sa, name);
+    Token_Destroy(name);
+
+    if (!element || element->type != TYPE_PRIMITIVE) {
+        SEMANTIC_PRINT("%s can only hold primitives, '%s' is not one.\n", vector ? "Vectors" : "Arrays", id->value);
+        return NULL;
+    }
+
+    unsigned long length = strtoul(open + 1, NULL, 10);
+    unsigned long limit = INT_MAX / (Type_Quantify(element) / 8);
+
+    if (vector) {
+        unsigned long size = length * (Type_Quantify(element) / 8);
+
+        if (size != 16 && size != 32) {
+            SEMANTIC_PRINT("The vector type '%s' takes %lu bytes, vectors fill a register of 16 or 32.\n", id->value,
+                           size);
+            return NULL;
+        }
+    } else if (length == 0 || length > limit) {
+        SEMANTIC_PRINT("The length of the array type '%s' must be between 1 and %lu.\n", id->value, limit);
+        return NULL;
+    }
+
+    Type *array = vector ? Type_CreateVector(element, (unsigned) length) : Type_CreateArray(element, (unsigned) length);
+
+    for (unsigned i = 0; i < sa->types->length; i++) {
+        Type *t = Array_At(sa->types, i);
+        if (Type_Compare(t, array)) {
+            Type_Destroy(array);
+            return t;
+        }
+    }
+
+    Array_Push(sa->types, array);
+    return array;
+}
+
 Type *SemanticAnalysis_ResolveType(SemanticAnalysis *sa, Type *type, Node *n) {
     if (type->type != TYPE_PLACEHOLDER)
         return NULL;
@@ -30,33 +88,85 @@ Type *SemanticAnalysis_ResolveType(SemanticAnalysis *sa, Type *type, Node *n) {
     if (t)
         return t;
 
-    return NULL;
+    return SemanticAnalysis_ResolveArray(sa, type->content.placeholder.id);
 }
 
+// Complex types are owned by the analysis once they have been defined. Types are destroyed
+// last to first, so the types of their fields are still there when they go.
 void SemanticAnalysis_Destroy(SemanticAnalysis *analysis) {
-    Array_DestroyCallBack(analysis->types, (void *) Type_Destroy);
+    for (unsigned i = analysis->types->length; i > 0; i--)
+        Type_DestroyHard(Array_At(analysis->types, i - 1));
+
+    Array_Destroy(analysis->types);
+    StringPool_Destroy(analysis->names);
     free(analysis);
 }
 
-PrimitiveType PrimitiveType_FitInteger(int n) {
-    int storage = ceil(log2(n)) + 1;
+// The smallest primitive holding the integer along with its sign bit, found by a bit scan
+PrimitiveType PrimitiveType_FitInteger(long long n) {
+    unsigned long long magnitude = n < 0 ? ~(unsigned long long) n : (unsigned long long) n;
+    int storage = (magnitude ? 64 - __builtin_clzll(magnitude) : 0) + 1;
+
     if (storage <= 8)
         return PRIMITIVE_BYTE;
     else if (storage <= 16)
         return PRIMITIVE_WORD;
     else if (storage <= 32)
         return PRIMITIVE_DWORD;
-    else if (storage <= 64)
+    else
         return PRIMITIVE_QWORD;
-    else {
-        SEMANTIC_PRINT("Integer exceeds QWORD bounds: %u\n", n);
-        return -1;
-    }
 }
 
 Status SemanticAnalysis_AnalyseNode(SemanticAnalysis *, Node *);
 
-Type *SemanticAnalysis_AnalyseExpression(SemanticAnalysis *analysis, Node *expr) {
+Type *SemanticAnalysis_AnalyseExpression(SemanticAnalysis *, Node *);
+
+// The element type of the indexed array or vector, which is given by its declaration
+Type *SemanticAnalysis_AnalyseSubscript(SemanticAnalysis *analysis, Node *decl, Node *index) {
+    Type *array = decl->node.var_decl.type;
+
+    if (array->type != TYPE_ARRAY && array->type != TYPE_VECTOR) {
+        SEMANTIC_PRINT("The variable '%s' of type '%s' is neither an array nor a vector.\n",
+                       decl->node.var_decl.id->value, Type_Identifier(array));
+        return NULL;
+    }
+
+    Type *t = SemanticAnalysis_AnalyseExpression(analysis, index);
+
+    if (!t)
+        return NULL;
+
+    if (t->type != TYPE_PRIMITIVE) {
+        SEMANTIC_PRINT("Indices into '%s' must be of a primitive type, got '%s'.\n",
+                       decl->node.var_decl.id->value, Type_Identifier(t));
+        return NULL;
+    }
+
+    return array->content.array.element;
+}
+
+// Vectors are computed with lane by lane, a scalar operand is broadcast to every lane
+Type *SemanticAnalysis_VectorBinary(Node *expr, Type *left, Type *right) {
+    BinaryType op = expr->node.binary.op;
+    Type *vector = left->type == TYPE_VECTOR ? left : right;
+    Type *other = vector == left ? right : left;
+
+    if (op != BIN_ADD && op != BIN_SUB && op != BIN_MUL) {
+        SEMANTIC_PRINT("Vectors can only be added, subtracted and multiplied, not combined by %s.\n",
+                       BinaryType_ToString(op));
+        return NULL;
+    }
+
+    if (!Type_Assignable(vector, other)) {
+        SEMANTIC_PRINT("Cannot combine the vector type '%s' with '%s'.\n", Type_Identifier(vector),
+                       Type_Identifier(other));
+        return NULL;
+    }
+
+    return vector;
+}
+
+Type *SemanticAnalysis_ResolveExpression(SemanticAnalysis *analysis, Node *expr) {
     if (expr->type == NODE_BINARY_EXPRESSION) {
         Type *left = SemanticAnalysis_AnalyseExpression(analysis, expr->node.binary.left);
         if (!left)
@@ -71,6 +181,9 @@ Type *SemanticAnalysis_AnalyseExpression(SemanticAnalysis *analysis, Node *expr)
             return NULL;
         }
 
+        if (left->type == TYPE_VECTOR || right->type == TYPE_VECTOR)
+            return SemanticAnalysis_VectorBinary(expr, left, right);
+
         if (!Type_Compare(left, right)) {
             Type *new = Type_Larger(left, right);
             SEMANTIC_PRINT(
@@ -85,17 +198,21 @@ Type *SemanticAnalysis_AnalyseExpression(SemanticAnalysis *analysis, Node *expr)
 
     if (expr->type == NODE_INTEGER_LITERAL) {
         PrimitiveType fitting = PrimitiveType_FitInteger(expr->node.int_lit.n);
-        if (fitting == -1) {
-            SEMANTIC_PRINT("Integer automatic classification failed. Maybe try explicit typing?\n");
-            return NULL;
-        }
         Token *tok = Token_Create((char *) PrimitiveType_String(fitting), TT_IDEN);
         Type *t = SemanticAnalysis_FindType(analysis, tok);
-        SEMANTIC_PRINT("Classified integer %d (%s)\n", expr->node.int_lit.n, tok->value);
+        SEMANTIC_PRINT("Classified integer %lld (%s)\n", expr->node.int_lit.n, tok->value);
         Token_Destroy(tok);
         return t;
     }
 
+    // Strings are handled by the QWORD address of their text
+    if (expr->type == NODE_STRING_LITERAL) {
+        Token *t = Token_Create("qword", TT_IDEN);
+        Type *qw = SemanticAnalysis_FindType(analysis, t);
+        Token_Destroy(t);
+        return qw;
+    }
+
     // Floats are stored as QWORDS
     if (expr->type == NODE_FLOAT_LITERAL) {
         Token *t = Token_Create("qword", TT_IDEN);
@@ -113,21 +230,148 @@ Type *SemanticAnalysis_AnalyseExpression(SemanticAnalysis *analysis, Node *expr)
         // Check whether the variable is accessible
         Element e = Block_FindElement(expr->super, expr->node.var_ref.id);
 
+        if (!e.n) {
+            SEMANTIC_PRINT("The variable '%s' is undefined.\n", expr->node.var_ref.id->value);
+            return NULL;
+        }
+
         if (e.type != ELEMENT_VARIABLE) {
             SEMANTIC_PRINT("The referenced variable '%s' is not a variable.\n", expr->node.var_ref.id->value);
             return NULL;
         }
 
-        if (e.n)
-            return e.n->node.var_decl.type;
+        if (e.n->node.var_decl.type->type == TYPE_ARRAY) {
+            SEMANTIC_PRINT("The array '%s' can only be accessed element by element.\n", expr->node.var_ref.id->value);
+            return NULL;
+        }
 
-        SEMANTIC_PRINT("The variable '%s' is undefined.\n", expr->node.var_ref.id->value);
-        return NULL;
+        expr->node.var_ref.decl = e.n;
+        e.n->node.var_decl.refs++;
+        return e.n->node.var_decl.type;
     }
 
+    if (expr->type == NODE_INDEX) {
+        Node *ref = expr->node.index.array;
+        Element e = Block_FindElement(ref->super, ref->node.var_ref.id);
+
+        if (!e.n || e.type != ELEMENT_VARIABLE) {
+            SEMANTIC_PRINT("The indexed array '%s' is undefined.\n", ref->node.var_ref.id->value);
+            return NULL;
+        }
+
+        Type *t = SemanticAnalysis_AnalyseSubscript(analysis, e.n, expr->node.index.expr);
+
+        if (!t)
+            return NULL;
+
+        ref->node.var_ref.decl = e.n;
+        ref->etype = e.n->node.var_decl.type;
+        e.n->node.var_decl.refs++;
+        return t;
+    }
+
+    if (expr->type == NODE_REDUCE) {
+        Type *t = SemanticAnalysis_AnalyseExpression(analysis, expr->node.reduce.expr);
+
+        if (!t)
+            return NULL;
+
+        if (t->type != TYPE_VECTOR) {
+            SEMANTIC_PRINT("Only the lanes of a vector can be added up, got '%s'.\n", Type_Identifier(t));
+            return NULL;
+        }
+
+        return t->content.array.element;
+    }
+
+    if (expr->type == NODE_FUNCTION_CALL) {
+        Element e = Block_FindElement(expr->super, expr->node.fcall.id);
+
+        if (!e.n) {
+            SEMANTIC_PRINT("The procedure '%s' is undefined.\n", expr->node.fcall.id->value);
+            return NULL;
+        }
+
+        if (e.type != ELEMENT_FUNCTION) {
+            SEMANTIC_PRINT("The called identifier '%s' is not a procedure.\n", expr->node.fcall.id->value);
+            return NULL;
+        }
+
+        Array *params = e.n->node.func_def.param_decls;
+        Array *args = expr->node.fcall.exprs;
+
+        if (args->length != params->length) {
+            SEMANTIC_PRINT("The procedure '%s' expects %u parameter(s), got %u.\n", expr->node.fcall.id->value,
+                           params->length, args->length);
+            return NULL;
+        }
+
+        for (unsigned i = 0; i < args->length; i++) {
+            Node *param = Array_At(params, i);
+            Type *t = SemanticAnalysis_AnalyseExpression(analysis, Array_At(args, i));
+
+            if (!t)
+                return NULL;
+
+            if (!Type_Assignable(param->node.var_decl.type, t)) {
+                SEMANTIC_PRINT("Parameter '%s' of procedure '%s' is of type '%s' and cannot take an expression of type '%s'.\n",
+                               param->node.var_decl.id->value, expr->node.fcall.id->value,
+                               Type_Identifier(param->node.var_decl.type), Type_Identifier(t));
+                return NULL;
+            }
+        }
+
+        expr->node.fcall.def = e.n;
+        e.n->node.func_def.refs++;
+        return e.n->node.func_def.type;
+    }
+
+    // Sizes are stored as QWORDS
+    if (expr->type == NODE_SIZE) {
+        if (expr->node.size.type->type == TYPE_PLACEHOLDER) {
+            Token *id = expr->node.size.type->content.placeholder.id;
+            Type *resv = SemanticAnalysis_FindType(analysis, id);
+            if (!resv)
+                resv = SemanticAnalysis_ResolveArray(analysis, id);
+            if (!resv) {
+                SEMANTIC_PRINT("Unresolved type '%s' in size directive.\n", Type_Identifier(expr->node.size.type));
+                return NULL;
+            }
+            Type_Destroy(expr->node.size.type);
+            expr->node.size.type = resv;
+        }
+
+        if (expr->node.size.type->type == TYPE_VOID) {
+            SEMANTIC_PRINT("The type 'void' has no size.\n");
+            return NULL;
+        }
+
+        Token *t = Token_Create("qword", TT_IDEN);
+        Type *qw = SemanticAnalysis_FindType(analysis, t);
+        Token_Destroy(t);
+        return qw;
+    }
+
+    SEMANTIC_PRINT("Unsupported expression of type %s.\n", NodeType_ToString(expr->type));
     return NULL;
 }
 
+// Resolve the expression and annotate it with its effective type
+Type *SemanticAnalysis_AnalyseExpression(SemanticAnalysis *analysis, Node *expr) {
+    Type *t = SemanticAnalysis_ResolveExpression(analysis, expr);
+    expr->etype = t;
+    return t;
+}
+
+// The declaration the identifier would conflict with. Names declared for the first time are the
+// common case, and are told apart without walking up every enclosing scope.
+Element SemanticAnalysis_FindConflict(SemanticAnalysis *analysis, Node *scope, Token *id) {
+    if (!StringPool_Contains(analysis->names, id->value))
+        return (Element) {.n = NULL};
+
+    return Block_FindElement(scope, id);
+}
+
 Status SemanticAnalysis_AnalyseVariableDeclaration(SemanticAnalysis *analysis, Node *n) {
     if (n->type != NODE_VARIABLE_DECLARATION) {
         SEMANTIC_PRINT("Internal error: Wrong node type passed to %s", __FUNCTION__);
@@ -146,8 +390,13 @@ Status SemanticAnalysis_AnalyseVariableDeclaration(SemanticAnalysis *analysis, N
         n->node.var_decl.type = resv;
     }
 
+    if (n->node.var_decl.type->type == TYPE_VOID) {
+        SEMANTIC_PRINT("The variable '%s' cannot be of type 'void'.\n", n->node.var_decl.id->value);
+        return STATUS_FAIL;
+    }
+
     // Check for identifier conflicts
-    Element e = Block_FindElement(n->super, n->node.var_decl.id);
+    Element e = SemanticAnalysis_FindConflict(analysis, n->super, n->node.var_decl.id);
 
     if (e.n) {
         SEMANTIC_PRINT("The identifier '%s' is already taken. Attempted redefinition as variable of type '%s'.\n",
@@ -155,23 +404,280 @@ Status SemanticAnalysis_AnalyseVariableDeclaration(SemanticAnalysis *analysis, N
         return STATUS_FAIL;
     }
 
+    if (n->node.var_decl.type->type == TYPE_ARRAY && n->node.var_decl.value) {
+        SEMANTIC_PRINT("The array '%s' cannot be initialized, its elements start out as zero.\n",
+                       n->node.var_decl.id->value);
+        return STATUS_FAIL;
+    }
+
     if (n->node.var_decl.value) {
         Type *t = SemanticAnalysis_AnalyseExpression(analysis, n->node.var_decl.value);
 
+        if (!t)
+            return STATUS_FAIL;
+
         // Check for type conflicts
-        if (!Type_Compare(t, n->node.var_decl.type)) {
+        if (!Type_Assignable(n->node.var_decl.type, t)) {
             SEMANTIC_PRINT(
                     "The variable '%s' of type '%s' cannot be initialized with an expression of effective type '%s'.\n",
                     n->node.var_decl.id->value, Type_Identifier(n->node.var_decl.type), Type_Identifier(t));
             return STATUS_FAIL;
         }
+    }
+
+    // Push the declaration onto the array
+    Array_Push(n->super->node.block.declarations, n);
+    StringPool_Intern(analysis->names, n->node.var_decl.id->value);
+
+    return STATUS_OK;
+}
+
+Status SemanticAnalysis_AnalyseVariableAssignment(SemanticAnalysis *analysis, Node *n) {
+    Element e = Block_FindElement(n->super, n->node.var_assign.id);
+
+    if (!e.n) {
+        SEMANTIC_PRINT("Assignment to undefined variable '%s'.\n", n->node.var_assign.id->value);
+        return STATUS_FAIL;
+    }
+
+    if (e.type != ELEMENT_VARIABLE) {
+        SEMANTIC_PRINT("The assignment target '%s' is not a variable.\n", n->node.var_assign.id->value);
+        return STATUS_FAIL;
+    }
+
+    if (e.n->node.var_decl.mutable == MQ_CONST) {
+        SEMANTIC_PRINT("The variable '%s' is declared 'const' and cannot be reassigned.\n",
+                       n->node.var_assign.id->value);
+        return STATUS_FAIL;
+    }
+
+    Type *target = e.n->node.var_decl.type;
+
+    if (n->node.var_assign.index) {
+        target = SemanticAnalysis_AnalyseSubscript(analysis, e.n, n->node.var_assign.index);
+
+        if (!target)
+            return STATUS_FAIL;
+    } else if (target->type == TYPE_ARRAY) {
+        SEMANTIC_PRINT("The array '%s' cannot be assigned as a whole.\n", n->node.var_assign.id->value);
+        return STATUS_FAIL;
+    }
+
+    Type *t = SemanticAnalysis_AnalyseExpression(analysis, n->node.var_assign.value);
+
+    if (!t)
+        return STATUS_FAIL;
+
+    if (!Type_Assignable(target, t)) {
+        SEMANTIC_PRINT("The variable '%s' of type '%s' cannot be assigned an expression of effective type '%s'.\n",
+                       n->node.var_assign.id->value, Type_Identifier(target), Type_Identifier(t));
+        return STATUS_FAIL;
+    }
+
+    n->node.var_assign.decl = e.n;
+
+    return STATUS_OK;
+}
+
+Status SemanticAnalysis_AnalyseFunctionDefinition(SemanticAnalysis *analysis, Node *n) {
+
+    // Resolve the return type
+    if (n->node.func_def.type->type == TYPE_PLACEHOLDER) {
+        Type *resv = SemanticAnalysis_ResolveType(analysis, n->node.func_def.type, n->super);
+        if (!resv) {
+            SEMANTIC_PRINT("Unresolved return type '%s' of procedure '%s'.\n",
+                           Type_Identifier(n->node.func_def.type), n->node.func_def.id->value);
+            return STATUS_FAIL;
+        }
+        Type_Destroy(n->node.func_def.type);
+        n->node.func_def.type = resv;
+    }
+
+    Element e = SemanticAnalysis_FindConflict(analysis, n->super, n->node.func_def.id);
+
+    if (e.n) {
+        SEMANTIC_PRINT("The identifier '%s' is already taken. Attempted redefinition as procedure.\n",
+                       n->node.func_def.id->value);
+        return STATUS_FAIL;
+    }
+
+    // Declared before the body is analysed to allow recursion
+    Array_Push(n->super->node.block.declarations, n);
+    StringPool_Intern(analysis->names, n->node.func_def.id->value);
+
+    Node *blk = n->node.func_def.block;
+
+    // Parameters live in the scope of the procedure body
+    for (unsigned i = 0; i < n->node.func_def.params->length; i++) {
+        FunctionParameter *param = Array_At(n->node.func_def.params, i);
+        Node *decl = Node_CreateVariableDeclaration(param->id, NULL, param->type->content.placeholder.id, MQ_VARYING,
+                                                    blk);
+        Array_Push(n->node.func_def.param_decls, decl);
+
+        if (!SemanticAnalysis_AnalyseVariableDeclaration(analysis, decl))
+            return STATUS_FAIL;
+    }
+
+    Node *prev = analysis->currentFunction;
+    analysis->currentFunction = n;
+
+    double start = Trace_Now();
+    Status stat = SemanticAnalysis_AnalyseNode(analysis, blk);
+    Trace_Span("procedure", n->node.func_def.id->value, start);
+
+    analysis->currentFunction = prev;
 
-        // Push the declaration onto the array
-        Array_Push(n->super->node.block.declarations, n);
+    return stat;
+}
+
+Status SemanticAnalysis_AnalyseReturn(SemanticAnalysis *analysis, Node *n) {
+    Type *expected = analysis->currentFunction ? analysis->currentFunction->node.func_def.type : NULL;
+    const char *name = analysis->currentFunction ? analysis->currentFunction->node.func_def.id->value : "(program)";
 
+    if (!n->node.ret.expr) {
+        if (expected && expected->type != TYPE_VOID) {
+            SEMANTIC_PRINT("The procedure '%s' must return a value of type '%s'.\n", name, Type_Identifier(expected));
+            return STATUS_FAIL;
+        }
         return STATUS_OK;
     }
 
+    if (n->node.ret.jump && !analysis->currentFunction) {
+        SEMANTIC_PRINT("'jmp' can only be used inside of a procedure.\n");
+        return STATUS_FAIL;
+    }
+
+    Type *t = SemanticAnalysis_AnalyseExpression(analysis, n->node.ret.expr);
+
+    if (!t)
+        return STATUS_FAIL;
+
+    // The result of the called procedure is returned as is, so it cannot be widened
+    if (n->node.ret.jump && !Type_Compare(expected, t)) {
+        SEMANTIC_PRINT("The procedure '%s' of type '%s' cannot jump to '%s' of type '%s'.\n", name,
+                       Type_Identifier(expected), n->node.ret.expr->node.fcall.id->value, Type_Identifier(t));
+        return STATUS_FAIL;
+    }
+
+    if (expected && !Type_Assignable(expected, t)) {
+        SEMANTIC_PRINT("The procedure '%s' of type '%s' cannot return an expression of effective type '%s'.\n", name,
+                       Type_Identifier(expected), Type_Identifier(t));
+        return STATUS_FAIL;
+    }
+
+    return STATUS_OK;
+}
+
+Status SemanticAnalysis_AnalyseCheck(SemanticAnalysis *analysis, Node *n) {
+    for (Node *chk = n; chk; chk = chk->node.check.sub) {
+        if (chk->node.check.expr) {
+            Type *t = SemanticAnalysis_AnalyseExpression(analysis, chk->node.check.expr);
+
+            if (!t)
+                return STATUS_FAIL;
+
+            if (t->type != TYPE_PRIMITIVE) {
+                SEMANTIC_PRINT("Check conditions must be of a primitive type, got '%s'.\n", Type_Identifier(t));
+                return STATUS_FAIL;
+            }
+        }
+
+        if (!SemanticAnalysis_AnalyseNode(analysis, chk->node.check.block))
+            return STATUS_FAIL;
+    }
+
+    return STATUS_OK;
+}
+
+Status SemanticAnalysis_AnalyseLoop(SemanticAnalysis *analysis, Node *n) {
+    Node *var = n->node.loop.var;
+    Node *bounds[] = {n->node.loop.from, n->node.loop.to};
+
+    // The bounds are evaluated outside of the body, before the counter exists
+    for (unsigned i = 0; i < 2; i++) {
+        Type *t = SemanticAnalysis_AnalyseExpression(analysis, bounds[i]);
+
+        if (!t)
+            return STATUS_FAIL;
+
+        if (t->type != TYPE_PRIMITIVE) {
+            SEMANTIC_PRINT("Loop bounds must be of a primitive type, got '%s'.\n", Type_Identifier(t));
+            return STATUS_FAIL;
+        }
+    }
+
+    if (!SemanticAnalysis_AnalyseVariableDeclaration(analysis, var))
+        return STATUS_FAIL;
+
+    if (var->node.var_decl.type->type != TYPE_PRIMITIVE) {
+        SEMANTIC_PRINT("The loop counter '%s' must be of a primitive type, got '%s'.\n", var->node.var_decl.id->value,
+                       Type_Identifier(var->node.var_decl.type));
+        return STATUS_FAIL;
+    }
+
+    for (unsigned i = 0; i < 2; i++) {
+        if (!Type_Assignable(var->node.var_decl.type, bounds[i]->etype)) {
+            SEMANTIC_PRINT("The loop counter '%s' of type '%s' cannot take a bound of effective type '%s'.\n",
+                           var->node.var_decl.id->value, Type_Identifier(var->node.var_decl.type),
+                           Type_Identifier(bounds[i]->etype));
+            return STATUS_FAIL;
+        }
+    }
+
+    return SemanticAnalysis_AnalyseNode(analysis, n->node.loop.block);
+}
+
+// Complex types are program-wide and laid out as soon as they are defined, their fields can only
+// be of types defined before them
+Status SemanticAnalysis_AnalyseComplex(SemanticAnalysis *analysis, Node *n) {
+    Type *type = n->node.complx.type;
+    ComplexType *complx = type->content.complx.ref;
+
+    if (analysis->currentFunction) {
+        SEMANTIC_PRINT("The complex type '%s' must be defined outside of procedures.\n", complx->id->value);
+        return STATUS_FAIL;
+    }
+
+    if (SemanticAnalysis_FindType(analysis, complx->id)) {
+        SEMANTIC_PRINT("The type '%s' is already defined.\n", complx->id->value);
+        return STATUS_FAIL;
+    }
+
+    for (unsigned i = 0; i < complx->fields->length; i++) {
+        ComplexField *field = Array_At(complx->fields, i);
+
+        for (unsigned j = 0; j < i; j++) {
+            ComplexField *other = Array_At(complx->fields, j);
+            if (Token_Cmp(field->id, other->id)) {
+                SEMANTIC_PRINT("The complex type '%s' has more than one field named '%s'.\n", complx->id->value,
+                               field->id->value);
+                return STATUS_FAIL;
+            }
+        }
+
+        Token *id = field->type->content.placeholder.id;
+        Type *t = SemanticAnalysis_FindType(analysis, id);
+
+        if (!t)
+            t = SemanticAnalysis_ResolveArray(analysis, id);
+
+        if (!t || t->type == TYPE_VOID) {
+            SEMANTIC_PRINT("Unresolved type '%s' of the field '%s' in complex type '%s'.\n", id->value,
+                           field->id->value, complx->id->value);
+            return STATUS_FAIL;
+        }
+
+        Type_Destroy(field->type);
+        field->type = t;
+    }
+
+    ComplexType_Layout(complx);
+
+    n->node.complx.registered = true;
+    Array_Push(analysis->types, type);
+
+    SEMANTIC_PRINT("Laid out complex type '%s' in %u byte(s) aligned to %u, %u of them padding.\n",
+                   complx->id->value, complx->size, complx->alignment, complx->padding);
     return STATUS_OK;
 }
 
@@ -192,8 +698,9 @@ Status SemanticAnalysis_AnalyseNode(SemanticAnalysis *analysis, Node *n) {
         return stat;
     }
 
-    if (n->type == NODE_INTEGER_LITERAL || n->type == NODE_BINARY_EXPRESSION || n->type == NODE_FUNCTION_CALL ||
-        n->type == NODE_VARIABLE_REFERENCE) {
+    if (n->type == NODE_INTEGER_LITERAL || n->type == NODE_FLOAT_LITERAL || n->type == NODE_STRING_LITERAL ||
+        n->type == NODE_BINARY_EXPRESSION || n->type == NODE_FUNCTION_CALL || n->type == NODE_VARIABLE_REFERENCE ||
+        n->type == NODE_SIZE || n->type == NODE_INDEX || n->type == NODE_REDUCE) {
         return SemanticAnalysis_AnalyseExpression(analysis, n) != NULL;
     }
 
@@ -201,11 +708,32 @@ Status SemanticAnalysis_AnalyseNode(SemanticAnalysis *analysis, Node *n) {
         return SemanticAnalysis_AnalyseVariableDeclaration(analysis, n);
     }
 
+    if (n->type == NODE_VARIABLE_ASSIGNMENT) {
+        return SemanticAnalysis_AnalyseVariableAssignment(analysis, n);
+    }
+
     if (n->type == NODE_FUNCTION_DEFINITION) {
-        // TODO Handle function definition
+        return SemanticAnalysis_AnalyseFunctionDefinition(analysis, n);
     }
 
-    return STATUS_OK;
+    if (n->type == NODE_RETURN) {
+        return SemanticAnalysis_AnalyseReturn(analysis, n);
+    }
+
+    if (n->type == NODE_CHECK) {
+        return SemanticAnalysis_AnalyseCheck(analysis, n);
+    }
+
+    if (n->type == NODE_LOOP) {
+        return SemanticAnalysis_AnalyseLoop(analysis, n);
+    }
+
+    if (n->type == NODE_COMPLEX) {
+        return SemanticAnalysis_AnalyseComplex(analysis, n);
+    }
+
+    SEMANTIC_PRINT("Unsupported statement of type %s.\n", NodeType_ToString(n->type));
+    return STATUS_FAIL;
 }
 
 Status SemanticAnalysis_RunAnalysis(SemanticAnalysis *analysis) {
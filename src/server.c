@@ -0,0 +1,280 @@
+#include "include/server.h"
+#include "include/compile.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "include/memory.h"
+
+volatile sig_atomic_t Server_Stopping = 0;
+
+void Server_Stop(int sig) {
+    (void) sig;
+    Server_Stopping = 1;
+}
+
+Status Server_Address(const char *path, struct sockaddr_un *addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        SERVER_PRINT("The socket path \"%s\" is too long.\n", path);
+        return STATUS_FAIL;
+    }
+
+    strcpy(addr->sun_path, path);
+    return STATUS_OK;
+}
+
+// Reads or writes all of the buffer, however the socket splits it up
+bool Server_Transfer(int fd, void *buffer, size_t size, bool writing) {
+    char *at = buffer;
+
+    while (size > 0) {
+        ssize_t done = writing ? write(fd, at, size) : read(fd, at, size);
+
+        if (done < 0 && errno == EINTR)
+            continue;
+        if (done <= 0)
+            return false;
+
+        at += done;
+        size -= done;
+    }
+
+    return true;
+}
+
+// A request is its length followed by the working directory of the client and its arguments, each
+// terminated by a NUL. Whatever the compile prints goes back to the client, followed by the trailer.
+void Server_Serve(int client, AstCache *cache, int home) {
+    uint32_t length;
+
+    if (!Server_Transfer(client, &length, sizeof(length), false) || length == 0 || length > SERVER_REQUEST_MAX)
+        return;
+
+    char *request = malloc(length + 1);
+
+    if (!Server_Transfer(client, request, length, false)) {
+        free(request);
+        return;
+    }
+
+    request[length] = 0;
+
+    // The arguments follow the directory, behind the name of the program
+    char *cwd = request;
+    int argc = 1;
+
+    for (uint32_t i = 0; i < length; i++)
+        argc += request[i] == 0;
+
+    char **argv = malloc((argc + 1) * sizeof(char *));
+    argv[0] = "lflow";
+    argc = 1;
+
+    for (char *arg = cwd + strlen(cwd) + 1; arg < request + length; arg += strlen(arg) + 1)
+        argv[argc++] = arg;
+
+    argv[argc] = NULL;
+
+    fflush(stdout);
+    int out = dup(STDOUT_FILENO);
+    dup2(client, STDOUT_FILENO);
+
+    Options opts;
+    Options_Default(&opts);
+    Status status = STATUS_FAIL;
+
+    if (chdir(cwd) != 0) {
+        printf("The server cannot enter \"%s\".\n", cwd);
+    } else if (Options_Parse(&opts, argc, argv) == STATUS_OK) {
+        if (opts.server || opts.connect)
+            printf("A compile request cannot start or reach another server.\n");
+        else
+            status = Compile_Run(&opts, cache);
+    }
+
+    fflush(stdout);
+    dup2(out, STDOUT_FILENO);
+    close(out);
+
+    char trailer[SERVER_TRAILER] = {0, (char) status};
+    Server_Transfer(client, trailer, sizeof(trailer), true);
+
+    if (fchdir(home) != 0) {
+        SERVER_PRINT("Could not return to the directory the server was started in.\n");
+    }
+
+    SERVER_PRINT("Compiled \"%s\" in \"%s\" for a client, %s.\n", opts.input, cwd,
+                 status == STATUS_OK ? "successfully" : "unsuccessfully");
+
+    free(argv);
+    free(request);
+}
+
+// Serves compile requests one at a time until interrupted, keeping the syntax tree of every input
+// in memory for the next request to load or reparse
+Status Server_Run(Options *opts) {
+    struct sockaddr_un addr;
+
+    if (Server_Address(opts->server, &addr) == STATUS_FAIL)
+        return STATUS_FAIL;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0) {
+        SERVER_PRINT("Could not create a socket.\n");
+        return STATUS_FAIL;
+    }
+
+    // A socket left behind by a server that is gone is taken over
+    if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool live = errno == EADDRINUSE && connect(probe, (struct sockaddr *) &addr, sizeof(addr)) == 0;
+        close(probe);
+
+        if (live || unlink(opts->server) != 0 || bind(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+            SERVER_PRINT("Could not listen on \"%s\"%s.\n", opts->server, live ? ", another server is" : "");
+            close(fd);
+            return STATUS_FAIL;
+        }
+    }
+
+    if (listen(fd, 16) != 0) {
+        SERVER_PRINT("Could not listen on \"%s\".\n", opts->server);
+        close(fd);
+        unlink(opts->server);
+        return STATUS_FAIL;
+    }
+
+    // Interrupts end the wait for the next client rather than resuming it
+    struct sigaction stop = {0};
+    stop.sa_handler = Server_Stop;
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    AstCache cache = {opts->ast_cache, Array_Create()};
+    int home = open(".", O_RDONLY);
+
+    SERVER_PRINT("Serving compile requests on \"%s\".\n", opts->server);
+    fflush(stdout);
+
+    while (!Server_Stopping) {
+        int client = accept(fd, NULL, NULL);
+
+        if (client < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        Server_Serve(client, &cache, home);
+        close(client);
+        fflush(stdout);
+    }
+
+    SERVER_PRINT("Stopped serving on \"%s\", %u input(s) were kept in memory.\n", opts->server,
+                 cache.modules->length);
+
+    AstCache_Release(&cache);
+    close(home);
+    close(fd);
+    unlink(opts->server);
+    return STATUS_OK;
+}
+
+// Sends the arguments to the server and prints what it answers, failing if there is none to reach.
+// The status of the compile is that of the trailer, a failure if the reply ends without one.
+Status Server_Request(const char *path, int argc, char **argv, Status *compiled) {
+    struct sockaddr_un addr;
+
+    if (Server_Address(path, &addr) == STATUS_FAIL)
+        return STATUS_FAIL;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0 || connect(fd, (struct sockaddr *) &addr, sizeof(addr)) != 0) {
+        if (fd >= 0)
+            close(fd);
+        SERVER_PRINT("No server is listening on \"%s\", compiling here.\n", path);
+        return STATUS_FAIL;
+    }
+
+    char *cwd = getcwd(NULL, 0);
+    size_t length = cwd ? strlen(cwd) + 1 : 2;
+
+    for (int i = 1; i < argc; i++)
+        if (strncmp(argv[i], "--connect=", 10) != 0)
+            length += strlen(argv[i]) + 1;
+
+    char *request = malloc(length);
+    size_t at = 0;
+
+    strcpy(request, cwd ? cwd : ".");
+    at += strlen(request) + 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--connect=", 10) == 0)
+            continue;
+
+        strcpy(request + at, argv[i]);
+        at += strlen(argv[i]) + 1;
+    }
+
+    uint32_t size = (uint32_t) length;
+    bool sent = length <= SERVER_REQUEST_MAX && Server_Transfer(fd, &size, sizeof(size), true) &&
+                Server_Transfer(fd, request, length, true);
+
+    free(request);
+    free(cwd);
+
+    if (!sent) {
+        close(fd);
+        SERVER_PRINT("Could not send the request to \"%s\", compiling here.\n", path);
+        return STATUS_FAIL;
+    }
+
+    // The last bytes read are held back until the reply ends, as they may be the trailer
+    char buffer[4096 + SERVER_TRAILER];
+    size_t held = 0;
+    ssize_t got;
+
+    fflush(stdout);
+
+    while ((got = read(fd, buffer + held, sizeof(buffer) - held)) != 0) {
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+            break;
+
+        held += got;
+
+        if (held > SERVER_TRAILER) {
+            if (!Server_Transfer(STDOUT_FILENO, buffer, held - SERVER_TRAILER, true))
+                break;
+
+            memmove(buffer, buffer + held - SERVER_TRAILER, SERVER_TRAILER);
+            held = SERVER_TRAILER;
+        }
+    }
+
+    close(fd);
+
+    bool answered = got == 0 && held == SERVER_TRAILER && buffer[0] == 0;
+
+    if (!answered) {
+        Server_Transfer(STDOUT_FILENO, buffer, held, true);
+        SERVER_PRINT("The server on \"%s\" stopped before answering.\n", path);
+    }
+
+    *compiled = answered && buffer[1] == STATUS_OK ? STATUS_OK : STATUS_FAIL;
+    return STATUS_OK;
+}
@@ -0,0 +1,92 @@
+#include "include/trace.h"
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// Chrome trace events, viewed in chrome://tracing or Perfetto. Timestamps are taken from the
+// monotonic clock, shared by every process on the machine, so the traces of the compiles of a
+// build can be merged into one timeline.
+
+bool Trace_Enabled = false;
+
+FILE *Trace_File = NULL;
+unsigned Trace_Events = 0;
+
+// Microseconds, 0 while not tracing
+double Trace_Now() {
+    if (!Trace_Enabled)
+        return 0;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e6 + (double) ts.tv_nsec / 1e3;
+}
+
+void Trace_String(const char *str) {
+    fputc('"', Trace_File);
+
+    for (const char *c = str; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fprintf(Trace_File, "\\%c", *c);
+        else if ((unsigned char) *c < 0x20)
+            fprintf(Trace_File, "\\u%04x", (unsigned char) *c);
+        else
+            fputc(*c, Trace_File);
+    }
+
+    fputc('"', Trace_File);
+}
+
+// Starts an event, leaving it open for its remaining fields
+void Trace_Event(const char *phase, const char *category, const char *name) {
+    fprintf(Trace_File, "%s\n  {\"ph\": \"%s\", \"pid\": %d, \"tid\": %ld, \"cat\": ", Trace_Events++ ? "," : "",
+            phase, (int) getpid(), (long) syscall(SYS_gettid));
+    Trace_String(category);
+    fprintf(Trace_File, ", \"name\": ");
+    Trace_String(name);
+}
+
+// Traces to the file until it is closed, naming the process after what it compiles
+Status Trace_Open(const char *path, const char *process) {
+    Trace_File = fopen(path, "w");
+
+    if (!Trace_File) {
+        TRACE_PRINT("Could not open \"%s\" for writing.\n", path);
+        return STATUS_FAIL;
+    }
+
+    Trace_Enabled = true;
+    Trace_Events = 0;
+
+    fprintf(Trace_File, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+    Trace_Event("M", "lflow", "process_name");
+    fprintf(Trace_File, ", \"args\": {\"name\": ");
+    Trace_String(process);
+    fprintf(Trace_File, "}}");
+
+    return STATUS_OK;
+}
+
+void Trace_Close() {
+    if (!Trace_Enabled)
+        return;
+
+    fprintf(Trace_File, "\n]}\n");
+    fclose(Trace_File);
+
+    Trace_File = NULL;
+    Trace_Enabled = false;
+}
+
+// A span of the category from the start, taken from Trace_Now, until now
+void Trace_Span(const char *category, const char *name, double start) {
+    if (!Trace_Enabled)
+        return;
+
+    double end = Trace_Now();
+
+    Trace_Event("X", category, name);
+    fprintf(Trace_File, ", \"ts\": %.3f, \"dur\": %.3f}", start, end - start);
+}
@@ -1,8 +1,10 @@
 
 #include "include/type.h"
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "include/memory.h"
 
 #define CASE(x, y) case x: return y;
 
@@ -23,10 +25,15 @@ ComplexField *ComplexField_Create(Token *id, Type *type) {
     ComplexField *field = malloc(sizeof(ComplexField));
     field->id = Token_Dup(id);
     field->type = type;
+    field->offset = 0;
     return field;
 }
 
+// Field types are shared once they have been resolved
 void ComplexField_Destroy(ComplexField *field) {
+    if (field->type && field->type->type == TYPE_PLACEHOLDER)
+        Type_Destroy(field->type);
+
     Token_Destroy(field->id);
     free(field);
 }
@@ -35,6 +42,10 @@ ComplexType *ComplexType_Create(Token *id, Array *fields) {
     ComplexType *type = malloc(sizeof(ComplexType));
     type->id = Token_Dup(id);
     type->fields = fields;
+    type->ordered = false;
+    type->size = 0;
+    type->alignment = 1;
+    type->padding = 0;
     return type;
 }
 
@@ -75,10 +86,33 @@ Type *Type_CreatePlaceholder(Token *id) {
     return type;
 }
 
+// The element type is not owned by the array
+Type *Type_CreateArray(Type *element, unsigned length) {
+    const char *name = Type_Identifier(element);
+
+    Type *type = malloc(sizeof(Type));
+    type->type = TYPE_ARRAY;
+    type->content.array.element = element;
+    type->content.array.length = length;
+    type->content.array.id = malloc(strlen(name) + 16);
+    sprintf(type->content.array.id, "%s[%u]", name, length);
+    return type;
+}
+
+Type *Type_CreateVector(Type *element, unsigned lanes) {
+    Type *type = Type_CreateArray(element, lanes);
+    type->type = TYPE_VECTOR;
+    sprintf(type->content.array.id, "%s<%u>", Type_Identifier(element), lanes);
+    return type;
+}
+
 void Type_Destroy(Type *type) {
     if (type->type == TYPE_PLACEHOLDER)
         Token_Destroy(type->content.placeholder.id);
 
+    if (type->type == TYPE_ARRAY || type->type == TYPE_VECTOR)
+        free(type->content.array.id);
+
     if (type->type == TYPE_COMPLEX)
         Token_Destroy(type->content.complx.id);
 
@@ -86,7 +120,8 @@ void Type_Destroy(Type *type) {
 }
 
 void Type_DestroyHard(Type *type) {
-    if (type->type == TYPE_PLACEHOLDER || type->type == TYPE_PRIMITIVE || type->type == TYPE_VOID) {
+    if (type->type == TYPE_PLACEHOLDER || type->type == TYPE_PRIMITIVE || type->type == TYPE_VOID ||
+        type->type == TYPE_ARRAY || type->type == TYPE_VECTOR) {
         Type_Destroy(type);
         return;
     }
@@ -94,6 +129,7 @@ void Type_DestroyHard(Type *type) {
     if (type->type == TYPE_COMPLEX) {
         ComplexType_Destroy(type->content.complx.ref);
         Token_Destroy(type->content.complx.id);
+        free(type);
         return;
     }
 
@@ -114,6 +150,11 @@ const char *Type_Identifier(Type *type) {
 
     if (type->type == TYPE_PLACEHOLDER)
         return type->content.placeholder.id->value;
+
+    if (type->type == TYPE_ARRAY || type->type == TYPE_VECTOR)
+        return type->content.array.id;
+
+    return "(unknown)";
 }
 
 bool Type_Compare(Type *a, Type *b) {
@@ -129,12 +170,35 @@ bool Type_Compare(Type *a, Type *b) {
     if (a->type == TYPE_PLACEHOLDER)
         return strcmp(a->content.placeholder.id->value, b->content.placeholder.id->value) == 0;
 
+    if (a->type == TYPE_ARRAY || a->type == TYPE_VECTOR)
+        return a->content.array.length == b->content.array.length &&
+               Type_Compare(a->content.array.element, b->content.array.element);
+
     if (a->type == TYPE_VOID)
         return true;
 
     return false;
 }
 
+// Whether a value of the second type may be stored in the first one.
+// Primitives are implicitly widened, never narrowed.
+bool Type_Assignable(Type *to, Type *from) {
+    if (!to || !from)
+        return false;
+
+    if (Type_Compare(to, from))
+        return true;
+
+    // Scalars are broadcast to every lane
+    if (to->type == TYPE_VECTOR)
+        return Type_Assignable(to->content.array.element, from);
+
+    if (to->type != TYPE_PRIMITIVE || from->type != TYPE_PRIMITIVE)
+        return false;
+
+    return Type_Quantify(from) <= Type_Quantify(to);
+}
+
 int Type_Quantify(Type *t) {
     if (t->type != TYPE_PRIMITIVE)
         return -1;
@@ -157,4 +221,83 @@ Type *Type_Larger(Type *a, Type *b) {
     if (tA < 0 || tB < 0)
         return NULL;
     return ((tA > tB) ? a : b);
-}
\ No newline at end of file
+}
+
+// In bytes, 0 for void and unresolved types
+unsigned Type_Size(Type *type) {
+    if (!type)
+        return 0;
+
+    switch (type->type) {
+        case TYPE_PRIMITIVE:
+            return Type_Quantify(type) / 8;
+        case TYPE_ARRAY:
+        case TYPE_VECTOR:
+            return Type_Size(type->content.array.element) * type->content.array.length;
+        case TYPE_COMPLEX:
+            return type->content.complx.ref->size;
+        default:
+            return 0;
+    }
+}
+
+// Vectors are aligned to their register, arrays to their elements
+unsigned Type_Alignment(Type *type) {
+    if (!type)
+        return 1;
+
+    switch (type->type) {
+        case TYPE_PRIMITIVE:
+        case TYPE_VECTOR:
+            return Type_Size(type);
+        case TYPE_ARRAY:
+            return Type_Alignment(type->content.array.element);
+        case TYPE_COMPLEX:
+            return type->content.complx.ref->alignment;
+        default:
+            return 1;
+    }
+}
+
+// Every field is placed at the next multiple of its alignment, which is a power of two that
+// divides its size. Unless the type is ordered, fields are placed by decreasing alignment,
+// which leaves no padding but at the end.
+void ComplexType_Layout(ComplexType *type) {
+    unsigned n = type->fields->length;
+    ComplexField **order = malloc((n + 1) * sizeof(ComplexField *));
+
+    // Insertion sort, fields of the same alignment stay in the order of declaration
+    for (unsigned i = 0; i < n; i++) {
+        ComplexField *field = Array_At(type->fields, i);
+        unsigned j = i;
+
+        while (!type->ordered && j > 0 && Type_Alignment(order[j - 1]->type) < Type_Alignment(field->type)) {
+            order[j] = order[j - 1];
+            j--;
+        }
+
+        order[j] = field;
+    }
+
+    unsigned offset = 0;
+    unsigned data = 0;
+    type->alignment = 1;
+
+    for (unsigned i = 0; i < n; i++) {
+        unsigned align = Type_Alignment(order[i]->type);
+        unsigned size = Type_Size(order[i]->type);
+
+        offset = (offset + align - 1) / align * align;
+        order[i]->offset = offset;
+        offset += size;
+        data += size;
+
+        if (align > type->alignment)
+            type->alignment = align;
+    }
+
+    type->size = (offset + type->alignment - 1) / type->alignment * type->alignment;
+    type->padding = type->size - data;
+
+    free(order);
+}
@@ -0,0 +1,452 @@
+#include "include/vectorize.h"
+#include "include/ir.h"
+#include "include/cse.h"
+#include "include/inline.h"
+
+#include <stdlib.h>
+#include "include/memory.h"
+
+Vectorizer *Vectorizer_Create(unsigned width, bool report) {
+    Vectorizer *vec = malloc(sizeof(Vectorizer));
+    vec->width = width;
+    vec->report = report;
+    vec->vectorized = 0;
+    vec->declined = 0;
+    return vec;
+}
+
+void Vectorizer_Destroy(Vectorizer *vec) {
+    free(vec);
+}
+
+VectorInduction *VectorPlan_FindInduction(VectorPlan *plan, Node *n) {
+    Induction *iv = Loop_FindInduction(&plan->loop, n);
+
+    for (unsigned i = 0; iv && i < plan->inductions->length; i++) {
+        VectorInduction *vi = Array_At(plan->inductions, i);
+        if (vi->iv == iv)
+            return vi;
+    }
+
+    return NULL;
+}
+
+VectorStatement *VectorPlan_FindTemporary(VectorPlan *plan, Node *n) {
+    if (n->type != NODE_VARIABLE_REFERENCE || n->node.var_ref.next)
+        return NULL;
+
+    for (unsigned i = 0; i < plan->statements->length; i++) {
+        VectorStatement *vs = Array_At(plan->statements, i);
+        if (vs->kind == VECTOR_TEMPORARY && vs->decl == n->node.var_ref.decl)
+            return vs;
+    }
+
+    return NULL;
+}
+
+VectorInvariant *VectorPlan_FindInvariant(VectorPlan *plan, Node *n) {
+    for (unsigned i = 0; i < plan->invariants->length; i++) {
+        VectorInvariant *inv = Array_At(plan->invariants, i);
+        if (Cse_Equal(inv->leaf, n))
+            return inv;
+    }
+
+    return NULL;
+}
+
+// Width of the value computed by the scalar code, operands are widened to the wider one
+unsigned Vectorize_Width(Node *n) {
+    switch (n->type) {
+        case NODE_VARIABLE_REFERENCE:
+            return Ir_Width(n->node.var_ref.decl->node.var_decl.type);
+        case NODE_SIZE:
+            return 8;
+        case NODE_BINARY_EXPRESSION: {
+            unsigned left = Vectorize_Width(n->node.binary.left);
+            unsigned right = Vectorize_Width(n->node.binary.right);
+            return left > right ? left : right;
+        }
+        default:
+            return Ir_Width(n->etype);
+    }
+}
+
+unsigned Vectorize_Reads(Node *n, Node *decl) {
+    if (!n)
+        return 0;
+
+    if (n->type == NODE_BINARY_EXPRESSION)
+        return Vectorize_Reads(n->node.binary.left, decl) + Vectorize_Reads(n->node.binary.right, decl);
+
+    return n->type == NODE_VARIABLE_REFERENCE && n->node.var_ref.decl == decl;
+}
+
+// Consecutive iterations access consecutive elements when they are indexed by the counter
+const char *Vectorize_Element(VectorPlan *plan, Node *decl, Node *index, bool checked) {
+    if (checked)
+        return "an array access is bounds checked";
+
+    if (index->type != NODE_VARIABLE_REFERENCE || index->node.var_ref.next ||
+        index->node.var_ref.decl != plan->loop.loop->node.loop.var)
+        return "an array is indexed by something other than the counter";
+
+    if (Ir_Width(decl->node.var_decl.type->content.array.element) != plan->width)
+        return "the elements of an array are not as wide as the other values";
+
+    return NULL;
+}
+
+// Lanes compute modulo the element width, which only matches the scalar code when nothing
+// narrower wraps around before being widened. Counters never wrap, they stop short of the bound.
+const char *Vectorize_Expression(Vectorizer *vec, VectorPlan *plan, Node *n, unsigned *binaries) {
+    if (n->etype && n->etype->type == TYPE_VECTOR)
+        return "it computes with vector values";
+
+    switch (n->type) {
+        case NODE_INTEGER_LITERAL:
+        case NODE_SIZE:
+            break;
+
+        case NODE_FLOAT_LITERAL:
+            return "it computes with floating point values";
+
+        case NODE_VARIABLE_REFERENCE: {
+            VectorInduction *vi = VectorPlan_FindInduction(plan, n);
+
+            if (vi) {
+                if (vi->iv->step && Vectorize_Width(n) < plan->width)
+                    return "an induction variable is narrower than the elements and would wrap around";
+
+                vi->read = true;
+                vi->read_after |= vi->advanced;
+                return NULL;
+            }
+
+            VectorStatement *temp = VectorPlan_FindTemporary(plan, n);
+
+            if (temp) {
+                if (Vectorize_Width(n) < plan->width)
+                    return "a variable of the body is narrower than the elements and would wrap around";
+                return NULL;
+            }
+
+            if (!Loop_Invariant(&plan->loop, n))
+                return "it reads a variable that changes from one iteration to the next";
+            break;
+        }
+
+        case NODE_INDEX: {
+            const char *reason = Vectorize_Element(plan, n->node.index.array->node.var_ref.decl, n->node.index.expr,
+                                                   n->node.index.checked);
+
+            // The elements are loaded into a temporary
+            (*binaries)++;
+            return reason;
+        }
+
+        case NODE_BINARY_EXPRESSION: {
+            BinaryType op = n->node.binary.op;
+
+            if (op != BIN_ADD && op != BIN_SUB && op != BIN_MUL)
+                return "it uses operations other than addition, subtraction and multiplication";
+
+            if (op == BIN_MUL && (plan->width == 1 || plan->width == 8))
+                return "there is no vector multiplication of bytes or qwords";
+
+            if (op == BIN_MUL && plan->width == 4 && vec->width < VECTOR_AVX2)
+                return "multiplying dwords needs AVX2";
+
+            if (Vectorize_Width(n) < plan->width)
+                return "part of a computation is narrower than the elements and would wrap around";
+
+            const char *reason = Vectorize_Expression(vec, plan, n->node.binary.left, binaries);
+            if (!reason)
+                reason = Vectorize_Expression(vec, plan, n->node.binary.right, binaries);
+
+            (*binaries)++;
+            return reason;
+        }
+
+        default:
+            return "it computes something other than arithmetic";
+    }
+
+    if (!VectorPlan_FindInvariant(plan, n)) {
+        VectorInvariant *inv = malloc(sizeof(VectorInvariant));
+        inv->leaf = n;
+        inv->reg = IR_NONE;
+        Array_Push(plan->invariants, inv);
+    }
+
+    return NULL;
+}
+
+VectorStatement *Vectorize_AddStatement(VectorPlan *plan, VectorStatementKind kind, Node *decl, Node *expr,
+                                        BinaryType op) {
+    VectorStatement *vs = malloc(sizeof(VectorStatement));
+    vs->kind = kind;
+    vs->decl = decl;
+    vs->expr = expr;
+    vs->op = op;
+    vs->iv = NULL;
+    vs->reg = IR_NONE;
+    Array_Push(plan->statements, vs);
+    return vs;
+}
+
+VectorInduction *Vectorize_Advancing(VectorPlan *plan, Node *s) {
+    for (unsigned i = 0; i < plan->inductions->length; i++) {
+        VectorInduction *vi = Array_At(plan->inductions, i);
+        if (vi->iv->update == s)
+            return vi;
+    }
+
+    return NULL;
+}
+
+// Sort the statements of the body into inductions, reductions and temporaries
+const char *Vectorize_Statements(Vectorizer *vec, VectorPlan *plan) {
+    LoopContext *ctx = &plan->loop;
+    Array *nodes = ctx->body->node.block.nodes;
+
+    // The elements are as wide as the accumulators
+    for (unsigned i = 0; i < nodes->length; i++) {
+        Node *s = Array_At(nodes, i);
+
+        if (s->type != NODE_VARIABLE_ASSIGNMENT || Vectorize_Advancing(plan, s))
+            continue;
+
+        Type *type = s->node.var_assign.decl->node.var_decl.type;
+        unsigned width = Ir_Width(s->node.var_assign.index ? type->content.array.element : type);
+
+        if (width == 0)
+            return "it assigns values other than integers";
+
+        if (plan->width != 0 && plan->width != width)
+            return "it accumulates values of different widths";
+
+        plan->width = width;
+    }
+
+    if (plan->width == 0)
+        return "it accumulates nothing";
+
+    plan->lanes = vec->width / plan->width;
+
+    for (unsigned i = 0; i < nodes->length; i++) {
+        Node *s = Array_At(nodes, i);
+        unsigned binaries = 0;
+        const char *reason = NULL;
+
+        switch (s->type) {
+            case NODE_VARIABLE_DECLARATION: {
+                Node *value = s->node.var_decl.value;
+
+                if (!value || Loop_Assignments(ctx, s) > 0)
+                    return "a variable of the body changes within an iteration";
+
+                reason = Vectorize_Expression(vec, plan, value, &binaries);
+                Vectorize_AddStatement(plan, VECTOR_TEMPORARY, s, value, BIN_ADD);
+                break;
+            }
+
+            case NODE_VARIABLE_ASSIGNMENT: {
+                Node *decl = s->node.var_assign.decl;
+                Node *value = s->node.var_assign.value;
+                VectorInduction *vi = Vectorize_Advancing(plan, s);
+
+                if (vi) {
+                    Vectorize_AddStatement(plan, VECTOR_INDUCTION, decl, NULL, vi->iv->op)->iv = vi;
+                    vi->advanced = true;
+                    break;
+                }
+
+                if (s->node.var_assign.index) {
+                    if (!value)
+                        return "an element is only checked, not stored";
+
+                    reason = Vectorize_Element(plan, decl, s->node.var_assign.index, s->node.var_assign.checked);
+                    if (!reason)
+                        reason = Vectorize_Expression(vec, plan, value, &binaries);
+                    Vectorize_AddStatement(plan, VECTOR_STORE, decl, value, BIN_ADD);
+                    break;
+                }
+
+                if (value->type != NODE_BINARY_EXPRESSION || Loop_Assignments(ctx, decl) != 1 ||
+                    Inline_Within(decl->super, ctx->body))
+                    return "a variable carries a value other than a sum from one iteration to the next";
+
+                Node *left = value->node.binary.left;
+                Node *right = value->node.binary.right;
+                BinaryType op = value->node.binary.op;
+                Node *expr;
+
+                if ((op == BIN_ADD || op == BIN_SUB) && Loop_Refers(left, decl))
+                    expr = right;
+                else if (op == BIN_ADD && Loop_Refers(right, decl))
+                    expr = left;
+                else
+                    return "a variable carries a value other than a sum from one iteration to the next";
+
+                unsigned reads = 0;
+                for (unsigned k = 0; k < nodes->length; k++) {
+                    Node *other = Array_At(nodes, k);
+                    if (other->type == NODE_VARIABLE_DECLARATION)
+                        reads += Vectorize_Reads(other->node.var_decl.value, decl);
+                    else if (other->type == NODE_VARIABLE_ASSIGNMENT)
+                        reads += Vectorize_Reads(other->node.var_assign.value, decl);
+                }
+
+                if (reads != 1)
+                    return "a sum is read while it is being accumulated";
+
+                reason = Vectorize_Expression(vec, plan, expr, &binaries);
+                Vectorize_AddStatement(plan, VECTOR_REDUCTION, decl, expr, op);
+                break;
+            }
+
+            case NODE_CHECK:
+            case NODE_LOOP:
+            case NODE_BLOCK:
+                return "its body branches";
+
+            case NODE_RETURN:
+                return "it returns from within its body";
+
+            case NODE_FUNCTION_DEFINITION:
+                return "it defines procedures";
+
+            default:
+                return "its body has statements other than assignments";
+        }
+
+        if (reason)
+            return reason;
+
+        if (binaries > plan->temps)
+            plan->temps = binaries;
+    }
+
+    return NULL;
+}
+
+// Vector registers are handed out once, the lowering follows the plan
+void Vectorize_Allocate(VectorPlan *plan) {
+    int next = 0;
+
+    for (unsigned i = 0; i < plan->inductions->length; i++) {
+        VectorInduction *vi = Array_At(plan->inductions, i);
+
+        vi->advanced = false;
+
+        if (!vi->read)
+            continue;
+
+        vi->reg = next++;
+        vi->stride = next++;
+
+        if (vi->read_after) {
+            vi->step = next++;
+            vi->after = next++;
+        }
+    }
+
+    for (unsigned i = 0; i < plan->statements->length; i++) {
+        VectorStatement *vs = Array_At(plan->statements, i);
+        if (vs->kind != VECTOR_INDUCTION && vs->kind != VECTOR_STORE)
+            vs->reg = next++;
+    }
+
+    for (unsigned i = 0; i < plan->invariants->length; i++)
+        ((VectorInvariant *) Array_At(plan->invariants, i))->reg = next++;
+
+    plan->registers = (unsigned) next;
+}
+
+const char *Vectorize_Analyse(Vectorizer *vec, VectorPlan *plan) {
+    LoopContext *ctx = &plan->loop;
+
+    Loop_Scan(ctx, ctx->body);
+
+    if (ctx->calls)
+        return "it calls procedures";
+
+    Loop_Inductions(ctx);
+
+    for (unsigned i = 0; i < ctx->inductions->length; i++) {
+        VectorInduction *vi = malloc(sizeof(VectorInduction));
+        vi->iv = Array_At(ctx->inductions, i);
+        vi->reg = IR_NONE;
+        vi->stride = IR_NONE;
+        vi->step = IR_NONE;
+        vi->after = IR_NONE;
+        vi->read = false;
+        vi->read_after = false;
+        vi->advanced = false;
+        Array_Push(plan->inductions, vi);
+    }
+
+    const char *reason = Vectorize_Statements(vec, plan);
+
+    if (reason)
+        return reason;
+
+    Vectorize_Allocate(plan);
+
+    if (plan->registers + plan->temps > VECTOR_REGISTERS)
+        return "it needs more vector registers than there are";
+
+    return NULL;
+}
+
+// Whether the loop is vectorized, reporting the decision. The plan is released by the caller either way.
+bool Vectorize_Plan(Vectorizer *vec, VectorPlan *plan, Node *loop, Node *fn) {
+    plan->stats = (LoopStatistics) {0};
+    plan->loop = (LoopContext) {&plan->stats, loop, loop->node.loop.block, NULL, 0, Array_Create(), false,
+                                Array_Create(), Array_Create(), Array_Create()};
+    plan->width = 0;
+    plan->lanes = 0;
+    plan->inductions = Array_Create();
+    plan->invariants = Array_Create();
+    plan->statements = Array_Create();
+    plan->registers = 0;
+    plan->temps = 0;
+
+    if (vec->width == 0)
+        return false;
+
+    const char *reason = Vectorize_Analyse(vec, plan);
+    const char *where = fn ? fn->node.func_def.id->value : "(program)";
+    const char *counter = loop->node.loop.var->node.var_decl.id->value;
+
+    if (reason) {
+        vec->declined++;
+
+        if (vec->report) {
+            EMIT_PRINT("Not vectorizing the loop over '%s' in '%s': %s.\n", counter, where, reason);
+        }
+
+        return false;
+    }
+
+    vec->vectorized++;
+
+    if (vec->report) {
+        EMIT_PRINT("Vectorizing the loop over '%s' in '%s' (%u lanes of %u byte(s) with %s, %u vector register(s)).\n",
+                   counter, where, plan->lanes, plan->width, vec->width == VECTOR_AVX2 ? "AVX2" : "SSE2",
+                   plan->registers + plan->temps);
+    }
+
+    return true;
+}
+
+void VectorPlan_Release(VectorPlan *plan) {
+    Array_Destroy(plan->loop.assigned);
+    Array_DestroyCallBack(plan->loop.inductions, free);
+    Array_Destroy(plan->loop.reductions);
+    Array_Destroy(plan->loop.hoisted);
+
+    Array_DestroyCallBack(plan->inductions, free);
+    Array_DestroyCallBack(plan->invariants, free);
+    Array_DestroyCallBack(plan->statements, free);
+}
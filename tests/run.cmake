@@ -0,0 +1,107 @@
+# Compiles a program with lflow, assembles and runs it, failing unless it exits with EXPECT
+#
+#   LFLOW          The compiler
+#   CC             Assembles and links the generated code
+#   SOURCE         Program to compile
+#   WORK           Directory the program is compiled and run in, emptied first
+#   EXPECT         Exit code of the program, or "trap" if a check must stop it
+#   FLAGS          Compiler options, separated by spaces
+#   MODULES        Modules compiled with --module and FLAGS before the program and linked with it, separated by spaces
+#   PROFILE        Compile it instrumented and run it first, then compile it with the profile
+#   EDIT           Compile and run the program, then compile EDIT in its place and run that
+#   EXPECT_BEFORE  Exit code of the program before the edit
+#   OUTPUT         Regular expression the messages of the last compile must match
+#   REQUIRES       Processor feature the program needs, it is skipped without it
+
+if (REQUIRES)
+    file(READ /proc/cpuinfo cpuinfo)
+
+    if (NOT cpuinfo MATCHES "[ \t]${REQUIRES}[ \n]")
+        message("Skipped: the processor has no ${REQUIRES}.")
+        return()
+    endif ()
+endif ()
+
+file(REMOVE_RECURSE ${WORK})
+file(MAKE_DIRECTORY ${WORK})
+
+separate_arguments(flags UNIX_COMMAND "${FLAGS}")
+separate_arguments(modules UNIX_COMMAND "${MODULES}")
+get_filename_component(program ${SOURCE} NAME)
+set(assembly)
+
+function(lflow_compile source options)
+    get_filename_component(name ${program} NAME_WE)
+    configure_file(${source} ${WORK}/${program} COPYONLY)
+
+    execute_process(COMMAND ${LFLOW} ${program} ${options} ${flags} -o ${name}.s
+                    WORKING_DIRECTORY ${WORK} RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "Compiling ${source} failed (${result}):\n${output}")
+    endif ()
+
+    set(output "${output}" PARENT_SCOPE)
+endfunction()
+
+function(lflow_run expect)
+    get_filename_component(name ${program} NAME_WE)
+
+    execute_process(COMMAND ${CC} -o ${name} ${name}.s ${assembly}
+                    WORKING_DIRECTORY ${WORK} RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "Assembling ${name}.s failed:\n${output}")
+    endif ()
+
+    execute_process(COMMAND ${WORK}/${name} WORKING_DIRECTORY ${WORK} RESULT_VARIABLE result)
+
+    # A failed check executes ud2, the program does not exit on its own
+    if (expect STREQUAL "trap")
+        set(expect "Illegal instruction")
+    endif ()
+
+    if (NOT result STREQUAL expect)
+        message(FATAL_ERROR "${program} exited with ${result}, expected ${expect}.")
+    endif ()
+endfunction()
+
+foreach (module ${modules})
+    get_filename_component(name ${module} NAME_WE)
+    configure_file(${module} ${WORK}/${name}.flow COPYONLY)
+
+    execute_process(COMMAND ${LFLOW} --module ${name}.flow ${flags} -o ${name}.s
+                    WORKING_DIRECTORY ${WORK} RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "Compiling the module ${module} failed (${result}):\n${output}")
+    endif ()
+
+    list(APPEND assembly ${name}.s)
+endforeach ()
+
+if (PROFILE)
+    lflow_compile(${SOURCE} --profile-generate=profile.data)
+    lflow_run(${EXPECT})
+    set(profile --profile-use=profile.data)
+endif ()
+
+if (EDIT)
+    if (NOT DEFINED EXPECT_BEFORE)
+        set(EXPECT_BEFORE ${EXPECT})
+    endif ()
+
+    lflow_compile(${SOURCE} "${profile}")
+    lflow_run(${EXPECT_BEFORE})
+    lflow_compile(${EDIT} "${profile}")
+else ()
+    lflow_compile(${SOURCE} "${profile}")
+endif ()
+
+message("${output}")
+
+if (OUTPUT AND NOT output MATCHES "${OUTPUT}")
+    message(FATAL_ERROR "The messages of the compiler do not match \"${OUTPUT}\".")
+endif ()
+
+lflow_run(${EXPECT})